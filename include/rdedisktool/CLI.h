@@ -10,6 +10,8 @@
 #include <memory>
 #include <optional>
 #include <cstdint>
+#include <filesystem>
+#include <list>
 #include <unordered_map>
 
 namespace rde {
@@ -23,8 +25,8 @@ class FileSystemHandler;
  * Used to reduce code duplication in command handlers
  */
 struct LoadedDisk {
-    std::unique_ptr<DiskImage> image;
-    std::unique_ptr<FileSystemHandler> handler;
+    std::shared_ptr<DiskImage> image;
+    std::shared_ptr<FileSystemHandler> handler;
     DiskFormat format = DiskFormat::Unknown;
 
     // Allow implicit bool conversion for easy null checking
@@ -111,8 +113,12 @@ public:
 private:
 public:
     struct FileDigest {
+        std::string path;
         size_t size = 0;
-        uint64_t hash = 0;
+        uint64_t hash = 0;          // whole-file digest when extents are unknown
+        bool byExtent = false;      // extents/extentHashes describe the file
+        std::vector<std::pair<size_t, size_t>> extents;  // (offset, length) in raw data
+        std::vector<uint64_t> extentHashes;
     };
 
     struct SafeAddSnapshot {
@@ -138,9 +144,30 @@ private:
     bool m_forceBootDisk = false;
     bool m_forceSystemFile = false;
     bool m_keepBackup = false;
+    bool m_fsync = false;
+    bool m_inPlace = false;
+    enum class OutputMode { Text, Json, NDJson };
+    OutputMode m_outputMode = OutputMode::Text;
+    enum class StatsMode { Off, Text, Json };
+    StatsMode m_statsMode = StatsMode::Off;
     std::optional<BootDiskProfile> m_forcedBootProfile;
     std::string m_globalOptionError;
 
+    // serve: images stay loaded between requests (see Serve.cpp)
+    struct CachedDisk {
+        std::string key;                // absolute, normalized image path
+        LoadedDisk disk;
+        std::filesystem::file_time_type mtime{};
+        uintmax_t size = 0;
+        bool dirty = false;             // changed since the last flush
+        bool touched = false;           // opened by the current request
+        std::shared_ptr<DiskImage> undo;  // copy of the image before the request
+    };
+    bool m_serving = false;
+    bool m_requestMutates = false;
+    size_t m_diskCacheLimit = 8;
+    std::list<CachedDisk> m_diskCache;  // most recently used first
+
     // Built-in command handlers
     int cmdInfo(const std::vector<std::string>& args);
     int cmdList(const std::vector<std::string>& args);
@@ -154,7 +181,15 @@ private:
     int cmdDump(const std::vector<std::string>& args);
     int cmdRename(const std::vector<std::string>& args);
     int cmdValidate(const std::vector<std::string>& args);
+    int cmdCompact(const std::vector<std::string>& args);
+    int cmdDiff(const std::vector<std::string>& args);
+    int cmdPatch(const std::vector<std::string>& args);
     int cmdListFormats(const std::vector<std::string>& args);
+    int cmdServe(const std::vector<std::string>& args);
+    int cmdScan(const std::vector<std::string>& args);
+    int cmdIndex(const std::vector<std::string>& args);
+    int indexBuild(const std::vector<std::string>& args);
+    int indexQuery(const std::vector<std::string>& args);
 
     // Macintosh AppleDouble / MacBinary export helper called from cmdExtract.
     // Defined in CLI.cpp where LoadedDisk is in scope.
@@ -179,6 +214,8 @@ private:
     LoadedDisk loadDiskImage(const std::string& imagePath);
     LoadedDisk loadDiskImageOnly(const std::string& imagePath);
     bool saveDiskImage(DiskImage* image, const std::string& operation);
+    bool writeDiskImage(DiskImage* image, const std::string& operation);
+    void recoverInterruptedSave(const std::string& imagePath);
     bool captureSafeAddSnapshot(const LoadedDisk& disk,
                                 BootDiskProfile profile,
                                 SafeAddSnapshot& snapshot,
@@ -188,6 +225,13 @@ private:
                                const SafeAddSnapshot& snapshot,
                                const std::string& addedTarget,
                                std::string& error) const;
+
+    // serve-mode disk cache
+    bool lookupCachedDisk(const std::string& imagePath, LoadedDisk& disk);
+    void cacheLoadedDisk(const std::string& imagePath, const LoadedDisk& disk);
+    bool flushCachedDisk(CachedDisk& entry);
+    void finishServeRequest(bool failed);
+    std::string serveRequest(const std::string& line, bool& stop);
 };
 
 } // namespace rde
@@ -5,7 +5,9 @@
 #include "rdedisktool/Exceptions.h"
 #include <string>
 #include <vector>
+#include <map>
 #include <memory>
+#include <optional>
 #include <filesystem>
 
 namespace rde {
@@ -20,8 +22,7 @@ class DiskImage {
 public:
     virtual ~DiskImage() = default;
 
-    // Prevent copying, allow moving
-    DiskImage(const DiskImage&) = delete;
+    // Prevent copying (use clone()), allow moving
     DiskImage& operator=(const DiskImage&) = delete;
     DiskImage(DiskImage&&) = default;
     DiskImage& operator=(DiskImage&&) = default;
@@ -96,6 +97,41 @@ public:
      */
     virtual std::filesystem::path getFilePath() const = 0;
 
+    /**
+     * Record that the file at `path` now holds exactly this image (e.g. a
+     * save to a temporary file was renamed onto it): updates the file path
+     * and clears the modified flag without re-reading the file.
+     */
+    void markSavedAs(const std::filesystem::path& path) {
+        m_filePath = path;
+        m_modified = false;
+        m_dirty.clear();
+    }
+
+    /**
+     * Byte ranges of getRawData() written since the image was loaded or
+     * last saved, merged and keyed by start offset (value = end offset).
+     */
+    const std::map<size_t, size_t>& dirtyRanges() const { return m_dirty; }
+
+    /**
+     * File offset of getRawData() when the file is exactly that data after
+     * a fixed-size header, so dirtyRanges() can be rewritten in place.
+     * std::nullopt for encoded or compressed containers.
+     */
+    virtual std::optional<uint64_t> flatDataOffset() const { return std::nullopt; }
+
+    /**
+     * Offset of a sector within getRawData(), using the same addressing as
+     * readSector(). std::nullopt when sectors are not stored verbatim.
+     */
+    virtual std::optional<size_t> sectorOffset(size_t track, size_t side, size_t sector) const {
+        (void)track;
+        (void)side;
+        (void)sector;
+        return std::nullopt;
+    }
+
     //=========================================================================
     // Low-Level Sector Access
     //=========================================================================
@@ -176,6 +212,12 @@ public:
      */
     virtual void setRawData(const std::vector<uint8_t>& data) = 0;
 
+    /**
+     * Copy of the complete in-memory image, including state kept outside
+     * getRawData() (sparse DIM tracks, pending NIB/WOZ sector writes)
+     */
+    virtual std::unique_ptr<DiskImage> clone() const = 0;
+
     //=========================================================================
     // Format Conversion
     //=========================================================================
@@ -210,6 +252,13 @@ public:
 
 protected:
     DiskImage() = default;
+    DiskImage(const DiskImage&) = default;
+
+    // Dirty-range bookkeeping for writers of m_data.
+    void markDirty(size_t offset, size_t length);
+    void clearDirty() { m_dirty.clear(); }
+    // Replace m_data, marking only the 512-byte chunks that differ.
+    void assignRawData(const std::vector<uint8_t>& data);
 
     // Common state
     std::filesystem::path m_filePath;
@@ -217,6 +266,7 @@ protected:
     DiskGeometry m_geometry;
     bool m_writeProtected = false;
     bool m_modified = false;
+    std::map<size_t, size_t> m_dirty;   // start -> end, non-overlapping
 };
 
 } // namespace rde
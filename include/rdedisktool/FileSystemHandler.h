@@ -6,6 +6,7 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <utility>
 
 namespace rde {
 
@@ -81,6 +82,15 @@ public:
      */
     virtual size_t getTotalSpace() const = 0;
 
+    /**
+     * Get the disk space a file with this content would take, in bytes
+     * (file systems that leave holes in sparse files report less than
+     * the data size)
+     */
+    virtual size_t getRequiredSpace(const std::vector<uint8_t>& data) const {
+        return data.size();
+    }
+
     /**
      * Check if a file exists
      */
@@ -150,6 +160,21 @@ public:
         return false;
     }
 
+    /**
+     * Locate a file's storage inside the disk image's raw data
+     * @param filename File name or path
+     * @param extents Receives (offset, length) runs of getRawData() holding
+     *                the file's data, resource fork and index/list blocks
+     * @return false if the image does not keep sectors verbatim in its raw
+     *         data or the handler cannot map files (use readFile instead)
+     */
+    virtual bool getFileExtents(const std::string& filename,
+                                std::vector<std::pair<size_t, size_t>>& extents) {
+        (void)filename;
+        (void)extents;
+        return false;
+    }
+
     /**
      * Create appropriate handler for a disk's file system
      * @param disk Disk image to create handler for
@@ -165,6 +190,14 @@ public:
     static std::unique_ptr<FileSystemHandler> createForType(FileSystemType type);
 
 protected:
+    /**
+     * Append `length` bytes at a sector's raw offset to a getFileExtents()
+     * list, merging with the previous run when contiguous
+     * @return false if the image has no raw offset for the sector
+     */
+    bool appendSectorExtent(std::vector<std::pair<size_t, size_t>>& extents,
+                            size_t track, size_t side, size_t sector, size_t length) const;
+
     DiskImage* m_disk = nullptr;
 };
 
@@ -0,0 +1,56 @@
+#ifndef RDEDISKTOOL_SHA256_H
+#define RDEDISKTOOL_SHA256_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rde {
+
+/**
+ * SHA-256 (FIPS 180-4) for content addressing of files and images
+ */
+class SHA256 {
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    SHA256();
+
+    /**
+     * Feed more data into the running hash
+     */
+    void update(const uint8_t* data, size_t length);
+
+    /**
+     * Pad and return the digest; the object must not be updated afterwards
+     */
+    Digest finish();
+
+    static Digest digest(const uint8_t* data, size_t length);
+    static Digest digest(const std::vector<uint8_t>& data);
+
+    /**
+     * Lowercase hex form of a digest
+     */
+    static std::string toHex(const Digest& digest);
+
+    /**
+     * Parse a 64-digit hex digest (either case)
+     * @return false if `hex` is not a valid digest
+     */
+    static bool fromHex(const std::string& hex, Digest& digest);
+
+private:
+    void compress(const uint8_t* block);
+
+    uint32_t m_state[8];
+    uint8_t m_block[64];
+    size_t m_blockLength = 0;
+    uint64_t m_totalLength = 0;
+};
+
+} // namespace rde
+
+#endif // RDEDISKTOOL_SHA256_H
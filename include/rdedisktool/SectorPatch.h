@@ -0,0 +1,109 @@
+#ifndef RDEDISKTOOL_SECTORPATCH_H
+#define RDEDISKTOOL_SECTORPATCH_H
+
+#include "rdedisktool/SHA256.h"
+#include "rdedisktool/Types.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace rde {
+
+class DiskImage;
+
+/**
+ * Delta between the decoded sector streams of two disk images.
+ *
+ * Sectors are taken in (track, side, sector) order through readSector(),
+ * so the same disk in different containers (DSK/DMK/XSA, IMG/DC42/MOOF)
+ * yields the same stream and the same patch. The patch is a run-length
+ * list of operations, each covering a run of new sectors:
+ *   SAME n       - the old sectors at the same positions
+ *   COPY src n   - old sectors src..src+n-1
+ *   FILL byte n  - sectors filled with one byte value
+ *   DATA n bytes - literal sectors
+ * The header records both geometries and the SHA-256 of both streams, so
+ * a patch refuses to apply to the wrong base and verifies its result; a
+ * CRC-32 trailer covers the whole file.
+ */
+class SectorPatch {
+public:
+    struct Stats {
+        size_t same = 0;
+        size_t copied = 0;
+        size_t filled = 0;
+        size_t literal = 0;
+    };
+
+    /**
+     * Called for each new sector in order; `same` is true when the sector
+     * equals the old sector at the same position
+     */
+    using SectorSink = std::function<void(size_t index, const SectorBuffer& data, bool same)>;
+
+    /**
+     * Diff two images' sector streams
+     * @throws InvalidFormatException if the sector sizes differ
+     */
+    static SectorPatch create(DiskImage& oldImage, DiskImage& newImage);
+
+    /**
+     * Decode a patch file's contents
+     * @throws InvalidFormatException if it is not a valid patch
+     */
+    static SectorPatch parse(const std::vector<uint8_t>& bytes);
+
+    std::vector<uint8_t> serialize() const;
+
+    /**
+     * Replay the patch over `oldSectors`, handing every new sector to `sink`
+     * @throws InvalidFormatException if `oldSectors` is not the patch base or
+     *         the result does not hash to the recorded new stream
+     */
+    void apply(const std::vector<SectorBuffer>& oldSectors, const SectorSink& sink) const;
+
+    /**
+     * Check that an image now reads back as the patch result
+     * @throws InvalidFormatException if it does not
+     */
+    void verify(DiskImage& image) const;
+
+    const DiskGeometry& oldGeometry() const { return m_oldGeometry; }
+    const DiskGeometry& newGeometry() const { return m_newGeometry; }
+    const Stats& stats() const { return m_stats; }
+
+    /**
+     * Decoded sectors of an image in (track, side, sector) order
+     * @throws DiskException if any sector cannot be read
+     */
+    static std::vector<SectorBuffer> readSectors(DiskImage& image);
+
+    /**
+     * readSector()/writeSector() address of the n-th sector of that stream
+     */
+    static void sectorAddress(const DiskImage& image, size_t index,
+                              size_t& track, size_t& side, size_t& sector);
+
+    /**
+     * Cylinders x sides x sectors of an image's stream. X68000 images count
+     * every side in `tracks`; this divides that back out.
+     */
+    static DiskGeometry streamGeometry(const DiskImage& image);
+
+    /**
+     * Inverse of streamGeometry(), for DiskImageFactory::create()
+     */
+    static DiskGeometry containerGeometry(DiskFormat format, const DiskGeometry& stream);
+
+private:
+    DiskGeometry m_oldGeometry;
+    DiskGeometry m_newGeometry;
+    SHA256::Digest m_oldHash{};
+    SHA256::Digest m_newHash{};
+    std::vector<uint8_t> m_ops;
+    Stats m_stats;
+};
+
+} // namespace rde
+
+#endif // RDEDISKTOOL_SECTORPATCH_H
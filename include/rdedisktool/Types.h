@@ -28,6 +28,7 @@ enum class DiskFormat {
     AppleNIB2,      // Nibble 6384 format (.nb2)
     AppleWOZ1,      // WOZ v1 (.woz)
     AppleWOZ2,      // WOZ v2 (.woz)
+    AppleHDV,       // ProDOS block device (.hdv / .2mg)
     // MSX formats
     MSXDSK,         // Standard DSK (.dsk)
     MSXDMK,         // DMK format (.dmk)
@@ -219,6 +220,7 @@ inline const char* formatToString(DiskFormat f) {
         case DiskFormat::AppleNIB2: return "Apple II Nibble 6384";
         case DiskFormat::AppleWOZ1: return "Apple II WOZ v1";
         case DiskFormat::AppleWOZ2: return "Apple II WOZ v2";
+        case DiskFormat::AppleHDV: return "Apple II Block Image (HDV/2MG)";
         case DiskFormat::MSXDSK: return "MSX DSK";
         case DiskFormat::MSXDMK: return "MSX DMK";
         case DiskFormat::MSXXSA: return "MSX XSA";
@@ -243,6 +245,7 @@ inline const char* formatToIdentifier(DiskFormat f) {
         case DiskFormat::AppleNIB2: return "AppleNIB2";
         case DiskFormat::AppleWOZ1: return "AppleWOZ1";
         case DiskFormat::AppleWOZ2: return "AppleWOZ2";
+        case DiskFormat::AppleHDV: return "AppleHDV";
         case DiskFormat::MSXDSK: return "MSXDSK";
         case DiskFormat::MSXDMK: return "MSXDMK";
         case DiskFormat::MSXXSA: return "MSXXSA";
@@ -264,6 +267,7 @@ inline const char* formatToExtension(DiskFormat f) {
         case DiskFormat::AppleNIB2: return ".nb2";
         case DiskFormat::AppleWOZ1:
         case DiskFormat::AppleWOZ2: return ".woz";
+        case DiskFormat::AppleHDV: return ".hdv";
         case DiskFormat::MSXDSK: return ".dsk";
         case DiskFormat::MSXDMK: return ".dmk";
         case DiskFormat::MSXXSA: return ".xsa";
@@ -284,6 +288,7 @@ inline DiskFormat stringToFormat(const std::string& s) {
     if (s == "nb2" || s == "nibble2") return DiskFormat::AppleNIB2;
     if (s == "woz" || s == "woz1") return DiskFormat::AppleWOZ1;
     if (s == "woz2") return DiskFormat::AppleWOZ2;
+    if (s == "hdv" || s == "2mg" || s == "2img" || s == "applehdv") return DiskFormat::AppleHDV;
     // MSX formats
     if (s == "dsk" || s == "msxdsk" || s == "msx") return DiskFormat::MSXDSK;
     if (s == "dmk" || s == "msxdmk") return DiskFormat::MSXDMK;
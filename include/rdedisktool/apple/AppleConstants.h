@@ -70,6 +70,8 @@ namespace ProDOS {
     constexpr size_t BLOCK_SIZE = 512;
     constexpr size_t BLOCKS_PER_TRACK = 8;
     constexpr size_t TOTAL_BLOCKS = 280;          // 140K disk
+    constexpr size_t MAX_VOLUME_BLOCKS = 65535;   // 32MB block device
+    constexpr size_t BLOCKS_PER_BITMAP_BLOCK = 4096;
 
     // System Block Locations
     constexpr size_t BOOT_BLOCK = 0;
@@ -30,6 +30,8 @@ public:
     void create(const DiskGeometry& geometry) override;
 
     DiskFormat getFormat() const override { return DiskFormat::AppleDO; }
+    std::optional<uint64_t> flatDataOffset() const override { return 0; }
+    std::optional<size_t> sectorOffset(size_t track, size_t side, size_t sector) const override;
 
     SectorBuffer readSector(size_t track, size_t side, size_t sector) override;
     void writeSector(size_t track, size_t side, size_t sector,
@@ -40,6 +42,7 @@ public:
 
     bool canConvertTo(DiskFormat format) const override;
     std::unique_ptr<DiskImage> convertTo(DiskFormat format) const override;
+    std::unique_ptr<DiskImage> clone() const override { return std::make_unique<AppleDOImage>(*this); }
 
     bool validate() const override;
     std::string getDiagnostics() const override;
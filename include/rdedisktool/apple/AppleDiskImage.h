@@ -81,6 +81,15 @@ public:
      */
     void writeBlock(size_t block, const SectorBuffer& data) override;
 
+    /**
+     * Locate the two sectors (readSector() numbering) that hold a block
+     * @param block Block number
+     * @param track Receives the track
+     * @param sector1 Receives the sector with the first 256 bytes
+     * @param sector2 Receives the sector with the last 256 bytes
+     */
+    void blockToSectors(size_t block, size_t& track, size_t& sector1, size_t& sector2) const;
+
     /**
      * Get total number of ProDOS blocks
      */
@@ -0,0 +1,112 @@
+#ifndef RDEDISKTOOL_APPLE_HDVIMAGE_H
+#define RDEDISKTOOL_APPLE_HDVIMAGE_H
+
+#include "rdedisktool/DiskImage.h"
+#include "rdedisktool/Types.h"
+
+namespace rde {
+
+/**
+ * Apple II block device image (.hdv / .2mg)
+ *
+ * A flat array of 512-byte ProDOS blocks, as used for hard disks,
+ * 3.5" 800K disks and other ProDOS volumes of up to 65535 blocks.
+ * Block N lives at offset N * 512 of the payload, so block access is
+ * a single offset computation with no sector translation.
+ *
+ * File structure:
+ * - .hdv / large .po: the raw block array
+ * - .2mg: a 64-byte "2IMG" header, the block array, then the optional
+ *   comment and creator chunks. Only ProDOS-order 2MG payloads are
+ *   accepted.
+ *
+ * The 2MG header is written when saving to a .2mg/.2img path, omitted
+ * for .hdv/.po, and otherwise kept as it was loaded.
+ *
+ * Geometry is reported as one 512-byte sector per "track", one track
+ * per block.
+ */
+class AppleHDVImage : public DiskImage {
+public:
+    static constexpr size_t BLOCK_SIZE = 512;
+    static constexpr size_t MAX_BLOCKS = 65535;
+    static constexpr size_t HEADER_2MG_SIZE = 64;
+    static constexpr uint32_t FORMAT_2MG_PRODOS = 1;
+    static constexpr uint32_t FLAG_2MG_LOCKED = 0x80000000;
+
+    AppleHDVImage();
+    ~AppleHDVImage() override = default;
+
+    //=========================================================================
+    // DiskImage Interface
+    //=========================================================================
+
+    void load(const std::filesystem::path& path) override;
+    void save(const std::filesystem::path& path = {}) override;
+    void create(const DiskGeometry& geometry) override;
+
+    Platform getPlatform() const override { return Platform::AppleII; }
+    DiskFormat getFormat() const override { return DiskFormat::AppleHDV; }
+    FileSystemType getFileSystemType() const override;
+    DiskGeometry getGeometry() const override { return m_geometry; }
+    bool isWriteProtected() const override { return m_writeProtected; }
+    void setWriteProtected(bool protect) override { m_writeProtected = protect; }
+    bool isModified() const override { return m_modified; }
+    std::filesystem::path getFilePath() const override { return m_filePath; }
+
+    std::optional<size_t> sectorOffset(size_t track, size_t side, size_t sector) const override;
+
+    SectorBuffer readSector(size_t track, size_t side, size_t sector) override;
+    void writeSector(size_t track, size_t side, size_t sector,
+                    const SectorBuffer& data) override;
+
+    TrackBuffer readTrack(size_t track, size_t side) override;
+    void writeTrack(size_t track, size_t side, const TrackBuffer& data) override;
+
+    SectorBuffer readBlock(size_t block) override;
+    void writeBlock(size_t block, const SectorBuffer& data) override;
+    size_t getTotalBlocks() const override { return m_data.size() / BLOCK_SIZE; }
+
+    const std::vector<uint8_t>& getRawData() const override { return m_data; }
+    void setRawData(const std::vector<uint8_t>& data) override;
+
+    bool canConvertTo(DiskFormat format) const override;
+    std::unique_ptr<DiskImage> convertTo(DiskFormat format) const override;
+    std::unique_ptr<DiskImage> clone() const override { return std::make_unique<AppleHDVImage>(*this); }
+
+    bool validate() const override;
+    std::string getDiagnostics() const override;
+
+    //=========================================================================
+    // 2MG Container
+    //=========================================================================
+
+    /**
+     * Check whether the image carries a 2MG header
+     */
+    bool has2MGHeader() const { return m_has2MGHeader; }
+
+    /**
+     * Choose whether save() writes a 2MG header (overridden by a .2mg or
+     * .hdv target extension)
+     */
+    void set2MGHeader(bool enable) { m_has2MGHeader = enable; }
+
+private:
+    void parse2MG(const std::vector<uint8_t>& file);
+    std::vector<uint8_t> build2MGHeader() const;
+    void updateGeometry();
+
+    bool m_has2MGHeader = false;
+    uint8_t m_creator[4] = {'R', 'D', 'E', 'T'};
+    uint32_t m_2mgFlags = 0;
+    std::vector<uint8_t> m_comment;
+    std::vector<uint8_t> m_creatorData;
+
+    mutable FileSystemType m_cachedFileSystem = FileSystemType::Unknown;
+    mutable bool m_fileSystemDetected = false;
+};
+
+} // namespace rde
+
+#endif // RDEDISKTOOL_APPLE_HDVIMAGE_H
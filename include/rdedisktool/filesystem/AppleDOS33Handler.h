@@ -6,6 +6,7 @@
 #include "rdedisktool/apple/AppleConstants.h"
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 namespace rde {
 
@@ -22,6 +23,10 @@ namespace rde {
  * - Track 1-16: User data
  * - Track 17: VTOC + Catalog
  * - Track 18-34: User data
+ *
+ * The VTOC free map is held as one 16-bit mask per track (bit n = sector
+ * n free) with a running free-sector count, so allocation takes whole
+ * tracks with a bit scan and a file's sectors come back as one T/S list.
  */
 class AppleDOS33Handler : public FileSystemHandler {
 public:
@@ -33,6 +38,8 @@ public:
     bool initialize(DiskImage* disk) override;
     std::vector<FileEntry> listFiles(const std::string& path = "") override;
     std::vector<uint8_t> readFile(const std::string& filename) override;
+    bool getFileExtents(const std::string& filename,
+                        std::vector<std::pair<size_t, size_t>>& extents) override;
     bool writeFile(const std::string& filename,
                   const std::vector<uint8_t>& data,
                   const FileMetadata& metadata = {}) override;
@@ -84,7 +91,7 @@ private:
         uint8_t tracksPerDisk;
         uint8_t sectorsPerTrack;
         uint16_t bytesPerSector;
-        uint8_t trackBitmap[MAX_TRACKS][4];
+        uint16_t trackFreeMask[MAX_TRACKS];  // Bit n set = sector n free
     };
 
     // Catalog entry structure
@@ -94,6 +101,11 @@ private:
         uint8_t fileType;
         char filename[30];
         uint16_t sectorCount;
+
+        // Location of the entry in the catalog chain
+        uint8_t catalogTrack;
+        uint8_t catalogSector;
+        uint8_t catalogSlot;
     };
 
     // Track/Sector pair
@@ -105,24 +117,58 @@ private:
     // Cached VTOC
     VTOC m_vtoc;
 
+    // Free sectors on allocatable tracks (all but track 0 and the VTOC track)
+    size_t m_freeSectorCount = 0;
+
+    // Catalog cache: the parsed catalog chain, free entry slots in chain
+    // order, and an index from the 30-byte name (high bit stripped) to the
+    // entry. Invalidated whenever the catalog is written.
+    struct CatalogSlot {
+        uint8_t track;
+        uint8_t sector;
+        uint8_t slot;
+    };
+    struct CatalogCache {
+        std::vector<CatalogEntry> entries;
+        std::vector<CatalogSlot> freeSlots;
+        std::unordered_map<std::string, int> index;
+    };
+    mutable CatalogCache m_catalogCache;
+    mutable bool m_catalogCacheValid = false;
+
     // Helper methods
     bool parseVTOC();
     void writeVTOC();
     std::vector<uint8_t> readSector(size_t track, size_t sector) const;
     void writeSector(size_t track, size_t sector, const std::vector<uint8_t>& data);
 
-    std::vector<CatalogEntry> readCatalog() const;
+    std::vector<CatalogEntry> readCatalog(std::vector<CatalogSlot>* freeSlots = nullptr) const;
     void writeCatalogEntry(size_t track, size_t sector, size_t entryIndex, const CatalogEntry& entry);
     int findCatalogEntry(const std::string& filename) const;
+    const CatalogCache& getCachedCatalog() const;
+    void invalidateCatalogCache() { m_catalogCacheValid = false; }
+    static std::string catalogKey(const char* name);
 
-    std::vector<TSPair> readTSList(uint8_t track, uint8_t sector) const;
-    void writeTSList(uint8_t track, uint8_t sector, const std::vector<TSPair>& pairs);
+    std::vector<TSPair> readTSList(uint8_t track, uint8_t sector,
+                                   std::vector<TSPair>* listSectors = nullptr) const;
+    void writeTSList(const std::vector<TSPair>& listSectors, const std::vector<TSPair>& pairs);
 
     bool isSectorFree(size_t track, size_t sector) const;
     void markSectorUsed(size_t track, size_t sector);
     void markSectorFree(size_t track, size_t sector);
-    TSPair allocateSector();
-    size_t countFreeSectors() const;
+    bool isAllocatableTrack(size_t track) const;
+    uint16_t sectorMask() const;
+    void recountFreeSectors();
+
+    /**
+     * Allocate sectors following the VTOC allocation direction, taking
+     * every free sector of a track before moving to the next one
+     * @param count Number of sectors
+     * @return The allocated sectors in order, or an empty list (nothing
+     *         allocated) if the disk does not have enough free sectors
+     */
+    std::vector<TSPair> allocateSectors(size_t count);
+    size_t countFreeSectors() const { return m_freeSectorCount; }
 
     std::string formatFilename(const char* name) const;
     void parseFilename(const std::string& filename, char* name) const;
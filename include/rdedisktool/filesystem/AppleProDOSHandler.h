@@ -23,8 +23,11 @@ namespace rde {
  * Layout:
  * - Blocks 0-1: Boot blocks
  * - Block 2+: Volume directory (key block)
- * - Block 6: Volume bitmap (typically)
+ * - Block 6+: Volume bitmap, one block per 4096 volume blocks
  * - Remaining blocks: Files and subdirectories
+ *
+ * The volume size follows the underlying image: 280 blocks for 5.25"
+ * disks, up to 65535 blocks for HDV/2MG block devices.
  */
 class AppleProDOSHandler : public FileSystemHandler {
 public:
@@ -36,6 +39,8 @@ public:
     bool initialize(DiskImage* disk) override;
     std::vector<FileEntry> listFiles(const std::string& path = "") override;
     std::vector<uint8_t> readFile(const std::string& filename) override;
+    bool getFileExtents(const std::string& filename,
+                        std::vector<std::pair<size_t, size_t>>& extents) override;
     bool writeFile(const std::string& filename,
                   const std::vector<uint8_t>& data,
                   const FileMetadata& metadata = {}) override;
@@ -44,6 +49,7 @@ public:
                    const std::string& newName) override;
     size_t getFreeSpace() const override;
     size_t getTotalSpace() const override;
+    size_t getRequiredSpace(const std::vector<uint8_t>& data) const override;
     bool fileExists(const std::string& filename) const override;
     bool format(const std::string& volumeName = "") override;
     std::string getVolumeName() const override;
@@ -66,6 +72,8 @@ private:
     static constexpr size_t ENTRIES_PER_BLOCK = AppleConstants::ProDOS::ENTRIES_PER_BLOCK;
     static constexpr size_t MAX_FILENAME_LENGTH = AppleConstants::ProDOS::MAX_FILENAME_LENGTH;
     static constexpr size_t TOTAL_BLOCKS = AppleConstants::ProDOS::TOTAL_BLOCKS;
+    static constexpr size_t MAX_VOLUME_BLOCKS = AppleConstants::ProDOS::MAX_VOLUME_BLOCKS;
+    static constexpr size_t BLOCKS_PER_BITMAP_BLOCK = AppleConstants::ProDOS::BLOCKS_PER_BITMAP_BLOCK;
 
     // Storage types from AppleConstants::ProDOS
     static constexpr uint8_t STORAGE_DELETED = AppleConstants::ProDOS::STORAGE_DELETED;
@@ -163,9 +171,16 @@ private:
 
     // Cached volume header
     DirectoryHeader m_volumeHeader;
-    std::vector<bool> m_bitmap;       // Block allocation bitmap
+
+    // Block allocation bitmap packed into 64-bit words: bit (n % 64) of
+    // word (n / 64) is set when block n is free. Bits past the last block
+    // stay clear so popcounts need no masking.
+    std::vector<uint64_t> m_bitmap;
+    size_t m_bitmapBlocks = 0;        // Number of blocks covered
 
     // Helper methods - Block I/O
+    size_t deviceBlocks() const;
+    size_t bitmapBlockCount() const;
     std::vector<uint8_t> readBlock(size_t block) const;
     void writeBlock(size_t block, const std::vector<uint8_t>& data);
 
@@ -175,7 +190,11 @@ private:
     bool isBlockFree(size_t block) const;
     void markBlockUsed(size_t block);
     void markBlockFree(size_t block);
+    void resetBitmap(size_t totalBlocks, bool free);
+    size_t findFreeBlock(size_t from) const;
+    size_t findUsedBlock(size_t from) const;
     size_t allocateBlock();
+    std::vector<uint16_t> allocateBlocks(size_t count);
     size_t countFreeBlocks() const;
 
     // Helper methods - Directory operations
@@ -189,13 +208,22 @@ private:
     bool updateDirectoryFileCount(uint16_t dirKeyBlock, int delta);
 
     // Helper methods - File I/O
+    // Files may be sparse: a zero index or data pointer is a hole that reads
+    // as 512 zero bytes. getFileBlocks() returns one entry per data block of
+    // the EOF with 0 for holes; the writer leaves all-zero blocks (other
+    // than the first) and fully sparse index blocks unallocated.
     std::vector<uint8_t> readFileData(const DirectoryEntry& entry) const;
-    std::vector<uint16_t> getFileBlocks(const DirectoryEntry& entry) const;
-    bool writeFileData(uint16_t keyBlock, uint8_t storageType, const std::vector<uint8_t>& data);
+    std::vector<uint16_t> getFileBlocks(const DirectoryEntry& entry,
+                                        std::vector<uint16_t>* indexBlocks = nullptr) const;
+    bool writeFileData(const std::vector<uint16_t>& blocks, uint8_t storageType,
+                       const std::vector<uint8_t>& data);
+    size_t countFileBlocks(uint8_t storageType, const std::vector<uint8_t>& data) const;
+    static bool isSparseBlock(const std::vector<uint8_t>& data, size_t dataBlock);
     void freeFileBlocks(const DirectoryEntry& entry);
 
     // Helper methods - Path handling
     std::pair<uint16_t, std::string> resolvePath(const std::string& path) const;
+    DirectoryEntry findFileEntry(const std::string& filename) const;
     std::string formatFilename(const char* name, uint8_t length) const;
     void parseFilename(const std::string& filename, char* name, uint8_t& length) const;
     bool isValidFilename(const std::string& filename) const;
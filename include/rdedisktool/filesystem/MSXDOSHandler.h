@@ -5,6 +5,7 @@
 #include "rdedisktool/msx/MSXDiskImage.h"
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 namespace rde {
 
@@ -29,6 +30,8 @@ public:
     bool initialize(DiskImage* disk) override;
     std::vector<FileEntry> listFiles(const std::string& path = "") override;
     std::vector<uint8_t> readFile(const std::string& filename) override;
+    bool getFileExtents(const std::string& filename,
+                        std::vector<std::pair<size_t, size_t>>& extents) override;
     bool writeFile(const std::string& filename,
                   const std::vector<uint8_t>& data,
                   const FileMetadata& metadata = {}) override;
@@ -141,6 +144,7 @@ private:
     // Subdirectory support helpers
     // Returns {dirCluster, entryName} where dirCluster=0 means root directory
     std::pair<uint16_t, std::string> resolvePath(const std::string& path) const;
+    DirEntry findFileEntry(const std::string& filename) const;
 
     // Read directory entries from a subdirectory cluster chain
     std::vector<DirEntry> readDirectoryCluster(uint16_t cluster) const;
@@ -156,6 +160,19 @@ private:
 
     // Set directory entries for any directory
     void setDirectoryEntries(uint16_t cluster, const std::vector<DirEntry>& entries);
+
+    // Directory lookup cache, keyed by the directory's first cluster
+    // (0 = root). Holds the parsed entries plus an index from the padded
+    // 8.3 name (11 bytes) to the entry's slot. Invalidated on write.
+    struct DirectoryCache {
+        std::vector<DirEntry> entries;
+        std::unordered_map<std::string, int> index;
+    };
+    mutable std::unordered_map<uint16_t, DirectoryCache> m_dirCache;
+
+    const DirectoryCache& getCachedDirectory(uint16_t cluster) const;
+    int lookupEntry(const DirectoryCache& dir, const std::string& filename) const;
+    void invalidateDirectoryCache(uint16_t cluster) { m_dirCache.erase(cluster); }
 };
 
 } // namespace rde
@@ -5,7 +5,12 @@
 
 #include <array>
 #include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <set>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace rde {
@@ -13,9 +18,11 @@ namespace rde {
 /**
  * Macintosh HFS read-only handler.
  *
- * Phase 1 scope: parse the Master Directory Block, walk the Catalog B-tree
- * leaf chain, and extract data / resource forks via initial extents plus the
- * Extents Overflow B-tree. Write paths (writeFile / deleteFile / renameFile /
+ * Phase 1 scope: parse the Master Directory Block, look up the Catalog B-tree,
+ * and extract data / resource forks via initial extents plus the Extents
+ * Overflow B-tree. Catalog leaves are parsed lazily: a lookup descends the
+ * index nodes by (parent CNID, name) and only the leaves it lands on are
+ * materialized. Write paths (writeFile / deleteFile / renameFile /
  * format / createDirectory) all return false and emit no I/O.
  *
  * References (MacDiskcopy/document/SPEC_MACDISKIMAGE.md):
@@ -63,6 +70,8 @@ public:
 
     std::vector<FileEntry> listFiles(const std::string& path = "") override;
     std::vector<uint8_t> readFile(const std::string& filename) override;
+    bool getFileExtents(const std::string& filename,
+                        std::vector<std::pair<size_t, size_t>>& extents) override;
 
     // Phase 1 = read-only. Mutate paths refuse explicitly.
     bool writeFile(const std::string& filename,
@@ -92,9 +101,21 @@ public:
      */
     std::vector<uint8_t> extractFork(uint32_t fileCNID, uint8_t forkType) const;
 
+    /**
+     * Stream a fork to `out` straight from the disk image, one extent at a
+     * time, without assembling it in memory. Returns the bytes written.
+     */
+    uint64_t readForkTo(std::ostream& out, uint32_t fileCNID, uint8_t forkType) const;
+
+    /**
+     * Bytes of a fork the image actually holds: its logical length, cut
+     * short where a truncated image ends. This is what readForkTo() writes.
+     */
+    uint64_t forkLength(uint32_t fileCNID, uint8_t forkType) const;
+
     // Catalog leaf records keyed by parent CNID -> child entries. Public so
     // that CLI exporters (AppleDouble / MacBinary) can read the cached
-    // metadata directly. Built once at initialize() and reused thereafter.
+    // metadata directly. Filled leaf by leaf as lookups reach them.
     struct CatalogChild {
         uint32_t cnid = 0;
         std::string name;          // UTF-8 (decoded from MacRoman)
@@ -142,11 +163,62 @@ private:
     Mdb m_mdb{};
     BootBlock m_bootBlock{};
 
-    std::unordered_map<uint32_t, std::vector<CatalogChild>> m_childrenByParent;
+    // Children per parent CNID. A parent's list is complete (and in catalog
+    // order) only once it is in m_listedParents or the whole catalog has
+    // been walked; before that it holds whatever loaded leaves contributed.
+    mutable std::unordered_map<uint32_t, std::vector<CatalogChild>> m_childrenByParent;
+
+    // Per-parent name index over m_childrenByParent: macNameHash() of the
+    // child's name -> CNID. Kept in step with the child lists so path
+    // lookups are O(1) per component and case-insensitive like the Finder.
+    mutable std::unordered_map<uint32_t, std::unordered_multimap<size_t, uint32_t>> m_childIndex;
 
     // CNID -> CatalogChild lookup for fast path resolution / extract.
-    // The HFS root directory CNID is fixed at 2.
-    std::unordered_map<uint32_t, CatalogChild> m_byCNID;
+    // The HFS root directory CNID is fixed at 2. Entries are never erased
+    // by lazy loading, so pointers handed out by resolvePath() stay valid
+    // until the next mutation.
+    mutable std::unordered_map<uint32_t, CatalogChild> m_byCNID;
+
+    // Lazy catalog state. Nodes are read in place from the disk image
+    // through the catalog file's extents.
+    uint16_t m_catalogNodeSize = 0;
+    uint32_t m_catalogRootNode = 0;
+    uint32_t m_catalogFirstLeaf = 0;
+    uint32_t m_catalogTotalNodes = 0;
+    mutable bool m_catalogFullyLoaded = false;
+    mutable std::unordered_set<uint32_t> m_loadedLeaves;
+    mutable std::unordered_set<uint32_t> m_listedParents;
+
+    // Free allocation blocks as sorted runs, built from the volume bitmap
+    // at initialize() and kept in step with every committed allocation or
+    // release. Runs are indexed by start (for splitting and merging) and by
+    // (length, start) for O(log n) best-fit queries.
+    class FreeExtentIndex {
+    public:
+        using Run = std::pair<uint16_t, uint16_t>;  // (first block, count)
+
+        void build(const std::vector<uint8_t>& raw, uint64_t bitmapByteBase,
+                   uint16_t numAllocBlocks);
+        void clear();
+
+        // Runs covering `needed` blocks with as few extents as possible: the
+        // smallest single run that fits, else the largest runs plus a
+        // best-fit tail. Disk order; empty if fewer blocks are free.
+        std::vector<Run> bestFit(uint32_t needed) const;
+
+        void allocate(const Run& run);
+        void release(const Run& run);
+        uint32_t freeBlocks() const { return m_freeBlocks; }
+
+    private:
+        void insertRun(uint16_t start, uint16_t count);
+        void eraseRun(std::map<uint16_t, uint16_t>::iterator it);
+
+        std::map<uint16_t, uint16_t> m_byStart;    // start -> count
+        std::set<std::pair<uint16_t, uint16_t>> m_bySize;  // (count, start)
+        uint32_t m_freeBlocks = 0;
+    };
+    FreeExtentIndex m_freeExtents;
 
     // Extents Overflow leaf records: (file_cnid, fork_type, start_block) -> 3 extents.
     struct ExtentsKey {
@@ -169,22 +241,45 @@ private:
 
     // Helpers (defined in the .cpp).
     bool parseMdb();
+    void buildFreeExtents();
     bool parseBootBlock();
-    bool walkCatalogLeaves();
+    bool openCatalog();
+    bool walkCatalogLeaves() const;
     bool walkExtentsOverflowLeaves();
     bool walkBTreeLeaves(uint32_t btreeFileSize,
                          const std::array<uint16_t, 6>& fileExtents,
                          std::vector<uint8_t>& outBuffer,
                          uint16_t& outNodeSize);
-    void parseCatalogLeafNode(const uint8_t* node, size_t nodeSize);
+    void parseCatalogLeafNode(const uint8_t* node, size_t nodeSize,
+                              std::vector<std::pair<uint32_t, CatalogChild>>& out) const;
     void parseExtentsLeafNode(const uint8_t* node, size_t nodeSize);
 
+    // Lazy catalog access. catalogNode() maps a node number to its bytes in
+    // the disk image (nullptr if out of range). findCatalogLeaf() descends
+    // the index nodes to the leaf that would hold (parentCNID, name), or
+    // returns 0 if the index cannot be followed. loadCatalogChildren()
+    // completes a parent's child list by scanning forward from its first
+    // key; walkCatalogLeaves() parses every leaf and is the fallback when
+    // the index is unusable.
+    const uint8_t* catalogNode(uint32_t node) const;
+    uint32_t findCatalogLeaf(uint32_t parentCNID, std::string_view name) const;
+    void loadCatalogLeaf(uint32_t node) const;
+    void loadCatalogChildren(uint32_t parentCNID) const;
+    const CatalogChild* findChild(uint32_t parentCNID, std::string_view name) const;
+    const CatalogChild* findIndexedChild(uint32_t parentCNID, std::string_view name) const;
+
     // Resolve a full path "/Folder/SubFolder/File" (or "Folder/SubFolder/File")
     // into the CatalogChild entry. Path uses '/' separator. Empty path → root.
-    const CatalogChild* resolvePath(const std::string& path) const;
+    // Components match case-insensitively (macNamesEqual).
+    const CatalogChild* resolvePath(std::string_view path) const;
 
-    // Read raw bytes from an HFS allocation-block run.
-    std::vector<uint8_t> readAllocBlocks(uint16_t startBlock, uint16_t count) const;
+    // Image byte ranges (offset, length) holding the first `logical` bytes
+    // of a fork, in fork order. Extents past the three in `initial` come
+    // from the Extents Overflow records of (fileCNID, forkType); ranges are
+    // clipped to the image.
+    std::vector<std::pair<uint64_t, size_t>> forkSpans(
+        uint32_t fileCNID, uint8_t forkType,
+        const std::array<uint16_t, 6>& initial, uint64_t logical) const;
 
     // B2 (mkdir / rmdir): single-leaf catalog mutators used by createDirectory
     // and deleteDirectory. These reassemble the catalog file from its initial
@@ -215,18 +310,40 @@ private:
     // moves throw NotImplementedException.
     bool renameFolder(const std::string& oldName, const std::string& newName);
 
+    // Fork allocation. writeForkExtents() picks free runs from
+    // m_freeExtents best-fit (fewest extents), writes `data` and marks the
+    // bitmap in `raw`; the first 3 extents are returned for the catalog
+    // record and any further ones are inserted into the Extents Overflow
+    // B-tree. Returns the allocation blocks used; throws DiskFullException
+    // when space runs out. releaseForkExtents() frees every block of a fork
+    // and removes its overflow records, returning the blocks freed. Both
+    // only touch `raw`: the runs they report in `runs` are applied to
+    // m_freeExtents once the caller commits.
+    uint32_t writeForkExtents(std::vector<uint8_t>& raw,
+                              uint32_t cnid,
+                              uint8_t forkType,
+                              const std::vector<uint8_t>& data,
+                              std::array<uint16_t, 6>& firstExtents,
+                              std::vector<FreeExtentIndex::Run>& runs) const;
+    uint32_t releaseForkExtents(std::vector<uint8_t>& raw,
+                                uint32_t cnid,
+                                uint8_t forkType,
+                                const std::array<uint16_t, 6>& firstExtents,
+                                uint32_t logical,
+                                std::vector<FreeExtentIndex::Run>& runs) const;
+
     // C3 (rsrc-fork-preserving rename): after writeFile creates the new
     // record (data fork only), patch its body to (a) carry the rsrc fork
     // bytes, (b) restore preserved metadata (FInfo, FXInfo, filFlags,
-    // backupDate, clpSize) from `oldBody`. Throws NotImplementedException
-    // when the rsrc fork doesn't fit in a contiguous run of free
-    // allocation blocks (Extents Overflow B-tree write deferred).
+    // backupDate, clpSize) from `oldBody`. The rsrc fork is allocated
+    // through writeForkExtents(); callers apply `rsrcRuns` on commit.
     bool applyRsrcForkAndMetadataPatch(
         std::vector<uint8_t>& raw,
         uint32_t parentCNID,
         const std::string& leaf,
         const std::vector<uint8_t>& oldBody,
-        const std::vector<uint8_t>& rsrcFork);
+        const std::vector<uint8_t>& rsrcFork,
+        std::vector<FreeExtentIndex::Run>& rsrcRuns);
 
     // C4 (catalog leaf split): split a full leaf node and insert a record
     // that wouldn't otherwise fit. Allocates a new leaf from the B-tree
@@ -5,6 +5,7 @@
 
 #include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace rde {
@@ -71,6 +72,8 @@ public:
 
     std::vector<FileEntry> listFiles(const std::string& path = "") override;
     std::vector<uint8_t> readFile(const std::string& filename) override;
+    bool getFileExtents(const std::string& filename,
+                        std::vector<std::pair<size_t, size_t>>& extents) override;
 
     bool writeFile(const std::string& filename,
                    const std::vector<uint8_t>& data,
@@ -99,25 +102,37 @@ public:
 private:
     Mdb m_mdb{};
     BootBlock m_bootBlock{};
-    std::vector<DirEntry> m_entries;     // active (used-bit set) entries
+    std::vector<DirEntry> m_entries;     // active (used-bit set) entries, directory order
+    // name -> index into m_entries (first entry wins on duplicate names).
+    std::unordered_map<std::string, size_t> m_byName;
+    // Decoded 12-bit allocation map, one entry per allocation block from
+    // block 2. Loaded at initialize() and kept in step with every commit.
+    std::vector<uint16_t> m_allocMap;
 
     bool parseMdb();
     bool parseBootBlock();
     bool parseDirectory();
+    void loadAllocMap();
+    void indexEntries();
     const DirEntry* findEntry(const std::string& name) const;
 
-    // Read a 12-bit BE big-endian allocation map entry. Index 0 corresponds
-    // to allocation block 2.
+    // Allocation map entry from m_allocMap. Index 0 corresponds to
+    // allocation block 2; out-of-range indices read as free.
     uint16_t readAllocEntry(size_t index) const;
     // Write a 12-bit BE big-endian allocation map entry. Mirrors readAllocEntry.
     void writeAllocEntry(std::vector<uint8_t>& raw, size_t index, uint16_t value) const;
     // Convert allocation block N → byte offset in the raw stream.
     uint64_t blockOffset(uint16_t block) const;
+    // (raw offset, length) runs of a fork, following the 12-bit map.
+    std::vector<std::pair<uint64_t, size_t>> forkSpans(uint16_t startBlock,
+                                                       uint32_t logical) const;
     // Walk the alloc map and return all currently-free block numbers (>= 2).
     std::vector<uint16_t> findFreeBlocks(const std::vector<uint8_t>& raw, size_t need) const;
-    // Write a fresh directory entry into the directory area. Returns false if
-    // no slot fits within any 512B directory block.
-    bool insertDirectoryEntry(std::vector<uint8_t>& raw, const DirEntry& de) const;
+    // Write a fresh directory entry into the directory area and report its
+    // position among the active entries. Returns false if no slot fits
+    // within any 512B directory block.
+    bool insertDirectoryEntry(std::vector<uint8_t>& raw, const DirEntry& de,
+                              size_t& entryIndex) const;
     // Update MDB scalar fields (drFreeBks, drNmFls, drNxtFNum) in-place.
     void updateMdb(std::vector<uint8_t>& raw, int delta_files,
                    int delta_freeBlocks, uint32_t bumpNxtFNum) const;
@@ -5,6 +5,7 @@
 #include "rdedisktool/x68000/X68000DiskImage.h"
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 namespace rde {
 
@@ -33,6 +34,8 @@ public:
     bool initialize(DiskImage* disk) override;
     std::vector<FileEntry> listFiles(const std::string& path = "") override;
     std::vector<uint8_t> readFile(const std::string& filename) override;
+    bool getFileExtents(const std::string& filename,
+                        std::vector<std::pair<size_t, size_t>>& extents) override;
     bool writeFile(const std::string& filename,
                   const std::vector<uint8_t>& data,
                   const FileMetadata& metadata = {}) override;
@@ -62,6 +65,12 @@ public:
 
     ClusterInfo getClusterInfo() const;
 
+    /**
+     * Map of linear tracks (cylinder * heads + head) that hold live data:
+     * boot sector, FATs, root directory or any allocated cluster
+     */
+    std::vector<bool> getUsedTrackMap() const;
+
     // Accessors for BPB values
     uint16_t getSectorsPerCluster() const { return m_sectorsPerCluster; }
     uint16_t getBytesPerSector() const { return m_bytesPerSector; }
@@ -85,6 +94,17 @@ private:
     uint16_t m_firstDataSector = 0;
     uint16_t m_totalClusters = 0;
     uint16_t m_dataSectors = 0;
+    uint32_t m_rootDirStart = 0;
+    size_t m_bytesPerCluster = 0;
+
+    // Direct sector access into XDF/DIM track storage (null = generic path)
+    X68000DiskImage* m_directImage = nullptr;
+
+    // Decoded FAT entries and the raw first FAT copy they were read from
+    mutable std::vector<uint16_t> m_fatCache;
+    mutable std::vector<uint8_t> m_fatRaw;
+    mutable bool m_fatLoaded = false;
+    bool m_fatDirty = false;
 
     // Directory entry structure (32 bytes) - same as FAT
     #pragma pack(push, 1)
@@ -122,14 +142,43 @@ private:
 
     // Helper methods
     bool parseBPB();
-    std::vector<uint8_t> readFAT() const;
-    void writeFAT(const std::vector<uint8_t>& fat);
-    uint16_t getFATEntry(const std::vector<uint8_t>& fat, uint16_t cluster) const;
-    void setFATEntry(std::vector<uint8_t>& fat, uint16_t cluster, uint16_t value);
+
+    /**
+     * Recompute derived geometry and enable the direct-access path when
+     * the image stores tracks contiguously with the BPB's layout
+     */
+    void updateGeometryCache();
+
+    // Decoded FAT cache (loaded on first use, written back by commitFAT)
+    const std::vector<uint16_t>& fatTable() const;
+    uint16_t getFATEntry(uint16_t cluster) const;
+    void setFATEntry(uint16_t cluster, uint16_t value);
+    void commitFAT();
+    void discardFATChanges();
+    void writeFATCopies(const std::vector<uint8_t>& fat);
+
+    // Held by each mutator: drops FAT changes still uncommitted when it
+    // returns early or throws, so a later commitFAT() cannot write them
+    class FATRollback {
+    public:
+        explicit FATRollback(Human68kHandler& handler) : m_handler(handler) {}
+        ~FATRollback() {
+            if (m_handler.m_fatDirty) m_handler.discardFATChanges();
+        }
+        FATRollback(const FATRollback&) = delete;
+        FATRollback& operator=(const FATRollback&) = delete;
+
+    private:
+        Human68kHandler& m_handler;
+    };
+
+    // Raw FAT12 encoding
+    static uint16_t decodeFATEntry(const std::vector<uint8_t>& fat, uint16_t cluster);
+    static void encodeFATEntry(std::vector<uint8_t>& fat, uint16_t cluster, uint16_t value);
 
     std::vector<uint16_t> getClusterChain(uint16_t startCluster) const;
-    uint16_t allocateCluster(std::vector<uint8_t>& fat);
-    void freeClusterChain(std::vector<uint8_t>& fat, uint16_t startCluster);
+    uint16_t allocateCluster();
+    void freeClusterChain(uint16_t startCluster);
 
     std::vector<uint8_t> readCluster(uint16_t cluster) const;
     void writeCluster(uint16_t cluster, const std::vector<uint8_t>& data);
@@ -151,13 +200,32 @@ private:
     std::vector<uint8_t> readLogicalSector(uint32_t logicalSector) const;
     void writeLogicalSector(uint32_t logicalSector, const std::vector<uint8_t>& data);
 
+    // Multi-sector transfers; runs within one track are a single copy when
+    // direct access is available
+    void readSectors(uint32_t firstSector, uint32_t count, uint8_t* out) const;
+    void writeSectors(uint32_t firstSector, uint32_t count, const uint8_t* data);
+
     // Subdirectory support
     std::pair<uint16_t, std::string> resolvePath(const std::string& path) const;
+    DirEntry findFileEntry(const std::string& filename) const;
     std::vector<DirEntry> readDirectoryCluster(uint16_t cluster) const;
     void writeDirectoryCluster(uint16_t cluster, const std::vector<DirEntry>& entries);
     int findEntryInDirectory(uint16_t cluster, const std::string& name) const;
     std::vector<DirEntry> getDirectoryEntries(uint16_t cluster) const;
     void setDirectoryEntries(uint16_t cluster, const std::vector<DirEntry>& entries);
+
+    // Directory lookup cache, keyed by the directory's first cluster
+    // (0 = root). Holds the parsed entries plus an index from the padded
+    // 8.3 name (11 bytes) to the entry's slot. Invalidated on write.
+    struct DirectoryCache {
+        std::vector<DirEntry> entries;
+        std::unordered_map<std::string, int> index;
+    };
+    mutable std::unordered_map<uint16_t, DirectoryCache> m_dirCache;
+
+    const DirectoryCache& getCachedDirectory(uint16_t cluster) const;
+    int lookupEntry(const DirectoryCache& dir, const std::string& filename) const;
+    void invalidateDirectoryCache(uint16_t cluster) { m_dirCache.erase(cluster); }
 };
 
 } // namespace rde
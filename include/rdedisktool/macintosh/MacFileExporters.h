@@ -30,6 +30,15 @@ struct AppleDoubleInput {
  */
 std::vector<uint8_t> buildAppleDoubleSidecar(const AppleDoubleInput& in);
 
+/**
+ * Build the sidecar up to where the resource fork payload starts, for a
+ * fork of `rsrcLength` bytes the caller streams right after it. The
+ * resource fork is the last entry, so header + fork equals
+ * buildAppleDoubleSidecar() of the same input. in.resourceFork is ignored.
+ */
+std::vector<uint8_t> buildAppleDoubleHeader(const AppleDoubleInput& in,
+                                            uint32_t rsrcLength);
+
 /**
  * MacBinary v1 input record. Per SPEC §1690 a 128-byte header is followed
  * by the data fork (zero-padded to 128B), then the resource fork (zero-
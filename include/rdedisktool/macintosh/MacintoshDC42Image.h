@@ -43,6 +43,7 @@ public:
 
     bool canConvertTo(DiskFormat format) const override;
     std::unique_ptr<DiskImage> convertTo(DiskFormat format) const override;
+    std::unique_ptr<DiskImage> clone() const override { return std::make_unique<MacintoshDC42Image>(*this); }
 
     bool validate() const override;
     std::string getDiagnostics() const override;
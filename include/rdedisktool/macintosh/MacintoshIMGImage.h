@@ -25,12 +25,14 @@ public:
     void create(const DiskGeometry& geometry) override;
 
     DiskFormat getFormat() const override { return DiskFormat::MacIMG; }
+    std::optional<uint64_t> flatDataOffset() const override { return 0; }
 
     // readSector / writeSector / readTrack / writeTrack inherited from
     // MacintoshDiskImage (raw 512B sector stream — no header offset).
 
     bool canConvertTo(DiskFormat format) const override;
     std::unique_ptr<DiskImage> convertTo(DiskFormat format) const override;
+    std::unique_ptr<DiskImage> clone() const override { return std::make_unique<MacintoshIMGImage>(*this); }
 
     bool validate() const override;
     std::string getDiagnostics() const override;
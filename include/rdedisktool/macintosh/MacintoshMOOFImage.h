@@ -39,6 +39,7 @@ public:
 
     bool canConvertTo(DiskFormat format) const override;
     std::unique_ptr<DiskImage> convertTo(DiskFormat format) const override;
+    std::unique_ptr<DiskImage> clone() const override { return std::make_unique<MacintoshMOOFImage>(*this); }
 
     bool validate() const override;
     std::string getDiagnostics() const override;
@@ -2,6 +2,7 @@
 #define RDEDISKTOOL_MSX_DMKIMAGE_H
 
 #include "rdedisktool/msx/MSXDiskImage.h"
+#include "rdedisktool/msx/TrackLayout.h"
 #include <array>
 
 namespace rde {
@@ -84,6 +85,7 @@ public:
 
     bool canConvertTo(DiskFormat format) const override;
     std::unique_ptr<DiskImage> convertTo(DiskFormat format) const override;
+    std::unique_ptr<DiskImage> clone() const override { return std::make_unique<MSXDMKImage>(*this); }
 
     bool validate() const override;
     std::string getDiagnostics() const override;
@@ -152,12 +154,23 @@ public:
      * Set interleave factor for formatting
      * @param interleave Interleave factor (1 = no interleave, 2 = every other sector, etc.)
      */
-    void setInterleave(uint8_t interleave) { m_interleave = interleave; }
+    void setInterleave(uint8_t interleave) { m_layout.interleave = interleave; }
 
     /**
      * Get current interleave factor
      */
-    uint8_t getInterleave() const { return m_interleave; }
+    uint8_t getInterleave() const { return m_layout.interleave; }
+
+    /**
+     * Set the track layout (interleave, track/head skew) used by create()
+     * The sector count is taken from the geometry passed to create().
+     */
+    void setTrackLayout(const TrackLayout& layout) { m_layout = layout; }
+
+    /**
+     * Get the track layout used for formatting
+     */
+    const TrackLayout& getTrackLayout() const { return m_layout; }
 
 protected:
     size_t calculateOffset(size_t track, size_t side, size_t sector) const override;
@@ -169,7 +182,7 @@ private:
     uint8_t m_dmkFlags = 0;
 
     // Format options
-    uint8_t m_interleave = 1;  // 1 = no interleave
+    TrackLayout m_layout;      // Sector order and gap sizing for create()
     bool m_verifyCRC = false;  // Verify CRC on read
     bool m_strictCRC = false;  // Throw exception on CRC error
 
@@ -192,9 +205,12 @@ private:
 
     IDAMEntry parseIDAM(const uint8_t* data, uint16_t idamPtr) const;
 
-    // Build a complete track with MFM encoding
+    // Count sectors on a track from its IDAM table
+    size_t countSectorsInTrack(size_t track, size_t side) const;
+
+    // Build a complete track with MFM encoding, laid out per m_layout
     TrackBuffer buildFormattedTrack(size_t track, size_t side,
-                                    const std::array<SectorBuffer, 9>& sectors);
+                                    const std::vector<SectorBuffer>& sectors);
 };
 
 } // namespace rde
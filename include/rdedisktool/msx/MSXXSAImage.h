@@ -85,6 +85,7 @@ public:
      * Convert to DSK or DMK format
      */
     std::unique_ptr<DiskImage> convertTo(DiskFormat format) const override;
+    std::unique_ptr<DiskImage> clone() const override { return std::make_unique<MSXXSAImage>(*this); }
 
     bool validate() const override;
     std::string getDiagnostics() const override;
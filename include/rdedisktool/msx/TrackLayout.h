@@ -0,0 +1,79 @@
+#ifndef RDEDISKTOOL_MSX_TRACKLAYOUT_H
+#define RDEDISKTOOL_MSX_TRACKLAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rde {
+
+/**
+ * Physical sector layout for MFM track builders (DMK)
+ *
+ * Decides in which order the logical sectors of a track pass under the
+ * head. Three knobs are combined:
+ * - interleave: distance (in physical slots) between consecutive logical
+ *   sectors within one track (1 = sequential)
+ * - trackSkew: rotation of the first sector per cylinder step, so a
+ *   sequential read continuing on the next cylinder does not miss sector 1
+ *   while the head settles
+ * - headSkew: extra rotation applied to side 1 of each cylinder, covering
+ *   the head-switch latency
+ *
+ * The track builder also uses the layout to size Gap 3 so that 8, 9 or 10
+ * sectors of 512 bytes fit into a standard double-density track.
+ */
+struct TrackLayout {
+    // Standard IBM System/34 gap lengths used by MSX formatters
+    static constexpr size_t GAP4A_LENGTH = 80;
+    static constexpr size_t GAP1_LENGTH = 50;
+    static constexpr size_t GAP2_LENGTH = 22;
+    static constexpr size_t GAP3_LENGTH = 54;
+    static constexpr size_t GAP3_MIN_LENGTH = 16;
+    static constexpr size_t SYNC_LENGTH = 12;
+
+    // Track preamble: Gap 4a + sync + index mark (3x C2 + FC) + Gap 1
+    static constexpr size_t PREAMBLE_LENGTH = GAP4A_LENGTH + SYNC_LENGTH + 4 + GAP1_LENGTH;
+
+    size_t sectorsPerTrack = 9;
+    uint8_t interleave = 1;   // 1 = no interleave
+    uint8_t trackSkew = 0;    // Slots to rotate per cylinder
+    uint8_t headSkew = 0;     // Additional slots to rotate on side 1
+
+    /**
+     * Build the physical sector order for a track
+     * @param track Cylinder number
+     * @param side Side number
+     * @return Logical sector index (0-based) for each physical slot
+     */
+    std::vector<uint8_t> sectorOrder(size_t track, size_t side) const;
+
+    /**
+     * Compute the Gap 3 length for this sector count
+     * @param trackLength Usable raw track length (excluding the DMK IDAM table)
+     * @param bytesPerSector Sector payload size
+     * @return Gap 3 length (standard 54 bytes when space allows), or 0 if the
+     *         sectors cannot fit into the track at all
+     */
+    size_t gap3Length(size_t trackLength, size_t bytesPerSector) const;
+
+    /**
+     * Raw bytes occupied by one sector excluding Gap 3
+     * (sync + IDAM + ID CRC + Gap 2 + sync + DAM + data + data CRC)
+     */
+    static size_t sectorOverhead(size_t bytesPerSector) {
+        return SYNC_LENGTH + 4 + 4 + 2 + GAP2_LENGTH +
+               SYNC_LENGTH + 4 + bytesPerSector + 2;
+    }
+
+    /**
+     * Check that the layout parameters are usable
+     * @param trackLength Usable raw track length (excluding the IDAM table)
+     * @param bytesPerSector Sector payload size
+     */
+    bool isValid(size_t trackLength, size_t bytesPerSector) const;
+};
+
+} // namespace rde
+
+#endif // RDEDISKTOOL_MSX_TRACKLAYOUT_H
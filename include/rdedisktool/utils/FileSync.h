@@ -0,0 +1,23 @@
+#ifndef RDEDISKTOOL_UTILS_FILESYNC_H
+#define RDEDISKTOOL_UTILS_FILESYNC_H
+
+#include <filesystem>
+
+namespace rde {
+
+/**
+ * Flush a file's data to stable storage (fsync / _commit).
+ * @throws WriteException if the file cannot be opened or flushed
+ */
+void syncFile(const std::filesystem::path& path);
+
+/**
+ * Flush a directory so a rename inside it survives a crash. No-op on
+ * platforms where directories cannot be synced.
+ * @throws WriteException if the directory cannot be opened or flushed
+ */
+void syncDirectory(const std::filesystem::path& dir);
+
+} // namespace rde
+
+#endif // RDEDISKTOOL_UTILS_FILESYNC_H
@@ -0,0 +1,110 @@
+#ifndef RDEDISKTOOL_UTILS_IMAGEINDEX_H
+#define RDEDISKTOOL_UTILS_IMAGEINDEX_H
+
+#include "rdedisktool/SHA256.h"
+#include "rdedisktool/Types.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace rde {
+
+/**
+ * Content-addressed index of a disk image collection.
+ *
+ * On disk the index is a header followed by fixed-size little-endian
+ * tables and a string pool, so it can be read (or mapped) without any
+ * parsing pass:
+ *   - images, sorted by path
+ *   - files, sorted by SHA-256 of their contents
+ *   - file numbers sorted by file size
+ *   - NUL-terminated strings referenced by offset
+ * A CRC-32 over everything after the header guards against torn writes.
+ */
+
+struct IndexedFile {
+    std::string path;
+    uint64_t size = 0;
+    uint8_t fileType = 0;
+    uint8_t attributes = 0;
+    SHA256::Digest hash{};
+};
+
+struct IndexedImage {
+    std::string path;
+    std::string format;
+    std::string fileSystem;
+    std::string volume;
+    DiskGeometry geometry;
+    SHA256::Digest hash{};          // of the image file as stored on disk
+    std::vector<IndexedFile> files;
+};
+
+/**
+ * Write `images` as an index file, replacing `file` atomically
+ * @throws WriteException on any I/O failure
+ */
+void writeImageIndex(const std::filesystem::path& file, std::vector<IndexedImage> images);
+
+/**
+ * Read-only view of an index written by writeImageIndex()
+ */
+class ImageIndex {
+public:
+    struct Image {
+        std::string path;
+        std::string format;
+        std::string fileSystem;
+        std::string volume;
+        DiskGeometry geometry;
+        SHA256::Digest hash{};
+        uint32_t fileCount = 0;
+    };
+
+    struct File {
+        uint32_t image = 0;
+        std::string path;
+        uint64_t size = 0;
+        uint8_t fileType = 0;
+        uint8_t attributes = 0;
+        SHA256::Digest hash{};
+    };
+
+    /**
+     * @throws FileNotFoundException, ReadException, InvalidFormatException
+     */
+    explicit ImageIndex(const std::filesystem::path& file);
+
+    uint32_t imageCount() const { return m_imageCount; }
+    uint32_t fileCount() const { return m_fileCount; }
+
+    Image image(uint32_t index) const;
+
+    /** File by position in hash order */
+    File file(uint32_t index) const;
+
+    /** Positions of the files whose contents hash to `hash` */
+    std::vector<uint32_t> findByHash(const SHA256::Digest& hash) const;
+
+    /** Positions of the files with min <= size <= max, smallest first */
+    std::vector<uint32_t> findBySize(uint64_t min, uint64_t max) const;
+
+private:
+    const uint8_t* fileRecord(uint32_t index) const;
+    uint64_t fileSize(uint32_t index) const;
+    std::string string(uint32_t offset) const;
+
+    std::vector<uint8_t> m_data;
+    uint32_t m_imageCount = 0;
+    uint32_t m_fileCount = 0;
+    size_t m_imagesOffset = 0;
+    size_t m_filesOffset = 0;
+    size_t m_sizeOrderOffset = 0;
+    size_t m_stringsOffset = 0;
+    size_t m_stringsSize = 0;
+};
+
+} // namespace rde
+
+#endif // RDEDISKTOOL_UTILS_IMAGEINDEX_H
@@ -0,0 +1,90 @@
+#ifndef RDEDISKTOOL_UTILS_JSONWRITER_H
+#define RDEDISKTOOL_UTILS_JSONWRITER_H
+
+#include "rdedisktool/Types.h"
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace rde {
+
+/**
+ * Buffered JSON writer for machine-readable CLI output.
+ *
+ * Values are appended to an in-memory buffer that is handed to the stream
+ * in large writes (flushTo / automatically past `flushThreshold`), instead
+ * of one `<<` per field. Pretty mode indents with two spaces; compact mode
+ * emits one record per line for NDJSON (call endRecord() after each).
+ * Nothing left in the buffer is written on destruction, so output cut
+ * short by an exception does not leave half a record behind.
+ */
+class JsonWriter {
+public:
+    JsonWriter(std::ostream& out, bool pretty, size_t flushThreshold = 64 * 1024);
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    JsonWriter& key(const char* name);
+
+    JsonWriter& value(const std::string& s);
+    JsonWriter& value(const char* s);
+    JsonWriter& value(bool b);
+    JsonWriter& null();
+
+    template <typename T,
+              typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+    JsonWriter& value(T n) {
+        separate();
+        m_buffer += std::to_string(n);
+        return *this;
+    }
+
+    template <typename T>
+    JsonWriter& value(const std::optional<T>& v) {
+        return v ? value(*v) : null();
+    }
+
+    /** Shorthand for key(name).value(v) */
+    template <typename T>
+    JsonWriter& field(const char* name, const T& v) {
+        return key(name).value(v);
+    }
+
+    /** End a top-level value: newline, and flush if the buffer is large */
+    void endRecord();
+
+    /** Write everything buffered so far to the stream; call when done */
+    void flushTo();
+
+    /** Append `s` as a quoted, escaped JSON string. Bytes that are not
+     *  well-formed UTF-8 are escaped as \u00XX (their Latin-1 reading). */
+    static void appendString(std::string& out, const std::string& s);
+
+private:
+    void separate();
+    void newline();
+
+    std::ostream& m_out;
+    bool m_pretty;
+    size_t m_flushThreshold;
+    std::string m_buffer;
+    std::vector<bool> m_hasItems;   // per open container
+    bool m_afterKey = false;
+};
+
+// Stable field sets for the core result types
+void writeJson(JsonWriter& w, const FileEntry& entry);
+void writeJson(JsonWriter& w, const DiskGeometry& geometry);
+void writeJson(JsonWriter& w, const ValidationResult& result);
+
+} // namespace rde
+
+#endif // RDEDISKTOOL_UTILS_JSONWRITER_H
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace rde {
 
@@ -22,6 +23,27 @@ inline std::string macRomanToUtf8(const std::string& s) {
     return macRomanToUtf8(reinterpret_cast<const uint8_t*>(s.data()), s.size());
 }
 
+/**
+ * Compare two UTF-8 file names the way the HFS / MFS catalog does:
+ * case-insensitively but diacritic-sensitively ("readme" matches "ReadMe",
+ * "cafe" does not match "caf\u00e9"). Case folding covers ASCII and the
+ * accented Latin letters Mac-Roman can encode.
+ */
+bool macNamesEqual(std::string_view a, std::string_view b);
+
+/**
+ * Hash of a UTF-8 file name, consistent with macNamesEqual() (names that
+ * compare equal hash equal). Does not allocate.
+ */
+size_t macNameHash(std::string_view name);
+
+/**
+ * Upper-case a single Mac-Roman byte with the folding macNamesEqual() uses
+ * ('a' -> 'A', 0x8A a-diaeresis -> 0x80 A-diaeresis). Other bytes are
+ * returned unchanged. Suitable for ordering raw catalog key names.
+ */
+uint8_t macRomanFoldByte(uint8_t b);
+
 } // namespace rde
 
 #endif // RDEDISKTOOL_UTILS_MACROMAN_H
@@ -0,0 +1,63 @@
+#ifndef RDEDISKTOOL_UTILS_REDOJOURNAL_H
+#define RDEDISKTOOL_UTILS_REDOJOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <vector>
+
+namespace rde {
+
+/**
+ * Redo journal for in-place image saves.
+ *
+ * writeRangesInPlace() first writes every range it is about to change to
+ * "<image>.rdejournal" and syncs it and its directory, then overwrites just
+ * those ranges of the image, syncs it and removes the journal. A crash
+ * before the journal is complete leaves a torn journal that is discarded;
+ * a crash after it replays cleanly.
+ *
+ * Besides the ranges (offset/length/bytes each, CRC-32 trailer) the journal
+ * records the image file size and the CRC-32 of the data region as it must
+ * read after the write. Recovery replays only onto a file of that size that
+ * matches the checksum once the ranges are applied, so a journal left next
+ * to an image that was since replaced is discarded instead.
+ */
+
+/**
+ * Outcome of recoverRedoJournal()
+ */
+enum class JournalRecovery {
+    None,       // no journal
+    Replayed,   // complete journal applied to the image
+    Torn,       // incomplete journal removed; the image was not touched
+    Mismatch    // journal for another file state removed; image not touched
+};
+
+/**
+ * Journal file used for an image path
+ */
+std::filesystem::path redoJournalPath(const std::filesystem::path& image);
+
+/**
+ * Overwrite the given [begin, end) ranges of `data` at `dataOffset + begin`
+ * in the existing file `image`, crash-safely.
+ * @return number of payload bytes written to the image
+ * @throws WriteException on any I/O failure (the journal is kept)
+ */
+uint64_t writeRangesInPlace(const std::filesystem::path& image,
+                            const std::vector<uint8_t>& data,
+                            uint64_t dataOffset,
+                            const std::map<size_t, size_t>& ranges);
+
+/**
+ * Replay a complete journal left next to `image` and remove it; a torn or
+ * mismatched journal is removed without touching the image.
+ * @throws WriteException if a complete, matching journal cannot be applied
+ */
+JournalRecovery recoverRedoJournal(const std::filesystem::path& image);
+
+} // namespace rde
+
+#endif // RDEDISKTOOL_UTILS_REDOJOURNAL_H
@@ -0,0 +1,115 @@
+#ifndef RDEDISKTOOL_UTILS_STATS_H
+#define RDEDISKTOOL_UTILS_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace rde {
+
+/**
+ * Process-wide phase timers and I/O counters behind the --stats option.
+ *
+ * Everything is a relaxed atomic so images handled on the scan/index worker
+ * threads are counted too. When disabled, each hook is a single relaxed load
+ * and a branch; no clock is read. Phase times are inclusive: a Load or
+ * FsInit that runs inside a Command is counted in both.
+ */
+class Stats {
+public:
+    enum class Phase {
+        Detect,     // format detection in DiskImageFactory::open
+        Load,       // DiskImage::load
+        FsInit,     // FileSystemHandler::initialize
+        Save,       // DiskImage::save
+        Command,    // the command handler as a whole
+        Count_
+    };
+
+    enum class Counter {
+        SectorReads,
+        SectorBytesRead,
+        SectorWrites,
+        SectorBytesWritten,
+        BytesLoaded,
+        Count_
+    };
+
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on) { s_enabled.store(on, std::memory_order_relaxed); }
+
+    static void add(Counter c, uint64_t n = 1) {
+        if (enabled()) {
+            s_counters[static_cast<size_t>(c)].fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * `sectors` sectors totalling `bytes` read from the image, through
+     * readSector() or a direct view of its data
+     */
+    static void sectorRead(uint64_t bytes, uint64_t sectors = 1) {
+        if (enabled()) {
+            add(Counter::SectorReads, sectors);
+            add(Counter::SectorBytesRead, bytes);
+        }
+    }
+
+    /**
+     * `sectors` sectors totalling `bytes` stored into the image, through
+     * writeSector(), a direct view or setRawData()
+     */
+    static void sectorWritten(uint64_t bytes, uint64_t sectors = 1) {
+        if (enabled()) {
+            add(Counter::SectorWrites, sectors);
+            add(Counter::SectorBytesWritten, bytes);
+        }
+    }
+
+    static void addTime(Phase p, uint64_t nanoseconds);
+
+    static void reset();
+
+    /** Human-readable table, or a single JSON object when `json` is set */
+    static void report(std::ostream& out, bool json);
+
+private:
+    static std::atomic<bool> s_enabled;
+    static std::atomic<uint64_t> s_counters[static_cast<size_t>(Counter::Count_)];
+    static std::atomic<uint64_t> s_phaseCalls[static_cast<size_t>(Phase::Count_)];
+    static std::atomic<uint64_t> s_phaseNanos[static_cast<size_t>(Phase::Count_)];
+};
+
+/**
+ * Adds the lifetime of the object to a phase, including when the scope is
+ * left by an exception. Reads the clock only if stats were enabled on entry.
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Stats::Phase phase) : m_phase(phase), m_active(Stats::enabled()) {
+        if (m_active) {
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedTimer() {
+        if (m_active) {
+            auto elapsed = std::chrono::steady_clock::now() - m_start;
+            Stats::addTime(m_phase, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Stats::Phase m_phase;
+    bool m_active;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace rde
+
+#endif // RDEDISKTOOL_UTILS_STATS_H
@@ -0,0 +1,63 @@
+#ifndef RDEDISKTOOL_UTILS_WORKSTEALINGPOOL_H
+#define RDEDISKTOOL_UTILS_WORKSTEALINGPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rde {
+
+/**
+ * Fixed-size thread pool with one task deque per worker.
+ *
+ * submit() deals tasks round-robin onto the worker deques. A worker takes
+ * its own newest task first and, when its deque is empty, steals the oldest
+ * task from another worker, so a few slow tasks (large images) do not hold
+ * up the rest of a queue. Tasks must not throw.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(size_t threads);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task task);
+
+    /** Block until every submitted task has finished */
+    void wait();
+
+    size_t size() const { return m_threads.size(); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool takeTask(size_t self, Task& task);
+    void run(size_t self);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    size_t m_next = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_allDone;
+    size_t m_queued = 0;       // submitted, not yet taken
+    size_t m_unfinished = 0;   // submitted, not yet finished
+    bool m_stop = false;
+};
+
+} // namespace rde
+
+#endif // RDEDISKTOOL_UTILS_WORKSTEALINGPOOL_H
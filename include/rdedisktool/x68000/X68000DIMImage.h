@@ -2,6 +2,7 @@
 #define RDEDISKTOOL_X68000_DIMIMAGE_H
 
 #include "rdedisktool/x68000/X68000DiskImage.h"
+#include <optional>
 
 namespace rde {
 
@@ -13,6 +14,12 @@ namespace rde {
  * - Per-track existence flags for sparse images
  * - Metadata fields (date, time, comment)
  *
+ * Track data is kept sparse in memory as well: only tracks whose trkflag is
+ * set own a buffer. Absent tracks read back as filler (0xE5) and are
+ * materialized on the first writeSector()/writeTrack() that touches them.
+ * getRawData() serializes the header and present tracks on each call,
+ * exactly as save() writes them, so it costs a copy of the stored tracks.
+ *
  * Header structure (256 bytes):
  *   Offset  Size  Description
  *   0x00    1     Disk type (0-9)
@@ -36,6 +43,9 @@ public:
     void save(const std::filesystem::path& path = {}) override;
     void create(const DiskGeometry& geometry) override;
 
+    const std::vector<uint8_t>& getRawData() const override;
+    void setRawData(const std::vector<uint8_t>& data) override;
+
     DiskFormat getFormat() const override { return DiskFormat::X68000DIM; }
 
     SectorBuffer readSector(size_t track, size_t side, size_t sector) override;
@@ -45,8 +55,12 @@ public:
     TrackBuffer readTrack(size_t track, size_t side) override;
     void writeTrack(size_t track, size_t side, const TrackBuffer& data) override;
 
+    const uint8_t* sectorData(size_t linearTrack, size_t sector) const override;
+    uint8_t* mutableSectorData(size_t linearTrack, size_t sector) override;
+
     bool canConvertTo(DiskFormat format) const override;
     std::unique_ptr<DiskImage> convertTo(DiskFormat format) const override;
+    std::unique_ptr<DiskImage> clone() const override { return std::make_unique<X68000DIMImage>(*this); }
 
     bool validate() const override;
     std::string getDiagnostics() const override;
@@ -82,9 +96,34 @@ public:
 
     /**
      * Set track presence flag
+     * Marking a track present materializes it filled with 0xE5; marking it
+     * absent releases its buffer.
      */
     void setTrackPresent(size_t track, bool present);
 
+    /**
+     * Number of tracks currently stored in the image
+     */
+    size_t getPresentTrackCount() const;
+
+    /**
+     * Check whether a present track holds only 0x00 or only filler bytes
+     */
+    bool isTrackBlank(size_t track) const;
+
+    /**
+     * Drop blank tracks (entirely 0x00 or 0xE5) from the image
+     *
+     * Filler tracks read back identically once absent, so they are always
+     * dropped. Zero-filled tracks would read back as filler, so they are
+     * only dropped when @p usedTracks is given and does not mark them (e.g.
+     * a filesystem map of metadata and allocated clusters).
+     *
+     * @param usedTracks Linear track map of tracks in use, if known
+     * @return Number of tracks removed
+     */
+    size_t compactTracks(const std::optional<std::vector<bool>>& usedTracks = std::nullopt);
+
     /**
      * Get sector size for current DIM type
      */
@@ -156,21 +195,43 @@ private:
         154, 160, 160, 160, 0, 0, 0, 0, 0, 160
     };
 
+    static constexpr uint8_t FILLER_BYTE = 0xE5;
+
     DIMHeader m_header;
     X68000DIMType m_dimType;
 
+    /**
+     * Track buffers indexed by linear track; empty = absent
+     */
+    std::vector<std::vector<uint8_t>> m_tracks;
+
+    /**
+     * Serialized image returned by getRawData()
+     */
+    mutable std::vector<uint8_t> m_rawView;
+
     /**
      * Parse header from loaded data
      */
     void parseHeader();
 
+    /**
+     * Parse a complete DIM file image (header + present tracks)
+     */
+    void parseImage(const std::vector<uint8_t>& image);
+
+    /**
+     * Get the buffer of a track, allocating it if absent
+     */
+    std::vector<uint8_t>& materializeTrack(size_t track);
+
     /**
      * Build header before saving
      */
     void buildHeader();
 
     /**
-     * Calculate byte offset for a given track and sector
+     * Calculate byte offset of a sector within its track buffer
      */
     size_t calculateOffset(size_t track, size_t sector) const override;
 
@@ -183,11 +244,6 @@ private:
      * Check if DIM type is valid
      */
     static bool isValidDIMType(uint8_t type);
-
-    /**
-     * Get the data offset (after header, accounting for sparse tracks)
-     */
-    size_t getDataOffset(size_t track) const;
 };
 
 } // namespace rde
@@ -108,6 +108,26 @@ public:
      */
     bool isHuman68k() const;
 
+    /**
+     * Direct pointer to a stored sector
+     *
+     * Sectors of one track are contiguous, so the pointer also covers the
+     * following sectors up to the end of the track.
+     *
+     * @param linearTrack Linear track (cylinder * 2 + head)
+     * @param sector Sector number (1-indexed)
+     * @return nullptr if the sector is out of range or not stored
+     */
+    virtual const uint8_t* sectorData(size_t linearTrack, size_t sector) const;
+
+    /**
+     * Writable direct pointer to a sector, allocating storage if needed
+     * Marks the image as modified.
+     * @throws WriteProtectedException if the image is write protected
+     * @throws SectorNotFoundException if the sector is out of range
+     */
+    virtual uint8_t* mutableSectorData(size_t linearTrack, size_t sector);
+
 protected:
     X68000DiskImage();
 
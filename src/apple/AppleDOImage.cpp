@@ -1,6 +1,7 @@
 #include "rdedisktool/apple/AppleDOImage.h"
 #include "rdedisktool/apple/ApplePOImage.h"
 #include "rdedisktool/DiskImageFactory.h"
+#include "rdedisktool/utils/Stats.h"
 #include <fstream>
 #include <sstream>
 
@@ -57,10 +58,12 @@ void AppleDOImage::load(const std::filesystem::path& path) {
 
     m_filePath = path;
     m_modified = false;
+    clearDirty();
     m_fileSystemDetected = false;
 }
 
 void AppleDOImage::save(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Save);
     std::filesystem::path savePath = path.empty() ? m_filePath : path;
 
     if (savePath.empty()) {
@@ -97,6 +100,7 @@ void AppleDOImage::create(const DiskGeometry& geometry) {
 
     // Create blank disk image filled with zeros
     m_data.resize(tracks * sectors * BYTES_PER_SECTOR, 0);
+    markDirty(0, m_data.size());
     m_modified = true;
     m_fileSystemDetected = false;
     m_filePath.clear();
@@ -108,7 +112,19 @@ size_t AppleDOImage::calculateOffset(size_t track, size_t sector) const {
     return (track * m_geometry.sectorsPerTrack + sector) * BYTES_PER_SECTOR;
 }
 
+std::optional<size_t> AppleDOImage::sectorOffset(size_t track, size_t /*side*/, size_t sector) const {
+    if (track >= m_geometry.tracks || sector >= m_geometry.sectorsPerTrack) {
+        return std::nullopt;
+    }
+    const size_t offset = calculateOffset(track, sector);
+    if (offset + BYTES_PER_SECTOR > m_data.size()) {
+        return std::nullopt;
+    }
+    return offset;
+}
+
 SectorBuffer AppleDOImage::readSector(size_t track, size_t /*side*/, size_t sector) {
+    Stats::sectorRead(m_geometry.bytesPerSector);
     if (track >= m_geometry.tracks) {
         throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
     }
@@ -127,6 +143,7 @@ SectorBuffer AppleDOImage::readSector(size_t track, size_t /*side*/, size_t sect
 
 void AppleDOImage::writeSector(size_t track, size_t /*side*/, size_t sector,
                                const SectorBuffer& data) {
+    Stats::sectorWritten(data.size());
     if (m_writeProtected) {
         throw WriteProtectedException();
     }
@@ -146,6 +163,7 @@ void AppleDOImage::writeSector(size_t track, size_t /*side*/, size_t sector,
     // Copy data, padding or truncating to sector size
     size_t copySize = std::min(data.size(), BYTES_PER_SECTOR);
     std::copy(data.begin(), data.begin() + copySize, m_data.begin() + offset);
+    markDirty(offset, BYTES_PER_SECTOR);
 
     // Zero-fill if data is short
     if (copySize < BYTES_PER_SECTOR) {
@@ -182,6 +200,7 @@ void AppleDOImage::writeTrack(size_t track, size_t /*side*/, const TrackBuffer&
     size_t copySize = std::min(data.size(), trackSize);
 
     std::copy(data.begin(), data.begin() + copySize, m_data.begin() + offset);
+    markDirty(offset, trackSize);
 
     // Zero-fill remainder
     if (copySize < trackSize) {
@@ -199,6 +218,7 @@ bool AppleDOImage::canConvertTo(DiskFormat format) const {
         case DiskFormat::AppleWOZ2:
             return true;
         case DiskFormat::Unknown:
+        case DiskFormat::AppleHDV:
         case DiskFormat::AppleDO:
         case DiskFormat::AppleNIB2:
         case DiskFormat::AppleWOZ1:
@@ -15,7 +15,7 @@ void AppleDiskImage::initGeometry(size_t tracks, size_t sectors) {
 }
 
 void AppleDiskImage::setRawData(const std::vector<uint8_t>& data) {
-    m_data = data;
+    assignRawData(data);
     m_modified = true;
     m_fileSystemDetected = false;
 }
@@ -149,29 +149,17 @@ size_t AppleDiskImage::physicalToLogical(size_t physical) const {
     }
 }
 
-SectorBuffer AppleDiskImage::readBlock(size_t block) {
-    // ProDOS block = 512 bytes = 2 sectors
-    // Block mapping depends on format
-
-    if (block >= getTotalBlocks()) {
-        throw SectorNotFoundException(static_cast<int>(block / 8),
-                                      static_cast<int>(block % 8));
-    }
-
-    // Calculate track and sectors for this block
+void AppleDiskImage::blockToSectors(size_t block, size_t& track,
+                                    size_t& sector1, size_t& sector2) const {
     // Each track has 8 blocks (16 sectors / 2 sectors per block)
-    size_t track = block / 8;
+    track = block / 8;
     size_t blockInTrack = block % 8;
 
-    // Read two sectors that make up this block
-    SectorBuffer result;
-    result.reserve(512);
-
     // ProDOS logical sectors in this track.
     size_t logical1 = blockInTrack * 2;
     size_t logical2 = blockInTrack * 2 + 1;
-    size_t sector1 = logical1;
-    size_t sector2 = logical2;
+    sector1 = logical1;
+    sector2 = logical2;
 
     if (getSectorOrder() == SectorOrder::DOS) {
         // DO images store DOS logical sectors. Convert ProDOS logical -> physical
@@ -181,6 +169,23 @@ SectorBuffer AppleDiskImage::readBlock(size_t block) {
         sector1 = AppleInterleave::DOS33_DEINTERLEAVE[phys1];
         sector2 = AppleInterleave::DOS33_DEINTERLEAVE[phys2];
     }
+}
+
+SectorBuffer AppleDiskImage::readBlock(size_t block) {
+    // ProDOS block = 512 bytes = 2 sectors
+    // Block mapping depends on format
+
+    if (block >= getTotalBlocks()) {
+        throw SectorNotFoundException(static_cast<int>(block / 8),
+                                      static_cast<int>(block % 8));
+    }
+
+    size_t track, sector1, sector2;
+    blockToSectors(block, track, sector1, sector2);
+
+    // Read two sectors that make up this block
+    SectorBuffer result;
+    result.reserve(512);
 
     auto s1 = readSector(track, 0, sector1);
     auto s2 = readSector(track, 0, sector2);
@@ -201,19 +206,8 @@ void AppleDiskImage::writeBlock(size_t block, const SectorBuffer& data) {
         throw InvalidFormatException("Block data must be 512 bytes");
     }
 
-    size_t track = block / 8;
-    size_t blockInTrack = block % 8;
-    size_t logical1 = blockInTrack * 2;
-    size_t logical2 = blockInTrack * 2 + 1;
-    size_t sector1 = logical1;
-    size_t sector2 = logical2;
-
-    if (getSectorOrder() == SectorOrder::DOS) {
-        size_t phys1 = AppleInterleave::PRODOS_INTERLEAVE[logical1];
-        size_t phys2 = AppleInterleave::PRODOS_INTERLEAVE[logical2];
-        sector1 = AppleInterleave::DOS33_DEINTERLEAVE[phys1];
-        sector2 = AppleInterleave::DOS33_DEINTERLEAVE[phys2];
-    }
+    size_t track, sector1, sector2;
+    blockToSectors(block, track, sector1, sector2);
 
     SectorBuffer s1(data.begin(), data.begin() + 256);
     SectorBuffer s2(data.begin() + 256, data.begin() + 512);
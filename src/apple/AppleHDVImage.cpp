@@ -0,0 +1,411 @@
+#include "rdedisktool/apple/AppleHDVImage.h"
+#include "rdedisktool/apple/ApplePOImage.h"
+#include "rdedisktool/DiskImageFactory.h"
+#include "rdedisktool/Exceptions.h"
+#include "rdedisktool/utils/BinaryReader.h"
+#include "rdedisktool/utils/Stats.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace rde {
+
+// Register format with factory
+namespace {
+    struct AppleHDVRegistrar {
+        AppleHDVRegistrar() {
+            DiskImageFactory::registerFormat(DiskFormat::AppleHDV,
+                []() -> std::unique_ptr<DiskImage> {
+                    return std::make_unique<AppleHDVImage>();
+                });
+        }
+    };
+    static AppleHDVRegistrar registrar;
+
+    std::string lowerExtension(const std::filesystem::path& path) {
+        std::string ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return ext;
+    }
+}
+
+AppleHDVImage::AppleHDVImage() {
+    updateGeometry();
+}
+
+void AppleHDVImage::updateGeometry() {
+    m_geometry.tracks = m_data.size() / BLOCK_SIZE;
+    m_geometry.sides = 1;
+    m_geometry.sectorsPerTrack = 1;
+    m_geometry.bytesPerSector = BLOCK_SIZE;
+}
+
+void AppleHDVImage::load(const std::filesystem::path& path) {
+    if (!std::filesystem::exists(path)) {
+        throw FileNotFoundException(path.string());
+    }
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw ReadException("Cannot open file: " + path.string());
+    }
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+
+    std::vector<uint8_t> contents(fileSize);
+    file.read(reinterpret_cast<char*>(contents.data()), fileSize);
+    if (!file) {
+        throw ReadException("Failed to read file: " + path.string());
+    }
+
+    if (contents.size() >= 4 && std::memcmp(contents.data(), "2IMG", 4) == 0) {
+        parse2MG(contents);
+    } else {
+        if (fileSize == 0 || fileSize % BLOCK_SIZE != 0) {
+            throw InvalidFormatException("Block image size must be a non-zero multiple of 512 bytes");
+        }
+        if (fileSize / BLOCK_SIZE > MAX_BLOCKS) {
+            throw InvalidFormatException("Block image exceeds 65535 blocks");
+        }
+        m_data = std::move(contents);
+        m_has2MGHeader = false;
+        m_2mgFlags = 0;
+        m_comment.clear();
+        m_creatorData.clear();
+    }
+
+    updateGeometry();
+    m_filePath = path;
+    m_modified = false;
+    m_fileSystemDetected = false;
+}
+
+void AppleHDVImage::parse2MG(const std::vector<uint8_t>& file) {
+    if (file.size() < HEADER_2MG_SIZE) {
+        throw InvalidFormatException("2MG header truncated");
+    }
+
+    rdedisktool::BinaryReader reader(file);
+    uint16_t headerSize = reader.readU16LE(0x08);
+    uint32_t imageFormat = reader.readU32LE(0x0C);
+    uint32_t flags = reader.readU32LE(0x10);
+    uint32_t blocks = reader.readU32LE(0x14);
+    uint32_t dataOffset = reader.readU32LE(0x18);
+    uint32_t dataLength = reader.readU32LE(0x1C);
+    uint32_t commentOffset = reader.readU32LE(0x20);
+    uint32_t commentLength = reader.readU32LE(0x24);
+    uint32_t creatorOffset = reader.readU32LE(0x28);
+    uint32_t creatorLength = reader.readU32LE(0x2C);
+
+    if (imageFormat != FORMAT_2MG_PRODOS) {
+        throw UnsupportedFormatException("2MG image is not in ProDOS block order");
+    }
+    if (headerSize < HEADER_2MG_SIZE || dataOffset < headerSize) {
+        throw InvalidFormatException("Invalid 2MG header size");
+    }
+
+    // ProDOS addresses at most MAX_BLOCKS blocks; checking first also keeps
+    // the size computed from the count below from wrapping
+    if (blocks > MAX_BLOCKS) {
+        throw InvalidFormatException("Invalid 2MG block count: " + std::to_string(blocks));
+    }
+
+    // Some writers leave the data length at zero for ProDOS images
+    if (dataLength == 0) {
+        dataLength = blocks * static_cast<uint32_t>(BLOCK_SIZE);
+    }
+    if (dataLength == 0 || dataLength % BLOCK_SIZE != 0 ||
+        dataLength / BLOCK_SIZE > MAX_BLOCKS) {
+        throw InvalidFormatException("Invalid 2MG data length: " + std::to_string(dataLength));
+    }
+    if (static_cast<size_t>(dataOffset) + dataLength > file.size()) {
+        throw InvalidFormatException("2MG data extends past end of file");
+    }
+
+    auto chunk = [&](uint32_t offset, uint32_t length) -> std::vector<uint8_t> {
+        if (offset == 0 || length == 0 ||
+            static_cast<size_t>(offset) + length > file.size()) {
+            return {};
+        }
+        return std::vector<uint8_t>(file.begin() + offset, file.begin() + offset + length);
+    };
+
+    std::memcpy(m_creator, file.data() + 0x04, sizeof(m_creator));
+    m_2mgFlags = flags;
+    m_comment = chunk(commentOffset, commentLength);
+    m_creatorData = chunk(creatorOffset, creatorLength);
+    m_data.assign(file.begin() + dataOffset, file.begin() + dataOffset + dataLength);
+    m_has2MGHeader = true;
+    m_writeProtected = (flags & FLAG_2MG_LOCKED) != 0;
+}
+
+std::vector<uint8_t> AppleHDVImage::build2MGHeader() const {
+    std::vector<uint8_t> header(HEADER_2MG_SIZE, 0);
+    rdedisktool::BinaryWriter writer(header);
+
+    uint32_t dataLength = static_cast<uint32_t>(m_data.size());
+    uint32_t next = static_cast<uint32_t>(HEADER_2MG_SIZE) + dataLength;
+
+    std::memcpy(header.data(), "2IMG", 4);
+    std::memcpy(header.data() + 0x04, m_creator, sizeof(m_creator));
+    writer.writeU16LE(0x08, static_cast<uint16_t>(HEADER_2MG_SIZE));
+    writer.writeU16LE(0x0A, 1);
+    writer.writeU32LE(0x0C, FORMAT_2MG_PRODOS);
+    writer.writeU32LE(0x10, (m_2mgFlags & ~FLAG_2MG_LOCKED) |
+                            (m_writeProtected ? FLAG_2MG_LOCKED : 0));
+    writer.writeU32LE(0x14, dataLength / static_cast<uint32_t>(BLOCK_SIZE));
+    writer.writeU32LE(0x18, static_cast<uint32_t>(HEADER_2MG_SIZE));
+    writer.writeU32LE(0x1C, dataLength);
+
+    // Comment and creator chunks follow the block data
+    if (!m_comment.empty()) {
+        writer.writeU32LE(0x20, next);
+        writer.writeU32LE(0x24, static_cast<uint32_t>(m_comment.size()));
+        next += static_cast<uint32_t>(m_comment.size());
+    }
+    if (!m_creatorData.empty()) {
+        writer.writeU32LE(0x28, next);
+        writer.writeU32LE(0x2C, static_cast<uint32_t>(m_creatorData.size()));
+    }
+
+    return header;
+}
+
+void AppleHDVImage::save(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Save);
+    std::filesystem::path savePath = path.empty() ? m_filePath : path;
+
+    if (savePath.empty()) {
+        throw WriteException("No file path specified");
+    }
+
+    if (m_writeProtected && savePath == m_filePath) {
+        throw WriteProtectedException();
+    }
+
+    // The target extension decides the container when it is unambiguous
+    std::string ext = lowerExtension(savePath);
+    bool with2MG = m_has2MGHeader;
+    if (ext == ".2mg" || ext == ".2img") {
+        with2MG = true;
+    } else if (ext == ".hdv" || ext == ".po") {
+        with2MG = false;
+    }
+
+    std::ofstream file(savePath, std::ios::binary);
+    if (!file) {
+        throw WriteException("Cannot create file: " + savePath.string());
+    }
+
+    if (with2MG) {
+        auto header = build2MGHeader();
+        file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    }
+
+    file.write(reinterpret_cast<const char*>(m_data.data()), m_data.size());
+
+    if (with2MG) {
+        file.write(reinterpret_cast<const char*>(m_comment.data()), m_comment.size());
+        file.write(reinterpret_cast<const char*>(m_creatorData.data()), m_creatorData.size());
+    }
+
+    if (!file) {
+        throw WriteException("Failed to write file: " + savePath.string());
+    }
+
+    if (path.empty() || path == m_filePath) {
+        m_modified = false;
+    }
+
+    m_has2MGHeader = with2MG;
+    m_filePath = savePath;
+}
+
+void AppleHDVImage::create(const DiskGeometry& geometry) {
+    size_t total = geometry.totalSize();
+    size_t blocks = total / BLOCK_SIZE;
+
+    if (total == 0 || total % BLOCK_SIZE != 0) {
+        throw InvalidFormatException("Block image geometry must yield a non-zero multiple of 512 bytes");
+    }
+    if (blocks > MAX_BLOCKS) {
+        throw InvalidFormatException("Block image exceeds 65535 blocks");
+    }
+
+    m_data.assign(total, 0);
+    m_has2MGHeader = false;
+    m_2mgFlags = 0;
+    m_comment.clear();
+    m_creatorData.clear();
+    updateGeometry();
+
+    m_modified = true;
+    m_fileSystemDetected = false;
+    m_filePath.clear();
+}
+
+void AppleHDVImage::setRawData(const std::vector<uint8_t>& data) {
+    assignRawData(data);
+    updateGeometry();
+    m_modified = true;
+    m_fileSystemDetected = false;
+}
+
+FileSystemType AppleHDVImage::getFileSystemType() const {
+    if (m_fileSystemDetected) {
+        return m_cachedFileSystem;
+    }
+
+    // ProDOS volume header at block 2, offset 4
+    m_cachedFileSystem = FileSystemType::Unknown;
+    size_t offset = 2 * BLOCK_SIZE;
+    if (offset + BLOCK_SIZE <= m_data.size()) {
+        const uint8_t* blk = m_data.data() + offset;
+        uint8_t storageType = (blk[0x04] >> 4) & 0x0F;
+        uint8_t nameLen = blk[0x04] & 0x0F;
+        uint16_t bitmapPtr = static_cast<uint16_t>(blk[0x27] | (blk[0x28] << 8));
+        uint16_t totalBlocks = static_cast<uint16_t>(blk[0x29] | (blk[0x2A] << 8));
+
+        if (storageType == 0x0F && nameLen >= 1 && blk[0x23] == 0x27 && blk[0x24] != 0 &&
+            bitmapPtr > 0 && bitmapPtr < getTotalBlocks() &&
+            totalBlocks > 0 && totalBlocks <= getTotalBlocks()) {
+            m_cachedFileSystem = FileSystemType::ProDOS;
+        }
+    }
+
+    m_fileSystemDetected = true;
+    return m_cachedFileSystem;
+}
+
+std::optional<size_t> AppleHDVImage::sectorOffset(size_t track, size_t side, size_t sector) const {
+    if (side != 0 || sector != 0 || (track + 1) * BLOCK_SIZE > m_data.size()) {
+        return std::nullopt;
+    }
+    return track * BLOCK_SIZE;
+}
+
+SectorBuffer AppleHDVImage::readSector(size_t track, size_t side, size_t sector) {
+    Stats::sectorRead(m_geometry.bytesPerSector);
+    if (side != 0 || sector != 0) {
+        throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
+    }
+    return readBlock(track);
+}
+
+void AppleHDVImage::writeSector(size_t track, size_t side, size_t sector,
+                                const SectorBuffer& data) {
+    Stats::sectorWritten(data.size());
+    if (side != 0 || sector != 0) {
+        throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
+    }
+
+    SectorBuffer block(BLOCK_SIZE, 0);
+    std::copy(data.begin(), data.begin() + std::min(data.size(), BLOCK_SIZE), block.begin());
+    writeBlock(track, block);
+}
+
+TrackBuffer AppleHDVImage::readTrack(size_t track, size_t side) {
+    return readSector(track, side, 0);
+}
+
+void AppleHDVImage::writeTrack(size_t track, size_t side, const TrackBuffer& data) {
+    writeSector(track, side, 0, data);
+}
+
+SectorBuffer AppleHDVImage::readBlock(size_t block) {
+    size_t offset = block * BLOCK_SIZE;
+    if (offset + BLOCK_SIZE > m_data.size()) {
+        throw SectorNotFoundException(static_cast<int>(block), 0);
+    }
+
+    return SectorBuffer(m_data.begin() + offset, m_data.begin() + offset + BLOCK_SIZE);
+}
+
+void AppleHDVImage::writeBlock(size_t block, const SectorBuffer& data) {
+    if (m_writeProtected) {
+        throw WriteProtectedException();
+    }
+
+    if (data.size() < BLOCK_SIZE) {
+        throw InvalidFormatException("Block data must be 512 bytes");
+    }
+
+    size_t offset = block * BLOCK_SIZE;
+    if (offset + BLOCK_SIZE > m_data.size()) {
+        throw SectorNotFoundException(static_cast<int>(block), 0);
+    }
+
+    std::copy(data.begin(), data.begin() + BLOCK_SIZE, m_data.begin() + offset);
+    markDirty(offset, BLOCK_SIZE);
+    m_modified = true;
+}
+
+bool AppleHDVImage::canConvertTo(DiskFormat format) const {
+    switch (format) {
+        case DiskFormat::ApplePO:
+            // Only a 140K volume fits a 5.25" ProDOS-order image
+            return m_data.size() == ApplePOImage::DISK_SIZE_140K;
+        case DiskFormat::Unknown:
+        case DiskFormat::AppleDO:
+        case DiskFormat::AppleHDV:
+        case DiskFormat::AppleNIB:
+        case DiskFormat::AppleNIB2:
+        case DiskFormat::AppleWOZ1:
+        case DiskFormat::AppleWOZ2:
+        case DiskFormat::MSXDSK:
+        case DiskFormat::MSXDMK:
+        case DiskFormat::MSXXSA:
+        case DiskFormat::X68000XDF:
+        case DiskFormat::X68000DIM:
+        case DiskFormat::MacIMG:
+        case DiskFormat::MacDC42:
+        case DiskFormat::MacMOOF:
+            return false;
+    }
+    return false;
+}
+
+std::unique_ptr<DiskImage> AppleHDVImage::convertTo(DiskFormat format) const {
+    if (!canConvertTo(format)) {
+        throw UnsupportedFormatException("Cannot convert to " +
+                                         std::string(formatToString(format)));
+    }
+
+    // PO stores 140K volumes as the same contiguous block array
+    auto poImage = std::make_unique<ApplePOImage>();
+    poImage->create(DiskImageFactory::getDefaultGeometry(DiskFormat::ApplePO));
+    poImage->setRawData(m_data);
+    return poImage;
+}
+
+bool AppleHDVImage::validate() const {
+    return !m_data.empty() &&
+           m_data.size() % BLOCK_SIZE == 0 &&
+           m_data.size() / BLOCK_SIZE <= MAX_BLOCKS;
+}
+
+std::string AppleHDVImage::getDiagnostics() const {
+    std::ostringstream oss;
+
+    oss << "Format: Apple II Block Image (" << (m_has2MGHeader ? ".2mg" : ".hdv") << ")\n";
+    oss << "Size: " << m_data.size() << " bytes\n";
+    oss << "Blocks: " << getTotalBlocks() << "\n";
+    if (m_has2MGHeader) {
+        oss << "2MG Creator: " << std::string(reinterpret_cast<const char*>(m_creator), 4) << "\n";
+        if (!m_comment.empty()) {
+            oss << "2MG Comment: "
+                << std::string(m_comment.begin(), m_comment.end()) << "\n";
+        }
+    }
+    oss << "File System: " << fileSystemTypeToString(getFileSystemType()) << "\n";
+    oss << "Write Protected: " << (m_writeProtected ? "Yes" : "No") << "\n";
+    oss << "Modified: " << (m_modified ? "Yes" : "No") << "\n";
+
+    return oss.str();
+}
+
+} // namespace rde
@@ -1,6 +1,7 @@
 #include "rdedisktool/apple/AppleNibImage.h"
 #include "rdedisktool/apple/AppleDOImage.h"
 #include "rdedisktool/DiskImageFactory.h"
+#include "rdedisktool/utils/Stats.h"
 #include <fstream>
 #include <sstream>
 
@@ -65,6 +66,7 @@ void AppleNibImage::load(const std::filesystem::path& path) {
 }
 
 void AppleNibImage::save(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Save);
     std::filesystem::path savePath = path.empty() ? m_filePath : path;
 
     if (savePath.empty()) {
@@ -183,6 +185,7 @@ void AppleNibImage::rebuildTrack(size_t track) {
 }
 
 SectorBuffer AppleNibImage::readSector(size_t track, size_t /*side*/, size_t sector) {
+    Stats::sectorRead(m_geometry.bytesPerSector);
     if (track >= m_geometry.tracks) {
         throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
     }
@@ -196,6 +199,7 @@ SectorBuffer AppleNibImage::readSector(size_t track, size_t /*side*/, size_t sec
 
 void AppleNibImage::writeSector(size_t track, size_t /*side*/, size_t sector,
                                 const SectorBuffer& data) {
+    Stats::sectorWritten(data.size());
     if (m_writeProtected) {
         throw WriteProtectedException();
     }
@@ -262,6 +266,7 @@ bool AppleNibImage::canConvertTo(DiskFormat format) const {
         case DiskFormat::AppleWOZ2:
             return true;
         case DiskFormat::Unknown:
+        case DiskFormat::AppleHDV:
         case DiskFormat::AppleNIB:
         case DiskFormat::AppleNIB2:
         case DiskFormat::AppleWOZ1:
@@ -1,6 +1,8 @@
 #include "rdedisktool/apple/ApplePOImage.h"
 #include "rdedisktool/apple/AppleDOImage.h"
+#include "rdedisktool/apple/AppleHDVImage.h"
 #include "rdedisktool/DiskImageFactory.h"
+#include "rdedisktool/utils/Stats.h"
 #include <fstream>
 #include <sstream>
 
@@ -48,10 +50,12 @@ void ApplePOImage::load(const std::filesystem::path& path) {
 
     m_filePath = path;
     m_modified = false;
+    clearDirty();
     m_fileSystemDetected = false;
 }
 
 void ApplePOImage::save(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Save);
     std::filesystem::path savePath = path.empty() ? m_filePath : path;
 
     if (savePath.empty()) {
@@ -87,6 +91,7 @@ void ApplePOImage::create(const DiskGeometry& geometry) {
     initGeometry(tracks, sectors);
 
     m_data.resize(tracks * sectors * BYTES_PER_SECTOR, 0);
+    markDirty(0, m_data.size());
     m_modified = true;
     m_fileSystemDetected = false;
     m_filePath.clear();
@@ -97,7 +102,19 @@ size_t ApplePOImage::calculateOffset(size_t track, size_t sector) const {
     return (track * m_geometry.sectorsPerTrack + sector) * BYTES_PER_SECTOR;
 }
 
+std::optional<size_t> ApplePOImage::sectorOffset(size_t track, size_t /*side*/, size_t sector) const {
+    if (track >= m_geometry.tracks || sector >= m_geometry.sectorsPerTrack) {
+        return std::nullopt;
+    }
+    const size_t offset = calculateOffset(track, sector);
+    if (offset + BYTES_PER_SECTOR > m_data.size()) {
+        return std::nullopt;
+    }
+    return offset;
+}
+
 SectorBuffer ApplePOImage::readSector(size_t track, size_t /*side*/, size_t sector) {
+    Stats::sectorRead(m_geometry.bytesPerSector);
     if (track >= m_geometry.tracks) {
         throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
     }
@@ -116,6 +133,7 @@ SectorBuffer ApplePOImage::readSector(size_t track, size_t /*side*/, size_t sect
 
 void ApplePOImage::writeSector(size_t track, size_t /*side*/, size_t sector,
                                const SectorBuffer& data) {
+    Stats::sectorWritten(data.size());
     if (m_writeProtected) {
         throw WriteProtectedException();
     }
@@ -134,6 +152,7 @@ void ApplePOImage::writeSector(size_t track, size_t /*side*/, size_t sector,
 
     size_t copySize = std::min(data.size(), BYTES_PER_SECTOR);
     std::copy(data.begin(), data.begin() + copySize, m_data.begin() + offset);
+    markDirty(offset, BYTES_PER_SECTOR);
 
     if (copySize < BYTES_PER_SECTOR) {
         std::fill(m_data.begin() + offset + copySize,
@@ -169,6 +188,7 @@ void ApplePOImage::writeTrack(size_t track, size_t /*side*/, const TrackBuffer&
     size_t copySize = std::min(data.size(), trackSize);
 
     std::copy(data.begin(), data.begin() + copySize, m_data.begin() + offset);
+    markDirty(offset, trackSize);
 
     if (copySize < trackSize) {
         std::fill(m_data.begin() + offset + copySize,
@@ -217,6 +237,7 @@ void ApplePOImage::writeBlock(size_t block, const SectorBuffer& data) {
     }
 
     std::copy(data.begin(), data.begin() + 512, m_data.begin() + offset);
+    markDirty(offset, 512);
     m_modified = true;
 }
 
@@ -225,6 +246,7 @@ bool ApplePOImage::canConvertTo(DiskFormat format) const {
         case DiskFormat::AppleDO:
         case DiskFormat::AppleNIB:
         case DiskFormat::AppleWOZ2:
+        case DiskFormat::AppleHDV:
             return true;
         case DiskFormat::Unknown:
         case DiskFormat::ApplePO:
@@ -274,6 +296,13 @@ std::unique_ptr<DiskImage> ApplePOImage::convertTo(DiskFormat format) const {
         return doImage;
     }
 
+    if (format == DiskFormat::AppleHDV) {
+        // Blocks are already contiguous; the payload carries over as-is
+        auto hdvImage = std::make_unique<AppleHDVImage>();
+        hdvImage->setRawData(m_data);
+        return hdvImage;
+    }
+
     throw NotImplementedException("Conversion to " + std::string(formatToString(format)));
 }
 
@@ -2,6 +2,7 @@
 #include "rdedisktool/apple/AppleDOImage.h"
 #include "rdedisktool/apple/NibbleEncoder.h"
 #include "rdedisktool/DiskImageFactory.h"
+#include "rdedisktool/utils/Stats.h"
 #include <fstream>
 #include <sstream>
 #include <cstring>
@@ -234,6 +235,7 @@ void AppleWozImage::parseMetaChunk(const uint8_t* data, size_t size) {
 }
 
 void AppleWozImage::save(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Save);
     std::filesystem::path savePath = path.empty() ? m_filePath : path;
 
     if (savePath.empty()) {
@@ -512,6 +514,7 @@ void AppleWozImage::decodeSectorsForTrack(size_t track) {
 }
 
 SectorBuffer AppleWozImage::readSector(size_t track, size_t /*side*/, size_t sector) {
+    Stats::sectorRead(m_geometry.bytesPerSector);
     if (track >= m_geometry.tracks) {
         throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
     }
@@ -525,6 +528,7 @@ SectorBuffer AppleWozImage::readSector(size_t track, size_t /*side*/, size_t sec
 
 void AppleWozImage::writeSector(size_t track, size_t /*side*/, size_t sector,
                                 const SectorBuffer& data) {
+    Stats::sectorWritten(data.size());
     if (m_writeProtected) {
         throw WriteProtectedException();
     }
@@ -641,6 +645,7 @@ bool AppleWozImage::canConvertTo(DiskFormat format) const {
         case DiskFormat::AppleNIB2:
         case DiskFormat::AppleWOZ1:
         case DiskFormat::AppleWOZ2:
+        case DiskFormat::AppleHDV:
         case DiskFormat::MSXDSK:
         case DiskFormat::MSXDMK:
         case DiskFormat::MSXXSA:
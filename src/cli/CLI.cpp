@@ -12,7 +12,16 @@
 #include "rdedisktool/apple/AppleConstants.h"
 #include "rdedisktool/msx/MSXXSAImage.h"
 #include "rdedisktool/msx/MSXDiskImage.h"
+#include "rdedisktool/msx/MSXDMKImage.h"
+#include "rdedisktool/x68000/X68000DIMImage.h"
+#include "rdedisktool/filesystem/x68000/Human68kHandler.h"
 #include "rdedisktool/utils/CommandOptions.h"
+#include "rdedisktool/utils/FileSync.h"
+#include "rdedisktool/utils/JsonWriter.h"
+#include "rdedisktool/utils/RedoJournal.h"
+#include "rdedisktool/utils/Stats.h"
+#include "rdedisktool/SHA256.h"
+#include "rdedisktool/SectorPatch.h"
 #include "rdedisktool/Version.h"
 #include <iostream>
 #include <iomanip>
@@ -44,6 +53,7 @@ rde::DiskFormat formatFromString(const std::string& str) {
     if (s == "nb2" || s == "applenib2") return rde::DiskFormat::AppleNIB2;
     if (s == "woz" || s == "woz2" || s == "applewoz2") return rde::DiskFormat::AppleWOZ2;
     if (s == "woz1" || s == "applewoz1") return rde::DiskFormat::AppleWOZ1;
+    if (s == "hdv" || s == "2mg" || s == "2img" || s == "applehdv") return rde::DiskFormat::AppleHDV;
     // MSX formats
     if (s == "msxdsk" || s == "msx") return rde::DiskFormat::MSXDSK;
     if (s == "dmk" || s == "msxdmk") return rde::DiskFormat::MSXDMK;
@@ -91,6 +101,10 @@ bool isFileSystemCompatible(rde::DiskFormat format, rde::FileSystemType fsType)
                   format == rde::DiskFormat::MacDC42 ||
                   format == rde::DiskFormat::MacMOOF);
 
+    if (format == rde::DiskFormat::AppleHDV) {
+        // Block devices beyond 140K only carry ProDOS volumes
+        return fsType == rde::FileSystemType::ProDOS;
+    }
     if (isApple) {
         return (fsType == rde::FileSystemType::DOS33 ||
                 fsType == rde::FileSystemType::ProDOS);
@@ -129,6 +143,50 @@ bool parseGeometry(const std::string& spec, rde::DiskGeometry& geom) {
     return true;
 }
 
+// Track layout options shared by `create` and `convert` (DMK output only).
+void addTrackLayoutOptions(rdedisktool::CommandOptions& opts) {
+    opts.addValue("interleave", {"--interleave"});
+    opts.addValue("track-skew", {"--track-skew"});
+    opts.addValue("head-skew", {"--head-skew"});
+}
+
+// Returns false on a malformed value. `requested` reports whether any layout
+// option was given, so callers can reject them for non-DMK targets.
+bool parseTrackLayoutOptions(const rdedisktool::CommandOptions& opts,
+                             rde::TrackLayout& layout,
+                             bool& requested,
+                             std::string& error) {
+    requested = false;
+    const std::pair<const char*, uint8_t*> fields[] = {
+        {"interleave", &layout.interleave},
+        {"track-skew", &layout.trackSkew},
+        {"head-skew", &layout.headSkew},
+    };
+    for (const auto& [name, target] : fields) {
+        std::string value = opts.getValue(name);
+        if (value.empty()) {
+            continue;
+        }
+        requested = true;
+        try {
+            size_t pos = 0;
+            unsigned long v = std::stoul(value, &pos);
+            if (pos != value.size() || v > 0xFF) {
+                throw std::out_of_range(value);
+            }
+            *target = static_cast<uint8_t>(v);
+        } catch (...) {
+            error = std::string("Invalid --") + name + " value: " + value;
+            return false;
+        }
+    }
+    if (layout.interleave == 0) {
+        error = "--interleave must be at least 1";
+        return false;
+    }
+    return true;
+}
+
 std::string toUpper(const std::string& s) {
     std::string out = s;
     std::transform(out.begin(), out.end(), out.begin(),
@@ -200,15 +258,19 @@ bool confirmCriticalDelete(const std::string& filename,
     return true;
 }
 
-uint64_t fnv1a64(const std::vector<uint8_t>& data) {
+uint64_t fnv1a64(const uint8_t* data, size_t length) {
     uint64_t h = 1469598103934665603ULL;
-    for (uint8_t b : data) {
-        h ^= static_cast<uint64_t>(b);
+    for (size_t i = 0; i < length; ++i) {
+        h ^= static_cast<uint64_t>(data[i]);
         h *= 1099511628211ULL;
     }
     return h;
 }
 
+uint64_t fnv1a64(const std::vector<uint8_t>& data) {
+    return fnv1a64(data.data(), data.size());
+}
+
 bool readSectorLinear(rde::DiskImage& image,
                       rde::DiskFormat format,
                       uint32_t linearSector,
@@ -263,10 +325,13 @@ std::vector<std::pair<uint32_t, uint32_t>> protectedLinearRanges(const rde::Disk
             // Boot protection only: Track 0 bootstrap sectors.
             addRange(0, spt > 0 ? (spt - 1) : 0);
             break;
-        case rde::BootDiskProfile::ProDOS:
-            // ProDOS boot blocks 0..1 (4 x 256-byte sectors on Apple II).
-            addRange(0, 3);
+        case rde::BootDiskProfile::ProDOS: {
+            // ProDOS boot blocks 0..1: 4 x 256-byte sectors on 140K disks,
+            // 2 x 512-byte sectors on block devices.
+            const uint32_t bps = geom.bytesPerSector > 0 ? static_cast<uint32_t>(geom.bytesPerSector) : 256;
+            addRange(0, std::max<uint32_t>(1024 / bps, 1) - 1);
             break;
+        }
         case rde::BootDiskProfile::MSXDOS:
             // MSX boot sector only; FAT/root updates are required for normal file add.
             addRange(0, 0);
@@ -287,10 +352,10 @@ std::vector<std::pair<uint32_t, uint32_t>> protectedLinearRanges(const rde::Disk
     return ranges;
 }
 
-bool collectFileDigestsRecursive(rde::FileSystemHandler& handler,
-                                 const std::string& path,
-                                 std::unordered_map<std::string, rde::CLI::FileDigest>& out,
-                                 std::string& error) {
+bool collectFilesRecursive(rde::FileSystemHandler& handler,
+                           const std::string& path,
+                           std::vector<std::pair<std::string, size_t>>& out,
+                           std::string& error) {
     std::vector<rde::FileEntry> entries;
     try {
         entries = handler.listFiles(path);
@@ -302,26 +367,124 @@ bool collectFileDigestsRecursive(rde::FileSystemHandler& handler,
     for (const auto& e : entries) {
         std::string child = path.empty() ? e.name : (path + "/" + e.name);
         if (e.isDirectory) {
-            if (!collectFileDigestsRecursive(handler, child, out, error)) {
+            if (!collectFilesRecursive(handler, child, out, error)) {
                 return false;
             }
             continue;
         }
-        try {
-            const auto data = handler.readFile(child);
-            rde::CLI::FileDigest d;
-            d.size = data.size();
-            d.hash = fnv1a64(data);
-            out[normalizePathKey(child)] = d;
-        } catch (const std::exception& ex) {
-            error = std::string("readFile failed for '") + child + "': " + ex.what();
-            return false;
-        }
+        out.emplace_back(std::move(child), e.size);
     }
 
     return true;
 }
 
+// True if [offset, offset + length) touches any written range.
+bool overlapsWritten(const std::map<size_t, size_t>& written, size_t offset, size_t length) {
+    auto it = written.upper_bound(offset);
+    if (it != written.begin() && std::prev(it)->second > offset) {
+        return true;
+    }
+    return it != written.end() && it->first < offset + length;
+}
+
+// Changed [begin, end) byte ranges between two raw images, at block
+// granularity, with adjacent blocks merged. Equal stretches are skipped a
+// chunk at a time with memcmp, which libc runs with vector instructions;
+// only chunks that differ are compared block by block. Bytes past the end
+// of the shorter image count as changed.
+std::map<size_t, size_t> diffRawBlocks(const std::vector<uint8_t>& a,
+                                       const std::vector<uint8_t>& b,
+                                       size_t blockSize) {
+    const size_t chunkSize = blockSize * std::max<size_t>(1, (64 * 1024) / blockSize);
+    const size_t common = std::min(a.size(), b.size());
+    std::map<size_t, size_t> ranges;
+    auto addRange = [&ranges](size_t begin, size_t end) {
+        if (!ranges.empty() && std::prev(ranges.end())->second == begin) {
+            std::prev(ranges.end())->second = end;
+        } else {
+            ranges.emplace(begin, end);
+        }
+    };
+    for (size_t chunk = 0; chunk < common; chunk += chunkSize) {
+        const size_t chunkEnd = std::min(common, chunk + chunkSize);
+        if (std::memcmp(a.data() + chunk, b.data() + chunk, chunkEnd - chunk) == 0) {
+            continue;
+        }
+        for (size_t block = chunk; block < chunkEnd; block += blockSize) {
+            const size_t blockEnd = std::min(chunkEnd, block + blockSize);
+            if (std::memcmp(a.data() + block, b.data() + block, blockEnd - block) != 0) {
+                addRange(block, blockEnd);
+            }
+        }
+    }
+    if (a.size() != b.size()) {
+        addRange(common, std::max(a.size(), b.size()));
+    }
+    return ranges;
+}
+
+// Decoded sectors of an image in SectorPatch stream order, concatenated.
+std::vector<uint8_t> decodedSectorStream(rde::DiskImage& image) {
+    std::vector<uint8_t> out;
+    for (const auto& sector : rde::SectorPatch::readSectors(image)) {
+        out.insert(out.end(), sector.begin(), sector.end());
+    }
+    return out;
+}
+
+// An extracted file written beside its destination and renamed into place
+// by commit(), so a fork that fails to read half way through never leaves
+// a truncated or empty file under the final name. The temporary file is
+// removed if the object goes away uncommitted.
+class StagedOutputFile {
+public:
+    explicit StagedOutputFile(std::filesystem::path path)
+        : m_path(std::move(path)), m_tmpPath(m_path.string() + ".tmp.rdedisktool") {
+        m_stream.open(m_tmpPath, std::ios::binary | std::ios::trunc);
+        if (!m_stream) {
+            throw rde::WriteException("Unable to create output file: " + m_path.string());
+        }
+    }
+
+    ~StagedOutputFile() {
+        if (!m_committed) {
+            m_stream.close();
+            std::error_code ec;
+            std::filesystem::remove(m_tmpPath, ec);
+        }
+    }
+
+    StagedOutputFile(const StagedOutputFile&) = delete;
+    StagedOutputFile& operator=(const StagedOutputFile&) = delete;
+
+    std::ofstream& stream() { return m_stream; }
+
+    void write(const std::vector<uint8_t>& bytes) {
+        m_stream.write(reinterpret_cast<const char*>(bytes.data()),
+                       static_cast<std::streamsize>(bytes.size()));
+    }
+
+    void commit() {
+        m_stream.close();
+        if (!m_stream) {
+            throw rde::WriteException("Failed to write output file: " + m_path.string());
+        }
+        std::error_code ec;
+        std::filesystem::rename(m_tmpPath, m_path, ec);
+        if (ec) {
+            throw rde::WriteException("Failed to replace output file: " + m_path.string() +
+                                      ": " + ec.message());
+        }
+        m_committed = true;
+    }
+
+private:
+    std::filesystem::path m_path;
+    std::filesystem::path m_tmpPath;
+    std::ofstream m_stream;
+    bool m_committed = false;
+};
+
 } // anonymous namespace
 
 namespace rde {
@@ -378,12 +541,14 @@ void CLI::initCommands() {
     registerCommand("create",
         [this](const std::vector<std::string>& args) { return cmdCreate(args); },
         "Create new disk image",
-        "create <file> -f <format> [--fs <filesystem>] [-n <volume>] [-g <geometry>] [--force]");
+        "create <file> -f <format> [--fs <filesystem>] [-n <volume>] [-g <geometry>] [--force]\n"
+        "       [--interleave <n>] [--track-skew <n>] [--head-skew <n>]");
 
     registerCommand("convert",
         [this](const std::vector<std::string>& args) { return cmdConvert(args); },
         "Convert disk image format",
-        "convert <input_file> <output_file> [--format <format>]");
+        "convert <input_file> <output_file> [--format <format>]\n"
+        "       [--interleave <n>] [--track-skew <n>] [--head-skew <n>]");
 
     registerCommand("dump",
         [this](const std::vector<std::string>& args) { return cmdDump(args); },
@@ -395,10 +560,57 @@ void CLI::initCommands() {
         "Validate disk image integrity",
         "validate <image_file>");
 
+    registerCommand("compact",
+        [this](const std::vector<std::string>& args) { return cmdCompact(args); },
+        "Drop blank tracks from a sparse disk image (DIM)",
+        "compact <image_file>");
+
+    registerCommand("diff",
+        [this](const std::vector<std::string>& args) { return cmdDiff(args); },
+        "Compare two disk images block by block and file by file",
+        "diff <image_a> <image_b> [--blocks | --files]\n"
+        "    Exit status is 0 if the images are identical, 1 if they differ, 2 on error.");
+
+    registerCommand("patch",
+        [this](const std::vector<std::string>& args) { return cmdPatch(args); },
+        "Create or apply a sector-level delta between two disk images",
+        "patch create <old_image> <new_image> <patch_file>\n"
+        "       rdedisktool patch apply <old_image> <patch_file> <output_image> [-f <format>]\n"
+        "    The output format defaults to the output file's extension, then to the\n"
+        "    old image's format; any container of the same disk can be patched.");
+
     registerCommand("list-formats",
         [this](const std::vector<std::string>& args) { return cmdListFormats(args); },
         "List registered disk image formats",
         "list-formats");
+
+    registerCommand("scan",
+        [this](const std::vector<std::string>& args) { return cmdScan(args); },
+        "Inventory every disk image under a directory as NDJSON",
+        "scan <directory> [-j, --jobs <n>]\n"
+        "    One {\"type\":\"image\"} record per image, then one {\"type\":\"file\"} record\n"
+        "    per file or directory in it; unreadable images get ok=false and an error.");
+
+    registerCommand("index",
+        [this](const std::vector<std::string>& args) { return cmdIndex(args); },
+        "Build or query a content-hash index of a disk image collection",
+        "index build <directory> <index-file> [-j, --jobs <n>]\n"
+        "       rdedisktool index query <index-file> [--hash <sha256>] [--name <glob>] [--size <min>[-<max>]]\n"
+        "       rdedisktool index query <index-file> --duplicates\n"
+        "    Filters combine; --name matches the file name, or the whole path if the\n"
+        "    pattern contains '/'. --duplicates lists images with identical bytes.");
+
+    registerCommand("serve",
+        [this](const std::vector<std::string>& args) { return cmdServe(args); },
+        "Serve NDJSON requests on a local Unix socket, keeping images loaded",
+        "serve --socket <path> [--cache <n>]\n"
+        "    Requests (one JSON object per line):\n"
+        "      {\"cmd\":\"list|extract|add|delete|mkdir|rmdir|rename|validate\",\"args\":[...]}\n"
+        "      {\"cmd\":\"flush\",\"args\":[\"<image>\"]}      write pending changes (all if no image)\n"
+        "      {\"cmd\":\"close\",\"args\":[\"<image>\"]}      flush and unload (add \"--discard\" to drop)\n"
+        "      {\"cmd\":\"shutdown\"}                       flush everything and exit\n"
+        "    Several clients may stay connected, but requests are handled one at a\n"
+        "    time in arrival order: a long request (a large extract) delays the rest.");
 }
 
 void CLI::registerCommand(const std::string& command,
@@ -426,7 +638,12 @@ int CLI::run(int argc, char* argv[]) {
         return 0;
     }
 
-    return execute(args);
+    int rc = execute(args);
+    if (m_statsMode != StatsMode::Off) {
+        // stderr, so --json/--ndjson output on stdout stays parseable
+        Stats::report(std::cerr, m_statsMode == StatsMode::Json);
+    }
+    return rc;
 }
 
 int CLI::execute(const std::vector<std::string>& args) {
@@ -461,6 +678,7 @@ int CLI::execute(const std::vector<std::string>& args) {
     }
 
     try {
+        ScopedTimer timer(Stats::Phase::Command);
         std::vector<std::string> cmdArgs(args.begin() + 1, args.end());
         return it->second.handler(cmdArgs);
     } catch (const DiskException& e) {
@@ -488,6 +706,20 @@ std::vector<std::string> CLI::parseGlobalOptions(const std::vector<std::string>&
             m_forceSystemFile = true;
         } else if (arg == "--keep-backup") {
             m_keepBackup = true;
+        } else if (arg == "--fsync") {
+            m_fsync = true;
+        } else if (arg == "--in-place") {
+            m_inPlace = true;
+        } else if (arg == "--json") {
+            m_outputMode = OutputMode::Json;
+        } else if (arg == "--ndjson") {
+            m_outputMode = OutputMode::NDJson;
+        } else if (arg == "--stats" || arg == "--stats=text") {
+            m_statsMode = StatsMode::Text;
+            Stats::setEnabled(true);
+        } else if (arg == "--stats=json") {
+            m_statsMode = StatsMode::Json;
+            Stats::setEnabled(true);
         } else if (arg == "--bootdisk-mode") {
             if (i + 1 >= args.size()) {
                 m_globalOptionError = "Missing value for --bootdisk-mode";
@@ -535,6 +767,11 @@ void CLI::printHelp() const {
     std::cout << "  --force-system-file  Force delete of boot-critical files without prompt\n";
     std::cout << "  --bootdisk-profile <p>  Force boot profile: dos33|prodos|msxdos|human68k|macintosh|unknown\n";
     std::cout << "  --keep-backup        Keep .bak file when saving changes\n";
+    std::cout << "  --fsync              Flush saved images to disk before and after the rename\n";
+    std::cout << "  --in-place           Rewrite only changed sectors of flat images (journaled)\n";
+    std::cout << "  --json               JSON output for list, info and validate\n";
+    std::cout << "  --ndjson             Compact one-record-per-line JSON (list: one line per file)\n";
+    std::cout << "  --stats[=json]       Print phase timings and sector I/O counters to stderr on exit\n";
     std::cout << "  -h, --help       Show help message\n";
     std::cout << "  -V, --version    Show version information\n";
     std::cout << "\n";
@@ -577,6 +814,11 @@ void CLI::printCommandHelp(const std::string& command) const {
         std::cout << "  -n, --volume <name>     Volume name (optional, ignored for DOS 3.3)\n";
         std::cout << "  -g, --geometry <spec>   Custom geometry: tracks:sides:sectors:bytes\n";
         std::cout << "  --force                 Overwrite existing file\n";
+        std::cout << "\nDMK Track Layout Options:\n";
+        std::cout << "  --interleave <n>        Sector interleave (1 = sequential, default)\n";
+        std::cout << "  --track-skew <n>        Rotate sector 1 by n slots per cylinder\n";
+        std::cout << "  --head-skew <n>         Rotate side 1 by n further slots\n";
+        std::cout << "                          Sectors/track (8, 9 or 10) come from -g\n";
         std::cout << "\nSupported Formats:\n";
         std::cout << "  Apple II:  do, po, nib, nb2, woz, woz1, woz2\n";
         std::cout << "  MSX:       msxdsk, dmk\n";
@@ -607,6 +849,7 @@ void CLI::printCommandHelp(const std::string& command) const {
         std::cout << "  rdedisktool create mac.img -f mac_img --fs hfs -n V -g 80:2:10:512 # 800K HFS\n";
         std::cout << "  rdedisktool create mfs.img -f mac_img --fs mfs -n V -g 80:1:10:512 # 400K MFS\n";
         std::cout << "  rdedisktool create mac.moof -f mac_moof                            # 1440K MFM, blank\n";
+        std::cout << "  rdedisktool create msx.dmk -f dmk --fs msxdos -g 80:2:10:512 --interleave 2 --track-skew 2\n";
         std::cout << "  rdedisktool create custom.do -f do -g 40:1:16:256\n";
         std::cout << "  rdedisktool create blank.po -f po\n";
         std::cout << "\nNotes:\n";
@@ -698,6 +941,9 @@ void CLI::printCommandHelp(const std::string& command) const {
     } else if (command == "convert") {
         std::cout << "\nOptions:\n";
         std::cout << "  -f, --format <fmt> Output disk format (auto-detected from extension if not specified)\n";
+        std::cout << "  --interleave <n>   DMK output: sector interleave (1 = sequential, default)\n";
+        std::cout << "  --track-skew <n>   DMK output: rotate sector 1 by n slots per cylinder\n";
+        std::cout << "  --head-skew <n>    DMK output: rotate side 1 by n further slots\n";
         std::cout << "\nSupported Conversions:\n";
         std::cout << "  Apple II:  do <-> po\n";
         std::cout << "  MSX:       dsk <-> dmk <-> xsa\n";
@@ -709,6 +955,7 @@ void CLI::printCommandHelp(const std::string& command) const {
         std::cout << "  rdedisktool convert game.do game.po\n";
         std::cout << "  rdedisktool convert game.dsk game.xsa\n";
         std::cout << "  rdedisktool convert game.xsa game.dsk -f msxdsk\n";
+        std::cout << "  rdedisktool convert game.dsk game.dmk --interleave 3 --head-skew 1\n";
         std::cout << "  rdedisktool convert game.image game.img -f mac_img   # DC42 → raw\n";
         std::cout << "  rdedisktool convert game.img game.dc42 -f mac_dc42   # raw → DC42\n";
         std::cout << "  rdedisktool convert game.moof game.img -f mac_img    # MOOF → raw (decode)\n";
@@ -769,6 +1016,13 @@ void CLI::printCommandHelp(const std::string& command) const {
         std::cout << "  - Disk image structure integrity\n";
         std::cout << "  - File system metadata consistency\n";
         std::cout << "  - Sector allocation bitmap verification\n";
+    } else if (command == "compact") {
+        std::cout << "\nClears the track flag of every X68000 DIM track that is entirely\n";
+        std::cout << "0x00 or 0xE5 filler, so the track is no longer stored in the file.\n";
+        std::cout << "Absent tracks read back as 0xE5 filler. Zero-filled tracks that hold\n";
+        std::cout << "Human68k metadata or allocated clusters are kept.\n";
+        std::cout << "\nExamples:\n";
+        std::cout << "  rdedisktool compact x68k.dim\n";
     } else if (command == "info") {
         std::cout << "\nOptions:\n";
         std::cout << "  -v, --verbose      Show detailed information (FAT/cluster map for MSX)\n";
@@ -796,8 +1050,31 @@ void CLI::printInfo(const std::string& message) const {
 // Disk Loading Helpers
 //=============================================================================
 
+void CLI::recoverInterruptedSave(const std::string& imagePath) {
+    try {
+        switch (recoverRedoJournal(imagePath)) {
+            case JournalRecovery::Replayed:
+                printWarning("Replayed interrupted in-place save: " + imagePath);
+                break;
+            case JournalRecovery::Mismatch:
+                printWarning("Discarded save journal that does not match the image: " +
+                             imagePath);
+                break;
+            case JournalRecovery::None:
+            case JournalRecovery::Torn:
+                break;
+        }
+    } catch (const std::exception& e) {
+        printWarning("Failed to replay save journal: " + std::string(e.what()));
+    }
+}
+
 LoadedDisk CLI::loadDiskImage(const std::string& imagePath) {
     LoadedDisk result;
+    if (m_serving && lookupCachedDisk(imagePath, result)) {
+        return result;
+    }
+    recoverInterruptedSave(imagePath);
 
     // Detect format
     result.format = DiskImageFactory::detectFormat(imagePath);
@@ -834,11 +1111,18 @@ LoadedDisk CLI::loadDiskImage(const std::string& imagePath) {
         return result;
     }
 
+    if (m_serving) {
+        cacheLoadedDisk(imagePath, result);
+    }
     return result;
 }
 
 LoadedDisk CLI::loadDiskImageOnly(const std::string& imagePath) {
     LoadedDisk result;
+    if (m_serving && lookupCachedDisk(imagePath, result)) {
+        return result;
+    }
+    recoverInterruptedSave(imagePath);
 
     // Detect format
     result.format = DiskImageFactory::detectFormat(imagePath);
@@ -863,6 +1147,9 @@ LoadedDisk CLI::loadDiskImageOnly(const std::string& imagePath) {
     // Try to create filesystem handler (optional for this method)
     result.handler = FileSystemHandler::create(result.image.get());
 
+    if (m_serving && result) {
+        cacheLoadedDisk(imagePath, result);
+    }
     return result;
 }
 
@@ -872,6 +1159,20 @@ bool CLI::saveDiskImage(DiskImage* image, const std::string& operation) {
         return false;
     }
 
+    // serve: keep the change in memory until an explicit flush or close
+    if (m_serving) {
+        for (auto& entry : m_diskCache) {
+            if (entry.disk.image.get() == image) {
+                entry.dirty = true;
+                return true;
+            }
+        }
+    }
+    return writeDiskImage(image, operation);
+}
+
+bool CLI::writeDiskImage(DiskImage* image, const std::string& operation) {
+
     try {
         const std::filesystem::path originalPath = image->getFilePath();
         if (originalPath.empty()) {
@@ -883,21 +1184,47 @@ bool CLI::saveDiskImage(DiskImage* image, const std::string& operation) {
         const std::filesystem::path bakPath = originalPath.string() + ".bak";
 
         std::error_code ec;
+        auto keepBackup = [&]() {
+            if (std::filesystem::exists(bakPath, ec)) {
+                std::filesystem::remove(bakPath, ec);
+            }
+            std::filesystem::copy_file(originalPath, bakPath, std::filesystem::copy_options::overwrite_existing, ec);
+            if (ec) {
+                printWarning("Failed to create backup file: " + bakPath.string());
+            }
+        };
+
+        // In-place: a flat image whose file still has the loaded size only
+        // needs its dirty ranges rewritten, through the redo journal.
+        const auto dataOffset = image->flatDataOffset();
+        if (m_inPlace && dataOffset && !image->isWriteProtected() &&
+            std::filesystem::file_size(originalPath, ec) == *dataOffset + image->getRawData().size() &&
+            !ec) {
+            if (m_keepBackup) {
+                keepBackup();
+            }
+            const uint64_t written = writeRangesInPlace(originalPath, image->getRawData(),
+                                                        *dataOffset, image->dirtyRanges());
+            if (m_verbose) {
+                std::cout << "In-place save: " << written << " bytes in "
+                          << image->dirtyRanges().size() << " range(s)\n";
+            }
+            image->markSavedAs(originalPath);
+            return true;
+        }
+
         if (std::filesystem::exists(tmpPath, ec)) {
             std::filesystem::remove(tmpPath, ec);
         }
 
         // Write to temporary path first to avoid partial overwrite on failure.
         image->save(tmpPath);
+        if (m_fsync) {
+            syncFile(tmpPath);
+        }
 
         if (m_keepBackup) {
-            if (std::filesystem::exists(bakPath, ec)) {
-                std::filesystem::remove(bakPath, ec);
-            }
-            std::filesystem::copy_file(originalPath, bakPath, std::filesystem::copy_options::overwrite_existing, ec);
-            if (ec) {
-                printWarning("Failed to create backup file: " + bakPath.string());
-            }
+            keepBackup();
         }
 
         // POSIX std::filesystem::rename is atomic within a single filesystem
@@ -915,8 +1242,13 @@ bool CLI::saveDiskImage(DiskImage* image, const std::string& operation) {
             return false;
         }
 
-        // Refresh in-memory image state to the final path.
-        image->load(originalPath);
+        if (m_fsync) {
+            syncDirectory(originalPath.parent_path());
+        }
+
+        // The file now holds exactly the in-memory image; point it at the
+        // final path instead of re-reading and re-decoding what was written.
+        image->markSavedAs(originalPath);
         return true;
     } catch (const std::exception& e) {
         printError("Error saving disk image after " + operation + ": " + std::string(e.what()));
@@ -936,13 +1268,44 @@ bool CLI::captureSafeAddSnapshot(const LoadedDisk& disk,
     snapshot.existingFiles.clear();
     snapshot.protectedSectors.clear();
 
-    if (!collectFileDigestsRecursive(*disk.handler, "", snapshot.existingFiles, error)) {
+    std::vector<std::pair<std::string, size_t>> files;
+    if (!collectFilesRecursive(*disk.handler, "", files, error)) {
         if (error.empty()) {
             error = "failed to snapshot existing files";
         }
         return false;
     }
 
+    // Hash the raw-data runs each file owns; the add should only write
+    // free space and metadata, so verification re-hashes just the runs
+    // that overlap the image's dirty ranges. Files whose storage the
+    // handler cannot map are digested through readFile instead.
+    const auto& raw = disk.image->getRawData();
+    for (const auto& [path, size] : files) {
+        FileDigest d;
+        d.path = path;
+        d.size = size;
+        try {
+            d.byExtent = disk.handler->getFileExtents(path, d.extents);
+            for (const auto& [offset, length] : d.extents) {
+                if (offset + length > raw.size()) {
+                    d.byExtent = false;
+                    break;
+                }
+                d.extentHashes.push_back(fnv1a64(raw.data() + offset, length));
+            }
+            if (!d.byExtent) {
+                const auto data = disk.handler->readFile(path);
+                d.size = data.size();
+                d.hash = fnv1a64(data);
+            }
+        } catch (const std::exception& ex) {
+            error = std::string("readFile failed for '") + path + "': " + ex.what();
+            return false;
+        }
+        snapshot.existingFiles[normalizePathKey(path)] = std::move(d);
+    }
+
     const auto ranges = protectedLinearRanges(disk.image->getGeometry(), profile);
     for (const auto& r : ranges) {
         for (uint32_t s = r.first; s <= r.second; ++s) {
@@ -968,26 +1331,56 @@ bool CLI::verifySafeAddSnapshot(const LoadedDisk& disk,
         return false;
     }
 
-    std::unordered_map<std::string, FileDigest> afterFiles;
-    if (!collectFileDigestsRecursive(*disk.handler, "", afterFiles, error)) {
+    std::vector<std::pair<std::string, size_t>> files;
+    if (!collectFilesRecursive(*disk.handler, "", files, error)) {
         if (error.empty()) {
             error = "failed to verify existing files";
         }
         return false;
     }
+    std::unordered_map<std::string, size_t> afterSizes;
+    for (const auto& [path, size] : files) {
+        afterSizes[normalizePathKey(path)] = size;
+    }
 
+    const auto& raw = disk.image->getRawData();
+    const auto& written = disk.image->dirtyRanges();
     const std::string addedUpper = normalizePathKey(addedTarget);
     for (const auto& kv : snapshot.existingFiles) {
         const std::string& name = kv.first;
+        const FileDigest& before = kv.second;
         if (name == addedUpper) {
             continue;
         }
-        auto it = afterFiles.find(name);
-        if (it == afterFiles.end()) {
+        auto it = afterSizes.find(name);
+        if (it == afterSizes.end()) {
             error = "existing file disappeared after add: " + name;
             return false;
         }
-        if (it->second.size != kv.second.size || it->second.hash != kv.second.hash) {
+
+        bool same = true;
+        try {
+            if (before.byExtent) {
+                // Same runs (metadata intact), and unchanged where written
+                std::vector<std::pair<size_t, size_t>> extents;
+                same = disk.handler->getFileExtents(before.path, extents) &&
+                       extents == before.extents && it->second == before.size;
+                for (size_t i = 0; same && i < extents.size(); ++i) {
+                    const auto& [offset, length] = extents[i];
+                    if (overlapsWritten(written, offset, length)) {
+                        same = offset + length <= raw.size() &&
+                               fnv1a64(raw.data() + offset, length) == before.extentHashes[i];
+                    }
+                }
+            } else {
+                const auto data = disk.handler->readFile(before.path);
+                same = data.size() == before.size && fnv1a64(data) == before.hash;
+            }
+        } catch (const std::exception& ex) {
+            error = std::string("readFile failed for '") + before.path + "': " + ex.what();
+            return false;
+        }
+        if (!same) {
             error = "existing file was modified after add: " + name;
             return false;
         }
@@ -1022,12 +1415,48 @@ int CLI::cmdInfo(const std::vector<std::string>& args) {
 
     const std::string& imagePath = args[0];
 
+    recoverInterruptedSave(imagePath);
+
     try {
         // Detect format
         DiskFormat format = DiskImageFactory::detectFormat(imagePath);
         Platform platform = DiskImageFactory::getPlatformForFormat(format);
         DiskGeometry geom = DiskImageFactory::getDefaultGeometry(format);
 
+        if (m_outputMode != OutputMode::Text) {
+            JsonWriter w(std::cout, m_outputMode == OutputMode::Json);
+            w.beginObject()
+             .field("image", imagePath)
+             .field("format", formatToIdentifier(format))
+             .field("formatName", formatToString(format))
+             .field("platform", platformToString(platform))
+             .field("supported", DiskImageFactory::isFormatSupported(format));
+            if (DiskImageFactory::isFormatSupported(format)) {
+                auto image = DiskImageFactory::open(imagePath, format);
+                auto handler = FileSystemHandler::create(image.get());
+                w.key("geometry").beginObject();
+                writeJson(w, image->getGeometry());
+                w.endObject();
+                w.field("fileSystem", fileSystemTypeToString(image->getFileSystemType()));
+                if (handler) {
+                    w.field("volume", handler->getVolumeName())
+                     .field("freeSpace", handler->getFreeSpace())
+                     .field("totalSpace", handler->getTotalSpace());
+                } else {
+                    w.key("volume").null().key("freeSpace").null().key("totalSpace").null();
+                }
+                w.field("writeProtected", image->isWriteProtected());
+            } else {
+                w.key("geometry").beginObject();
+                writeJson(w, geom);
+                w.endObject();
+            }
+            w.endObject();
+            w.endRecord();
+            w.flushTo();
+            return 0;
+        }
+
         std::cout << "File: " << imagePath << "\n";
         std::cout << "Format: " << formatToString(format) << "\n";
         std::cout << "Platform: " << platformToString(platform) << "\n";
@@ -1166,6 +1595,44 @@ int CLI::cmdList(const std::vector<std::string>& args) {
 
         auto files = disk.handler->listFiles(path);
 
+        if (m_outputMode != OutputMode::Text) {
+            JsonWriter w(std::cout, m_outputMode == OutputMode::Json);
+            if (m_outputMode == OutputMode::NDJson) {
+                // One record per file, each self-describing
+                for (const auto& file : files) {
+                    w.beginObject()
+                     .field("image", imagePath)
+                     .field("path", path);
+                    writeJson(w, file);
+                    w.endObject();
+                    w.endRecord();
+                }
+            } else {
+                size_t totalSize = 0;
+                w.beginObject()
+                 .field("image", imagePath)
+                 .field("format", formatToIdentifier(disk.format))
+                 .field("fileSystem", fileSystemTypeToString(disk.handler->getType()))
+                 .field("volume", disk.handler->getVolumeName())
+                 .field("path", path);
+                w.key("files").beginArray();
+                for (const auto& file : files) {
+                    w.beginObject();
+                    writeJson(w, file);
+                    w.endObject();
+                    totalSize += file.size;
+                }
+                w.endArray();
+                w.field("fileCount", files.size())
+                 .field("totalSize", totalSize)
+                 .field("freeSpace", disk.handler->getFreeSpace());
+                w.endObject();
+                w.endRecord();
+            }
+            w.flushTo();
+            return 0;
+        }
+
         // PR-D: detect Mac handlers — verbose mode adds Mac-specific
         // columns (type / creator / Finder flags). Non-Mac handlers
         // ignore -v entirely so non-Mac output stays identical.
@@ -1375,31 +1842,37 @@ int CLI::cmdExtract(const std::vector<std::string>& args) {
         // fork is being extracted without --apple-double / --macbinary —
         // dropping the rsrc fork silently is one of the easiest ways to
         // corrupt a Mac application.
-        if (auto* hfs = dynamic_cast<rde::MacintoshHFSHandler*>(disk.handler.get())) {
-            if (auto* child = hfs->lookupByPath(filename)) {
-                if (!child->isDirectory && child->rsrcLogical != 0) {
-                    std::cerr << "warning: '" << filename << "' has a non-empty "
-                              << "resource fork (" << child->rsrcLogical
-                              << " bytes); use --apple-double or --macbinary "
-                              << "to preserve it.\n";
-                }
+        const rde::MacintoshHFSHandler::CatalogChild* hfsChild = nullptr;
+        auto* hfs = dynamic_cast<rde::MacintoshHFSHandler*>(disk.handler.get());
+        if (hfs) {
+            hfsChild = hfs->lookupByPath(filename);
+            if (hfsChild && !hfsChild->isDirectory && hfsChild->rsrcLogical != 0) {
+                std::cerr << "warning: '" << filename << "' has a non-empty "
+                          << "resource fork (" << hfsChild->rsrcLogical
+                          << " bytes); use --apple-double or --macbinary "
+                          << "to preserve it.\n";
             }
         }
 
-        auto data = disk.handler->readFile(filename);
-
-        std::ofstream outFile(outputPath, std::ios::binary);
-        if (!outFile) {
-            printError("Unable to create output file: " + outputPath);
-            return 1;
+        // HFS data forks stream straight from the image; other handlers
+        // hand back the whole file.
+        std::vector<uint8_t> data;
+        if (!hfsChild) {
+            data = disk.handler->readFile(filename);
         }
 
-        outFile.write(reinterpret_cast<const char*>(data.data()), data.size());
-        outFile.close();
+        StagedOutputFile outFile(outputPath);
+        uint64_t written = data.size();
+        if (hfsChild) {
+            written = hfs->readForkTo(outFile.stream(), hfsChild->cnid, 0x00);
+        } else {
+            outFile.write(data);
+        }
+        outFile.commit();
 
         if (!m_quiet) {
             std::cout << "Extracted: " << filename << " -> " << outputPath
-                      << " (" << data.size() << " bytes)\n";
+                      << " (" << written << " bytes)\n";
         }
 
         return 0;
@@ -1684,7 +2157,7 @@ int CLI::cmdAdd(const std::vector<std::string>& args) {
         }
 
         // Check free space (Mac modes: account for both forks)
-        size_t needBytes = data.size();
+        size_t needBytes = disk.handler->getRequiredSpace(data);
         if (modeMacBinary || modeAppleDouble) {
             needBytes = macFile.dataFork.size() + macFile.resourceFork.size();
         }
@@ -2036,6 +2509,7 @@ int CLI::cmdCreate(const std::vector<std::string>& args) {
     opts.addValue("volume", {"-n", "--volume"});
     opts.addValue("geometry", {"-g", "--geometry"});
     opts.addFlag("force", {"--force"});
+    addTrackLayoutOptions(opts);
 
     std::string parseError;
     if (!opts.parse(args, &parseError)) {
@@ -2063,7 +2537,7 @@ int CLI::cmdCreate(const std::vector<std::string>& args) {
         format = formatFromString(formatStr);
         if (format == DiskFormat::Unknown) {
             printError("Unknown disk format: " + formatStr);
-            printError("Supported formats: do, po, nib, nb2, woz, woz1, woz2, msxdsk, dmk, xdf, dim");
+            printError("Supported formats: do, po, nib, nb2, woz, woz1, woz2, hdv, 2mg, msxdsk, dmk, xdf, dim");
             return 1;
         }
     } else {
@@ -2075,7 +2549,7 @@ int CLI::cmdCreate(const std::vector<std::string>& args) {
         }
         if (format == DiskFormat::Unknown) {
             printError("Cannot determine format from extension. Use --format option.");
-            printError("Supported formats: do, po, nib, nb2, woz, woz1, woz2, msxdsk, dmk, xdf, dim");
+            printError("Supported formats: do, po, nib, nb2, woz, woz1, woz2, hdv, 2mg, msxdsk, dmk, xdf, dim");
             return 1;
         }
     }
@@ -2086,6 +2560,18 @@ int CLI::cmdCreate(const std::vector<std::string>& args) {
         return 1;
     }
 
+    TrackLayout layout;
+    bool layoutRequested = false;
+    std::string layoutError;
+    if (!parseTrackLayoutOptions(opts, layout, layoutRequested, layoutError)) {
+        printError(layoutError);
+        return 1;
+    }
+    if (layoutRequested && format != DiskFormat::MSXDMK) {
+        printError("--interleave/--track-skew/--head-skew are only supported for DMK images");
+        return 1;
+    }
+
     // Check if file already exists
     if (std::filesystem::exists(outputPath) && !force) {
         printError("File already exists: " + outputPath);
@@ -2125,8 +2611,16 @@ int CLI::cmdCreate(const std::vector<std::string>& args) {
     }
 
     try {
-        // Create the disk image
-        auto image = DiskImageFactory::create(format, geometry);
+        // Create the disk image (DMK tracks are laid out per the options)
+        std::unique_ptr<DiskImage> image;
+        if (format == DiskFormat::MSXDMK) {
+            auto dmk = std::make_unique<MSXDMKImage>();
+            dmk->setTrackLayout(layout);
+            dmk->create(geometry);
+            image = std::move(dmk);
+        } else {
+            image = DiskImageFactory::create(format, geometry);
+        }
         if (!image) {
             printError("Failed to create disk image");
             return 1;
@@ -2189,6 +2683,7 @@ int CLI::cmdConvert(const std::vector<std::string>& args) {
     // Parse options using CommandOptions
     rdedisktool::CommandOptions opts;
     opts.addValue("format", {"-f", "--format"});
+    addTrackLayoutOptions(opts);
 
     std::string parseError;
     if (!opts.parse(args, &parseError)) {
@@ -2197,6 +2692,14 @@ int CLI::cmdConvert(const std::vector<std::string>& args) {
         return 1;
     }
 
+    TrackLayout layout;
+    bool layoutRequested = false;
+    std::string layoutError;
+    if (!parseTrackLayoutOptions(opts, layout, layoutRequested, layoutError)) {
+        printError(layoutError);
+        return 1;
+    }
+
     if (opts.positionalCount() < 2) {
         printError("Missing input or output file");
         printCommandHelp("convert");
@@ -2207,6 +2710,8 @@ int CLI::cmdConvert(const std::vector<std::string>& args) {
     const std::string& outputPath = opts.getPositional(1);
     std::string formatStr = opts.getValue("format");
 
+    recoverInterruptedSave(inputPath);
+
     try {
 
         // Open input image
@@ -2230,7 +2735,12 @@ int CLI::cmdConvert(const std::vector<std::string>& args) {
 
         if (outputFormat == DiskFormat::Unknown) {
             printError("Cannot determine output format. Use --format option.");
-            printError("Supported formats: do, po, dsk, dmk, msxdsk, xsa, xdf, dim");
+            printError("Supported formats: do, po, hdv, 2mg, dsk, dmk, msxdsk, xsa, xdf, dim");
+            return 1;
+        }
+
+        if (layoutRequested && outputFormat != DiskFormat::MSXDMK) {
+            printError("--interleave/--track-skew/--head-skew are only supported for DMK output");
             return 1;
         }
 
@@ -2256,8 +2766,13 @@ int CLI::cmdConvert(const std::vector<std::string>& args) {
         // sector loop below relies on track/side/sector layout, which raw
         // Mac images don't preserve in a meaningful way (the geometry is
         // logical-only — see MacintoshDiskImage::initGeometryFromSize).
-        if (inputPlatform == Platform::Macintosh &&
-            outputPlatform == Platform::Macintosh &&
+        // Apple II block images (HDV/2MG) take the same path: a ProDOS-order
+        // .po maps onto blocks byte for byte, not through track/sector.
+        const bool blockImageConversion =
+            inputImage->getFormat() == DiskFormat::AppleHDV ||
+            outputFormat == DiskFormat::AppleHDV;
+        if (((inputPlatform == Platform::Macintosh &&
+              outputPlatform == Platform::Macintosh) || blockImageConversion) &&
             inputImage->canConvertTo(outputFormat)) {
             outputImage = inputImage->convertTo(outputFormat);
             outputImage->save(outputPath);
@@ -2308,27 +2823,37 @@ int CLI::cmdConvert(const std::vector<std::string>& args) {
             outputImage = MSXXSAImage::createFromRawData(rawData, origFilename);
         } else {
             // Standard conversion: create output image and copy sectors
-            outputImage = DiskImageFactory::create(outputFormat, geom);
+            if (outputFormat == DiskFormat::MSXDMK) {
+                auto dmk = std::make_unique<MSXDMKImage>();
+                dmk->setTrackLayout(layout);
+                dmk->create(geom);
+                outputImage = std::move(dmk);
+            } else {
+                outputImage = DiskImageFactory::create(outputFormat, geom);
+            }
             if (!outputImage) {
                 printError("Failed to create output file: " + outputPath);
                 return 1;
             }
 
-            // Copy all sectors
-            for (size_t track = 0; track < geom.tracks; ++track) {
-                for (size_t side = 0; side < geom.sides; ++side) {
-                    for (size_t sector = 0; sector < geom.sectorsPerTrack; ++sector) {
-                        try {
-                            auto data = inputImage->readSector(track, side, sector);
-                            outputImage->writeSector(track, side, sector, data);
-                            ++sectorsConverted;
-                        } catch (const std::exception& e) {
-                            if (m_verbose) {
-                                printWarning("Failed to copy sector T" + std::to_string(track) +
-                                           "/S" + std::to_string(side) + "/H" + std::to_string(sector) +
-                                           ": " + e.what());
-                            }
-                        }
+            // Copy all sectors in stream order. SectorPatch owns the
+            // per-format addressing: X68000 images count each side as a
+            // track and number their sectors from 1.
+            const size_t totalSectors = SectorPatch::streamGeometry(*inputImage).totalSectors();
+            for (size_t i = 0; i < totalSectors; ++i) {
+                size_t track, side, sector;
+                SectorPatch::sectorAddress(*inputImage, i, track, side, sector);
+                try {
+                    auto data = inputImage->readSector(track, side, sector);
+                    size_t outTrack, outSide, outSector;
+                    SectorPatch::sectorAddress(*outputImage, i, outTrack, outSide, outSector);
+                    outputImage->writeSector(outTrack, outSide, outSector, data);
+                    ++sectorsConverted;
+                } catch (const std::exception& e) {
+                    if (m_verbose) {
+                        printWarning("Failed to copy sector T" + std::to_string(track) +
+                                   "/S" + std::to_string(side) + "/H" + std::to_string(sector) +
+                                   ": " + e.what());
                     }
                 }
             }
@@ -2418,6 +2943,8 @@ int CLI::cmdDump(const std::vector<std::string>& args) {
         return 1;
     }
 
+    recoverInterruptedSave(imagePath);
+
     try {
         // Determine format
         DiskFormat format = DiskFormat::Unknown;
@@ -2512,6 +3039,8 @@ int CLI::cmdValidate(const std::vector<std::string>& args) {
 
     const std::string& imagePath = args[0];
 
+    recoverInterruptedSave(imagePath);
+
     try {
         DiskFormat format = DiskImageFactory::detectFormat(imagePath);
 
@@ -2520,36 +3049,73 @@ int CLI::cmdValidate(const std::vector<std::string>& args) {
             return 1;
         }
 
-        if (!m_quiet) {
+        const bool json = m_outputMode != OutputMode::Text;
+        const bool showText = !json && !m_quiet;
+        JsonWriter w(std::cout, m_outputMode == OutputMode::Json);
+        if (json) {
+            w.beginObject()
+             .field("image", imagePath)
+             .field("format", formatToIdentifier(format))
+             .field("formatName", formatToString(format))
+             .field("supported", DiskImageFactory::isFormatSupported(format));
+        }
+
+        if (showText) {
             std::cout << "File: " << imagePath << "\n";
             std::cout << "Format: " << formatToString(format) << "\n";
         }
 
+        if (!DiskImageFactory::isFormatSupported(format) && json) {
+            w.endObject();
+            w.endRecord();
+            w.flushTo();
+            return 0;
+        }
         if (!DiskImageFactory::isFormatSupported(format)) {
             printWarning("Full validation not available for this format");
             std::cout << "Status: Format detected but handler not implemented\n";
             return 0;
         }
 
-        auto image = DiskImageFactory::open(imagePath, format);
+        // serve: validate the loaded image, including unflushed changes
+        LoadedDisk disk;
+        if (!m_serving || !lookupCachedDisk(imagePath, disk)) {
+            disk.image = DiskImageFactory::open(imagePath, format);
+            disk.handler = FileSystemHandler::create(disk.image.get());
+            if (m_serving && disk) {
+                cacheLoadedDisk(imagePath, disk);
+            }
+        }
+        if (!disk.image) {
+            return 1;
+        }
+        const auto& image = disk.image;
 
         // Basic disk image validation
         bool basicValid = image->validate();
 
-        if (!m_quiet) {
+        if (json) {
+            w.field("imageValid", basicValid);
+        } else if (showText) {
             std::cout << "Disk image: " << (basicValid ? "Valid" : "Invalid") << "\n";
         }
 
         // Extended filesystem validation
-        auto handler = FileSystemHandler::create(image.get());
+        const auto& handler = disk.handler;
         if (handler) {
-            if (!m_quiet) {
+            if (showText) {
                 std::cout << "File system: " << fileSystemTypeToString(handler->getType()) << "\n\n";
             }
 
             ValidationResult result = handler->validateExtended();
 
-            if (!m_quiet) {
+            if (json) {
+                w.field("fileSystem", fileSystemTypeToString(handler->getType()));
+                writeJson(w, result);
+                w.endObject();
+                w.endRecord();
+                w.flushTo();
+            } else if (showText) {
                 // Print issues
                 for (const auto& issue : result.issues) {
                     std::string prefix;
@@ -2580,7 +3146,15 @@ int CLI::cmdValidate(const std::vector<std::string>& args) {
 
             return result.isValid ? 0 : 1;
         } else {
-            if (!m_quiet) {
+            if (json) {
+                ValidationResult result;
+                result.isValid = basicValid;
+                w.key("fileSystem").null();
+                writeJson(w, result);
+                w.endObject();
+                w.endRecord();
+                w.flushTo();
+            } else if (showText) {
                 std::cout << "File system: Not detected\n";
                 std::cout << "Status: " << (basicValid ? "Valid" : "Invalid") << "\n";
             }
@@ -2678,34 +3252,29 @@ int CLI::extractMacintoshSpecial(LoadedDisk& disk,
             return 1;
         }
 
-        std::vector<uint8_t> dataFork = hfs->extractFork(match->cnid, 0x00);
-        std::vector<uint8_t> rsrcFork = hfs->extractFork(match->cnid, 0xFF);
-
         if (modeAppleDouble) {
             ad.macRomanName = match->macRomanName;
             ad.finderInfo.assign(match->finfo, match->finfo + 16);
             ad.finderInfo.insert(ad.finderInfo.end(),
                                  match->fxinfo, match->fxinfo + 16);
-            ad.resourceFork = rsrcFork;
 
-            // Write data fork to outputPath, sidecar to ._<basename>.
-            std::ofstream df(outputPath, std::ios::binary);
-            if (!df) { printError("Cannot create: " + outputPath); return 1; }
-            if (!dataFork.empty()) {
-                df.write(reinterpret_cast<const char*>(dataFork.data()),
-                         static_cast<std::streamsize>(dataFork.size()));
-            }
-            df.close();
+            // Write data fork to outputPath, sidecar to ._<basename>. Both
+            // forks stream from the image; neither file appears until both
+            // were written.
+            StagedOutputFile df(outputPath);
+            hfs->readForkTo(df.stream(), match->cnid, 0x00);
 
-            // Sidecar path: prefix the leaf basename with "._".
+            // Sidecar path: prefix the leaf basename with "._". The header
+            // declares the resource bytes the image really holds, which a
+            // truncated image can cut short of the catalog's logical length.
             std::filesystem::path opath = outputPath;
             std::filesystem::path sidecar = opath.parent_path() / ("._" + opath.filename().string());
-            const auto sidecarBytes = rde::buildAppleDoubleSidecar(ad);
-            std::ofstream sf(sidecar, std::ios::binary);
-            if (!sf) { printError("Cannot create: " + sidecar.string()); return 1; }
-            sf.write(reinterpret_cast<const char*>(sidecarBytes.data()),
-                     static_cast<std::streamsize>(sidecarBytes.size()));
-            sf.close();
+            const uint64_t rsrcLength = hfs->forkLength(match->cnid, 0xFF);
+            StagedOutputFile sf(sidecar);
+            sf.write(rde::buildAppleDoubleHeader(ad, static_cast<uint32_t>(rsrcLength)));
+            hfs->readForkTo(sf.stream(), match->cnid, 0xFF);
+            df.commit();
+            sf.commit();
             if (!m_quiet) {
                 std::cout << "Extracted (AppleDouble): " << filename
                           << " -> " << outputPath
@@ -2715,6 +3284,8 @@ int CLI::extractMacintoshSpecial(LoadedDisk& disk,
         }
 
         // MacBinary
+        std::vector<uint8_t> dataFork = hfs->extractFork(match->cnid, 0x00);
+        std::vector<uint8_t> rsrcFork = hfs->extractFork(match->cnid, 0xFF);
         mb.macRomanName = match->macRomanName;
         std::memcpy(mb.fileType, match->fileType, 4);
         std::memcpy(mb.creator,  match->creator,  4);
@@ -2723,8 +3294,9 @@ int CLI::extractMacintoshSpecial(LoadedDisk& disk,
         std::memcpy(mb.finderInfoLocation, match->finfo + 10, 6);
         // Protected flag: HFS uses Finder flags low bit 0 (FInfo[9] bit 0).
         mb.protectedFlag = static_cast<uint8_t>((match->finfo[9] & 0x01) != 0 ? 1 : 0);
-        mb.dataLength = match->dataLogical;
-        mb.rsrcLength = match->rsrcLogical;
+        // Lengths of the forks as read, which a truncated image can cut short.
+        mb.dataLength = static_cast<uint32_t>(dataFork.size());
+        mb.rsrcLength = static_cast<uint32_t>(rsrcFork.size());
         mb.createDate = match->createDate;
         mb.modifyDate = match->modifyDate;
         mb.dataFork   = std::move(dataFork);
@@ -2791,8 +3363,9 @@ int CLI::extractMacintoshSpecial(LoadedDisk& disk,
         mb.finderFlagsHi = m->flUsrWds[8];
         std::memcpy(mb.finderInfoLocation, m->flUsrWds + 10, 6);
         mb.protectedFlag = static_cast<uint8_t>(m->locked ? 1 : 0);
-        mb.dataLength = m->dataLogical;
-        mb.rsrcLength = m->rsrcLogical;
+        // Lengths of the forks as read, which a truncated image can cut short.
+        mb.dataLength = static_cast<uint32_t>(dataFork.size());
+        mb.rsrcLength = static_cast<uint32_t>(rsrcFork.size());
         mb.createDate = m->createDate;
         mb.modifyDate = m->modifyDate;
         mb.dataFork = std::move(dataFork);
@@ -2812,6 +3385,510 @@ int CLI::extractMacintoshSpecial(LoadedDisk& disk,
     }
 }
 
+int CLI::cmdCompact(const std::vector<std::string>& args) {
+    if (args.empty()) {
+        printError("Missing image file argument");
+        printCommandHelp("compact");
+        return 1;
+    }
+
+    const std::string& imagePath = args[0];
+
+    try {
+        auto disk = loadDiskImageOnly(imagePath);
+        if (!disk.hasImage()) {
+            return 1;
+        }
+
+        auto* dim = dynamic_cast<X68000DIMImage*>(disk.image.get());
+        if (!dim) {
+            printError("compact is only supported for DIM images (got " +
+                       std::string(formatToString(disk.format)) + ")");
+            return 1;
+        }
+
+        // Zero-filled tracks are only dropped where the filesystem map shows
+        // them unused; without a Human68k volume they are all kept
+        std::optional<std::vector<bool>> usedTracks;
+        if (auto* human = dynamic_cast<Human68kHandler*>(disk.handler.get())) {
+            usedTracks = human->getUsedTrackMap();
+        }
+
+        const size_t before = dim->getPresentTrackCount();
+        const size_t removed = dim->compactTracks(usedTracks);
+
+        if (removed > 0 && !saveDiskImage(disk.image.get(), "compact")) {
+            return 1;
+        }
+
+        if (!m_quiet) {
+            std::cout << "Compacted " << imagePath << ": removed " << removed
+                      << " blank track(s), " << before << " -> " << (before - removed)
+                      << " stored\n";
+        }
+
+        return 0;
+    } catch (const DiskException& e) {
+        printError(e.what());
+        return 1;
+    }
+}
+
+int CLI::cmdDiff(const std::vector<std::string>& args) {
+    std::vector<std::string> paths;
+    bool compareBlocks = true;
+    bool compareFiles = true;
+    for (const auto& arg : args) {
+        if (arg == "--blocks") {
+            compareFiles = false;
+        } else if (arg == "--files") {
+            compareBlocks = false;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.size() != 2 || (!compareBlocks && !compareFiles)) {
+        printError("Expected two image files");
+        printCommandHelp("diff");
+        return 2;
+    }
+
+    // diff(1) convention: 0 identical, 1 different, 2 trouble
+    try {
+        auto a = loadDiskImageOnly(paths[0]);
+        auto b = loadDiskImageOnly(paths[1]);
+        if (!a.hasImage() || !b.hasImage()) {
+            return 2;
+        }
+
+        // Blocks are only comparable between images of the same format.
+        // Flat images compare their stored bytes, whose offsets are the
+        // sector offsets file extents use, so the changed ranges also let
+        // the file pass skip files whose extents are untouched. Other
+        // containers store encoded (NIB, WOZ, MOOF) or sparse (DIM) data
+        // and compare their decoded sectors, or their container bytes if a
+        // sector cannot be decoded.
+        const bool sameFormat = a.format == b.format;
+        const bool flat = a.image->flatDataOffset() && b.image->flatDataOffset();
+        std::vector<uint8_t> decodedA;
+        std::vector<uint8_t> decodedB;
+        bool decoded = false;
+        if (sameFormat && !flat) {
+            try {
+                decodedA = decodedSectorStream(*a.image);
+                decodedB = decodedSectorStream(*b.image);
+                decoded = true;
+            } catch (const DiskException&) {
+            }
+        }
+        const auto& rawA = decoded ? decodedA : a.image->getRawData();
+        const auto& rawB = decoded ? decodedB : b.image->getRawData();
+        const bool sameLayout = sameFormat && flat && rawA.size() == rawB.size();
+        size_t blockSize = a.image->getGeometry().bytesPerSector;
+        if (blockSize == 0) {
+            blockSize = 256;
+        }
+        std::map<size_t, size_t> changed;
+        if (sameFormat) {
+            changed = diffRawBlocks(rawA, rawB, blockSize);
+        }
+
+        struct FileChange {
+            const char* kind;
+            std::string path;
+            size_t sizeA = 0;
+            size_t sizeB = 0;
+            SHA256::Digest hashA{};
+            SHA256::Digest hashB{};
+        };
+        std::vector<FileChange> fileChanges;
+        size_t unchangedFiles = 0;
+        size_t unchangedByExtent = 0;
+        const bool haveFiles = a.handler && b.handler;
+        if (compareFiles && !haveFiles) {
+            if (!compareBlocks) {
+                printError("No supported file system in " + paths[a.handler ? 1 : 0]);
+                return 2;
+            }
+        } else if (compareFiles) {
+            std::vector<std::pair<std::string, size_t>> listA;
+            std::vector<std::pair<std::string, size_t>> listB;
+            std::string error;
+            if (!collectFilesRecursive(*a.handler, "", listA, error) ||
+                !collectFilesRecursive(*b.handler, "", listB, error)) {
+                printError(error);
+                return 2;
+            }
+            std::map<std::string, size_t> filesA(listA.begin(), listA.end());
+            std::map<std::string, size_t> filesB(listB.begin(), listB.end());
+
+            for (const auto& [path, size] : filesA) {
+                auto other = filesB.find(path);
+                if (other == filesB.end()) {
+                    FileChange c{"removed", path};
+                    c.sizeA = size;
+                    c.hashA = SHA256::digest(a.handler->readFile(path));
+                    fileChanges.push_back(std::move(c));
+                    continue;
+                }
+                if (sameLayout && size == other->second) {
+                    if (changed.empty()) {
+                        ++unchangedFiles;
+                        ++unchangedByExtent;
+                        continue;
+                    }
+                    std::vector<std::pair<size_t, size_t>> extentsA;
+                    std::vector<std::pair<size_t, size_t>> extentsB;
+                    if (a.handler->getFileExtents(path, extentsA) &&
+                        b.handler->getFileExtents(path, extentsB) && extentsA == extentsB &&
+                        std::none_of(extentsA.begin(), extentsA.end(), [&changed](const auto& e) {
+                            return overlapsWritten(changed, e.first, e.second);
+                        })) {
+                        ++unchangedFiles;
+                        ++unchangedByExtent;
+                        continue;
+                    }
+                }
+                const auto dataA = a.handler->readFile(path);
+                const auto dataB = b.handler->readFile(path);
+                if (dataA == dataB) {
+                    ++unchangedFiles;
+                    continue;
+                }
+                FileChange c{"modified", path};
+                c.sizeA = dataA.size();
+                c.sizeB = dataB.size();
+                c.hashA = SHA256::digest(dataA);
+                c.hashB = SHA256::digest(dataB);
+                fileChanges.push_back(std::move(c));
+            }
+            for (const auto& [path, size] : filesB) {
+                if (filesA.count(path) == 0) {
+                    FileChange c{"added", path};
+                    c.sizeB = size;
+                    c.hashB = SHA256::digest(b.handler->readFile(path));
+                    fileChanges.push_back(std::move(c));
+                }
+            }
+            std::sort(fileChanges.begin(), fileChanges.end(),
+                      [](const FileChange& x, const FileChange& y) { return x.path < y.path; });
+        }
+
+        const bool blocksDiffer = compareBlocks && (!sameFormat || !changed.empty());
+        const bool filesDiffer = compareFiles && haveFiles && !fileChanges.empty();
+        const int status = (blocksDiffer || filesDiffer) ? 1 : 0;
+        auto blocksIn = [blockSize](size_t begin, size_t end) {
+            return (end - 1) / blockSize - begin / blockSize + 1;
+        };
+
+        if (m_outputMode != OutputMode::Text) {
+            JsonWriter w(std::cout, m_outputMode == OutputMode::Json);
+            const bool nd = m_outputMode == OutputMode::NDJson;
+            if (!nd) {
+                w.beginObject()
+                 .field("a", paths[0])
+                 .field("b", paths[1])
+                 .field("formatA", formatToIdentifier(a.format))
+                 .field("formatB", formatToIdentifier(b.format))
+                 .field("identical", status == 0);
+            }
+            if (compareBlocks) {
+                if (!nd) {
+                    w.key("blocks").beginObject()
+                     .field("compared", sameFormat)
+                     .field("blockSize", blockSize);
+                    w.key("ranges").beginArray();
+                }
+                size_t changedBlocks = 0;
+                for (const auto& [begin, end] : changed) {
+                    changedBlocks += blocksIn(begin, end);
+                    w.beginObject();
+                    if (nd) {
+                        w.field("type", "blocks").field("a", paths[0]).field("b", paths[1]);
+                    }
+                    w.field("offset", begin)
+                     .field("length", end - begin)
+                     .field("firstBlock", begin / blockSize)
+                     .field("lastBlock", (end - 1) / blockSize)
+                     .endObject();
+                    if (nd) {
+                        w.endRecord();
+                    }
+                }
+                if (!nd) {
+                    w.endArray().field("changedBlocks", changedBlocks).endObject();
+                }
+            }
+            if (compareFiles && haveFiles) {
+                if (!nd) {
+                    w.key("files").beginObject();
+                    w.key("changes").beginArray();
+                }
+                for (const auto& c : fileChanges) {
+                    w.beginObject();
+                    if (nd) {
+                        w.field("type", "file").field("a", paths[0]).field("b", paths[1]);
+                    }
+                    w.field("change", c.kind).field("path", c.path);
+                    if (std::strcmp(c.kind, "added") != 0) {
+                        w.field("sizeA", c.sizeA).field("sha256A", SHA256::toHex(c.hashA));
+                    }
+                    if (std::strcmp(c.kind, "removed") != 0) {
+                        w.field("sizeB", c.sizeB).field("sha256B", SHA256::toHex(c.hashB));
+                    }
+                    w.endObject();
+                    if (nd) {
+                        w.endRecord();
+                    }
+                }
+                if (!nd) {
+                    w.endArray()
+                     .field("unchanged", unchangedFiles)
+                     .field("unchangedByExtent", unchangedByExtent)
+                     .endObject();
+                }
+            }
+            if (!nd) {
+                w.endObject();
+                w.endRecord();
+            }
+            w.flushTo();
+            return status;
+        }
+
+        if (m_quiet) {
+            return status;
+        }
+        if (compareBlocks) {
+            if (!sameFormat) {
+                std::cout << "Blocks: not compared (" << formatToIdentifier(a.format) << " vs "
+                          << formatToIdentifier(b.format) << ")\n";
+            } else {
+                size_t changedBlocks = 0;
+                for (const auto& [begin, end] : changed) {
+                    changedBlocks += blocksIn(begin, end);
+                }
+                std::cout << "Blocks: " << changed.size() << " range(s), " << changedBlocks
+                          << " block(s) of " << blockSize << " bytes differ\n";
+                for (const auto& [begin, end] : changed) {
+                    std::cout << "  0x" << std::hex << std::setw(8) << std::setfill('0') << begin
+                              << "-0x" << std::setw(8) << (end - 1) << std::dec << std::setfill(' ');
+                    const size_t first = begin / blockSize;
+                    const size_t last = (end - 1) / blockSize;
+                    if (first == last) {
+                        std::cout << "  block " << first << "\n";
+                    } else {
+                        std::cout << "  blocks " << first << "-" << last << "\n";
+                    }
+                }
+            }
+        }
+        if (compareFiles && !haveFiles) {
+            std::cout << "Files: not compared (no supported file system in "
+                      << paths[a.handler ? 1 : 0] << ")\n";
+        } else if (compareFiles) {
+            size_t added = 0, removed = 0, modified = 0;
+            for (const auto& c : fileChanges) {
+                if (c.kind[0] == 'a') ++added;
+                else if (c.kind[0] == 'r') ++removed;
+                else ++modified;
+            }
+            std::cout << "Files: " << added << " added, " << removed << " removed, " << modified
+                      << " modified, " << unchangedFiles << " unchanged";
+            if (unchangedByExtent > 0) {
+                std::cout << " (" << unchangedByExtent << " by extent)";
+            }
+            std::cout << "\n";
+            auto shortHash = [](const SHA256::Digest& d) { return SHA256::toHex(d).substr(0, 12); };
+            for (const auto& c : fileChanges) {
+                if (c.kind[0] == 'a') {
+                    std::cout << "  A  " << c.path << "  " << c.sizeB << " bytes  " << shortHash(c.hashB) << "\n";
+                } else if (c.kind[0] == 'r') {
+                    std::cout << "  D  " << c.path << "  " << c.sizeA << " bytes  " << shortHash(c.hashA) << "\n";
+                } else {
+                    std::cout << "  M  " << c.path << "  " << c.sizeA << " -> " << c.sizeB << " bytes  "
+                              << shortHash(c.hashA) << " -> " << shortHash(c.hashB) << "\n";
+                }
+            }
+        }
+        return status;
+    } catch (const std::exception& e) {
+        printError(e.what());
+        return 2;
+    }
+}
+
+int CLI::cmdPatch(const std::vector<std::string>& args) {
+    rdedisktool::CommandOptions opts;
+    opts.addValue("format", {"-f", "--format"});
+
+    std::string parseError;
+    if (!opts.parse(args, &parseError)) {
+        printError(parseError);
+        printCommandHelp("patch");
+        return 1;
+    }
+    const std::string mode = opts.positionalCount() > 0 ? opts.getPositional(0) : "";
+    if ((mode != "create" && mode != "apply") || opts.positionalCount() != 4) {
+        printError("Expected 'patch create <old> <new> <patch>' or 'patch apply <old> <patch> <out>'");
+        printCommandHelp("patch");
+        return 1;
+    }
+
+    try {
+        if (mode == "create") {
+            const std::string& oldPath = opts.getPositional(1);
+            const std::string& newPath = opts.getPositional(2);
+            const std::string& patchPath = opts.getPositional(3);
+            auto oldDisk = loadDiskImageOnly(oldPath);
+            auto newDisk = loadDiskImageOnly(newPath);
+            if (!oldDisk.hasImage() || !newDisk.hasImage()) {
+                return 1;
+            }
+
+            const SectorPatch patch = SectorPatch::create(*oldDisk.image, *newDisk.image);
+            const std::vector<uint8_t> bytes = patch.serialize();
+            std::ofstream out(patchPath, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            out.close();
+            if (!out) {
+                printError("Unable to write patch file: " + patchPath);
+                return 1;
+            }
+
+            if (!m_quiet) {
+                const auto& st = patch.stats();
+                std::cout << "Created " << patchPath << ": " << bytes.size() << " bytes for "
+                          << (st.same + st.copied + st.filled + st.literal) << " sectors ("
+                          << st.same << " unchanged, " << st.copied << " copied, " << st.filled
+                          << " filled, " << st.literal << " literal)\n";
+            }
+            return 0;
+        }
+
+        const std::string& oldPath = opts.getPositional(1);
+        const std::string& patchPath = opts.getPositional(2);
+        const std::string& outputPath = opts.getPositional(3);
+
+        std::ifstream in(patchPath, std::ios::binary);
+        if (!in) {
+            printError("Unable to open patch file: " + patchPath);
+            return 1;
+        }
+        const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const SectorPatch patch = SectorPatch::parse(bytes);
+
+        auto oldDisk = loadDiskImageOnly(oldPath);
+        if (!oldDisk.hasImage()) {
+            return 1;
+        }
+        const std::vector<SectorBuffer> oldSectors = SectorPatch::readSectors(*oldDisk.image);
+
+        // Output container: --format, else the source's own format or a
+        // format of the same platform that uses the output extension (.dsk
+        // is both Apple DO and MSX DSK).
+        DiskFormat outputFormat = DiskFormat::Unknown;
+        const std::string formatStr = opts.getValue("format");
+        if (!formatStr.empty()) {
+            outputFormat = stringToFormat(formatStr);
+            if (outputFormat == DiskFormat::Unknown) {
+                printError("Unknown format: " + formatStr);
+                return 1;
+            }
+        } else {
+            const std::string ext = toLower(std::filesystem::path(outputPath).extension().string());
+            const Platform platform = DiskImageFactory::getPlatformForFormat(oldDisk.format);
+            auto usesExtension = [&ext](DiskFormat format) {
+                const auto exts = DiskImageFactory::getExtensions(format);
+                return std::find(exts.begin(), exts.end(), ext) != exts.end();
+            };
+            if (ext.empty() || usesExtension(oldDisk.format)) {
+                outputFormat = oldDisk.format;
+            } else {
+                for (DiskFormat format : DiskImageFactory::getSupportedFormats()) {
+                    if (DiskImageFactory::getPlatformForFormat(format) == platform && usesExtension(format)) {
+                        outputFormat = format;
+                        break;
+                    }
+                }
+            }
+        }
+        if (outputFormat == DiskFormat::Unknown) {
+            printError("Cannot determine output format. Use --format option.");
+            return 1;
+        }
+        if (DiskImageFactory::getPlatformForFormat(outputFormat) !=
+            DiskImageFactory::getPlatformForFormat(oldDisk.format)) {
+            printError(std::string("Cross-platform patching is not supported (") +
+                       formatToString(oldDisk.format) + " -> " + formatToString(outputFormat) + ")");
+            return 1;
+        }
+
+        // Patch the source image itself when it can take the result, else a
+        // converted copy of it, else a blank image in the output format.
+        // Only the source image skips sectors that are already current;
+        // a conversion need not keep every sector where it was.
+        const DiskGeometry& oldGeom = patch.oldGeometry();
+        const DiskGeometry& newGeom = patch.newGeometry();
+        const bool sameGeometry = oldGeom.tracks == newGeom.tracks && oldGeom.sides == newGeom.sides &&
+                                  oldGeom.sectorsPerTrack == newGeom.sectorsPerTrack;
+        std::shared_ptr<DiskImage> target;
+        std::vector<uint8_t> xsaData;
+        bool startsFromOld = false;
+        if (outputFormat == DiskFormat::MSXXSA) {
+            xsaData.reserve(newGeom.totalSize());
+        } else if (sameGeometry && outputFormat == oldDisk.format && !oldDisk.image->isWriteProtected()) {
+            target = oldDisk.image;
+            startsFromOld = true;
+        } else if (sameGeometry && oldDisk.image->canConvertTo(outputFormat)) {
+            try {
+                target = oldDisk.image->convertTo(outputFormat);
+            } catch (const NotImplementedException&) {
+                // Advertised but not implemented (XDF -> DIM): build it below
+            }
+        }
+        if (!target && outputFormat != DiskFormat::MSXXSA) {
+            target = DiskImageFactory::create(outputFormat,
+                                              SectorPatch::containerGeometry(outputFormat, newGeom));
+        }
+
+        size_t written = 0;
+        patch.apply(oldSectors, [&](size_t index, const SectorBuffer& data, bool same) {
+            if (!target) {
+                xsaData.insert(xsaData.end(), data.begin(), data.end());
+                return;
+            }
+            if (same && startsFromOld) {
+                return;
+            }
+            size_t track, side, sector;
+            SectorPatch::sectorAddress(*target, index, track, side, sector);
+            target->writeSector(track, side, sector, data);
+            ++written;
+        });
+
+        if (!target) {
+            const std::string origFilename = std::filesystem::path(outputPath).stem().string() + ".dsk";
+            MSXXSAImage::createFromRawData(xsaData, origFilename)->save(outputPath);
+        } else {
+            patch.verify(*target);
+            target->save(outputPath);
+        }
+
+        if (!m_quiet) {
+            std::cout << "Patched " << oldPath << " -> " << outputPath << " ("
+                      << formatToString(outputFormat) << ", " << written << " sector(s) written)\n";
+        }
+        return 0;
+    } catch (const DiskException& e) {
+        printError(e.what());
+        return 1;
+    } catch (const std::exception& e) {
+        printError(std::string("Error: ") + e.what());
+        return 1;
+    }
+}
+
 int CLI::cmdListFormats(const std::vector<std::string>& /*args*/) {
     // Stable, columnar text output for both human inspection and CI grep.
     // Format per row:  <Identifier>\t<extensions, comma-joined>\t<DisplayName>
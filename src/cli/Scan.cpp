@@ -0,0 +1,541 @@
+#include "rdedisktool/CLI.h"
+#include "rdedisktool/DiskImage.h"
+#include "rdedisktool/DiskImageFactory.h"
+#include "rdedisktool/FileSystemHandler.h"
+#include "rdedisktool/FormatDetector.h"
+#include "rdedisktool/SHA256.h"
+#include "rdedisktool/utils/ImageIndex.h"
+#include "rdedisktool/utils/JsonWriter.h"
+#include "rdedisktool/utils/WorkStealingPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+namespace {
+
+// Deeper trees than this are treated as a corrupt (cyclic) directory.
+constexpr int MAX_SCAN_DEPTH = 64;
+
+void listRecursive(rde::FileSystemHandler& handler, const std::string& path, int depth,
+                   std::vector<std::pair<std::string, rde::FileEntry>>& out) {
+    if (depth > MAX_SCAN_DEPTH) {
+        throw std::runtime_error("directory nesting too deep at '" + path + "'");
+    }
+    for (auto& entry : handler.listFiles(path)) {
+        std::string child = path.empty() ? entry.name : path + "/" + entry.name;
+        const bool isDir = entry.isDirectory;
+        out.emplace_back(child, std::move(entry));
+        if (isDir) {
+            listRecursive(handler, child, depth + 1, out);
+        }
+    }
+}
+
+enum class ScanOutcome { Scanned, Failed, Skipped };
+
+// One image: an "image" record followed by a "file" record per entry, or a
+// single failed "image" record. Only this image is held in memory.
+ScanOutcome scanImage(const std::filesystem::path& path, std::string& records) {
+    std::ostringstream out;
+    rde::JsonWriter w(out, false);
+    const std::string imagePath = path.string();
+    rde::DiskFormat format = rde::DiskFormat::Unknown;
+
+    try {
+        format = rdedisktool::FormatDetector::detect(path);
+        if (format == rde::DiskFormat::Unknown || !rde::DiskImageFactory::isFormatSupported(format)) {
+            return ScanOutcome::Skipped;
+        }
+
+        auto image = rde::DiskImageFactory::open(path, format);
+        auto handler = rde::FileSystemHandler::create(image.get());
+        std::vector<std::pair<std::string, rde::FileEntry>> files;
+        if (handler) {
+            listRecursive(*handler, "", 0, files);
+        }
+
+        size_t totalSize = 0;
+        for (const auto& f : files) {
+            totalSize += f.second.size;
+        }
+
+        w.beginObject()
+         .field("type", "image")
+         .field("image", imagePath)
+         .field("ok", true)
+         .field("format", rde::formatToIdentifier(format));
+        w.key("geometry").beginObject();
+        rde::writeJson(w, image->getGeometry());
+        w.endObject();
+        if (handler) {
+            w.field("fileSystem", rde::fileSystemTypeToString(handler->getType()))
+             .field("volume", handler->getVolumeName())
+             .field("freeSpace", handler->getFreeSpace());
+        } else {
+            w.key("fileSystem").null().key("volume").null().key("freeSpace").null();
+        }
+        w.field("fileCount", files.size())
+         .field("totalSize", totalSize)
+         .endObject();
+        w.endRecord();
+
+        for (const auto& [filePath, entry] : files) {
+            w.beginObject()
+             .field("type", "file")
+             .field("image", imagePath)
+             .field("path", filePath);
+            rde::writeJson(w, entry);
+            w.endObject();
+            w.endRecord();
+        }
+        w.flushTo();
+        records = out.str();
+        return ScanOutcome::Scanned;
+    } catch (const std::exception& e) {
+        std::ostringstream failed;
+        rde::JsonWriter fw(failed, false);
+        fw.beginObject()
+          .field("type", "image")
+          .field("image", imagePath)
+          .field("ok", false)
+          .field("format", rde::formatToIdentifier(format))
+          .field("error", e.what())
+          .endObject();
+        fw.endRecord();
+        fw.flushTo();
+        records = failed.str();
+        return ScanOutcome::Failed;
+    }
+}
+
+// Hands every regular file under `root` to `task` on a pool of `jobs`
+// threads; returns the error that stopped the walk, if any.
+template <typename Task>
+std::error_code forEachFileParallel(const std::string& root, size_t jobs, Task task) {
+    std::error_code ec;
+    rde::WorkStealingPool pool(jobs);
+    auto it = std::filesystem::recursive_directory_iterator(
+        root, std::filesystem::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        std::error_code typeErr;
+        if (it->is_regular_file(typeErr)) {
+            pool.submit([path = it->path(), &task] { task(path); });
+        }
+    }
+    pool.wait();
+    return ec;
+}
+
+rde::SHA256::Digest hashFileOnDisk(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw rde::ReadException("Cannot open file: " + path.string());
+    }
+    rde::SHA256 sha;
+    std::vector<char> buffer(64 * 1024);
+    while (in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        sha.update(reinterpret_cast<const uint8_t*>(buffer.data()), static_cast<size_t>(in.gcount()));
+    }
+    if (in.bad()) {
+        throw rde::ReadException("Cannot read file: " + path.string());
+    }
+    return sha.finish();
+}
+
+// One image's index entry: metadata plus a content hash of every file.
+ScanOutcome indexImage(const std::filesystem::path& path, rde::IndexedImage& indexed, std::string& error) {
+    try {
+        const rde::DiskFormat format = rdedisktool::FormatDetector::detect(path);
+        if (format == rde::DiskFormat::Unknown || !rde::DiskImageFactory::isFormatSupported(format)) {
+            return ScanOutcome::Skipped;
+        }
+
+        auto image = rde::DiskImageFactory::open(path, format);
+        auto handler = rde::FileSystemHandler::create(image.get());
+        indexed.path = path.string();
+        indexed.format = rde::formatToIdentifier(format);
+        indexed.geometry = image->getGeometry();
+        indexed.hash = hashFileOnDisk(path);
+        if (!handler) {
+            return ScanOutcome::Scanned;
+        }
+        indexed.fileSystem = rde::fileSystemTypeToString(handler->getType());
+        indexed.volume = handler->getVolumeName();
+
+        std::vector<std::pair<std::string, rde::FileEntry>> files;
+        listRecursive(*handler, "", 0, files);
+        for (const auto& [filePath, entry] : files) {
+            if (entry.isDirectory) {
+                continue;
+            }
+            const auto data = handler->readFile(filePath);
+            rde::IndexedFile file;
+            file.path = filePath;
+            file.size = data.size();
+            file.fileType = entry.fileType;
+            file.attributes = entry.attributes;
+            file.hash = rde::SHA256::digest(data);
+            indexed.files.push_back(std::move(file));
+        }
+        return ScanOutcome::Scanned;
+    } catch (const std::exception& e) {
+        error = e.what();
+        return ScanOutcome::Failed;
+    }
+}
+
+// Case-insensitive shell-style match supporting '*' and '?'.
+bool globMatch(const std::string& pattern, const std::string& text) {
+    size_t p = 0, t = 0, starP = std::string::npos, starT = 0;
+    auto same = [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+    };
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || same(pattern[p], text[t]))) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            starP = p++;
+            starT = t;
+        } else if (starP != std::string::npos) {
+            p = starP + 1;
+            t = ++starT;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+// "<min>", "<min>-<max>", "-<max>" or "<min>-"
+bool parseSizeRange(const std::string& text, uint64_t& min, uint64_t& max) {
+    auto parse = [](const std::string& s, uint64_t& out) {
+        if (s.empty() || !std::all_of(s.begin(), s.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            return false;
+        }
+        try {
+            out = std::stoull(s);
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    };
+    const size_t dash = text.find('-');
+    if (dash == std::string::npos) {
+        if (!parse(text, min)) return false;
+        max = min;
+        return true;
+    }
+    const std::string lo = text.substr(0, dash);
+    const std::string hi = text.substr(dash + 1);
+    min = 0;
+    max = UINT64_MAX;
+    if (lo.empty() && hi.empty()) return false;
+    if (!lo.empty() && !parse(lo, min)) return false;
+    if (!hi.empty() && !parse(hi, max)) return false;
+    return min <= max;
+}
+
+} // anonymous namespace
+
+namespace rde {
+
+int CLI::cmdScan(const std::vector<std::string>& args) {
+    std::string root;
+    size_t jobs = std::thread::hardware_concurrency();
+    for (size_t i = 0; i < args.size(); ++i) {
+        if ((args[i] == "-j" || args[i] == "--jobs") && i + 1 < args.size()) {
+            try {
+                jobs = std::stoul(args[++i]);
+            } catch (const std::exception&) {
+                jobs = 0;
+            }
+            if (jobs == 0) {
+                printError("Invalid --jobs value: " + args[i]);
+                return 1;
+            }
+        } else if (root.empty()) {
+            root = args[i];
+        } else {
+            printError("Unexpected argument: " + args[i]);
+            printCommandHelp("scan");
+            return 1;
+        }
+    }
+    if (root.empty()) {
+        printError("Missing directory argument");
+        printCommandHelp("scan");
+        return 1;
+    }
+
+    std::error_code dirErr;
+    if (!std::filesystem::is_directory(root, dirErr)) {
+        printError("Not a directory: " + root);
+        return 1;
+    }
+
+    std::mutex outputMutex;
+    std::atomic<size_t> scanned{0};
+    std::atomic<size_t> failed{0};
+    std::atomic<size_t> skipped{0};
+    const std::error_code ec = forEachFileParallel(root, jobs, [&](const std::filesystem::path& path) {
+        std::string records;
+        switch (scanImage(path, records)) {
+            case ScanOutcome::Scanned: ++scanned; break;
+            case ScanOutcome::Failed: ++failed; break;
+            case ScanOutcome::Skipped: ++skipped; return;
+        }
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout.write(records.data(), static_cast<std::streamsize>(records.size()));
+    });
+    std::cout.flush();
+
+    if (ec) {
+        printError("Directory walk stopped at " + root + ": " + ec.message());
+        return 1;
+    }
+    if (!m_quiet) {
+        std::cerr << "Scanned " << scanned << " image(s), " << failed << " failed, "
+                  << skipped << " other file(s) skipped\n";
+    }
+    return 0;
+}
+
+int CLI::cmdIndex(const std::vector<std::string>& args) {
+    if (args.empty() || (args[0] != "build" && args[0] != "query")) {
+        printError("Expected 'index build' or 'index query'");
+        printCommandHelp("index");
+        return 1;
+    }
+    return args[0] == "build" ? indexBuild(args) : indexQuery(args);
+}
+
+int CLI::indexBuild(const std::vector<std::string>& args) {
+    std::vector<std::string> positional;
+    size_t jobs = std::thread::hardware_concurrency();
+    for (size_t i = 1; i < args.size(); ++i) {
+        if ((args[i] == "-j" || args[i] == "--jobs") && i + 1 < args.size()) {
+            try {
+                jobs = std::stoul(args[++i]);
+            } catch (const std::exception&) {
+                jobs = 0;
+            }
+            if (jobs == 0) {
+                printError("Invalid --jobs value: " + args[i]);
+                return 1;
+            }
+        } else {
+            positional.push_back(args[i]);
+        }
+    }
+    if (positional.size() != 2) {
+        printError("Usage: index build <directory> <index-file>");
+        printCommandHelp("index");
+        return 1;
+    }
+    const std::string& root = positional[0];
+    const std::string& indexFile = positional[1];
+    std::error_code dirErr;
+    if (!std::filesystem::is_directory(root, dirErr)) {
+        printError("Not a directory: " + root);
+        return 1;
+    }
+
+    std::mutex resultMutex;
+    std::vector<IndexedImage> images;
+    size_t failed = 0;
+    const std::error_code ec = forEachFileParallel(root, jobs, [&](const std::filesystem::path& path) {
+        IndexedImage indexed;
+        std::string error;
+        const ScanOutcome outcome = indexImage(path, indexed, error);
+        if (outcome == ScanOutcome::Skipped) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(resultMutex);
+        if (outcome == ScanOutcome::Failed) {
+            ++failed;
+            if (!m_quiet) {
+                printWarning("Not indexed: " + path.string() + ": " + error);
+            }
+            return;
+        }
+        images.push_back(std::move(indexed));
+    });
+    if (ec) {
+        printError("Directory walk stopped at " + root + ": " + ec.message());
+        return 1;
+    }
+
+    size_t fileCount = 0;
+    for (const auto& image : images) {
+        fileCount += image.files.size();
+    }
+    const size_t imageCount = images.size();
+    writeImageIndex(indexFile, std::move(images));
+    if (!m_quiet) {
+        std::cerr << "Indexed " << imageCount << " image(s) with " << fileCount << " file(s), "
+                  << failed << " failed\n";
+    }
+    return 0;
+}
+
+int CLI::indexQuery(const std::vector<std::string>& args) {
+    std::string indexFile;
+    std::optional<SHA256::Digest> hash;
+    std::string namePattern;
+    std::optional<std::pair<uint64_t, uint64_t>> sizeRange;
+    bool duplicates = false;
+    for (size_t i = 1; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        const bool hasValue = i + 1 < args.size();
+        if (arg == "--hash" && hasValue) {
+            SHA256::Digest digest;
+            if (!SHA256::fromHex(args[++i], digest)) {
+                printError("Invalid --hash value (expected 64 hex digits): " + args[i]);
+                return 1;
+            }
+            hash = digest;
+        } else if (arg == "--name" && hasValue) {
+            namePattern = args[++i];
+        } else if (arg == "--size" && hasValue) {
+            uint64_t min = 0, max = 0;
+            if (!parseSizeRange(args[++i], min, max)) {
+                printError("Invalid --size value (use N, MIN-MAX, MIN- or -MAX): " + args[i]);
+                return 1;
+            }
+            sizeRange = std::make_pair(min, max);
+        } else if (arg == "--duplicates") {
+            duplicates = true;
+        } else if (indexFile.empty() && !arg.empty() && arg[0] != '-') {
+            indexFile = arg;
+        } else {
+            printError("Unexpected argument: " + arg);
+            printCommandHelp("index");
+            return 1;
+        }
+    }
+    const bool fileQuery = hash || !namePattern.empty() || sizeRange;
+    if (indexFile.empty() || fileQuery == duplicates) {
+        printError("Give an index file and either --duplicates or any of --hash, --name, --size");
+        printCommandHelp("index");
+        return 1;
+    }
+
+    const ImageIndex index(indexFile);
+    JsonWriter w(std::cout, m_outputMode == OutputMode::Json);
+    if (m_outputMode == OutputMode::Json) {
+        w.beginObject().field("index", indexFile);
+    }
+
+    if (duplicates) {
+        // Images whose on-disk bytes are identical, grouped by hash
+        std::vector<ImageIndex::Image> images;
+        for (uint32_t i = 0; i < index.imageCount(); ++i) {
+            images.push_back(index.image(i));
+        }
+        std::stable_sort(images.begin(), images.end(),
+                         [](const auto& a, const auto& b) { return a.hash < b.hash; });
+        if (m_outputMode == OutputMode::Json) {
+            w.key("duplicates").beginArray();
+        }
+        for (size_t begin = 0, end = 0; begin < images.size(); begin = end) {
+            while (end < images.size() && images[end].hash == images[begin].hash) {
+                ++end;
+            }
+            if (end - begin < 2) {
+                continue;
+            }
+            const std::string hex = SHA256::toHex(images[begin].hash);
+            if (m_outputMode == OutputMode::Text) {
+                std::cout << hex << "\n";
+                for (size_t i = begin; i < end; ++i) {
+                    std::cout << "  " << images[i].path << "\n";
+                }
+                continue;
+            }
+            w.beginObject().field("sha256", hex);
+            w.key("images").beginArray();
+            for (size_t i = begin; i < end; ++i) {
+                w.value(images[i].path);
+            }
+            w.endArray().endObject();
+            if (m_outputMode == OutputMode::NDJson) {
+                w.endRecord();
+            }
+        }
+    } else {
+        // Narrow with the sorted tables first, then filter the candidates
+        std::vector<uint32_t> candidates;
+        if (hash) {
+            candidates = index.findByHash(*hash);
+        } else if (sizeRange) {
+            candidates = index.findBySize(sizeRange->first, sizeRange->second);
+        } else {
+            candidates.resize(index.fileCount());
+            for (uint32_t i = 0; i < index.fileCount(); ++i) {
+                candidates[i] = i;
+            }
+        }
+
+        std::vector<ImageIndex::Image> imageCache(index.imageCount());
+        std::vector<bool> imageLoaded(index.imageCount(), false);
+        if (m_outputMode == OutputMode::Json) {
+            w.key("matches").beginArray();
+        }
+        for (uint32_t n : candidates) {
+            const ImageIndex::File file = index.file(n);
+            if (sizeRange && (file.size < sizeRange->first || file.size > sizeRange->second)) {
+                continue;
+            }
+            if (!namePattern.empty()) {
+                const bool byPath = namePattern.find('/') != std::string::npos;
+                const size_t slash = file.path.rfind('/');
+                const std::string name = byPath || slash == std::string::npos
+                    ? file.path : file.path.substr(slash + 1);
+                if (!globMatch(namePattern, name)) {
+                    continue;
+                }
+            }
+            if (!imageLoaded[file.image]) {
+                imageCache[file.image] = index.image(file.image);
+                imageLoaded[file.image] = true;
+            }
+            const ImageIndex::Image& image = imageCache[file.image];
+            const std::string hex = SHA256::toHex(file.hash);
+            if (m_outputMode == OutputMode::Text) {
+                std::cout << hex << "  " << file.size << "  " << image.path << ":" << file.path << "\n";
+                continue;
+            }
+            w.beginObject()
+             .field("image", image.path)
+             .field("format", image.format)
+             .field("volume", image.volume)
+             .field("path", file.path)
+             .field("size", file.size)
+             .field("fileType", file.fileType)
+             .field("attributes", file.attributes)
+             .field("sha256", hex)
+             .endObject();
+            if (m_outputMode == OutputMode::NDJson) {
+                w.endRecord();
+            }
+        }
+    }
+
+    if (m_outputMode == OutputMode::Json) {
+        w.endArray().endObject();
+        w.endRecord();
+    }
+    w.flushTo();
+    return 0;
+}
+
+} // namespace rde
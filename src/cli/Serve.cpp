@@ -0,0 +1,668 @@
+#include "rdedisktool/CLI.h"
+#include "rdedisktool/DiskImage.h"
+#include "rdedisktool/FileSystemHandler.h"
+#include "rdedisktool/utils/JsonWriter.h"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <sstream>
+#include <set>
+#include <string_view>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// One request line: {"cmd": "...", "args": ["...", ...], "id": <scalar>}
+struct ServeRequest {
+    std::string cmd;
+    std::vector<std::string> args;
+    std::string id;     // raw JSON token, echoed back verbatim
+};
+
+class RequestParser {
+public:
+    explicit RequestParser(const std::string& text) : m_text(text) {}
+
+    bool parse(ServeRequest& req, std::string& error) {
+        skipWs();
+        if (!consume('{')) return fail(error, "expected a JSON object");
+        skipWs();
+        if (consume('}')) return finish(error);
+        while (true) {
+            std::string key;
+            skipWs();
+            if (!parseString(key)) return fail(error, "expected a string key");
+            skipWs();
+            if (!consume(':')) return fail(error, "expected ':' after \"" + key + "\"");
+            skipWs();
+            if (key == "cmd") {
+                if (!parseString(req.cmd)) return fail(error, "\"cmd\" must be a string");
+            } else if (key == "args") {
+                if (!parseStringArray(req.args)) return fail(error, "\"args\" must be an array of strings");
+            } else if (key == "id") {
+                if (!parseScalar(req.id)) return fail(error, "\"id\" must be a string or number");
+            } else {
+                std::string ignored;
+                std::vector<std::string> ignoredList;
+                if (!parseScalar(ignored) && !parseStringArray(ignoredList)) {
+                    return fail(error, "unsupported value for \"" + key + "\"");
+                }
+            }
+            skipWs();
+            if (consume('}')) return finish(error);
+            if (!consume(',')) return fail(error, "expected ',' or '}'");
+        }
+    }
+
+private:
+    const std::string& m_text;
+    size_t m_pos = 0;
+
+    static bool fail(std::string& error, const std::string& message) {
+        error = message;
+        return false;
+    }
+
+    bool finish(std::string& error) {
+        skipWs();
+        return m_pos == m_text.size() || fail(error, "trailing data after object");
+    }
+
+    void skipWs() {
+        while (m_pos < m_text.size() &&
+               (m_text[m_pos] == ' ' || m_text[m_pos] == '\t' ||
+                m_text[m_pos] == '\r' || m_text[m_pos] == '\n')) {
+            ++m_pos;
+        }
+    }
+
+    bool consume(char c) {
+        if (m_pos < m_text.size() && m_text[m_pos] == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseHex4(uint32_t& value) {
+        if (m_text.size() - m_pos < 4) return false;
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = m_text[m_pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= static_cast<uint32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') value |= static_cast<uint32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value |= static_cast<uint32_t>(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool parseString(std::string& out) {
+        if (!consume('"')) return false;
+        out.clear();
+        while (m_pos < m_text.size()) {
+            const char c = m_text[m_pos++];
+            if (c == '"') return true;
+            if (static_cast<unsigned char>(c) < 0x20) return false;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (m_pos >= m_text.size()) return false;
+            const char e = m_text[m_pos++];
+            switch (e) {
+                case '"': case '\\': case '/': out += e; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    uint32_t cp = 0;
+                    if (!parseHex4(cp)) return false;
+                    if (cp >= 0xD800 && cp < 0xDC00) {
+                        uint32_t low = 0;
+                        if (!consume('\\') || !consume('u') || !parseHex4(low) ||
+                            low < 0xDC00 || low >= 0xE000) {
+                            return false;
+                        }
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, cp);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    bool parseStringArray(std::vector<std::string>& out) {
+        const size_t start = m_pos;
+        if (!consume('[')) return false;
+        out.clear();
+        skipWs();
+        if (consume(']')) return true;
+        while (true) {
+            skipWs();
+            std::string item;
+            if (!parseString(item)) {
+                m_pos = start;
+                return false;
+            }
+            out.push_back(std::move(item));
+            skipWs();
+            if (consume(']')) return true;
+            if (!consume(',')) {
+                m_pos = start;
+                return false;
+            }
+        }
+    }
+
+    // String, number, true/false/null; returns the raw JSON token. The token
+    // is echoed back in the reply, so it must be valid JSON on its own.
+    bool parseScalar(std::string& raw) {
+        const size_t start = m_pos;
+        bool ok = false;
+        if (m_pos < m_text.size() && m_text[m_pos] == '"') {
+            std::string ignored;
+            ok = parseString(ignored);
+        } else {
+            ok = parseLiteral("true") || parseLiteral("false") ||
+                 parseLiteral("null") || parseNumber();
+        }
+        if (!ok) {
+            m_pos = start;
+            return false;
+        }
+        raw = m_text.substr(start, m_pos - start);
+        return true;
+    }
+
+    bool parseLiteral(std::string_view word) {
+        if (m_text.compare(m_pos, word.size(), word) != 0) return false;
+        m_pos += word.size();
+        return true;
+    }
+
+    bool parseDigits() {
+        const size_t start = m_pos;
+        while (m_pos < m_text.size() &&
+               std::isdigit(static_cast<unsigned char>(m_text[m_pos]))) {
+            ++m_pos;
+        }
+        return m_pos > start;
+    }
+
+    // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    bool parseNumber() {
+        consume('-');
+        if (!consume('0') && !parseDigits()) return false;
+        if (consume('.') && !parseDigits()) return false;
+        if (consume('e') || consume('E')) {
+            if (!consume('+')) consume('-');
+            if (!parseDigits()) return false;
+        }
+        return true;
+    }
+};
+
+std::string jsonString(const std::string& s) {
+    std::string out;
+    rde::JsonWriter::appendString(out, s);
+    return out;
+}
+
+// Routes std::cout/std::cerr into strings for the response and answers
+// interactive prompts (critical-file delete) with "no".
+class OutputCapture {
+public:
+    OutputCapture()
+        : m_out(std::cout.rdbuf(m_outBuf.rdbuf())),
+          m_err(std::cerr.rdbuf(m_errBuf.rdbuf())),
+          m_in(std::cin.rdbuf(m_inBuf.rdbuf())) {}
+    ~OutputCapture() {
+        std::cout.rdbuf(m_out);
+        std::cerr.rdbuf(m_err);
+        std::cin.rdbuf(m_in);
+        std::cin.clear();
+    }
+    OutputCapture(const OutputCapture&) = delete;
+    OutputCapture& operator=(const OutputCapture&) = delete;
+
+    std::string out() const { return m_outBuf.str(); }
+    std::string err() const { return m_errBuf.str(); }
+
+private:
+    std::ostringstream m_outBuf;
+    std::ostringstream m_errBuf;
+    std::istringstream m_inBuf;
+    std::streambuf* m_out;
+    std::streambuf* m_err;
+    std::streambuf* m_in;
+};
+
+std::string cacheKey(const std::string& imagePath) {
+    std::error_code ec;
+    std::filesystem::path p = std::filesystem::absolute(imagePath, ec);
+    return (ec ? std::filesystem::path(imagePath) : p).lexically_normal().string();
+}
+
+bool statImage(const std::string& imagePath,
+               std::filesystem::file_time_type& mtime, uintmax_t& size) {
+    std::error_code ec;
+    mtime = std::filesystem::last_write_time(imagePath, ec);
+    if (ec) return false;
+    size = std::filesystem::file_size(imagePath, ec);
+    return !ec;
+}
+
+const std::set<std::string>& readVerbs() {
+    static const std::set<std::string> s = {"list", "extract", "validate"};
+    return s;
+}
+
+const std::set<std::string>& writeVerbs() {
+    static const std::set<std::string> s = {"add", "delete", "mkdir", "rmdir", "rename"};
+    return s;
+}
+
+#ifndef _WIN32
+volatile std::sig_atomic_t g_stopServing = 0;
+
+extern "C" void onServeSignal(int) {
+    g_stopServing = 1;
+}
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, 0);
+        if (n < 0) {
+            if (errno == EINTR && !g_stopServing) continue;
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Bind a listening socket at `path`, replacing a stale socket file but
+// refusing to take over one a live server still answers on.
+int listenUnixSocket(const std::string& path, std::string& error) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        error = "Socket path too long: " + path;
+        return -1;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    struct stat st{};
+    if (::lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            error = "Not a socket: " + path;
+            return -1;
+        }
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        const bool live = probe >= 0 &&
+            ::connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+        if (probe >= 0) ::close(probe);
+        if (live) {
+            error = "Socket already in use: " + path;
+            return -1;
+        }
+        ::unlink(path.c_str());
+    }
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 ||
+        ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::chmod(path.c_str(), 0600) != 0 ||
+        ::listen(fd, 16) != 0) {
+        error = "Cannot listen on " + path + ": " + std::strerror(errno);
+        if (fd >= 0) ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+#endif
+
+} // anonymous namespace
+
+namespace rde {
+
+//=============================================================================
+// Serve-mode disk cache
+//=============================================================================
+
+bool CLI::lookupCachedDisk(const std::string& imagePath, LoadedDisk& disk) {
+    const std::string key = cacheKey(imagePath);
+    auto it = std::find_if(m_diskCache.begin(), m_diskCache.end(),
+                           [&](const CachedDisk& e) { return e.key == key; });
+    if (it == m_diskCache.end()) {
+        return false;
+    }
+
+    std::filesystem::file_time_type mtime;
+    uintmax_t size = 0;
+    if (!statImage(imagePath, mtime, size) || mtime != it->mtime || size != it->size) {
+        if (!it->dirty) {
+            m_diskCache.erase(it);
+            return false;
+        }
+        printError("Image changed on disk while it has unflushed changes: " + imagePath);
+        printError("Hint: close it with --discard to reload, or flush to overwrite.");
+        disk = LoadedDisk{};
+        return true;
+    }
+
+    m_diskCache.splice(m_diskCache.begin(), m_diskCache, it);
+    CachedDisk& entry = m_diskCache.front();
+    entry.touched = true;
+    if (m_requestMutates && entry.dirty && !entry.undo) {
+        entry.undo = entry.disk.image->clone();
+    }
+    disk = entry.disk;
+    return true;
+}
+
+void CLI::cacheLoadedDisk(const std::string& imagePath, const LoadedDisk& disk) {
+    CachedDisk entry;
+    entry.key = cacheKey(imagePath);
+    entry.disk = disk;
+    entry.touched = true;
+    if (!statImage(imagePath, entry.mtime, entry.size)) {
+        return;
+    }
+    m_diskCache.remove_if([&](const CachedDisk& e) { return e.key == entry.key; });
+    m_diskCache.push_front(std::move(entry));
+
+    // Evict least recently used images; unflushed ones stay until flushed.
+    size_t count = m_diskCache.size();
+    for (auto it = std::prev(m_diskCache.end());
+         count > m_diskCacheLimit && it != m_diskCache.begin();) {
+        auto victim = it--;
+        if (!victim->dirty && !victim->touched) {
+            m_diskCache.erase(victim);
+            --count;
+        }
+    }
+}
+
+bool CLI::flushCachedDisk(CachedDisk& entry) {
+    if (!entry.dirty) {
+        return true;
+    }
+    if (!writeDiskImage(entry.disk.image.get(), "flush")) {
+        return false;
+    }
+    entry.dirty = false;
+    statImage(entry.disk.image->getFilePath().string(), entry.mtime, entry.size);
+    return true;
+}
+
+void CLI::finishServeRequest(bool failed) {
+    for (auto it = m_diskCache.begin(); it != m_diskCache.end();) {
+        CachedDisk& entry = *it;
+        if (!entry.touched) {
+            ++it;
+            continue;
+        }
+        // A failed command may have left a half-applied change in memory:
+        // roll back to the last good state (or reload it from the file).
+        if (failed && m_requestMutates) {
+            if (!entry.undo) {
+                it = m_diskCache.erase(it);
+                continue;
+            }
+            entry.disk.handler.reset();
+            entry.disk.image = std::move(entry.undo);
+            entry.disk.handler = FileSystemHandler::create(entry.disk.image.get());
+            if (!entry.disk.handler) {
+                printWarning("Dropped unflushed changes after a failed request: " + entry.key);
+                it = m_diskCache.erase(it);
+                continue;
+            }
+        }
+        entry.touched = false;
+        entry.undo.reset();
+        ++it;
+    }
+    m_requestMutates = false;
+}
+
+std::string CLI::serveRequest(const std::string& line, bool& stop) {
+    ServeRequest req;
+    std::string parseError;
+    if (!RequestParser(line).parse(req, parseError)) {
+        return "{\"ok\":false,\"exit\":1,\"error\":" + jsonString("Bad request: " + parseError) + "}";
+    }
+
+    int rc = 1;
+    OutputCapture capture;
+    try {
+        if (req.cmd == "flush") {
+            rc = 0;
+            const std::string key = req.args.empty() ? std::string() : cacheKey(req.args[0]);
+            for (auto& entry : m_diskCache) {
+                if ((key.empty() || entry.key == key) && !flushCachedDisk(entry)) {
+                    rc = 1;
+                }
+            }
+        } else if (req.cmd == "close") {
+            if (req.args.empty()) {
+                printError("Missing image file argument");
+            } else {
+                const std::string key = cacheKey(req.args[0]);
+                const bool discard = req.args.size() > 1 && req.args[1] == "--discard";
+                rc = 0;
+                for (auto it = m_diskCache.begin(); it != m_diskCache.end(); ++it) {
+                    if (it->key != key) continue;
+                    if (!discard && !flushCachedDisk(*it)) {
+                        rc = 1;
+                    } else {
+                        m_diskCache.erase(it);
+                    }
+                    break;
+                }
+            }
+        } else if (req.cmd == "shutdown") {
+            rc = 0;
+            for (auto& entry : m_diskCache) {
+                if (!flushCachedDisk(entry)) rc = 1;
+            }
+            stop = true;
+        } else if (readVerbs().count(req.cmd) || writeVerbs().count(req.cmd)) {
+            m_requestMutates = writeVerbs().count(req.cmd) > 0;
+            std::vector<std::string> args;
+            args.reserve(req.args.size() + 1);
+            args.push_back(req.cmd);
+            args.insert(args.end(), req.args.begin(), req.args.end());
+            rc = execute(args);
+            finishServeRequest(rc != 0);
+        } else {
+            printError("Unsupported serve command: " + req.cmd);
+        }
+    } catch (const std::exception& e) {
+        printError(e.what());
+        finishServeRequest(true);
+        rc = 1;
+    }
+
+    std::string response = "{";
+    if (!req.id.empty()) {
+        response += "\"id\":" + req.id + ",";
+    }
+    response += std::string("\"ok\":") + (rc == 0 ? "true" : "false") +
+                ",\"exit\":" + std::to_string(rc) +
+                ",\"stdout\":" + jsonString(capture.out()) +
+                ",\"stderr\":" + jsonString(capture.err()) + "}";
+    return response;
+}
+
+int CLI::cmdServe(const std::vector<std::string>& args) {
+    std::string socketPath;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--socket" && i + 1 < args.size()) {
+            socketPath = args[++i];
+        } else if (args[i] == "--cache" && i + 1 < args.size()) {
+            try {
+                m_diskCacheLimit = std::stoul(args[++i]);
+            } catch (const std::exception&) {
+                m_diskCacheLimit = 0;
+            }
+            if (m_diskCacheLimit == 0) {
+                printError("Invalid --cache value: " + args[i]);
+                return 1;
+            }
+        } else {
+            printError("Unknown serve option: " + args[i]);
+            printCommandHelp("serve");
+            return 1;
+        }
+    }
+    if (socketPath.empty()) {
+        printError("Missing --socket <path>");
+        printCommandHelp("serve");
+        return 1;
+    }
+
+#ifdef _WIN32
+    printError("serve requires Unix domain sockets, which this build does not support");
+    return 1;
+#else
+    std::string listenError;
+    const int listenFd = listenUnixSocket(socketPath, listenError);
+    if (listenFd < 0) {
+        printError(listenError);
+        return 1;
+    }
+
+    struct sigaction sa{};
+    sa.sa_handler = onServeSignal;
+    sigemptyset(&sa.sa_mask);
+    ::sigaction(SIGINT, &sa, nullptr);
+    ::sigaction(SIGTERM, &sa, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (!m_quiet) {
+        std::cout << "Serving on " << socketPath << "\n" << std::flush;
+    }
+
+    // All connections are polled together, so a client that stays
+    // connected does not lock the others out; requests themselves still run
+    // one at a time, in the order they arrive.
+    struct ServeClient {
+        int fd;
+        std::string pending;
+    };
+    std::vector<ServeClient> clients;
+    char buf[65536];
+    bool stop = false;
+
+    // Read what the client sent and answer each complete line; false once
+    // the connection is done.
+    auto serviceClient = [&](ServeClient& client) {
+        const ssize_t n = ::recv(client.fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) return true;
+        if (n <= 0) return false;
+        client.pending.append(buf, static_cast<size_t>(n));
+
+        size_t start = 0;
+        size_t nl;
+        while (!stop && (nl = client.pending.find('\n', start)) != std::string::npos) {
+            const std::string line = client.pending.substr(start, nl - start);
+            start = nl + 1;
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+            if (!sendAll(client.fd, serveRequest(line, stop) + "\n")) return false;
+        }
+        client.pending.erase(0, start);
+        return true;
+    };
+
+    m_serving = true;
+    while (!stop && !g_stopServing) {
+        std::vector<pollfd> fds;
+        fds.reserve(clients.size() + 1);
+        fds.push_back({listenFd, POLLIN, 0});
+        for (const auto& client : clients) {
+            fds.push_back({client.fd, POLLIN, 0});
+        }
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            printError(std::string("poll: ") + std::strerror(errno));
+            break;
+        }
+
+        for (size_t i = 0; i < clients.size() && !stop && !g_stopServing; ++i) {
+            if (fds[i + 1].revents == 0) continue;
+            if (!serviceClient(clients[i])) {
+                ::close(clients[i].fd);
+                clients[i].fd = -1;
+            }
+        }
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                     [](const ServeClient& c) { return c.fd < 0; }),
+                      clients.end());
+
+        if (!stop && (fds[0].revents & POLLIN)) {
+            const int fd = ::accept(listenFd, nullptr, nullptr);
+            if (fd >= 0) {
+                clients.push_back({fd, std::string()});
+            } else if (errno != EINTR && errno != ECONNABORTED) {
+                printError(std::string("accept: ") + std::strerror(errno));
+                break;
+            }
+        }
+    }
+    for (const auto& client : clients) {
+        ::close(client.fd);
+    }
+    m_serving = false;
+
+    // Stopped by a signal: do not lose changes that requests reported done.
+    int rc = 0;
+    for (auto& entry : m_diskCache) {
+        if (!flushCachedDisk(entry)) rc = 1;
+    }
+    m_diskCache.clear();
+    ::close(listenFd);
+    ::unlink(socketPath.c_str());
+    return rc;
+#endif
+}
+
+} // namespace rde
@@ -1,7 +1,44 @@
 #include "rdedisktool/DiskImage.h"
+#include "rdedisktool/utils/Stats.h"
+
+#include <algorithm>
+#include <cstring>
 
 namespace rde {
 
+void DiskImage::markDirty(size_t offset, size_t length) {
+    if (length == 0) return;
+    size_t begin = offset;
+    size_t end = offset + length;
+    // Absorb every range that overlaps or touches [begin, end).
+    auto it = m_dirty.upper_bound(begin);
+    if (it != m_dirty.begin() && std::prev(it)->second >= begin) --it;
+    while (it != m_dirty.end() && it->first <= end) {
+        begin = std::min(begin, it->first);
+        end = std::max(end, it->second);
+        it = m_dirty.erase(it);
+    }
+    m_dirty.emplace(begin, end);
+}
+
+void DiskImage::assignRawData(const std::vector<uint8_t>& data) {
+    if (data.size() != m_data.size()) {
+        m_data = data;
+        markDirty(0, m_data.size());
+        Stats::sectorWritten(data.size(), (data.size() + 511) / 512);
+        return;
+    }
+    constexpr size_t kChunk = 512;
+    for (size_t off = 0; off < data.size(); off += kChunk) {
+        const size_t len = std::min(kChunk, data.size() - off);
+        if (std::memcmp(m_data.data() + off, data.data() + off, len) != 0) {
+            std::memcpy(m_data.data() + off, data.data() + off, len);
+            markDirty(off, len);
+            Stats::sectorWritten(len);
+        }
+    }
+}
+
 SectorBuffer DiskImage::readBlock(size_t blockNumber) {
     // Default implementation: convert block number to track/sector
     // This works for 512-byte block formats
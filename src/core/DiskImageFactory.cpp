@@ -1,5 +1,6 @@
 #include "rdedisktool/DiskImageFactory.h"
 #include "rdedisktool/FormatDetector.h"
+#include "rdedisktool/utils/Stats.h"
 #include <fstream>
 #include <algorithm>
 #include <cctype>
@@ -17,6 +18,7 @@ std::map<DiskFormat, DiskImageFactory::CreatorFunc>& DiskImageFactory::getCreato
 //=============================================================================
 
 DiskFormat DiskImageFactory::detectFormat(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Detect);
     // Delegate to FormatDetector
     return rdedisktool::FormatDetector::detect(path);
 }
@@ -124,6 +126,7 @@ Platform DiskImageFactory::getPlatformForFormat(DiskFormat format) {
         case DiskFormat::AppleNIB2:
         case DiskFormat::AppleWOZ1:
         case DiskFormat::AppleWOZ2:
+        case DiskFormat::AppleHDV:
             return Platform::AppleII;
 
         case DiskFormat::MSXDSK:
@@ -170,7 +173,15 @@ std::unique_ptr<DiskImage> DiskImageFactory::open(const std::filesystem::path& p
 
     // Create the disk image instance
     auto image = it->second();
-    image->load(path);
+    {
+        ScopedTimer timer(Stats::Phase::Load);
+        image->load(path);
+    }
+    if (Stats::enabled()) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(path, ec);
+        if (!ec) Stats::add(Stats::Counter::BytesLoaded, size);
+    }
     return image;
 }
 
@@ -241,6 +252,14 @@ DiskGeometry DiskImageFactory::getDefaultGeometry(DiskFormat format) {
             geom.bytesPerSector = 256;
             break;
 
+        case DiskFormat::AppleHDV:
+            // 32MB ProDOS volume (65535 blocks), one block per track
+            geom.tracks = 65535;
+            geom.sides = 1;
+            geom.sectorsPerTrack = 1;
+            geom.bytesPerSector = 512;
+            break;
+
         // MSX formats
         case DiskFormat::MSXDSK:
             // Default to 720KB double-sided
@@ -313,6 +332,8 @@ std::vector<std::string> DiskImageFactory::getExtensions(DiskFormat format) {
         case DiskFormat::AppleWOZ1:
         case DiskFormat::AppleWOZ2:
             return {".woz"};
+        case DiskFormat::AppleHDV:
+            return {".hdv", ".2mg"};
         case DiskFormat::MSXDSK:
             return {".dsk"};
         case DiskFormat::MSXDMK:
@@ -354,7 +375,8 @@ std::vector<DiskFormat> DiskImageFactory::getFormatsForPlatform(Platform platfor
                 DiskFormat::AppleNIB,
                 DiskFormat::AppleNIB2,
                 DiskFormat::AppleWOZ1,
-                DiskFormat::AppleWOZ2
+                DiskFormat::AppleWOZ2,
+                DiskFormat::AppleHDV
             };
             break;
 
@@ -415,6 +437,9 @@ DiskFormat DiskImageFactory::getFormatFromExtension(const std::string& extension
     if (ext == ".nib") return DiskFormat::AppleNIB;
     if (ext == ".nb2") return DiskFormat::AppleNIB2;
     if (ext == ".woz") return DiskFormat::AppleWOZ2;  // Default to v2
+    if (ext == ".hdv") return DiskFormat::AppleHDV;
+    if (ext == ".2mg") return DiskFormat::AppleHDV;
+    if (ext == ".2img") return DiskFormat::AppleHDV;
     if (ext == ".dmk") return DiskFormat::MSXDMK;
     if (ext == ".xsa") return DiskFormat::MSXXSA;
     if (ext == ".xdf") return DiskFormat::X68000XDF;
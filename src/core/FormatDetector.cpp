@@ -147,6 +147,12 @@ rde::DiskFormat FormatDetector::detectByMagic(const std::vector<uint8_t>& data)
         return dc42Format;
     }
 
+    // Apple 2MG container ("2IMG"); only ProDOS-order payloads are loaded
+    if (data.size() >= 64 &&
+        data[0] == '2' && data[1] == 'I' && data[2] == 'M' && data[3] == 'G') {
+        return rde::DiskFormat::AppleHDV;
+    }
+
     // PR-E1: Applesauce MOOF — magic is 8 bytes "MOOF\xff\x0a\x0d\x0a", unique
     // enough that no other format can collide. CRC + chunk validation happens
     // later in the loader.
@@ -165,8 +171,15 @@ rde::DiskFormat FormatDetector::detectByExtension(const std::string& ext, size_t
         return rde::DiskFormat::AppleDO;
     }
     if (ext == ".po") {
+        // 800K and hard-disk volumes are plain block arrays too
+        if (fileSize != APPLE_140K && fileSize % 512 == 0) {
+            return rde::DiskFormat::AppleHDV;
+        }
         return rde::DiskFormat::ApplePO;
     }
+    if (ext == ".hdv" || ext == ".2mg" || ext == ".2img") {
+        return rde::DiskFormat::AppleHDV;
+    }
     if (ext == ".nib") {
         if (fileSize == APPLE_NIB) {
             return rde::DiskFormat::AppleNIB;
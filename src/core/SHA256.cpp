@@ -0,0 +1,154 @@
+#include "rdedisktool/SHA256.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace rde {
+
+namespace {
+
+constexpr uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // anonymous namespace
+
+SHA256::SHA256()
+    : m_state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+              0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19} {
+}
+
+void SHA256::compress(const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = (static_cast<uint32_t>(block[i * 4]) << 24) |
+               (static_cast<uint32_t>(block[i * 4 + 1]) << 16) |
+               (static_cast<uint32_t>(block[i * 4 + 2]) << 8) |
+               static_cast<uint32_t>(block[i * 4 + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+        const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+    uint32_t e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+    for (int i = 0; i < 64; ++i) {
+        const uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        const uint32_t ch = (e & f) ^ (~e & g);
+        const uint32_t t1 = h + s1 + ch + K[i] + w[i];
+        const uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        const uint32_t t2 = s0 + maj;
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    m_state[0] += a; m_state[1] += b; m_state[2] += c; m_state[3] += d;
+    m_state[4] += e; m_state[5] += f; m_state[6] += g; m_state[7] += h;
+}
+
+void SHA256::update(const uint8_t* data, size_t length) {
+    m_totalLength += length;
+    if (m_blockLength > 0) {
+        const size_t take = std::min(length, sizeof(m_block) - m_blockLength);
+        std::memcpy(m_block + m_blockLength, data, take);
+        m_blockLength += take;
+        data += take;
+        length -= take;
+        if (m_blockLength < sizeof(m_block)) {
+            return;
+        }
+        compress(m_block);
+        m_blockLength = 0;
+    }
+    while (length >= sizeof(m_block)) {
+        compress(data);
+        data += sizeof(m_block);
+        length -= sizeof(m_block);
+    }
+    if (length > 0) {
+        std::memcpy(m_block, data, length);
+        m_blockLength = length;
+    }
+}
+
+SHA256::Digest SHA256::finish() {
+    const uint64_t bits = m_totalLength * 8;
+    const uint8_t pad = 0x80;
+    update(&pad, 1);
+    const uint8_t zero = 0;
+    while (m_blockLength != 56) {
+        update(&zero, 1);
+    }
+    uint8_t lengthBytes[8];
+    for (int i = 0; i < 8; ++i) {
+        lengthBytes[i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+    }
+    update(lengthBytes, sizeof(lengthBytes));
+
+    Digest out;
+    for (int i = 0; i < 8; ++i) {
+        out[i * 4] = static_cast<uint8_t>(m_state[i] >> 24);
+        out[i * 4 + 1] = static_cast<uint8_t>(m_state[i] >> 16);
+        out[i * 4 + 2] = static_cast<uint8_t>(m_state[i] >> 8);
+        out[i * 4 + 3] = static_cast<uint8_t>(m_state[i]);
+    }
+    return out;
+}
+
+SHA256::Digest SHA256::digest(const uint8_t* data, size_t length) {
+    SHA256 sha;
+    sha.update(data, length);
+    return sha.finish();
+}
+
+SHA256::Digest SHA256::digest(const std::vector<uint8_t>& data) {
+    return digest(data.data(), data.size());
+}
+
+std::string SHA256::toHex(const Digest& digest) {
+    static const char* digits = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(digest.size() * 2);
+    for (uint8_t b : digest) {
+        hex += digits[b >> 4];
+        hex += digits[b & 0x0F];
+    }
+    return hex;
+}
+
+bool SHA256::fromHex(const std::string& hex, Digest& digest) {
+    if (hex.size() != digest.size() * 2) {
+        return false;
+    }
+    for (size_t i = 0; i < digest.size(); ++i) {
+        const int hi = hexValue(hex[i * 2]);
+        const int lo = hexValue(hex[i * 2 + 1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        digest[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+} // namespace rde
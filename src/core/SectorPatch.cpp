@@ -0,0 +1,401 @@
+#include "rdedisktool/SectorPatch.h"
+#include "rdedisktool/CRC.h"
+#include "rdedisktool/DiskImage.h"
+#include "rdedisktool/Exceptions.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+namespace rde {
+
+namespace {
+
+constexpr char PATCH_MAGIC[8] = {'R', 'D', 'E', 'P', 'T', 'C', 'H', '1'};
+
+enum PatchOp : uint8_t {
+    OP_END = 0,
+    OP_SAME = 1,
+    OP_COPY = 2,
+    OP_FILL = 3,
+    OP_DATA = 4,
+};
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Bounds-checked reader over a patch body
+class PatchReader {
+public:
+    PatchReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    uint8_t byte() {
+        need(1);
+        return m_data[m_pos++];
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const uint8_t b = byte();
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw InvalidFormatException("Corrupt patch: oversized number");
+    }
+
+    const uint8_t* bytes(uint64_t length) {
+        need(length);
+        const uint8_t* p = m_data + m_pos;
+        m_pos += static_cast<size_t>(length);
+        return p;
+    }
+
+    const uint8_t* here() const { return m_data + m_pos; }
+    bool atEnd() const { return m_pos == m_size; }
+
+private:
+    void need(uint64_t length) const {
+        if (length > m_size - m_pos) {
+            throw InvalidFormatException("Corrupt patch: truncated");
+        }
+    }
+
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+};
+
+void putGeometry(std::vector<uint8_t>& out, const DiskGeometry& g) {
+    putVarint(out, g.tracks);
+    putVarint(out, g.sides);
+    putVarint(out, g.sectorsPerTrack);
+    putVarint(out, g.bytesPerSector);
+}
+
+DiskGeometry readGeometry(PatchReader& in) {
+    DiskGeometry g;
+    g.tracks = static_cast<size_t>(in.varint());
+    g.sides = static_cast<size_t>(in.varint());
+    g.sectorsPerTrack = static_cast<size_t>(in.varint());
+    g.bytesPerSector = static_cast<size_t>(in.varint());
+    return g;
+}
+
+bool isFill(const SectorBuffer& data) {
+    return !data.empty() && std::all_of(data.begin(), data.end(),
+                                        [&data](uint8_t b) { return b == data[0]; });
+}
+
+// Collects operations, extending the previous run when a sector continues it.
+class OpBuilder {
+public:
+    explicit OpBuilder(std::vector<uint8_t>& out) : m_out(out) {}
+
+    void same() {
+        if (m_op != OP_SAME) start(OP_SAME);
+        ++m_count;
+    }
+
+    void copy(uint64_t src) {
+        if (m_op != OP_COPY || m_src + m_count != src) {
+            start(OP_COPY);
+            m_src = src;
+        }
+        ++m_count;
+    }
+
+    void fill(uint8_t value) {
+        if (m_op != OP_FILL || m_fill != value) {
+            start(OP_FILL);
+            m_fill = value;
+        }
+        ++m_count;
+    }
+
+    void data(const SectorBuffer& sector) {
+        if (m_op != OP_DATA) start(OP_DATA);
+        m_data.insert(m_data.end(), sector.begin(), sector.end());
+        ++m_count;
+    }
+
+    void finish() {
+        start(OP_END);
+        m_out.push_back(OP_END);
+    }
+
+private:
+    void start(PatchOp op) {
+        if (m_count > 0) {
+            m_out.push_back(m_op);
+            if (m_op == OP_COPY) putVarint(m_out, m_src);
+            if (m_op == OP_FILL) m_out.push_back(m_fill);
+            putVarint(m_out, m_count);
+            m_out.insert(m_out.end(), m_data.begin(), m_data.end());
+        }
+        m_op = op;
+        m_count = 0;
+        m_data.clear();
+    }
+
+    std::vector<uint8_t>& m_out;
+    PatchOp m_op = OP_END;
+    uint64_t m_count = 0;
+    uint64_t m_src = 0;
+    uint8_t m_fill = 0;
+    std::vector<uint8_t> m_data;
+};
+
+SHA256::Digest hashSectors(const std::vector<SectorBuffer>& sectors) {
+    SHA256 sha;
+    for (const auto& s : sectors) {
+        sha.update(s.data(), s.size());
+    }
+    return sha.finish();
+}
+
+} // anonymous namespace
+
+DiskGeometry SectorPatch::streamGeometry(const DiskImage& image) {
+    DiskGeometry geom = image.getGeometry();
+    const DiskFormat format = image.getFormat();
+    if ((format == DiskFormat::X68000XDF || format == DiskFormat::X68000DIM) && geom.sides > 0) {
+        geom.tracks /= geom.sides;
+    }
+    return geom;
+}
+
+DiskGeometry SectorPatch::containerGeometry(DiskFormat format, const DiskGeometry& stream) {
+    DiskGeometry geom = stream;
+    if (format == DiskFormat::X68000XDF || format == DiskFormat::X68000DIM) {
+        geom.tracks *= geom.sides;
+    }
+    return geom;
+}
+
+void SectorPatch::sectorAddress(const DiskImage& image, size_t index,
+                                size_t& track, size_t& side, size_t& sector) {
+    const DiskGeometry geom = streamGeometry(image);
+    const size_t perCylinder = geom.sides * geom.sectorsPerTrack;
+    if (perCylinder == 0) {
+        throw InvalidFormatException("Image has no sector geometry");
+    }
+    track = index / perCylinder;
+    side = (index % perCylinder) / geom.sectorsPerTrack;
+    sector = index % geom.sectorsPerTrack;
+    const DiskFormat format = image.getFormat();
+    if (format == DiskFormat::X68000XDF || format == DiskFormat::X68000DIM) {
+        sector += 1; // X68000 DiskImage sector is 1-indexed.
+    }
+}
+
+std::vector<SectorBuffer> SectorPatch::readSectors(DiskImage& image) {
+    const DiskGeometry geom = streamGeometry(image);
+    if (geom.sides == 0 || geom.sectorsPerTrack == 0 || geom.bytesPerSector == 0) {
+        throw InvalidFormatException("Image has no sector geometry");
+    }
+    std::vector<SectorBuffer> sectors;
+    sectors.reserve(geom.totalSectors());
+    for (size_t i = 0; i < geom.totalSectors(); ++i) {
+        size_t track, side, sector;
+        sectorAddress(image, i, track, side, sector);
+        sectors.push_back(image.readSector(track, side, sector));
+        if (sectors.back().size() != geom.bytesPerSector) {
+            throw InvalidFormatException("Sector " + std::to_string(i) + " has " +
+                                         std::to_string(sectors.back().size()) + " bytes, expected " +
+                                         std::to_string(geom.bytesPerSector));
+        }
+    }
+    return sectors;
+}
+
+SectorPatch SectorPatch::create(DiskImage& oldImage, DiskImage& newImage) {
+    SectorPatch patch;
+    patch.m_oldGeometry = streamGeometry(oldImage);
+    patch.m_newGeometry = streamGeometry(newImage);
+    if (patch.m_oldGeometry.bytesPerSector != patch.m_newGeometry.bytesPerSector) {
+        throw InvalidFormatException("Images have different sector sizes");
+    }
+    const auto oldSectors = readSectors(oldImage);
+    const auto newSectors = readSectors(newImage);
+    patch.m_oldHash = hashSectors(oldSectors);
+    patch.m_newHash = hashSectors(newSectors);
+
+    // First old position of each distinct sector, for COPY of moved data
+    std::unordered_map<std::string, uint64_t> oldPositions;
+    for (size_t i = 0; i < oldSectors.size(); ++i) {
+        oldPositions.emplace(std::string(oldSectors[i].begin(), oldSectors[i].end()), i);
+    }
+
+    OpBuilder ops(patch.m_ops);
+    for (size_t i = 0; i < newSectors.size(); ++i) {
+        const SectorBuffer& sector = newSectors[i];
+        if (i < oldSectors.size() && oldSectors[i] == sector) {
+            ops.same();
+            ++patch.m_stats.same;
+        } else if (isFill(sector)) {
+            ops.fill(sector[0]);
+            ++patch.m_stats.filled;
+        } else if (auto it = oldPositions.find(std::string(sector.begin(), sector.end()));
+                   it != oldPositions.end()) {
+            ops.copy(it->second);
+            ++patch.m_stats.copied;
+        } else {
+            ops.data(sector);
+            ++patch.m_stats.literal;
+        }
+    }
+    ops.finish();
+    return patch;
+}
+
+std::vector<uint8_t> SectorPatch::serialize() const {
+    std::vector<uint8_t> out(PATCH_MAGIC, PATCH_MAGIC + sizeof(PATCH_MAGIC));
+    putGeometry(out, m_oldGeometry);
+    putGeometry(out, m_newGeometry);
+    out.insert(out.end(), m_oldHash.begin(), m_oldHash.end());
+    out.insert(out.end(), m_newHash.begin(), m_newHash.end());
+    out.insert(out.end(), m_ops.begin(), m_ops.end());
+    const uint32_t crc = CRC::crc32(out.data(), out.size());
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(crc >> (8 * i)));
+    }
+    return out;
+}
+
+SectorPatch SectorPatch::parse(const std::vector<uint8_t>& bytes) {
+    if (bytes.size() < sizeof(PATCH_MAGIC) + 4 ||
+        std::memcmp(bytes.data(), PATCH_MAGIC, sizeof(PATCH_MAGIC)) != 0) {
+        throw InvalidFormatException("Not an rdedisktool sector patch");
+    }
+    const size_t body = bytes.size() - 4;
+    uint32_t crc = 0;
+    for (int i = 3; i >= 0; --i) {
+        crc = (crc << 8) | bytes[body + i];
+    }
+    if (CRC::crc32(bytes.data(), body) != crc) {
+        throw InvalidFormatException("Corrupt patch: checksum mismatch");
+    }
+
+    SectorPatch patch;
+    PatchReader in(bytes.data() + sizeof(PATCH_MAGIC), body - sizeof(PATCH_MAGIC));
+    patch.m_oldGeometry = readGeometry(in);
+    patch.m_newGeometry = readGeometry(in);
+    std::memcpy(patch.m_oldHash.data(), in.bytes(patch.m_oldHash.size()), patch.m_oldHash.size());
+    std::memcpy(patch.m_newHash.data(), in.bytes(patch.m_newHash.size()), patch.m_newHash.size());
+    const size_t bytesPerSector = patch.m_newGeometry.bytesPerSector;
+    const uint64_t oldCount = patch.m_oldGeometry.totalSectors();
+    const uint64_t newCount = patch.m_newGeometry.totalSectors();
+    if (bytesPerSector == 0 || bytesPerSector != patch.m_oldGeometry.bytesPerSector) {
+        throw InvalidFormatException("Corrupt patch: bad sector size");
+    }
+
+    // Validate the operation list once so apply() can trust it
+    const uint8_t* opsBegin = in.here();
+    uint64_t produced = 0;
+    while (true) {
+        const uint8_t op = in.byte();
+        if (op == OP_END) break;
+        uint64_t src = 0;
+        if (op == OP_COPY) src = in.varint();
+        if (op == OP_FILL) in.byte();
+        const uint64_t count = in.varint();
+        if (count == 0 || count > newCount - produced) {
+            throw InvalidFormatException("Corrupt patch: run past the end of the image");
+        }
+        switch (op) {
+            case OP_SAME:
+                if (produced + count > oldCount) {
+                    throw InvalidFormatException("Corrupt patch: run past the end of the base");
+                }
+                patch.m_stats.same += count;
+                break;
+            case OP_COPY:
+                if (src > oldCount || count > oldCount - src) {
+                    throw InvalidFormatException("Corrupt patch: copy past the end of the base");
+                }
+                patch.m_stats.copied += count;
+                break;
+            case OP_FILL:
+                patch.m_stats.filled += count;
+                break;
+            case OP_DATA:
+                if (count > SIZE_MAX / bytesPerSector) {
+                    throw InvalidFormatException("Corrupt patch: oversized literal run");
+                }
+                in.bytes(count * bytesPerSector);
+                patch.m_stats.literal += count;
+                break;
+            default:
+                throw InvalidFormatException("Corrupt patch: unknown operation " + std::to_string(op));
+        }
+        produced += count;
+    }
+    if (produced != newCount || !in.atEnd()) {
+        throw InvalidFormatException("Corrupt patch: operations do not cover the image");
+    }
+    patch.m_ops.assign(opsBegin, bytes.data() + body);
+    return patch;
+}
+
+void SectorPatch::apply(const std::vector<SectorBuffer>& oldSectors, const SectorSink& sink) const {
+    if (oldSectors.size() != m_oldGeometry.totalSectors() || hashSectors(oldSectors) != m_oldHash) {
+        throw InvalidFormatException("Patch does not apply: the source image is not the patch base");
+    }
+
+    const size_t bytesPerSector = m_newGeometry.bytesPerSector;
+    PatchReader in(m_ops.data(), m_ops.size());
+    SHA256 sha;
+    size_t index = 0;
+    auto emit = [&](const SectorBuffer& data, bool same) {
+        sha.update(data.data(), data.size());
+        sink(index++, data, same);
+    };
+    while (true) {
+        const uint8_t op = in.byte();
+        if (op == OP_END) break;
+        const uint64_t src = op == OP_COPY ? in.varint() : 0;
+        const uint8_t fill = op == OP_FILL ? in.byte() : 0;
+        const uint64_t count = in.varint();
+        for (uint64_t i = 0; i < count; ++i) {
+            switch (op) {
+                case OP_SAME:
+                    emit(oldSectors[index], true);
+                    break;
+                case OP_COPY: {
+                    const SectorBuffer& data = oldSectors[static_cast<size_t>(src + i)];
+                    emit(data, index < oldSectors.size() && oldSectors[index] == data);
+                    break;
+                }
+                case OP_FILL:
+                    emit(SectorBuffer(bytesPerSector, fill),
+                         index < oldSectors.size() && isFill(oldSectors[index]) && oldSectors[index][0] == fill);
+                    break;
+                default: {
+                    const uint8_t* p = in.bytes(bytesPerSector);
+                    emit(SectorBuffer(p, p + bytesPerSector), false);
+                    break;
+                }
+            }
+        }
+    }
+    if (sha.finish() != m_newHash) {
+        throw InvalidFormatException("Patch result does not match the recorded checksum");
+    }
+}
+
+void SectorPatch::verify(DiskImage& image) const {
+    if (hashSectors(readSectors(image)) != m_newHash) {
+        throw InvalidFormatException("Patched image does not read back as the patch result");
+    }
+}
+
+} // namespace rde
@@ -12,6 +12,7 @@
 #include "rdedisktool/filesystem/MacintoshHFSHandler.h"
 #include "rdedisktool/filesystem/MacintoshMFSHandler.h"
 #include "rdedisktool/DiskImage.h"
+#include "rdedisktool/utils/Stats.h"
 
 namespace rde {
 
@@ -19,6 +20,7 @@ std::unique_ptr<FileSystemHandler> FileSystemHandler::create(DiskImage* disk) {
     if (!disk) {
         return nullptr;
     }
+    ScopedTimer timer(Stats::Phase::FsInit);
 
     // Determine file system type from disk format
     DiskFormat format = disk->getFormat();
@@ -54,6 +56,17 @@ std::unique_ptr<FileSystemHandler> FileSystemHandler::create(DiskImage* disk) {
         }
     }
 
+    // Apple block devices hold ProDOS volumes only
+    if (format == DiskFormat::AppleHDV) {
+        if (disk->getFileSystemType() == FileSystemType::ProDOS) {
+            auto prodos = std::make_unique<AppleProDOSHandler>();
+            if (prodos->initialize(disk)) {
+                return prodos;
+            }
+        }
+        return nullptr;
+    }
+
     // X68000 disk formats
     if (format == DiskFormat::X68000XDF || format == DiskFormat::X68000DIM) {
         auto handler = std::make_unique<Human68kHandler>();
@@ -88,6 +101,21 @@ ValidationResult FileSystemHandler::validateExtended() const {
     return result;
 }
 
+bool FileSystemHandler::appendSectorExtent(std::vector<std::pair<size_t, size_t>>& extents,
+                                           size_t track, size_t side, size_t sector,
+                                           size_t length) const {
+    const auto offset = m_disk ? m_disk->sectorOffset(track, side, sector) : std::nullopt;
+    if (!offset) {
+        return false;
+    }
+    if (!extents.empty() && extents.back().first + extents.back().second == *offset) {
+        extents.back().second += length;
+    } else {
+        extents.emplace_back(*offset, length);
+    }
+    return true;
+}
+
 std::unique_ptr<FileSystemHandler> FileSystemHandler::createForType(FileSystemType type) {
     switch (type) {
         case FileSystemType::MSXDOS1:
@@ -19,6 +19,62 @@
 
 namespace rde {
 
+namespace {
+
+constexpr size_t TS_PAIRS_PER_SECTOR = 122;
+
+int popcount16(uint16_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(value);
+#else
+    int count = 0;
+    while (value) {
+        value &= value - 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Index of the lowest set bit; value must be non-zero
+int lowestSetBit(uint16_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(value);
+#else
+    int index = 0;
+    while (!(value & 1)) {
+        value >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// Sector s of a track lives at bit (15 - s) % 8 of bitmap byte (15 - s) / 8
+uint16_t decodeTrackBitmap(uint8_t byte0, uint8_t byte1) {
+    const uint8_t bytes[2] = {byte0, byte1};
+    uint16_t mask = 0;
+    for (int s = 0; s < 16; ++s) {
+        if (bytes[(15 - s) / 8] & (1 << ((15 - s) % 8))) {
+            mask |= static_cast<uint16_t>(1u << s);
+        }
+    }
+    return mask;
+}
+
+void encodeTrackBitmap(uint16_t mask, uint8_t& byte0, uint8_t& byte1) {
+    uint8_t bytes[2] = {0, 0};
+    for (int s = 0; s < 16; ++s) {
+        if (mask & (1u << s)) {
+            bytes[(15 - s) / 8] |= static_cast<uint8_t>(1 << ((15 - s) % 8));
+        }
+    }
+    byte0 = bytes[0];
+    byte1 = bytes[1];
+}
+
+} // namespace
+
 AppleDOS33Handler::AppleDOS33Handler() = default;
 
 FileSystemType AppleDOS33Handler::getType() const {
@@ -30,6 +86,7 @@ bool AppleDOS33Handler::initialize(DiskImage* disk) {
         return false;
     }
     m_disk = disk;
+    invalidateCatalogCache();
     return parseVTOC();
 }
 
@@ -64,15 +121,16 @@ bool AppleDOS33Handler::parseVTOC() {
         m_vtoc.bytesPerSector = 256;
     }
 
-    // Read track bitmap (4 bytes per track, starting at offset 0x38)
+    // Read track bitmap (4 bytes per track, starting at offset 0x38) into
+    // one mask per track with bit n set when sector n is free
+    std::fill(std::begin(m_vtoc.trackFreeMask), std::end(m_vtoc.trackFreeMask), 0);
     for (size_t t = 0; t < MAX_TRACKS && t < m_vtoc.tracksPerDisk; ++t) {
         size_t offset = 0x38 + (t * 4);
         if (offset + 4 <= vtocData.size()) {
-            for (int i = 0; i < 4; ++i) {
-                m_vtoc.trackBitmap[t][i] = vtocData[offset + i];
-            }
+            m_vtoc.trackFreeMask[t] = decodeTrackBitmap(vtocData[offset], vtocData[offset + 1]);
         }
     }
+    recountFreeSectors();
 
     return true;
 }
@@ -96,9 +154,7 @@ void AppleDOS33Handler::writeVTOC() {
     // Write track bitmap
     for (size_t t = 0; t < MAX_TRACKS && t < m_vtoc.tracksPerDisk; ++t) {
         size_t offset = 0x38 + (t * 4);
-        for (int i = 0; i < 4; ++i) {
-            vtocData[offset + i] = m_vtoc.trackBitmap[t][i];
-        }
+        encodeTrackBitmap(m_vtoc.trackFreeMask[t], vtocData[offset], vtocData[offset + 1]);
     }
 
     writeSector(VTOC_TRACK, VTOC_SECTOR, vtocData);
@@ -120,7 +176,8 @@ void AppleDOS33Handler::writeSector(size_t track, size_t sector, const std::vect
     m_disk->writeSector(track, 0, sector, data);
 }
 
-std::vector<AppleDOS33Handler::CatalogEntry> AppleDOS33Handler::readCatalog() const {
+std::vector<AppleDOS33Handler::CatalogEntry> AppleDOS33Handler::readCatalog(
+        std::vector<CatalogSlot>* freeSlots) const {
     std::vector<CatalogEntry> entries;
 
     uint8_t catTrack = m_vtoc.firstCatalogTrack;
@@ -150,6 +207,15 @@ std::vector<AppleDOS33Handler::CatalogEntry> AppleDOS33Handler::readCatalog() co
             std::memcpy(entry.filename, &sectorData[offset + 3], 30);
             entry.sectorCount = sectorData[offset + 33] |
                                (static_cast<uint16_t>(sectorData[offset + 34]) << 8);
+            entry.catalogTrack = catTrack;
+            entry.catalogSector = catSector;
+            entry.catalogSlot = static_cast<uint8_t>(i);
+
+            // Never-used (T/S track 0) and deleted slots can take a new file
+            if (freeSlots && (entry.trackSectorListTrack == 0 ||
+                              entry.trackSectorListTrack == FLAG_DELETED)) {
+                freeSlots->push_back({catTrack, catSector, static_cast<uint8_t>(i)});
+            }
 
             // Skip empty entries
             if (entry.trackSectorListTrack != 0 || entry.fileType != 0) {
@@ -184,38 +250,52 @@ void AppleDOS33Handler::writeCatalogEntry(size_t track, size_t sector, size_t en
     sectorData[offset + 34] = (entry.sectorCount >> 8) & 0xFF;
 
     writeSector(track, sector, sectorData);
+    invalidateCatalogCache();
 }
 
-int AppleDOS33Handler::findCatalogEntry(const std::string& filename) const {
-    char searchName[30];
-    parseFilename(filename, searchName);
+std::string AppleDOS33Handler::catalogKey(const char* name) {
+    // Filenames compare with the high bit ignored
+    std::string key(name, 30);
+    for (char& c : key) {
+        c &= 0x7F;
+    }
+    return key;
+}
+
+const AppleDOS33Handler::CatalogCache& AppleDOS33Handler::getCachedCatalog() const {
+    if (m_catalogCacheValid) {
+        return m_catalogCache;
+    }
 
-    auto entries = readCatalog();
-    for (size_t i = 0; i < entries.size(); ++i) {
+    m_catalogCache.freeSlots.clear();
+    m_catalogCache.index.clear();
+    m_catalogCache.entries = readCatalog(&m_catalogCache.freeSlots);
+
+    // Index live entries; the first match in chain order wins
+    for (size_t i = 0; i < m_catalogCache.entries.size(); ++i) {
+        const auto& entry = m_catalogCache.entries[i];
         // Skip deleted entries (DOS 3.3: trackSectorListTrack is set to 0xFF)
-        if (entries[i].trackSectorListTrack == FLAG_DELETED) {
+        if (entry.trackSectorListTrack == FLAG_DELETED) {
             continue;
         }
-
-        // Compare filenames (ignore high bit)
-        bool match = true;
-        for (int j = 0; j < 30; ++j) {
-            char c1 = searchName[j] & 0x7F;
-            char c2 = entries[i].filename[j] & 0x7F;
-            if (c1 != c2) {
-                match = false;
-                break;
-            }
-        }
-        if (match) {
-            return static_cast<int>(i);
-        }
+        m_catalogCache.index.emplace(catalogKey(entry.filename), static_cast<int>(i));
     }
 
-    return -1;
+    m_catalogCacheValid = true;
+    return m_catalogCache;
+}
+
+int AppleDOS33Handler::findCatalogEntry(const std::string& filename) const {
+    char searchName[30];
+    parseFilename(filename, searchName);
+
+    const auto& catalog = getCachedCatalog();
+    auto it = catalog.index.find(catalogKey(searchName));
+    return it != catalog.index.end() ? it->second : -1;
 }
 
-std::vector<AppleDOS33Handler::TSPair> AppleDOS33Handler::readTSList(uint8_t track, uint8_t sector) const {
+std::vector<AppleDOS33Handler::TSPair> AppleDOS33Handler::readTSList(
+        uint8_t track, uint8_t sector, std::vector<TSPair>* listSectors) const {
     std::vector<TSPair> pairs;
 
     while (track != 0 || sector != 0) {
@@ -223,13 +303,16 @@ std::vector<AppleDOS33Handler::TSPair> AppleDOS33Handler::readTSList(uint8_t tra
         if (sectorData.size() < SECTOR_SIZE) {
             break;
         }
+        if (listSectors) {
+            listSectors->push_back({track, sector});
+        }
 
         // Get next T/S list sector
         uint8_t nextTrack = sectorData[0x01];
         uint8_t nextSector = sectorData[0x02];
 
         // Read T/S pairs (up to 122 pairs per sector, starting at offset 0x0C)
-        for (size_t i = 0; i < 122; ++i) {
+        for (size_t i = 0; i < TS_PAIRS_PER_SECTOR; ++i) {
             size_t offset = 0x0C + (i * 2);
             if (offset + 2 > sectorData.size()) {
                 break;
@@ -252,30 +335,26 @@ std::vector<AppleDOS33Handler::TSPair> AppleDOS33Handler::readTSList(uint8_t tra
     return pairs;
 }
 
-void AppleDOS33Handler::writeTSList(uint8_t track, uint8_t sector, const std::vector<TSPair>& pairs) {
-    std::vector<uint8_t> sectorData(SECTOR_SIZE, 0);
-
-    // Write T/S pairs (up to 122 pairs per sector)
-    size_t pairIndex = 0;
-    for (size_t i = 0; i < 122 && pairIndex < pairs.size(); ++i, ++pairIndex) {
-        size_t offset = 0x0C + (i * 2);
-        sectorData[offset] = pairs[pairIndex].track;
-        sectorData[offset + 1] = pairs[pairIndex].sector;
-    }
+void AppleDOS33Handler::writeTSList(const std::vector<TSPair>& listSectors,
+                                    const std::vector<TSPair>& pairs) {
+    // Each T/S list sector holds up to 122 pairs and links to the next
+    for (size_t i = 0; i < listSectors.size(); ++i) {
+        std::vector<uint8_t> sectorData(SECTOR_SIZE, 0);
 
-    // If more pairs needed, allocate next T/S list sector
-    if (pairIndex < pairs.size()) {
-        TSPair nextTSList = allocateSector();
-        sectorData[0x01] = nextTSList.track;
-        sectorData[0x02] = nextTSList.sector;
+        if (i + 1 < listSectors.size()) {
+            sectorData[0x01] = listSectors[i + 1].track;
+            sectorData[0x02] = listSectors[i + 1].sector;
+        }
 
-        writeSector(track, sector, sectorData);
+        size_t first = i * TS_PAIRS_PER_SECTOR;
+        size_t last = std::min(first + TS_PAIRS_PER_SECTOR, pairs.size());
+        for (size_t p = first; p < last; ++p) {
+            size_t offset = 0x0C + ((p - first) * 2);
+            sectorData[offset] = pairs[p].track;
+            sectorData[offset + 1] = pairs[p].sector;
+        }
 
-        // Write remaining pairs to next sector
-        std::vector<TSPair> remaining(pairs.begin() + pairIndex, pairs.end());
-        writeTSList(nextTSList.track, nextTSList.sector, remaining);
-    } else {
-        writeSector(track, sector, sectorData);
+        writeSector(listSectors[i].track, listSectors[i].sector, sectorData);
     }
 }
 
@@ -284,92 +363,100 @@ bool AppleDOS33Handler::isSectorFree(size_t track, size_t sector) const {
         return false;
     }
 
-    // Bitmap: bytes 0-1 contain sector bits
     // Bit = 1 means free, bit = 0 means used
-    // Sector 15 = bit 7 of byte 0, sector 0 = bit 0 of byte 1
-    int byteIndex = (15 - sector) / 8;
-    int bitIndex = (15 - sector) % 8;
-
-    return (m_vtoc.trackBitmap[track][byteIndex] & (1 << bitIndex)) != 0;
+    return (m_vtoc.trackFreeMask[track] & (1u << sector)) != 0;
 }
 
 void AppleDOS33Handler::markSectorUsed(size_t track, size_t sector) {
-    if (track >= MAX_TRACKS || sector >= 16) {
+    if (!isSectorFree(track, sector)) {
         return;
     }
 
-    int byteIndex = (15 - sector) / 8;
-    int bitIndex = (15 - sector) % 8;
-
-    m_vtoc.trackBitmap[track][byteIndex] &= ~(1 << bitIndex);
+    m_vtoc.trackFreeMask[track] &= static_cast<uint16_t>(~(1u << sector));
+    if (isAllocatableTrack(track) && (sectorMask() & (1u << sector))) {
+        --m_freeSectorCount;
+    }
 }
 
 void AppleDOS33Handler::markSectorFree(size_t track, size_t sector) {
-    if (track >= MAX_TRACKS || sector >= 16) {
+    if (track >= MAX_TRACKS || sector >= 16 || isSectorFree(track, sector)) {
         return;
     }
 
-    int byteIndex = (15 - sector) / 8;
-    int bitIndex = (15 - sector) % 8;
+    m_vtoc.trackFreeMask[track] |= static_cast<uint16_t>(1u << sector);
+    if (isAllocatableTrack(track) && (sectorMask() & (1u << sector))) {
+        ++m_freeSectorCount;
+    }
+}
 
-    m_vtoc.trackBitmap[track][byteIndex] |= (1 << bitIndex);
+bool AppleDOS33Handler::isAllocatableTrack(size_t track) const {
+    // Track 0 (DOS) and the VTOC/catalog track are never allocated
+    return track != 0 && track != VTOC_TRACK &&
+           track < m_vtoc.tracksPerDisk && track < MAX_TRACKS;
 }
 
-AppleDOS33Handler::TSPair AppleDOS33Handler::allocateSector() {
-    // Allocation follows the direction in VTOC
-    int track = m_vtoc.lastTrackAllocated;
-    int direction = m_vtoc.allocationDirection;
-
-    // Search for free sector
-    for (int t = 0; t < static_cast<int>(m_vtoc.tracksPerDisk); ++t) {
-        // Skip track 0 and VTOC track
-        if (track == 0 || track == static_cast<int>(VTOC_TRACK)) {
-            track += direction;
-            if (track < 0) track = m_vtoc.tracksPerDisk - 1;
-            if (track >= static_cast<int>(m_vtoc.tracksPerDisk)) track = 1;
-            continue;
+uint16_t AppleDOS33Handler::sectorMask() const {
+    if (m_vtoc.sectorsPerTrack >= 16) {
+        return 0xFFFF;
+    }
+    return static_cast<uint16_t>((1u << m_vtoc.sectorsPerTrack) - 1);
+}
+
+void AppleDOS33Handler::recountFreeSectors() {
+    m_freeSectorCount = 0;
+    for (size_t t = 0; t < m_vtoc.tracksPerDisk && t < MAX_TRACKS; ++t) {
+        if (isAllocatableTrack(t)) {
+            m_freeSectorCount += popcount16(m_vtoc.trackFreeMask[t] & sectorMask());
         }
+    }
+}
 
-        for (int s = 0; s < static_cast<int>(m_vtoc.sectorsPerTrack); ++s) {
-            if (isSectorFree(track, s)) {
+std::vector<AppleDOS33Handler::TSPair> AppleDOS33Handler::allocateSectors(size_t count) {
+    std::vector<TSPair> sectors;
+    if (count == 0 || count > m_freeSectorCount) {
+        return sectors;
+    }
+    sectors.reserve(count);
+
+    // Start at the last allocated track and follow the VTOC direction,
+    // wrapping past the last track back to track 1
+    const int tracks = static_cast<int>(m_vtoc.tracksPerDisk);
+    const int direction = m_vtoc.allocationDirection < 0 ? -1 : 1;
+    int track = m_vtoc.lastTrackAllocated < tracks ? m_vtoc.lastTrackAllocated : 1;
+
+    for (int visited = 0; visited < tracks && sectors.size() < count; ++visited) {
+        uint16_t mask = isAllocatableTrack(track)
+                            ? static_cast<uint16_t>(m_vtoc.trackFreeMask[track] & sectorMask())
+                            : 0;
+        if (mask) {
+            // Take the track's free sectors lowest first
+            while (mask && sectors.size() < count) {
+                int s = lowestSetBit(mask);
+                mask &= static_cast<uint16_t>(mask - 1);
                 markSectorUsed(track, s);
-                m_vtoc.lastTrackAllocated = track;
-                return {static_cast<uint8_t>(track), static_cast<uint8_t>(s)};
+                sectors.push_back({static_cast<uint8_t>(track), static_cast<uint8_t>(s)});
             }
+            m_vtoc.lastTrackAllocated = static_cast<uint8_t>(track);
         }
 
         track += direction;
         if (track < 0) {
-            track = m_vtoc.tracksPerDisk - 1;
-            direction = -1;
+            track = tracks - 1;
         }
-        if (track >= static_cast<int>(m_vtoc.tracksPerDisk)) {
+        if (track >= tracks) {
             track = 1;
-            direction = 1;
         }
     }
 
-    // No free sectors
-    return {0, 0};
-}
-
-size_t AppleDOS33Handler::countFreeSectors() const {
-    size_t count = 0;
-
-    for (size_t t = 0; t < m_vtoc.tracksPerDisk; ++t) {
-        // Skip track 0 (DOS) and track 17 (catalog)
-        if (t == 0 || t == VTOC_TRACK) {
-            continue;
-        }
-
-        for (size_t s = 0; s < m_vtoc.sectorsPerTrack; ++s) {
-            if (isSectorFree(t, s)) {
-                ++count;
-            }
+    if (sectors.size() < count) {
+        // Free map and count disagree; give everything back
+        for (const auto& ts : sectors) {
+            markSectorFree(ts.track, ts.sector);
         }
+        sectors.clear();
     }
 
-    return count;
+    return sectors;
 }
 
 std::string AppleDOS33Handler::formatFilename(const char* name) const {
@@ -433,7 +520,7 @@ FileEntry AppleDOS33Handler::catalogEntryToFileEntry(const CatalogEntry& entry)
 
 std::vector<FileEntry> AppleDOS33Handler::listFiles(const std::string& /*path*/) {
     std::vector<FileEntry> files;
-    auto entries = readCatalog();
+    const auto& entries = getCachedCatalog().entries;
 
     for (const auto& entry : entries) {
         // Skip deleted entries (DOS 3.3: trackSectorListTrack is set to 0xFF)
@@ -451,14 +538,34 @@ std::vector<FileEntry> AppleDOS33Handler::listFiles(const std::string& /*path*/)
     return files;
 }
 
+bool AppleDOS33Handler::getFileExtents(const std::string& filename,
+                                       std::vector<std::pair<size_t, size_t>>& extents) {
+    int index = findCatalogEntry(filename);
+    if (index < 0) {
+        throw FileNotFoundException(filename);
+    }
+
+    const CatalogEntry& entry = getCachedCatalog().entries[index];
+    std::vector<TSPair> sectors;
+    auto tsList = readTSList(entry.trackSectorListTrack, entry.trackSectorListSector, &sectors);
+    sectors.insert(sectors.end(), tsList.begin(), tsList.end());
+
+    extents.clear();
+    for (const auto& ts : sectors) {
+        if (!appendSectorExtent(extents, ts.track, 0, ts.sector, SECTOR_SIZE)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 std::vector<uint8_t> AppleDOS33Handler::readFile(const std::string& filename) {
     int index = findCatalogEntry(filename);
     if (index < 0) {
         throw FileNotFoundException(filename);
     }
 
-    auto entries = readCatalog();
-    const auto& entry = entries[index];
+    const CatalogEntry entry = getCachedCatalog().entries[index];
 
     // Read T/S list
     auto tsList = readTSList(entry.trackSectorListTrack, entry.trackSectorListSector);
@@ -582,26 +689,15 @@ bool AppleDOS33Handler::writeFile(const std::string& filename,
         sectorsNeeded = 1;
     }
 
-    // Allocate T/S list sector
-    TSPair tsListSector = allocateSector();
-    if (tsListSector.track == 0 && tsListSector.sector == 0) {
+    // Allocate the T/S list sectors and the data sectors in one pass, so
+    // the file stays track-contiguous
+    size_t tsListSectors = (sectorsNeeded + TS_PAIRS_PER_SECTOR - 1) / TS_PAIRS_PER_SECTOR;
+    auto sectors = allocateSectors(tsListSectors + sectorsNeeded);
+    if (sectors.empty()) {
         return false; // Disk full
     }
-
-    // Allocate data sectors
-    std::vector<TSPair> dataSectors;
-    for (size_t i = 0; i < sectorsNeeded; ++i) {
-        TSPair sector = allocateSector();
-        if (sector.track == 0 && sector.sector == 0) {
-            // Disk full - free allocated sectors
-            for (const auto& s : dataSectors) {
-                markSectorFree(s.track, s.sector);
-            }
-            markSectorFree(tsListSector.track, tsListSector.sector);
-            return false;
-        }
-        dataSectors.push_back(sector);
-    }
+    std::vector<TSPair> listSectors(sectors.begin(), sectors.begin() + tsListSectors);
+    std::vector<TSPair> dataSectors(sectors.begin() + tsListSectors, sectors.end());
 
     // Write data sectors
     size_t offset = 0;
@@ -616,53 +712,32 @@ bool AppleDOS33Handler::writeFile(const std::string& filename,
     }
 
     // Write T/S list
-    writeTSList(tsListSector.track, tsListSector.sector, dataSectors);
+    writeTSList(listSectors, dataSectors);
 
-    // Find free catalog entry
-    uint8_t catTrack = m_vtoc.firstCatalogTrack;
-    uint8_t catSector = m_vtoc.firstCatalogSector;
+    // Take the first free (tsTrack == 0) or deleted (tsTrack == 0xFF)
+    // catalog slot in chain order
+    const auto& freeSlots = getCachedCatalog().freeSlots;
     bool entryWritten = false;
 
-    while (!entryWritten && (catTrack != 0 || catSector != 0)) {
-        auto sectorData = readSector(catTrack, catSector);
-        if (sectorData.size() < SECTOR_SIZE) {
-            break;
-        }
-
-        uint8_t nextTrack = sectorData[0x01];
-        uint8_t nextSector = sectorData[0x02];
+    if (!freeSlots.empty()) {
+        const CatalogSlot slot = freeSlots.front();
 
-        for (size_t i = 0; i < ENTRIES_PER_SECTOR; ++i) {
-            size_t entryOffset = 0x0B + (i * DIR_ENTRY_SIZE);
-            uint8_t tsTrack = sectorData[entryOffset];
-
-            // Check for free (tsTrack == 0) or deleted (tsTrack == 0xFF) entry
-            if (tsTrack == 0 || tsTrack == FLAG_DELETED) {
-                CatalogEntry newEntry;
-                newEntry.trackSectorListTrack = tsListSector.track;
-                newEntry.trackSectorListSector = tsListSector.sector;
-                newEntry.fileType = fileType;
-                parseFilename(filename, newEntry.filename);
-                // Calculate T/S list sectors: each can hold 122 data sector pairs
-                size_t tsListSectors = (sectorsNeeded + 121) / 122;
-                newEntry.sectorCount = static_cast<uint16_t>(sectorsNeeded + tsListSectors);
-
-                writeCatalogEntry(catTrack, catSector, i, newEntry);
-                entryWritten = true;
-                break;
-            }
-        }
+        CatalogEntry newEntry;
+        newEntry.trackSectorListTrack = listSectors.front().track;
+        newEntry.trackSectorListSector = listSectors.front().sector;
+        newEntry.fileType = fileType;
+        parseFilename(filename, newEntry.filename);
+        newEntry.sectorCount = static_cast<uint16_t>(sectorsNeeded + tsListSectors);
 
-        catTrack = nextTrack;
-        catSector = nextSector;
+        writeCatalogEntry(slot.track, slot.sector, slot.slot, newEntry);
+        entryWritten = true;
     }
 
     if (!entryWritten) {
         // No free catalog entries - free all allocated sectors
-        for (const auto& s : dataSectors) {
-            markSectorFree(s.track, s.sector);
+        for (const auto& ts : sectors) {
+            markSectorFree(ts.track, ts.sector);
         }
-        markSectorFree(tsListSector.track, tsListSector.sector);
         return false;
     }
 
@@ -678,8 +753,7 @@ bool AppleDOS33Handler::deleteFile(const std::string& filename) {
         return false;
     }
 
-    auto entries = readCatalog();
-    const auto& entry = entries[index];
+    const CatalogEntry entry = getCachedCatalog().entries[index];
 
     // Free T/S list sectors and data sectors
     uint8_t tsTrack = entry.trackSectorListTrack;
@@ -695,7 +769,7 @@ bool AppleDOS33Handler::deleteFile(const std::string& filename) {
         uint8_t nextSector = sectorData[0x02];
 
         // Free data sectors in this T/S list
-        for (size_t i = 0; i < 122; ++i) {
+        for (size_t i = 0; i < TS_PAIRS_PER_SECTOR; ++i) {
             size_t offset = 0x0C + (i * 2);
             uint8_t dataTrack = sectorData[offset];
             uint8_t dataSector = sectorData[offset + 1];
@@ -713,47 +787,24 @@ bool AppleDOS33Handler::deleteFile(const std::string& filename) {
     }
 
     // Mark catalog entry as deleted
-    uint8_t catTrack = m_vtoc.firstCatalogTrack;
-    uint8_t catSector = m_vtoc.firstCatalogSector;
-    int entryCount = 0;
-
-    while (catTrack != 0 || catSector != 0) {
-        auto sectorData = readSector(catTrack, catSector);
-        if (sectorData.size() < SECTOR_SIZE) {
-            break;
-        }
-
-        uint8_t nextTrack = sectorData[0x01];
-        uint8_t nextSector = sectorData[0x02];
-
-        for (size_t i = 0; i < ENTRIES_PER_SECTOR; ++i) {
-            if (entryCount == index) {
-                // Found the entry - mark as deleted
-                // DOS 3.3 standard deletion:
-                // - offset+0 (T/S list track): Set to 0xFF to mark as deleted
-                // - offset+3 (first char of filename): Store original T/S track for recovery
-                size_t offset = 0x0B + (i * DIR_ENTRY_SIZE);
-                sectorData[offset + 3] = entry.trackSectorListTrack;  // Save T/S track for recovery
-                sectorData[offset] = FLAG_DELETED;  // Mark entry as deleted (0xFF)
-                sectorData[offset + 1] = 0;  // Clear T/S list sector
-                writeSector(catTrack, catSector, sectorData);
-
-                // Write updated VTOC
-                writeVTOC();
-                return true;
-            }
-
-            size_t entryOffset = 0x0B + (i * DIR_ENTRY_SIZE);
-            if (sectorData[entryOffset] != 0 || sectorData[entryOffset + 2] != 0) {
-                ++entryCount;
-            }
-        }
-
-        catTrack = nextTrack;
-        catSector = nextSector;
+    auto sectorData = readSector(entry.catalogTrack, entry.catalogSector);
+    if (sectorData.size() < SECTOR_SIZE) {
+        return false;
     }
 
-    return false;
+    // DOS 3.3 standard deletion:
+    // - offset+0 (T/S list track): Set to 0xFF to mark as deleted
+    // - offset+3 (first char of filename): Store original T/S track for recovery
+    size_t offset = 0x0B + (entry.catalogSlot * DIR_ENTRY_SIZE);
+    sectorData[offset + 3] = entry.trackSectorListTrack;  // Save T/S track for recovery
+    sectorData[offset] = FLAG_DELETED;  // Mark entry as deleted (0xFF)
+    sectorData[offset + 1] = 0;  // Clear T/S list sector
+    writeSector(entry.catalogTrack, entry.catalogSector, sectorData);
+    invalidateCatalogCache();
+
+    // Write updated VTOC
+    writeVTOC();
+    return true;
 }
 
 bool AppleDOS33Handler::renameFile(const std::string& oldName, const std::string& newName) {
@@ -767,40 +818,23 @@ bool AppleDOS33Handler::renameFile(const std::string& oldName, const std::string
         return false;
     }
 
-    // Find and update the catalog entry
-    uint8_t catTrack = m_vtoc.firstCatalogTrack;
-    uint8_t catSector = m_vtoc.firstCatalogSector;
-    int entryCount = 0;
-
-    while (catTrack != 0 || catSector != 0) {
-        auto sectorData = readSector(catTrack, catSector);
-        if (sectorData.size() < SECTOR_SIZE) {
-            break;
-        }
-
-        uint8_t nextTrack = sectorData[0x01];
-        uint8_t nextSector = sectorData[0x02];
+    // Update the filename in place
+    const CatalogEntry& entry = getCachedCatalog().entries[index];
+    const uint8_t catTrack = entry.catalogTrack;
+    const uint8_t catSector = entry.catalogSector;
+    const size_t entryOffset = 0x0B + (entry.catalogSlot * DIR_ENTRY_SIZE);
 
-        for (size_t i = 0; i < ENTRIES_PER_SECTOR; ++i) {
-            size_t entryOffset = 0x0B + (i * DIR_ENTRY_SIZE);
-            if (sectorData[entryOffset] != 0 || sectorData[entryOffset + 2] != 0) {
-                if (entryCount == index) {
-                    // Found the entry - update filename
-                    char newFilename[30];
-                    parseFilename(newName, newFilename);
-                    std::memcpy(&sectorData[entryOffset + 3], newFilename, 30);
-                    writeSector(catTrack, catSector, sectorData);
-                    return true;
-                }
-                ++entryCount;
-            }
-        }
-
-        catTrack = nextTrack;
-        catSector = nextSector;
+    auto sectorData = readSector(catTrack, catSector);
+    if (sectorData.size() < SECTOR_SIZE) {
+        return false;
     }
 
-    return false;
+    char newFilename[30];
+    parseFilename(newName, newFilename);
+    std::memcpy(&sectorData[entryOffset + 3], newFilename, 30);
+    writeSector(catTrack, catSector, sectorData);
+    invalidateCatalogCache();
+    return true;
 }
 
 size_t AppleDOS33Handler::getFreeSpace() const {
@@ -840,20 +874,13 @@ bool AppleDOS33Handler::format(const std::string& /*volumeName*/) {
     // Initialize track bitmap - all sectors free except track 0 and 17
     for (size_t t = 0; t < MAX_TRACKS; ++t) {
         if (t < m_vtoc.tracksPerDisk) {
-            if (t == 0 || t == VTOC_TRACK) {
-                // Track 0 (DOS) and track 17 (catalog) are used
-                m_vtoc.trackBitmap[t][0] = 0x00;
-                m_vtoc.trackBitmap[t][1] = 0x00;
-            } else {
-                // All sectors free
-                m_vtoc.trackBitmap[t][0] = 0xFF;
-                m_vtoc.trackBitmap[t][1] = 0xFF;
-            }
-            m_vtoc.trackBitmap[t][2] = 0x00;
-            m_vtoc.trackBitmap[t][3] = 0x00;
+            // Track 0 (DOS) and track 17 (catalog) are used, the rest free
+            m_vtoc.trackFreeMask[t] = (t == 0 || t == VTOC_TRACK) ? 0x0000 : 0xFFFF;
         }
     }
 
+    recountFreeSectors();
+
     // Write VTOC
     writeVTOC();
 
@@ -870,6 +897,7 @@ bool AppleDOS33Handler::format(const std::string& /*volumeName*/) {
         writeSector(CATALOG_TRACK, s, catSector);
     }
 
+    invalidateCatalogCache();
     return true;
 }
 
@@ -17,6 +17,7 @@
 
 #include "rdedisktool/filesystem/AppleProDOSHandler.h"
 #include "rdedisktool/Exceptions.h"
+#include "rdedisktool/apple/AppleDiskImage.h"
 #include "rdedisktool/utils/BinaryReader.h"
 #include <algorithm>
 #include <cstring>
@@ -27,6 +28,48 @@
 
 namespace rde {
 
+namespace {
+
+constexpr size_t BITS_PER_WORD = 64;
+
+int popcount64(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(value);
+#else
+    int count = 0;
+    while (value) {
+        value &= value - 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Index of the lowest set bit; value must be non-zero
+int lowestSetBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(value);
+#else
+    int index = 0;
+    while (!(value & 1)) {
+        value >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// The on-disk bitmap is MSB-first within each byte; the packed words are
+// LSB-first so that bit n of the word is block (word * 64 + n)
+uint8_t reverseBits(uint8_t b) {
+    b = static_cast<uint8_t>(((b & 0xF0) >> 4) | ((b & 0x0F) << 4));
+    b = static_cast<uint8_t>(((b & 0xCC) >> 2) | ((b & 0x33) << 2));
+    b = static_cast<uint8_t>(((b & 0xAA) >> 1) | ((b & 0x55) << 1));
+    return b;
+}
+
+} // namespace
+
 AppleProDOSHandler::AppleProDOSHandler() {
     std::memset(&m_volumeHeader, 0, sizeof(m_volumeHeader));
 }
@@ -56,15 +99,26 @@ bool AppleProDOSHandler::initialize(DiskImage* disk) {
 // Block I/O
 //=============================================================================
 
+size_t AppleProDOSHandler::deviceBlocks() const {
+    if (!m_disk) {
+        return 0;
+    }
+    return std::min(m_disk->getTotalBlocks(), MAX_VOLUME_BLOCKS);
+}
+
+size_t AppleProDOSHandler::bitmapBlockCount() const {
+    return (m_volumeHeader.totalBlocks + BLOCKS_PER_BITMAP_BLOCK - 1) / BLOCKS_PER_BITMAP_BLOCK;
+}
+
 std::vector<uint8_t> AppleProDOSHandler::readBlock(size_t block) const {
-    if (!m_disk || block >= TOTAL_BLOCKS) {
+    if (!m_disk || block >= deviceBlocks()) {
         return {};
     }
     return m_disk->readBlock(block);
 }
 
 void AppleProDOSHandler::writeBlock(size_t block, const std::vector<uint8_t>& data) {
-    if (!m_disk || block >= TOTAL_BLOCKS) {
+    if (!m_disk || block >= deviceBlocks()) {
         return;
     }
     std::vector<uint8_t> blockData = data;
@@ -124,8 +178,8 @@ bool AppleProDOSHandler::parseVolumeHeader() {
     if (m_volumeHeader.entriesPerBlock == 0) {
         m_volumeHeader.entriesPerBlock = ENTRIES_PER_BLOCK;
     }
-    if (m_volumeHeader.totalBlocks == 0) {
-        m_volumeHeader.totalBlocks = TOTAL_BLOCKS;
+    if (m_volumeHeader.totalBlocks == 0 || m_volumeHeader.totalBlocks > deviceBlocks()) {
+        m_volumeHeader.totalBlocks = static_cast<uint16_t>(deviceBlocks());
     }
     if (m_volumeHeader.bitmapPointer == 0) {
         m_volumeHeader.bitmapPointer = BITMAP_BLOCK;
@@ -168,12 +222,10 @@ void AppleProDOSHandler::writeVolumeHeader() {
 //=============================================================================
 
 bool AppleProDOSHandler::parseVolumeBitmap() {
-    m_bitmap.clear();
-    m_bitmap.resize(m_volumeHeader.totalBlocks, false);
+    resetBitmap(m_volumeHeader.totalBlocks, false);
 
-    // Calculate number of bitmap blocks needed
-    size_t bitsNeeded = m_volumeHeader.totalBlocks;
-    size_t blocksNeeded = (bitsNeeded + (BLOCK_SIZE * 8) - 1) / (BLOCK_SIZE * 8);
+    size_t blocksNeeded = bitmapBlockCount();
+    size_t bytesNeeded = (m_volumeHeader.totalBlocks + 7) / 8;
 
     for (size_t i = 0; i < blocksNeeded; ++i) {
         auto block = readBlock(m_volumeHeader.bitmapPointer + i);
@@ -181,36 +233,37 @@ bool AppleProDOSHandler::parseVolumeBitmap() {
             return false;
         }
 
+        // In ProDOS bitmap, 1 = free, 0 = used
         for (size_t byte = 0; byte < BLOCK_SIZE; ++byte) {
-            for (int bit = 7; bit >= 0; --bit) {
-                size_t blockNum = i * BLOCK_SIZE * 8 + byte * 8 + (7 - bit);
-                if (blockNum < m_volumeHeader.totalBlocks) {
-                    // In ProDOS bitmap, 1 = free, 0 = used
-                    m_bitmap[blockNum] = (block[byte] & (1 << bit)) != 0;
-                }
+            size_t byteNum = i * BLOCK_SIZE + byte;
+            if (byteNum >= bytesNeeded) {
+                break;
             }
+            m_bitmap[byteNum / 8] |= static_cast<uint64_t>(reverseBits(block[byte]))
+                                     << ((byteNum % 8) * 8);
         }
     }
 
+    // Clear bits past the last block
+    if (m_bitmapBlocks % BITS_PER_WORD) {
+        m_bitmap.back() &= (uint64_t(1) << (m_bitmapBlocks % BITS_PER_WORD)) - 1;
+    }
+
     return true;
 }
 
 void AppleProDOSHandler::writeVolumeBitmap() {
-    size_t bitsNeeded = m_volumeHeader.totalBlocks;
-    size_t blocksNeeded = (bitsNeeded + (BLOCK_SIZE * 8) - 1) / (BLOCK_SIZE * 8);
+    size_t blocksNeeded = bitmapBlockCount();
 
     for (size_t i = 0; i < blocksNeeded; ++i) {
         std::vector<uint8_t> block(BLOCK_SIZE, 0);
 
         for (size_t byte = 0; byte < BLOCK_SIZE; ++byte) {
-            uint8_t value = 0;
-            for (int bit = 7; bit >= 0; --bit) {
-                size_t blockNum = i * BLOCK_SIZE * 8 + byte * 8 + (7 - bit);
-                if (blockNum < m_volumeHeader.totalBlocks && m_bitmap[blockNum]) {
-                    value |= (1 << bit);
-                }
+            size_t byteNum = i * BLOCK_SIZE + byte;
+            if (byteNum / 8 >= m_bitmap.size()) {
+                break;
             }
-            block[byte] = value;
+            block[byte] = reverseBits(static_cast<uint8_t>(m_bitmap[byteNum / 8] >> ((byteNum % 8) * 8)));
         }
 
         writeBlock(m_volumeHeader.bitmapPointer + i, block);
@@ -218,41 +271,115 @@ void AppleProDOSHandler::writeVolumeBitmap() {
 }
 
 bool AppleProDOSHandler::isBlockFree(size_t block) const {
-    if (block >= m_bitmap.size()) {
+    if (block >= m_bitmapBlocks) {
         return false;
     }
-    return m_bitmap[block];
+    return (m_bitmap[block / BITS_PER_WORD] >> (block % BITS_PER_WORD)) & 1;
 }
 
 void AppleProDOSHandler::markBlockUsed(size_t block) {
-    if (block < m_bitmap.size()) {
-        m_bitmap[block] = false;
+    if (block < m_bitmapBlocks) {
+        m_bitmap[block / BITS_PER_WORD] &= ~(uint64_t(1) << (block % BITS_PER_WORD));
     }
 }
 
 void AppleProDOSHandler::markBlockFree(size_t block) {
-    if (block < m_bitmap.size()) {
-        m_bitmap[block] = true;
+    if (block < m_bitmapBlocks) {
+        m_bitmap[block / BITS_PER_WORD] |= uint64_t(1) << (block % BITS_PER_WORD);
+    }
+}
+
+void AppleProDOSHandler::resetBitmap(size_t totalBlocks, bool free) {
+    m_bitmapBlocks = totalBlocks;
+    m_bitmap.assign((totalBlocks + BITS_PER_WORD - 1) / BITS_PER_WORD, free ? ~uint64_t(0) : 0);
+    if (free && (totalBlocks % BITS_PER_WORD)) {
+        m_bitmap.back() = (uint64_t(1) << (totalBlocks % BITS_PER_WORD)) - 1;
+    }
+}
+
+size_t AppleProDOSHandler::findFreeBlock(size_t from) const {
+    if (from >= m_bitmapBlocks) {
+        return m_bitmapBlocks;
+    }
+
+    size_t word = from / BITS_PER_WORD;
+    uint64_t bits = m_bitmap[word] & (~uint64_t(0) << (from % BITS_PER_WORD));
+
+    while (true) {
+        if (bits) {
+            // Padding bits are clear, so a hit is always a real block
+            return word * BITS_PER_WORD + lowestSetBit(bits);
+        }
+        if (++word >= m_bitmap.size()) {
+            return m_bitmapBlocks;
+        }
+        bits = m_bitmap[word];
+    }
+}
+
+size_t AppleProDOSHandler::findUsedBlock(size_t from) const {
+    if (from >= m_bitmapBlocks) {
+        return m_bitmapBlocks;
+    }
+
+    size_t word = from / BITS_PER_WORD;
+    uint64_t bits = ~m_bitmap[word] & (~uint64_t(0) << (from % BITS_PER_WORD));
+
+    while (true) {
+        if (bits) {
+            return std::min(word * BITS_PER_WORD + lowestSetBit(bits), m_bitmapBlocks);
+        }
+        if (++word >= m_bitmap.size()) {
+            return m_bitmapBlocks;
+        }
+        bits = ~m_bitmap[word];
     }
 }
 
 size_t AppleProDOSHandler::allocateBlock() {
     // Find first free block (skip boot blocks and system blocks)
-    for (size_t i = 7; i < m_bitmap.size(); ++i) {
-        if (m_bitmap[i]) {
-            markBlockUsed(i);
-            return i;
+    size_t block = findFreeBlock(7);
+    if (block >= m_bitmapBlocks) {
+        return 0;  // No free blocks
+    }
+    markBlockUsed(block);
+    return block;
+}
+
+std::vector<uint16_t> AppleProDOSHandler::allocateBlocks(size_t count) {
+    std::vector<uint16_t> blocks;
+    if (count == 0 || countFreeBlocks() < count) {
+        return blocks;
+    }
+    blocks.reserve(count);
+
+    // Prefer the first free run long enough to hold everything, so index
+    // blocks sit next to the data they point at
+    size_t start = findFreeBlock(7);
+    while (start < m_bitmapBlocks) {
+        size_t end = findUsedBlock(start);
+        if (end - start >= count) {
+            for (size_t i = 0; i < count; ++i) {
+                blocks.push_back(static_cast<uint16_t>(start + i));
+                markBlockUsed(start + i);
+            }
+            return blocks;
         }
+        start = findFreeBlock(end);
+    }
+
+    // Fragmented volume: take free blocks in ascending order
+    for (size_t block = findFreeBlock(7); blocks.size() < count; block = findFreeBlock(block + 1)) {
+        blocks.push_back(static_cast<uint16_t>(block));
+        markBlockUsed(block);
     }
-    return 0;  // No free blocks
+    return blocks;
 }
 
 size_t AppleProDOSHandler::countFreeBlocks() const {
     size_t count = 0;
-    for (size_t i = 0; i < m_bitmap.size(); ++i) {
-        if (m_bitmap[i]) {
-            ++count;
-        }
+    for (uint64_t word : m_bitmap) {
+        count += popcount64(word);
     }
     return count;
 }
@@ -575,7 +702,8 @@ bool AppleProDOSHandler::updateDirectoryFileCount(uint16_t dirKeyBlock, int delt
 // File I/O Operations
 //=============================================================================
 
-std::vector<uint16_t> AppleProDOSHandler::getFileBlocks(const DirectoryEntry& entry) const {
+std::vector<uint16_t> AppleProDOSHandler::getFileBlocks(const DirectoryEntry& entry,
+                                                        std::vector<uint16_t>* indexBlocks) const {
     std::vector<uint16_t> blocks;
 
     switch (entry.storageType) {
@@ -589,14 +717,15 @@ std::vector<uint16_t> AppleProDOSHandler::getFileBlocks(const DirectoryEntry& en
 
         case STORAGE_SAPLING: {
             // Index block pointing to data blocks
+            if (indexBlocks) {
+                indexBlocks->push_back(entry.keyPointer);
+            }
             auto indexBlock = readBlock(entry.keyPointer);
             if (indexBlock.size() >= BLOCK_SIZE) {
                 size_t numBlocks = (entry.eof + BLOCK_SIZE - 1) / BLOCK_SIZE;
                 for (size_t i = 0; i < numBlocks && i < 256; ++i) {
-                    uint16_t dataBlock = indexBlock[i] | (indexBlock[256 + i] << 8);
-                    if (dataBlock != 0) {
-                        blocks.push_back(dataBlock);
-                    }
+                    // A zero pointer is a hole; keep its position
+                    blocks.push_back(indexBlock[i] | (indexBlock[256 + i] << 8));
                 }
             }
             break;
@@ -604,6 +733,9 @@ std::vector<uint16_t> AppleProDOSHandler::getFileBlocks(const DirectoryEntry& en
 
         case STORAGE_TREE: {
             // Master index block pointing to index blocks
+            if (indexBlocks) {
+                indexBlocks->push_back(entry.keyPointer);
+            }
             auto masterBlock = readBlock(entry.keyPointer);
             if (masterBlock.size() >= BLOCK_SIZE) {
                 size_t totalDataBlocks = (entry.eof + BLOCK_SIZE - 1) / BLOCK_SIZE;
@@ -612,19 +744,23 @@ std::vector<uint16_t> AppleProDOSHandler::getFileBlocks(const DirectoryEntry& en
                 for (size_t mi = 0; mi < 256 && dataBlocksRead < totalDataBlocks; ++mi) {
                     uint16_t indexBlockNum = masterBlock[mi] | (masterBlock[256 + mi] << 8);
                     if (indexBlockNum == 0) {
+                        // Sparse index block: 256 holes
+                        size_t holes = std::min<size_t>(256, totalDataBlocks - dataBlocksRead);
+                        blocks.insert(blocks.end(), holes, 0);
+                        dataBlocksRead += holes;
                         continue;
                     }
 
+                    if (indexBlocks) {
+                        indexBlocks->push_back(indexBlockNum);
+                    }
                     auto indexBlock = readBlock(indexBlockNum);
                     if (indexBlock.size() < BLOCK_SIZE) {
                         break;
                     }
 
                     for (size_t i = 0; i < 256 && dataBlocksRead < totalDataBlocks; ++i) {
-                        uint16_t dataBlock = indexBlock[i] | (indexBlock[256 + i] << 8);
-                        if (dataBlock != 0) {
-                            blocks.push_back(dataBlock);
-                        }
+                        blocks.push_back(indexBlock[i] | (indexBlock[256 + i] << 8));
                         ++dataBlocksRead;
                     }
                 }
@@ -640,14 +776,17 @@ std::vector<uint16_t> AppleProDOSHandler::getFileBlocks(const DirectoryEntry& en
 }
 
 std::vector<uint8_t> AppleProDOSHandler::readFileData(const DirectoryEntry& entry) const {
-    std::vector<uint8_t> data;
-    data.reserve(entry.eof);
-
     auto blocks = getFileBlocks(entry);
 
-    for (uint16_t blockNum : blocks) {
-        auto block = readBlock(blockNum);
-        data.insert(data.end(), block.begin(), block.end());
+    // Holes stay zero-filled without touching the disk
+    std::vector<uint8_t> data(blocks.size() * BLOCK_SIZE, 0);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (blocks[i] == 0) {
+            continue;
+        }
+        auto block = readBlock(blocks[i]);
+        std::copy(block.begin(), block.begin() + std::min(block.size(), BLOCK_SIZE),
+                  data.begin() + i * BLOCK_SIZE);
     }
 
     // Trim to exact file size
@@ -658,6 +797,46 @@ std::vector<uint8_t> AppleProDOSHandler::readFileData(const DirectoryEntry& entr
     return data;
 }
 
+bool AppleProDOSHandler::isSparseBlock(const std::vector<uint8_t>& data, size_t dataBlock) {
+    // ProDOS always allocates the first data block of a file
+    if (dataBlock == 0) {
+        return false;
+    }
+    size_t begin = dataBlock * BLOCK_SIZE;
+    size_t end = std::min(begin + BLOCK_SIZE, data.size());
+    return std::all_of(data.begin() + begin, data.begin() + end,
+                       [](uint8_t b) { return b == 0; });
+}
+
+size_t AppleProDOSHandler::countFileBlocks(uint8_t storageType,
+                                           const std::vector<uint8_t>& data) const {
+    // Key block plus every allocated index and data block
+    size_t dataBlocks = (data.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    size_t count = 1;
+
+    if (storageType == STORAGE_SAPLING) {
+        for (size_t i = 0; i < dataBlocks; ++i) {
+            if (!isSparseBlock(data, i)) {
+                ++count;
+            }
+        }
+    } else if (storageType == STORAGE_TREE) {
+        for (size_t first = 0; first < dataBlocks; first += 256) {
+            size_t allocated = 0;
+            for (size_t i = first; i < std::min(first + 256, dataBlocks); ++i) {
+                if (!isSparseBlock(data, i)) {
+                    ++allocated;
+                }
+            }
+            if (allocated > 0) {
+                count += 1 + allocated;
+            }
+        }
+    }
+
+    return count;
+}
+
 uint8_t AppleProDOSHandler::calculateStorageType(size_t size) const {
     if (size <= BLOCK_SIZE) {
         return STORAGE_SEEDLING;
@@ -668,7 +847,20 @@ uint8_t AppleProDOSHandler::calculateStorageType(size_t size) const {
     }
 }
 
-bool AppleProDOSHandler::writeFileData(uint16_t keyBlock, uint8_t storageType, const std::vector<uint8_t>& data) {
+bool AppleProDOSHandler::writeFileData(const std::vector<uint16_t>& blocks, uint8_t storageType,
+                                       const std::vector<uint8_t>& data) {
+    // blocks[0] is the key block; the rest are consumed in order, each
+    // index block immediately followed by the data blocks it lists
+    if (blocks.empty()) {
+        return false;
+    }
+    const uint16_t keyBlock = blocks[0];
+    size_t nextBlock = 1;
+
+    auto takeBlock = [&]() -> size_t {
+        return nextBlock < blocks.size() ? blocks[nextBlock++] : 0;
+    };
+
     switch (storageType) {
         case STORAGE_SEEDLING: {
             // Write data directly to key block
@@ -686,7 +878,13 @@ bool AppleProDOSHandler::writeFileData(uint16_t keyBlock, uint8_t storageType, c
             size_t blockIndex = 0;
 
             while (dataOffset < data.size() && blockIndex < 256) {
-                size_t newBlock = allocateBlock();
+                if (isSparseBlock(data, blockIndex)) {
+                    dataOffset += BLOCK_SIZE;
+                    ++blockIndex;
+                    continue;
+                }
+
+                size_t newBlock = takeBlock();
                 if (newBlock == 0) {
                     return false;
                 }
@@ -716,8 +914,22 @@ bool AppleProDOSHandler::writeFileData(uint16_t keyBlock, uint8_t storageType, c
             size_t masterIndex = 0;
 
             while (dataOffset < data.size() && masterIndex < 256) {
-                // Allocate index block
-                size_t indexBlockNum = allocateBlock();
+                // Leave the index block out when its whole range is a hole
+                size_t firstData = masterIndex * 256;
+                size_t lastData = std::min(firstData + 256,
+                                           (data.size() + BLOCK_SIZE - 1) / BLOCK_SIZE);
+                bool sparseIndex = true;
+                for (size_t i = firstData; i < lastData && sparseIndex; ++i) {
+                    sparseIndex = isSparseBlock(data, i);
+                }
+                if (sparseIndex) {
+                    dataOffset += (lastData - firstData) * BLOCK_SIZE;
+                    ++masterIndex;
+                    continue;
+                }
+
+                // Take index block
+                size_t indexBlockNum = takeBlock();
                 if (indexBlockNum == 0) {
                     return false;
                 }
@@ -726,7 +938,13 @@ bool AppleProDOSHandler::writeFileData(uint16_t keyBlock, uint8_t storageType, c
                 size_t blockIndex = 0;
 
                 while (dataOffset < data.size() && blockIndex < 256) {
-                    size_t dataBlockNum = allocateBlock();
+                    if (isSparseBlock(data, firstData + blockIndex)) {
+                        dataOffset += BLOCK_SIZE;
+                        ++blockIndex;
+                        continue;
+                    }
+
+                    size_t dataBlockNum = takeBlock();
                     if (dataBlockNum == 0) {
                         return false;
                     }
@@ -1043,7 +1261,7 @@ std::vector<FileEntry> AppleProDOSHandler::listFiles(const std::string& path) {
     return files;
 }
 
-std::vector<uint8_t> AppleProDOSHandler::readFile(const std::string& filename) {
+AppleProDOSHandler::DirectoryEntry AppleProDOSHandler::findFileEntry(const std::string& filename) const {
     auto [dirBlock, name] = resolvePath(filename);
     if (dirBlock == 0 && name.empty()) {
         // Try root directory
@@ -1062,12 +1280,43 @@ std::vector<uint8_t> AppleProDOSHandler::readFile(const std::string& filename) {
         throw FileNotFoundException(filename);
     }
 
-    const DirectoryEntry& entry = *entryOpt;
-    if (entry.isDirectory()) {
+    if (entryOpt->isDirectory()) {
         throw InvalidFormatException("Cannot read directory as file");
     }
+    return *entryOpt;
+}
 
-    return readFileData(entry);
+std::vector<uint8_t> AppleProDOSHandler::readFile(const std::string& filename) {
+    return readFileData(findFileEntry(filename));
+}
+
+bool AppleProDOSHandler::getFileExtents(const std::string& filename,
+                                        std::vector<std::pair<size_t, size_t>>& extents) {
+    const DirectoryEntry entry = findFileEntry(filename);
+    std::vector<uint16_t> blocks;
+    auto dataBlocks = getFileBlocks(entry, &blocks);
+    blocks.insert(blocks.end(), dataBlocks.begin(), dataBlocks.end());
+
+    // 140K images split a block over two 256-byte sectors; block devices
+    // store one block per "sector"
+    const auto* apple = dynamic_cast<const AppleDiskImage*>(m_disk);
+    extents.clear();
+    for (uint16_t block : blocks) {
+        if (block == 0) {
+            continue;   // hole
+        }
+        if (apple) {
+            size_t track, sector1, sector2;
+            apple->blockToSectors(block, track, sector1, sector2);
+            if (!appendSectorExtent(extents, track, 0, sector1, BLOCK_SIZE / 2) ||
+                !appendSectorExtent(extents, track, 0, sector2, BLOCK_SIZE / 2)) {
+                return false;
+            }
+        } else if (!appendSectorExtent(extents, block, 0, 0, BLOCK_SIZE)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 // Helper function to convert DOS 3.3 file type to ProDOS file type
@@ -1112,19 +1361,9 @@ bool AppleProDOSHandler::writeFile(const std::string& filename,
         deleteFile(filename);
     }
 
-    // Calculate storage type and blocks needed
+    // Calculate storage type and blocks needed (all-zero blocks are holes)
     uint8_t storageType = calculateStorageType(data.size());
-    size_t blocksNeeded = 1;  // At least key block
-
-    if (storageType == STORAGE_SEEDLING) {
-        blocksNeeded = 1;
-    } else if (storageType == STORAGE_SAPLING) {
-        blocksNeeded = 1 + ((data.size() + BLOCK_SIZE - 1) / BLOCK_SIZE);
-    } else if (storageType == STORAGE_TREE) {
-        size_t dataBlocks = (data.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
-        size_t indexBlocks = (dataBlocks + 255) / 256;
-        blocksNeeded = 1 + indexBlocks + dataBlocks;
-    }
+    size_t blocksNeeded = countFileBlocks(storageType, data);
 
     // Check free space
     if (countFreeBlocks() < blocksNeeded) {
@@ -1137,15 +1376,18 @@ bool AppleProDOSHandler::writeFile(const std::string& filename,
         throw DirectoryFullException();
     }
 
-    // Allocate key block
-    size_t keyBlock = allocateBlock();
-    if (keyBlock == 0) {
+    // Allocate key, index and data blocks together as one run when possible
+    auto blocks = allocateBlocks(blocksNeeded);
+    if (blocks.empty()) {
         throw DiskFullException();
     }
+    size_t keyBlock = blocks[0];
 
     // Write file data
-    if (!writeFileData(static_cast<uint16_t>(keyBlock), storageType, data)) {
-        markBlockFree(keyBlock);
+    if (!writeFileData(blocks, storageType, data)) {
+        for (uint16_t block : blocks) {
+            markBlockFree(block);
+        }
         throw WriteException("Failed to write file data");
     }
 
@@ -1308,6 +1550,10 @@ size_t AppleProDOSHandler::getTotalSpace() const {
     return (m_volumeHeader.totalBlocks - 10) * BLOCK_SIZE;
 }
 
+size_t AppleProDOSHandler::getRequiredSpace(const std::vector<uint8_t>& data) const {
+    return countFileBlocks(calculateStorageType(data.size()), data) * BLOCK_SIZE;
+}
+
 bool AppleProDOSHandler::fileExists(const std::string& filename) const {
     auto [dirBlock, name] = resolvePath(filename);
     if (dirBlock == 0 && name.empty()) {
@@ -1344,23 +1590,28 @@ bool AppleProDOSHandler::format(const std::string& volumeName) {
     m_volumeHeader.entriesPerBlock = ENTRIES_PER_BLOCK;
     m_volumeHeader.fileCount = 0;
     m_volumeHeader.bitmapPointer = BITMAP_BLOCK;
-    m_volumeHeader.totalBlocks = TOTAL_BLOCKS;
+    m_volumeHeader.totalBlocks = static_cast<uint16_t>(deviceBlocks());
+
+    if (m_volumeHeader.totalBlocks <= BITMAP_BLOCK) {
+        return false;
+    }
 
     // Initialize bitmap - all blocks free except system blocks
-    m_bitmap.clear();
-    m_bitmap.resize(TOTAL_BLOCKS, true);
+    resetBitmap(m_volumeHeader.totalBlocks, true);
 
     // Mark boot blocks as used (0-1)
-    m_bitmap[0] = false;
-    m_bitmap[1] = false;
+    markBlockUsed(0);
+    markBlockUsed(1);
 
     // Mark volume directory blocks as used (2-5)
     for (size_t i = 2; i <= 5; ++i) {
-        m_bitmap[i] = false;
+        markBlockUsed(i);
     }
 
-    // Mark bitmap block as used
-    m_bitmap[BITMAP_BLOCK] = false;
+    // Mark bitmap blocks as used
+    for (size_t i = 0; i < bitmapBlockCount(); ++i) {
+        markBlockUsed(BITMAP_BLOCK + i);
+    }
 
     // Write boot blocks (zeros)
     std::vector<uint8_t> bootBlock(BLOCK_SIZE, 0);
@@ -1654,25 +1905,26 @@ ValidationResult AppleProDOSHandler::validateExtended() const {
     }
 
     // 2. Validate Bitmap Pointer
-    if (m_volumeHeader.bitmapPointer == 0 || m_volumeHeader.bitmapPointer >= TOTAL_BLOCKS) {
+    const size_t totalBlocks = m_volumeHeader.totalBlocks;
+    if (m_volumeHeader.bitmapPointer == 0 || m_volumeHeader.bitmapPointer >= totalBlocks) {
         result.addError("Invalid bitmap pointer: " + std::to_string(m_volumeHeader.bitmapPointer), "Block 2");
     }
 
     // 3. Validate Total Blocks
-    if (m_volumeHeader.totalBlocks == 0 || m_volumeHeader.totalBlocks > TOTAL_BLOCKS) {
+    if (m_volumeHeader.totalBlocks == 0 || m_volumeHeader.totalBlocks > deviceBlocks()) {
         result.addWarning("Unusual total blocks: " + std::to_string(m_volumeHeader.totalBlocks), "Block 2");
     }
 
     // 4. Count used blocks and verify against bitmap
-    std::vector<bool> usedBlocks(TOTAL_BLOCKS, false);
+    std::vector<bool> usedBlocks(std::max<size_t>(totalBlocks, BITMAP_BLOCK + 1), false);
     usedBlocks[0] = true;  // Boot block 0
     usedBlocks[1] = true;  // Boot block 1
     usedBlocks[2] = true;  // Volume directory key block
 
     // Mark bitmap blocks as used
-    size_t bitmapBlocks = (TOTAL_BLOCKS + 4095) / 4096;  // 4096 bits per block
+    size_t bitmapBlocks = bitmapBlockCount();
     for (size_t i = 0; i < bitmapBlocks; ++i) {
-        if (m_volumeHeader.bitmapPointer + i < TOTAL_BLOCKS) {
+        if (m_volumeHeader.bitmapPointer + i < totalBlocks) {
             usedBlocks[m_volumeHeader.bitmapPointer + i] = true;
         }
     }
@@ -1681,7 +1933,7 @@ ValidationResult AppleProDOSHandler::validateExtended() const {
     size_t fileCount = 0;
     std::function<void(uint16_t, const std::string&)> validateDirectory;
     validateDirectory = [&](uint16_t keyBlock, const std::string& path) {
-        if (keyBlock >= TOTAL_BLOCKS) {
+        if (keyBlock >= totalBlocks) {
             result.addError("Directory key block out of range: " + std::to_string(keyBlock), path);
             return;
         }
@@ -1699,7 +1951,7 @@ ValidationResult AppleProDOSHandler::validateExtended() const {
             ++fileCount;
 
             // Validate key pointer
-            if (entry.keyPointer >= TOTAL_BLOCKS) {
+            if (entry.keyPointer >= totalBlocks) {
                 result.addError("File key block out of range: " + std::to_string(entry.keyPointer), fullPath);
                 continue;
             }
@@ -1708,7 +1960,7 @@ ValidationResult AppleProDOSHandler::validateExtended() const {
             try {
                 auto fileBlocks = getFileBlocks(entry);
                 for (uint16_t block : fileBlocks) {
-                    if (block > 0 && block < TOTAL_BLOCKS) {
+                    if (block > 0 && block < totalBlocks) {
                         if (usedBlocks[block]) {
                             result.addWarning("Block " + std::to_string(block) + " referenced multiple times", fullPath);
                         }
@@ -1735,7 +1987,7 @@ ValidationResult AppleProDOSHandler::validateExtended() const {
     }
 
     // 7. Verify bitmap matches used blocks
-    for (size_t i = 0; i < TOTAL_BLOCKS; ++i) {
+    for (size_t i = 0; i < totalBlocks; ++i) {
         bool bitmapSaysFree = isBlockFree(i);
         bool shouldBeFree = !usedBlocks[i];
 
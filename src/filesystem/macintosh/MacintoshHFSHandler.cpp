@@ -3,9 +3,11 @@
 #include "rdedisktool/utils/MacEpoch.h"
 #include "rdedisktool/utils/MacRoman.h"
 #include "rdedisktool/utils/PascalString.h"
+#include "rdedisktool/utils/Stats.h"
 
 #include <algorithm>
 #include <cstring>
+#include <ostream>
 #include <set>
 #include <sstream>
 
@@ -36,6 +38,10 @@ constexpr uint8_t REC_FILE   = 0x02;
 // Thread records (0x03 / 0x04) are intentionally ignored — paths are
 // reconstructed via parent CNID relationships.
 
+// Catalog key order (defined with the write helpers below).
+int compareCatalogKey(uint32_t parentA, std::string_view nameA,
+                       uint32_t parentB, std::string_view nameB);
+
 } // namespace
 
 bool MacintoshHFSHandler::initialize(DiskImage* disk) {
@@ -43,6 +49,7 @@ bool MacintoshHFSHandler::initialize(DiskImage* disk) {
     if (!disk) return false;
 
     if (!parseMdb()) return false;
+    buildFreeExtents();
     parseBootBlock();          // optional — non-bootable disks have all zeros
     if (!walkExtentsOverflowLeaves()) {
         // Extents Overflow B-tree may be empty for many small volumes.
@@ -50,7 +57,7 @@ bool MacintoshHFSHandler::initialize(DiskImage* disk) {
         // initial 3 extents and report incomplete reads if necessary.
         m_extentsOverflow.clear();
     }
-    if (!walkCatalogLeaves()) return false;
+    if (!openCatalog()) return false;
     return true;
 }
 
@@ -112,24 +119,47 @@ bool MacintoshHFSHandler::parseBootBlock() {
     return true;
 }
 
-std::vector<uint8_t> MacintoshHFSHandler::readAllocBlocks(uint16_t startBlock,
-                                                            uint16_t count) const {
-    std::vector<uint8_t> out;
-    if (count == 0) return out;
-    const auto& raw = m_disk->getRawData();
+std::vector<std::pair<uint64_t, size_t>> MacintoshHFSHandler::forkSpans(
+        uint32_t fileCNID, uint8_t forkType,
+        const std::array<uint16_t, 6>& initial, uint64_t logical) const {
+    std::vector<std::pair<uint64_t, size_t>> spans;
+    if (logical == 0 || m_mdb.allocBlockSize == 0) return spans;
+    const uint64_t imageSize = m_disk->getRawData().size();
     const uint64_t base = static_cast<uint64_t>(m_mdb.firstAllocBlock) * 512ULL;
-    const uint64_t blockSize = static_cast<uint64_t>(m_mdb.allocBlockSize);
-    const uint64_t startOffset = base + static_cast<uint64_t>(startBlock) * blockSize;
-    const uint64_t totalBytes = static_cast<uint64_t>(count) * blockSize;
-    if (startOffset + totalBytes > raw.size()) {
-        // Truncate — caller will re-truncate to logical size anyway.
-        if (startOffset >= raw.size()) return out;
-        const uint64_t avail = raw.size() - startOffset;
-        out.assign(raw.begin() + startOffset, raw.begin() + startOffset + avail);
-        return out;
-    }
-    out.assign(raw.begin() + startOffset, raw.begin() + startOffset + totalBytes);
-    return out;
+    const uint64_t blockSize = m_mdb.allocBlockSize;
+
+    uint64_t remaining = logical;
+    uint32_t covered = 0;
+    auto append = [&](const std::array<uint16_t, 6>& exts) {
+        for (size_t i = 0; i < 3 && remaining > 0; ++i) {
+            const uint16_t start = exts[i * 2];
+            const uint16_t count = exts[i * 2 + 1];
+            if (count == 0) continue;
+            covered += count;
+            const uint64_t off = base + static_cast<uint64_t>(start) * blockSize;
+            if (off >= imageSize) continue;        // truncated image
+            const uint64_t len = std::min({static_cast<uint64_t>(count) * blockSize,
+                                           imageSize - off, remaining});
+            spans.emplace_back(off, static_cast<size_t>(len));
+            remaining -= len;
+        }
+    };
+
+    append(initial);
+
+    // Fetch overflow extents while logical bytes are still missing.
+    const uint64_t neededBlocks = (logical + blockSize - 1) / blockSize;
+    std::set<uint32_t> seen;
+    while (remaining > 0 && covered < neededBlocks && covered <= 0xFFFFu) {
+        if (!seen.insert(covered).second) break;  // loop guard
+        ExtentsKey key{fileCNID, forkType, static_cast<uint16_t>(covered)};
+        auto e = m_extentsOverflow.find(key);
+        if (e == m_extentsOverflow.end()) break;
+        const uint32_t before = covered;
+        append(e->second);
+        if (covered == before) break;              // empty record — stop
+    }
+    return spans;
 }
 
 // Walk the leaf chain of a B-tree file. The B-tree file is itself stored as
@@ -143,13 +173,20 @@ bool MacintoshHFSHandler::walkBTreeLeaves(uint32_t /*btreeFileSize*/,
     outBuffer.clear();
     outNodeSize = 0;
 
-    // Concatenate the (up to 3) initial extents.
+    // Concatenate the (up to 3) initial extents into one allocation.
+    uint64_t fileBytes = 0;
     for (size_t i = 0; i < 3; ++i) {
-        const uint16_t start = fileExtents[i * 2];
-        const uint16_t count = fileExtents[i * 2 + 1];
-        if (count == 0) continue;
-        auto chunk = readAllocBlocks(start, count);
-        outBuffer.insert(outBuffer.end(), chunk.begin(), chunk.end());
+        fileBytes += static_cast<uint64_t>(fileExtents[i * 2 + 1]) * m_mdb.allocBlockSize;
+    }
+    const auto spans = forkSpans(0, HFS_FORK_DATA, fileExtents, fileBytes);
+    size_t total = 0;
+    for (const auto& span : spans) total += span.second;
+    outBuffer.reserve(total);
+    const uint8_t* image = m_disk->getRawData().data();
+    for (const auto& span : spans) {
+        outBuffer.insert(outBuffer.end(), image + span.first,
+                         image + span.first + span.second);
+        Stats::sectorRead(span.second, (span.second + 511) / 512);
     }
     if (outBuffer.size() < 14 + 8) return false;  // need a node header + record
 
@@ -161,35 +198,227 @@ bool MacintoshHFSHandler::walkBTreeLeaves(uint32_t /*btreeFileSize*/,
     return true;
 }
 
-bool MacintoshHFSHandler::walkCatalogLeaves() {
-    std::vector<uint8_t> tree;
-    uint16_t nodeSize = 0;
-    if (!walkBTreeLeaves(m_mdb.catalogFileSize, m_mdb.catalogExtents, tree, nodeSize)) {
+bool MacintoshHFSHandler::openCatalog() {
+    m_childrenByParent.clear();
+    m_childIndex.clear();
+    m_loadedLeaves.clear();
+    m_listedParents.clear();
+    m_catalogFullyLoaded = false;
+    m_catalogNodeSize = 0;
+
+    // SPEC §1197: node_size lives in the header record of node 0, which is
+    // read with a provisional 512-byte node size first.
+    const uint8_t* hdr = catalogNode(0);
+    if (!hdr) return false;
+    const uint16_t nodeSize = be16(hdr + 0x20);
+    if (nodeSize == 0 || nodeSize > 16384) return false;
+    m_catalogNodeSize = nodeSize;
+    m_catalogTotalNodes = be32(hdr + 0x24);
+    hdr = catalogNode(0);
+    if (!hdr) {
+        m_catalogNodeSize = 0;
         return false;
     }
 
-    // first leaf node from header
-    const uint8_t* hdr = tree.data();
-    const uint32_t firstLeaf = be32(hdr + 0x18);
-    const uint32_t totalNodes = be32(hdr + 0x24);
+    m_catalogRootNode = be32(hdr + 0x10);
+    m_catalogFirstLeaf = be32(hdr + 0x18);
+    return true;
+}
 
-    uint32_t node = firstLeaf;
+bool MacintoshHFSHandler::walkCatalogLeaves() const {
+    if (m_catalogNodeSize == 0) return false;
+
+    // Re-parse every leaf in chain order so each child list ends up
+    // complete and ordered. m_byCNID entries are overwritten, not erased.
+    m_childrenByParent.clear();
+    m_childIndex.clear();
+    m_loadedLeaves.clear();
+    m_listedParents.clear();
+
+    uint32_t node = m_catalogFirstLeaf;
     std::set<uint32_t> visited;
     while (node != 0) {
         if (visited.count(node)) break;            // loop guard
-        if (node >= totalNodes) break;
-        const size_t nodeOff = static_cast<size_t>(node) * nodeSize;
-        if (nodeOff + nodeSize > tree.size()) break;
-        const uint8_t* p = tree.data() + nodeOff;
+        const uint8_t* p = catalogNode(node);
+        if (!p) break;
         const int8_t kind = static_cast<int8_t>(p[0x08]);
         if (kind != -1) break;                     // not a leaf
         visited.insert(node);
-        parseCatalogLeafNode(p, nodeSize);
+        loadCatalogLeaf(node);
         node = be32(p + 0x00);                     // forward link
     }
+    m_catalogFullyLoaded = true;
     return true;
 }
 
+const uint8_t* MacintoshHFSHandler::catalogNode(uint32_t node) const {
+    const size_t nodeSize = m_catalogNodeSize ? m_catalogNodeSize : 512;
+    if (m_catalogNodeSize && node >= m_catalogTotalNodes) return nullptr;
+
+    // Map the node's offset in the catalog file onto its (up to 3)
+    // initial extents. A node never straddles two extents.
+    const auto& raw = m_disk->getRawData();
+    const uint64_t blockSize = m_mdb.allocBlockSize;
+    uint64_t fileOff = static_cast<uint64_t>(node) * nodeSize;
+    for (size_t i = 0; i < 3; ++i) {
+        const uint16_t start = m_mdb.catalogExtents[i * 2];
+        const uint16_t count = m_mdb.catalogExtents[i * 2 + 1];
+        const uint64_t extentBytes = static_cast<uint64_t>(count) * blockSize;
+        if (fileOff < extentBytes) {
+            if (fileOff + nodeSize > extentBytes) return nullptr;
+            const uint64_t rawOff = static_cast<uint64_t>(m_mdb.firstAllocBlock) * 512ULL +
+                                    static_cast<uint64_t>(start) * blockSize + fileOff;
+            if (rawOff + nodeSize > raw.size()) return nullptr;
+            Stats::sectorRead(nodeSize, nodeSize / 512);
+            return raw.data() + rawOff;
+        }
+        fileOff -= extentBytes;
+    }
+    return nullptr;
+}
+
+uint32_t MacintoshHFSHandler::findCatalogLeaf(uint32_t parentCNID,
+                                                std::string_view name) const {
+    if (m_catalogNodeSize == 0) return 0;
+    const size_t nodeSize = m_catalogNodeSize;
+
+    uint32_t node = m_catalogRootNode;
+    for (int depth = 0; depth < 16 && node != 0; ++depth) {
+        const uint8_t* p = catalogNode(node);
+        if (!p) return 0;
+        const int8_t kind = static_cast<int8_t>(p[0x08]);
+        if (kind == -1) return node;               // leaf
+        if (kind != 0) return 0;                   // not an index node
+
+        // Follow the last index record whose key is <= the search key
+        // (the first record when the key sorts before all of them).
+        const uint16_t numRecords = be16(p + 0x0a);
+        uint32_t child = 0;
+        for (uint16_t i = 0; i < numRecords; ++i) {
+            const uint16_t off = be16(p + nodeSize - 2 * (i + 1));
+            const uint16_t end = be16(p + nodeSize - 2 * (i + 2));
+            if (off >= nodeSize || end > nodeSize || off >= end) continue;
+            const uint8_t* rec = p + off;
+            const uint8_t keyLen = rec[0x00];
+            size_t dataOff = 1U + keyLen;
+            if ((dataOff & 1U) != 0) dataOff += 1;
+            if (keyLen < 6 || dataOff + 4 > static_cast<size_t>(end - off)) continue;
+
+            const uint32_t keyParent = be32(rec + 0x02);
+            const size_t nameLen = std::min<size_t>(rec[0x06], keyLen - 6U);
+            const std::string_view keyName(reinterpret_cast<const char*>(rec + 0x07), nameLen);
+            if (child != 0 &&
+                compareCatalogKey(keyParent, keyName, parentCNID, name) > 0) {
+                break;
+            }
+            child = be32(rec + dataOff);
+        }
+        if (child == 0) return 0;
+        node = child;
+    }
+    return 0;
+}
+
+void MacintoshHFSHandler::loadCatalogLeaf(uint32_t node) const {
+    if (m_loadedLeaves.count(node)) return;
+    const uint8_t* p = catalogNode(node);
+    if (!p || static_cast<int8_t>(p[0x08]) != -1) return;
+    m_loadedLeaves.insert(node);
+
+    std::vector<std::pair<uint32_t, CatalogChild>> records;
+    parseCatalogLeafNode(p, m_catalogNodeSize, records);
+    for (auto& r : records) {
+        m_byCNID[r.second.cnid] = r.second;
+        // A listed parent already holds its complete, ordered list
+        if (!m_listedParents.count(r.first)) {
+            m_childIndex[r.first].emplace(macNameHash(r.second.name), r.second.cnid);
+            m_childrenByParent[r.first].push_back(std::move(r.second));
+        }
+    }
+}
+
+void MacintoshHFSHandler::loadCatalogChildren(uint32_t parentCNID) const {
+    if (m_catalogFullyLoaded || m_listedParents.count(parentCNID)) return;
+
+    // The empty name sorts first, so this lands on the leaf holding the
+    // parent's thread record or its first child.
+    uint32_t node = findCatalogLeaf(parentCNID, std::string_view());
+    if (node == 0) {
+        walkCatalogLeaves();
+        return;
+    }
+
+    std::vector<CatalogChild> children;
+    std::set<uint32_t> visited;
+    bool done = false;
+    while (node != 0 && !done) {
+        if (visited.count(node)) break;            // loop guard
+        const uint8_t* p = catalogNode(node);
+        if (!p || static_cast<int8_t>(p[0x08]) != -1) break;
+        visited.insert(node);
+        loadCatalogLeaf(node);
+
+        // Collect in key order from the node itself; the partial list in
+        // m_childrenByParent depends on the order leaves were loaded in
+        std::vector<std::pair<uint32_t, CatalogChild>> records;
+        parseCatalogLeafNode(p, m_catalogNodeSize, records);
+        for (auto& r : records) {
+            if (r.first == parentCNID) {
+                children.push_back(std::move(r.second));
+            } else if (r.first > parentCNID) {
+                done = true;
+                break;
+            }
+        }
+        node = be32(p + 0x00);                     // forward link
+    }
+
+    auto& index = m_childIndex[parentCNID];
+    index.clear();
+    for (const auto& c : children) {
+        index.emplace(macNameHash(c.name), c.cnid);
+    }
+    m_childrenByParent[parentCNID] = std::move(children);
+    m_listedParents.insert(parentCNID);
+}
+
+const MacintoshHFSHandler::CatalogChild*
+MacintoshHFSHandler::findIndexedChild(uint32_t parentCNID, std::string_view name) const {
+    auto pit = m_childIndex.find(parentCNID);
+    if (pit == m_childIndex.end()) return nullptr;
+
+    // Prefer an exact match; a folded one only wins when it is the sole
+    // candidate (HFS itself never stores two names differing in case)
+    const CatalogChild* folded = nullptr;
+    auto range = pit->second.equal_range(macNameHash(name));
+    for (auto it = range.first; it != range.second; ++it) {
+        auto c = m_byCNID.find(it->second);
+        if (c == m_byCNID.end()) continue;
+        if (c->second.name == name) return &c->second;
+        if (!folded && macNamesEqual(c->second.name, name)) folded = &c->second;
+    }
+    return folded;
+}
+
+const MacintoshHFSHandler::CatalogChild*
+MacintoshHFSHandler::findChild(uint32_t parentCNID, std::string_view name) const {
+    if (m_catalogFullyLoaded || m_listedParents.count(parentCNID)) {
+        return findIndexedChild(parentCNID, name);
+    }
+
+    // Fast path: descend the index by key and parse just that leaf
+    const uint32_t leaf = findCatalogLeaf(parentCNID, name);
+    if (leaf != 0) {
+        loadCatalogLeaf(leaf);
+        if (const CatalogChild* c = findIndexedChild(parentCNID, name)) return c;
+    }
+
+    // Names whose on-disk order differs from compareCatalogKey (non-ASCII)
+    // may sit in a neighbouring leaf: fall back to the parent's full list
+    loadCatalogChildren(parentCNID);
+    return findIndexedChild(parentCNID, name);
+}
+
 bool MacintoshHFSHandler::walkExtentsOverflowLeaves() {
     std::vector<uint8_t> tree;
     uint16_t nodeSize = 0;
@@ -217,7 +446,9 @@ bool MacintoshHFSHandler::walkExtentsOverflowLeaves() {
     return true;
 }
 
-void MacintoshHFSHandler::parseCatalogLeafNode(const uint8_t* node, size_t nodeSize) {
+void MacintoshHFSHandler::parseCatalogLeafNode(
+        const uint8_t* node, size_t nodeSize,
+        std::vector<std::pair<uint32_t, CatalogChild>>& out) const {
     const uint16_t numRecords = be16(node + 0x0a);
 
     // SPEC §1197: record offset table sits at the very end of the node, with
@@ -289,8 +520,7 @@ void MacintoshHFSHandler::parseCatalogLeafNode(const uint8_t* node, size_t nodeS
             continue;  // thread record — skip
         }
 
-        m_childrenByParent[parentCNID].push_back(child);
-        m_byCNID[child.cnid] = child;
+        out.emplace_back(parentCNID, std::move(child));
     }
 }
 
@@ -339,82 +569,88 @@ std::vector<uint8_t> MacintoshHFSHandler::extractFork(uint32_t fileCNID,
         (forkType == HFS_FORK_DATA) ? f.dataExtents : f.rsrcExtents;
     const uint32_t logical =
         (forkType == HFS_FORK_DATA) ? f.dataLogical : f.rsrcLogical;
-    if (logical == 0) return {};
-    if (m_mdb.allocBlockSize == 0) return {};
 
+    // Size the result once, then copy each extent straight from the image.
+    const auto spans = forkSpans(fileCNID, forkType, initial, logical);
+    size_t total = 0;
+    for (const auto& span : spans) total += span.second;
     std::vector<uint8_t> out;
-    uint16_t covered = 0;
+    out.reserve(total);
+    const uint8_t* image = m_disk->getRawData().data();
+    for (const auto& span : spans) {
+        out.insert(out.end(), image + span.first, image + span.first + span.second);
+        Stats::sectorRead(span.second, (span.second + 511) / 512);
+    }
+    return out;
+}
 
-    auto append = [&](const std::array<uint16_t, 6>& exts) {
-        for (size_t i = 0; i < 3; ++i) {
-            const uint16_t start = exts[i * 2];
-            const uint16_t count = exts[i * 2 + 1];
-            if (count == 0) continue;
-            auto chunk = readAllocBlocks(start, count);
-            out.insert(out.end(), chunk.begin(), chunk.end());
-            covered = static_cast<uint16_t>(covered + count);
-        }
-    };
+uint64_t MacintoshHFSHandler::readForkTo(std::ostream& out,
+                                         uint32_t fileCNID,
+                                         uint8_t forkType) const {
+    auto it = m_byCNID.find(fileCNID);
+    if (it == m_byCNID.end()) return 0;
+    const CatalogChild& f = it->second;
 
-    append(initial);
+    const auto spans = forkSpans(
+        fileCNID, forkType,
+        (forkType == HFS_FORK_DATA) ? f.dataExtents : f.rsrcExtents,
+        (forkType == HFS_FORK_DATA) ? f.dataLogical : f.rsrcLogical);
+    const char* image = reinterpret_cast<const char*>(m_disk->getRawData().data());
+    uint64_t written = 0;
+    for (const auto& span : spans) {
+        Stats::sectorRead(span.second, (span.second + 511) / 512);
+        out.write(image + span.first, static_cast<std::streamsize>(span.second));
+        if (!out) {
+            throw WriteException("Macintosh HFS: failed to write fork of CNID " +
+                                 std::to_string(fileCNID));
+        }
+        written += span.second;
+    }
+    return written;
+}
 
-    // Fetch overflow extents while logical bytes still missing.
-    const uint16_t neededBlocks = static_cast<uint16_t>(
-        (logical + m_mdb.allocBlockSize - 1) / m_mdb.allocBlockSize);
+uint64_t MacintoshHFSHandler::forkLength(uint32_t fileCNID, uint8_t forkType) const {
+    auto it = m_byCNID.find(fileCNID);
+    if (it == m_byCNID.end()) return 0;
+    const CatalogChild& f = it->second;
 
-    std::set<uint16_t> seen;
-    while (covered < neededBlocks) {
-        if (seen.count(covered)) break;            // loop guard
-        seen.insert(covered);
-        ExtentsKey key{fileCNID, forkType, covered};
-        auto e = m_extentsOverflow.find(key);
-        if (e == m_extentsOverflow.end()) break;
-        const uint16_t before = covered;
-        append(e->second);
-        if (covered == before) break;              // empty record — stop
+    uint64_t total = 0;
+    for (const auto& span : forkSpans(
+             fileCNID, forkType,
+             (forkType == HFS_FORK_DATA) ? f.dataExtents : f.rsrcExtents,
+             (forkType == HFS_FORK_DATA) ? f.dataLogical : f.rsrcLogical)) {
+        total += span.second;
     }
-
-    if (out.size() > logical) out.resize(logical);
-    return out;
+    return total;
 }
 
 const MacintoshHFSHandler::CatalogChild*
-MacintoshHFSHandler::resolvePath(const std::string& path) const {
-    // Normalize: strip leading '/', split on '/'.
-    std::string p = path;
-    while (!p.empty() && p.front() == '/') p.erase(p.begin());
+MacintoshHFSHandler::resolvePath(std::string_view path) const {
+    // Normalize: strip leading '/', then walk the components in place.
+    std::string_view p = path;
+    while (!p.empty() && p.front() == '/') p.remove_prefix(1);
     if (p.empty()) {
-        // Root — synthesize a CatalogChild for the volume folder.
+        // Root — the volume folder is the only child of parent CNID 1.
         auto it = m_byCNID.find(HFS_ROOT_CNID);
-        return (it != m_byCNID.end()) ? &it->second : nullptr;
-    }
-
-    std::vector<std::string> parts;
-    {
-        std::string cur;
-        for (char c : p) {
-            if (c == '/') {
-                if (!cur.empty()) parts.push_back(cur);
-                cur.clear();
-            } else {
-                cur.push_back(c);
-            }
+        if (it == m_byCNID.end()) {
+            loadCatalogChildren(1);
+            it = m_byCNID.find(HFS_ROOT_CNID);
         }
-        if (!cur.empty()) parts.push_back(cur);
+        return (it != m_byCNID.end()) ? &it->second : nullptr;
     }
 
     uint32_t parent = HFS_ROOT_CNID;
     const CatalogChild* found = nullptr;
-    for (size_t i = 0; i < parts.size(); ++i) {
-        auto pit = m_childrenByParent.find(parent);
-        if (pit == m_childrenByParent.end()) return nullptr;
-        const auto& children = pit->second;
-        const CatalogChild* match = nullptr;
-        for (const auto& c : children) {
-            if (c.name == parts[i]) { match = &c; break; }
-        }
+    while (!p.empty()) {
+        const size_t slash = p.find('/');
+        const std::string_view part = p.substr(0, slash);
+        p.remove_prefix(slash == std::string_view::npos ? p.size() : slash + 1);
+        if (part.empty()) continue;                // "a//b"
+
+        // Only folders can have children
+        if (found && !found->isDirectory) return nullptr;
+        const CatalogChild* match = findChild(parent, part);
         if (!match) return nullptr;
-        if (i + 1 < parts.size() && !match->isDirectory) return nullptr;
         parent = match->cnid;
         found = match;
     }
@@ -456,6 +692,7 @@ std::vector<FileEntry> MacintoshHFSHandler::listFiles(const std::string& path) {
         if (!node || !node->isDirectory) return out;
         parent = node->cnid;
     }
+    loadCatalogChildren(parent);
     auto it = m_childrenByParent.find(parent);
     if (it == m_childrenByParent.end()) return out;
     for (const auto& c : it->second) {
@@ -481,6 +718,22 @@ std::vector<uint8_t> MacintoshHFSHandler::readFile(const std::string& filename)
     return extractFork(f->cnid, HFS_FORK_DATA);
 }
 
+bool MacintoshHFSHandler::getFileExtents(const std::string& filename,
+                                         std::vector<std::pair<size_t, size_t>>& extents) {
+    const CatalogChild* f = resolvePath(filename);
+    if (!f || f->isDirectory) {
+        throw FileNotFoundException(filename);
+    }
+    extents.clear();
+    for (const auto& span : forkSpans(f->cnid, HFS_FORK_DATA, f->dataExtents, f->dataLogical)) {
+        extents.emplace_back(static_cast<size_t>(span.first), span.second);
+    }
+    for (const auto& span : forkSpans(f->cnid, HFS_FORK_RESOURCE, f->rsrcExtents, f->rsrcLogical)) {
+        extents.emplace_back(static_cast<size_t>(span.first), span.second);
+    }
+    return true;
+}
+
 // HFS volume bitmap helpers. Bitmap occupies sectors starting at drVBMSt;
 // inside each byte the MSB (bit 7) maps to the first allocation block in that
 // byte (Inside Mac File Manager). bit==1 means used, 0 means free.
@@ -504,21 +757,35 @@ inline void setBitmapBit(std::vector<uint8_t>& raw,
     else      raw[off] &= static_cast<uint8_t>(~mask);
 }
 
-// Compare HFS catalog keys: parent CNID first (BE u32), then case-folded
-// (Mac-Roman simple) name byte-wise. Returns <0 / 0 / >0 like memcmp.
-int compareCatalogKey(uint32_t parentA, const std::string& nameA,
-                       uint32_t parentB, const std::string& nameB) {
+// Mark `count` allocation blocks from `first` on, storing whole bitmap
+// bytes inside the run and masking only the partial bytes at its ends.
+void setBitmapRun(std::vector<uint8_t>& raw, uint64_t bitmapByteBase,
+                  uint16_t first, uint16_t count, bool used) {
+    const uint32_t end = static_cast<uint32_t>(first) + count;
+    for (uint32_t b = first; b < end; ) {
+        if ((b & 7) == 0 && b + 8 <= end) {
+            const size_t off = bitmapByteBase + (b / 8);
+            if (off >= raw.size()) return;
+            raw[off] = used ? 0xFF : 0x00;
+            b += 8;
+            continue;
+        }
+        setBitmapBit(raw, bitmapByteBase, static_cast<uint16_t>(b), used);
+        ++b;
+    }
+}
+
+// Compare HFS catalog keys: parent CNID first (BE u32), then the raw
+// Mac-Roman names byte-wise after case folding, so keys differing only in
+// case (including accented letters) collate together. Returns <0 / 0 / >0
+// like memcmp.
+int compareCatalogKey(uint32_t parentA, std::string_view nameA,
+                       uint32_t parentB, std::string_view nameB) {
     if (parentA != parentB) return (parentA < parentB) ? -1 : 1;
-    // Inside Mac uses a Mac-Roman case-insensitive comparison; for the
-    // M7 minimal scope (single new file at the root) plain byte comparison
-    // is sufficient — we never produce records that conflict with existing
-    // ones.
     const size_t n = std::min(nameA.size(), nameB.size());
     for (size_t i = 0; i < n; ++i) {
-        unsigned char a = static_cast<unsigned char>(nameA[i]);
-        unsigned char b = static_cast<unsigned char>(nameB[i]);
-        if (a >= 'a' && a <= 'z') a = static_cast<unsigned char>(a - 'a' + 'A');
-        if (b >= 'a' && b <= 'z') b = static_cast<unsigned char>(b - 'a' + 'A');
+        const uint8_t a = macRomanFoldByte(static_cast<uint8_t>(nameA[i]));
+        const uint8_t b = macRomanFoldByte(static_cast<uint8_t>(nameB[i]));
         if (a != b) return (a < b) ? -1 : 1;
     }
     if (nameA.size() != nameB.size()) {
@@ -1080,8 +1347,635 @@ inline bool patchFolderThreadName(
     return false;
 }
 
+// Reassemble a B-tree file (catalog or extents overflow) from its initial
+// 3 extents, and spread it back after mutation.
+inline bool readBTreeFile(const std::vector<uint8_t>& raw,
+                           uint64_t firstAllocByte,
+                           uint32_t allocBlockSize,
+                           const std::array<uint16_t, 6>& fileExtents,
+                           std::vector<uint8_t>& out) {
+    out.clear();
+    for (size_t i = 0; i < 3; ++i) {
+        const uint16_t start = fileExtents[i * 2];
+        const uint16_t count = fileExtents[i * 2 + 1];
+        if (count == 0) continue;
+        const uint64_t off = firstAllocByte +
+            static_cast<uint64_t>(start) * allocBlockSize;
+        const uint64_t len = static_cast<uint64_t>(count) * allocBlockSize;
+        if (off + len > raw.size()) return false;
+        out.insert(out.end(), raw.begin() + off, raw.begin() + off + len);
+    }
+    return !out.empty();
+}
+
+inline void writeBTreeFile(std::vector<uint8_t>& raw,
+                            uint64_t firstAllocByte,
+                            uint32_t allocBlockSize,
+                            const std::array<uint16_t, 6>& fileExtents,
+                            const std::vector<uint8_t>& bytes) {
+    size_t cursor = 0;
+    for (size_t i = 0; i < 3 && cursor < bytes.size(); ++i) {
+        const uint16_t start = fileExtents[i * 2];
+        const uint16_t count = fileExtents[i * 2 + 1];
+        if (count == 0) continue;
+        const uint64_t off = firstAllocByte +
+            static_cast<uint64_t>(start) * allocBlockSize;
+        const size_t len = std::min<size_t>(
+            static_cast<size_t>(count) * allocBlockSize, bytes.size() - cursor);
+        std::memcpy(raw.data() + off, bytes.data() + cursor, len);
+        cursor += len;
+    }
+}
+
+// Free run on the volume bitmap: (first allocation block, block count).
+// Same type as MacintoshHFSHandler::FreeExtentIndex::Run.
+using BlockRun = std::pair<uint16_t, uint16_t>;
+
+// Extents Overflow B-tree key order (Inside Mac: CompareExtentKeys):
+// file number, then fork type, then starting file allocation block.
+// Both arguments point at a record's key-length byte.
+int compareExtentsKey(const uint8_t* a, const uint8_t* b) {
+    const uint32_t fileA = be32(a + 0x02);
+    const uint32_t fileB = be32(b + 0x02);
+    if (fileA != fileB) return fileA < fileB ? -1 : 1;
+    if (a[0x01] != b[0x01]) return a[0x01] < b[0x01] ? -1 : 1;
+    const uint16_t startA = be16(a + 0x06);
+    const uint16_t startB = be16(b + 0x06);
+    if (startA != startB) return startA < startB ? -1 : 1;
+    return 0;
+}
+
+// Leaf record of the Extents Overflow B-tree: 8-byte key followed by an
+// extent record of 3 (start, count) pairs.
+std::vector<uint8_t> buildExtentsRecord(uint32_t cnid, uint8_t forkType,
+                                         uint16_t startBlock,
+                                         const BlockRun* runs, size_t count) {
+    std::vector<uint8_t> rec(8 + 12, 0);
+    rec[0x00] = 7;                                 // keyLen
+    rec[0x01] = forkType;
+    putBE32(rec, 0x02, cnid);
+    putBE16(rec, 0x06, startBlock);
+    for (size_t i = 0; i < count && i < 3; ++i) {
+        putBE16(rec, 8 + i * 4, runs[i].first);
+        putBE16(rec, 8 + i * 4 + 2, runs[i].second);
+    }
+    return rec;
+}
+
+// In-memory editor for the reassembled Extents Overflow B-tree file.
+// Inserts split full nodes (growing a new root when the root splits);
+// removals free emptied nodes and collapse single-entry roots. Every
+// extents key has the same length, so index records are fixed size and
+// splitting by record count always yields two nodes that fit. Throws
+// NotImplementedException when the header node map has no free node.
+class ExtentsTreeEditor {
+public:
+    ExtentsTreeEditor(std::vector<uint8_t>& tree, uint16_t nodeSize)
+        : m_tree(tree), m_nodeSize(nodeSize) {}
+
+    void insert(const std::vector<uint8_t>& record) {
+        uint32_t root = header32(0x02);
+        uint16_t depth = header16(0x00);
+        if (depth == 0 || root == 0) {
+            const uint32_t leaf = allocNode();
+            writeNode(leaf, Node{0, 0, -1, 1, {record}});
+            putHeader16(0x00, 1);
+            putHeader32(0x02, leaf);
+            putHeader32(0x0a, leaf);
+            putHeader32(0x0e, leaf);
+        } else {
+            std::vector<uint8_t> split = insertInto(root, record, depth);
+            if (!split.empty()) {
+                // Root split: a new index root over the old root and its sibling
+                const Node old = readNode(root);
+                const uint32_t newRoot = allocNode();
+                writeNode(newRoot, Node{0, 0, 0, static_cast<uint8_t>(depth + 1),
+                                        {buildIndexRecord(old.recs.front(), root), split}});
+                putHeader16(0x00, static_cast<uint16_t>(depth + 1));
+                putHeader32(0x02, newRoot);
+            }
+        }
+        putHeader32(0x06, header32(0x06) + 1);     // leafRecords
+    }
+
+    bool remove(const std::vector<uint8_t>& key) {
+        uint32_t root = header32(0x02);
+        uint16_t depth = header16(0x00);
+        if (depth == 0 || root == 0) return false;
+        const Removed r = removeFrom(root, key, depth);
+        if (!r.found) return false;
+        putHeader32(0x06, header32(0x06) > 0 ? header32(0x06) - 1 : 0);
+        if (r.emptied) {
+            putHeader16(0x00, 0);
+            putHeader32(0x02, 0);
+            putHeader32(0x0a, 0);
+            putHeader32(0x0e, 0);
+            return true;
+        }
+        // Drop index roots left with a single child
+        while (depth > 1) {
+            const Node n = readNode(root);
+            if (n.recs.size() != 1) break;
+            const uint32_t child = childOf(n.recs.front());
+            freeNode(root);
+            root = child;
+            --depth;
+        }
+        putHeader16(0x00, depth);
+        putHeader32(0x02, root);
+        return true;
+    }
+
+private:
+    struct Node {
+        uint32_t fLink;
+        uint32_t bLink;
+        int8_t kind;                               // -1 leaf, 0 index
+        uint8_t height;
+        std::vector<std::vector<uint8_t>> recs;
+    };
+    struct Removed {
+        bool found;
+        bool emptied;
+    };
+
+    static constexpr size_t BTH = 14;              // header record offset
+
+    uint16_t header16(size_t off) const { return be16(m_tree.data() + BTH + off); }
+    uint32_t header32(size_t off) const { return be32(m_tree.data() + BTH + off); }
+    void putHeader16(size_t off, uint16_t v) { putBE16(m_tree, BTH + off, v); }
+    void putHeader32(size_t off, uint32_t v) { putBE32(m_tree, BTH + off, v); }
+
+    size_t nodeOffset(uint32_t node) const {
+        const size_t off = static_cast<size_t>(node) * m_nodeSize;
+        if (node == 0 || off + m_nodeSize > m_tree.size()) {
+            throw NotImplementedException("Macintosh HFS extents tree: node out of range");
+        }
+        return off;
+    }
+
+    static uint32_t childOf(const std::vector<uint8_t>& indexRec) {
+        size_t dataOff = 1U + indexRec[0];
+        if (dataOff & 1U) dataOff += 1;
+        if (dataOff + 4 > indexRec.size()) {
+            throw NotImplementedException("Macintosh HFS extents tree: malformed index record");
+        }
+        return be32(indexRec.data() + dataOff);
+    }
+
+    Node readNode(uint32_t node) const {
+        const size_t base = nodeOffset(node);
+        const uint8_t* p = m_tree.data() + base;
+        Node n{be32(p + 0x00), be32(p + 0x04), static_cast<int8_t>(p[0x08]), p[0x09], {}};
+        const uint16_t numRecs = be16(p + 0x0a);
+        for (uint16_t i = 0; i < numRecs; ++i) {
+            const uint16_t off = be16(p + m_nodeSize - 2 * (i + 1));
+            const uint16_t end = be16(p + m_nodeSize - 2 * (i + 2));
+            if (off < 14 || off >= end || end > m_nodeSize || end - off < 8) {
+                throw NotImplementedException("Macintosh HFS extents tree: malformed offset table");
+            }
+            n.recs.emplace_back(p + off, p + end);
+        }
+        return n;
+    }
+
+    // Returns false (leaving the node untouched) when the records do not fit.
+    bool writeNode(uint32_t node, const Node& n) {
+        size_t used = 14 + 2 * (n.recs.size() + 1);
+        for (const auto& r : n.recs) used += r.size();
+        if (used > m_nodeSize) return false;
+
+        const size_t base = nodeOffset(node);
+        std::memset(m_tree.data() + base, 0, m_nodeSize);
+        putBE32(m_tree, base + 0x00, n.fLink);
+        putBE32(m_tree, base + 0x04, n.bLink);
+        m_tree[base + 0x08] = static_cast<uint8_t>(n.kind);
+        m_tree[base + 0x09] = n.height;
+        putBE16(m_tree, base + 0x0a, static_cast<uint16_t>(n.recs.size()));
+        size_t cursor = 14;
+        for (size_t i = 0; i < n.recs.size(); ++i) {
+            putBE16(m_tree, base + m_nodeSize - 2 * (i + 1), static_cast<uint16_t>(cursor));
+            std::memcpy(m_tree.data() + base + cursor, n.recs[i].data(), n.recs[i].size());
+            cursor += n.recs[i].size();
+        }
+        putBE16(m_tree, base + m_nodeSize - 2 * (n.recs.size() + 1),
+                static_cast<uint16_t>(cursor));
+        return true;
+    }
+
+    uint32_t allocNode() {
+        const uint32_t node = allocateBTreeNodeFromMap(m_tree, m_nodeSize);
+        if (node == 0 || static_cast<size_t>(node + 1) * m_nodeSize > m_tree.size()) {
+            throw NotImplementedException(
+                "Macintosh HFS extents tree: B-tree map has no free nodes");
+        }
+        return node;
+    }
+
+    void freeNode(uint32_t node) {
+        const size_t base = nodeOffset(node);
+        std::memset(m_tree.data() + base, 0, m_nodeSize);
+        const size_t mapOff = 248 + node / 8;
+        if (mapOff < static_cast<size_t>(m_nodeSize) - 8) {
+            m_tree[mapOff] &= static_cast<uint8_t>(~(1u << (7 - (node & 7))));
+        }
+        putHeader32(0x1a, header32(0x1a) + 1);     // freeNodes
+    }
+
+    // Drop a node from its level's sibling chain (and the leaf list ends)
+    void unlink(uint32_t node, const Node& n) {
+        if (n.bLink != 0) putBE32(m_tree, nodeOffset(n.bLink) + 0x00, n.fLink);
+        if (n.fLink != 0) putBE32(m_tree, nodeOffset(n.fLink) + 0x04, n.bLink);
+        if (n.kind == -1) {
+            if (header32(0x0a) == node) putHeader32(0x0a, n.fLink);
+            if (header32(0x0e) == node) putHeader32(0x0e, n.bLink);
+        }
+    }
+
+    // Index slot to descend into: the last record whose key is <= `key`,
+    // or -1 when `key` sorts before every record.
+    static int childSlot(const Node& n, const uint8_t* key) {
+        int slot = -1;
+        for (size_t i = 0; i < n.recs.size(); ++i) {
+            if (compareExtentsKey(n.recs[i].data(), key) > 0) break;
+            slot = static_cast<int>(i);
+        }
+        return slot;
+    }
+
+    // Insert below `node`. Returns the index record for a new right
+    // sibling when `node` had to split, or an empty vector.
+    std::vector<uint8_t> insertInto(uint32_t node, const std::vector<uint8_t>& record,
+                                    uint16_t levels) {
+        if (levels == 0) {
+            throw NotImplementedException("Macintosh HFS extents tree: depth mismatch");
+        }
+        Node n = readNode(node);
+        if (n.kind == -1) {
+            size_t pos = 0;
+            while (pos < n.recs.size() &&
+                   compareExtentsKey(n.recs[pos].data(), record.data()) < 0) {
+                ++pos;
+            }
+            if (pos < n.recs.size() &&
+                compareExtentsKey(n.recs[pos].data(), record.data()) == 0) {
+                n.recs[pos] = record;              // replace an existing key
+                putHeader32(0x06, header32(0x06) - 1);
+            } else {
+                n.recs.insert(n.recs.begin() + pos, record);
+            }
+        } else if (n.kind == 0 && !n.recs.empty()) {
+            int slot = childSlot(n, record.data());
+            if (slot < 0) {
+                // New smallest key: the first entry now starts below it
+                slot = 0;
+                n.recs[0] = buildIndexRecord(record, childOf(n.recs[0]));
+            }
+            std::vector<uint8_t> split = insertInto(childOf(n.recs[slot]), record,
+                                                    static_cast<uint16_t>(levels - 1));
+            if (!split.empty()) {
+                n.recs.insert(n.recs.begin() + slot + 1, std::move(split));
+            }
+        } else {
+            throw NotImplementedException("Macintosh HFS extents tree: unexpected node kind");
+        }
+
+        if (writeNode(node, n)) return {};
+
+        // Split by count; the right half moves to a new node after `node`
+        Node right{n.fLink, node, n.kind, n.height, {}};
+        const size_t half = n.recs.size() / 2;
+        right.recs.assign(n.recs.begin() + half, n.recs.end());
+        n.recs.resize(half);
+        const uint32_t sibling = allocNode();
+        n.fLink = sibling;
+        if (!writeNode(node, n) || !writeNode(sibling, right)) {
+            throw NotImplementedException("Macintosh HFS extents tree: split does not fit");
+        }
+        if (right.fLink != 0) putBE32(m_tree, nodeOffset(right.fLink) + 0x04, sibling);
+        if (n.kind == -1 && header32(0x0e) == node) putHeader32(0x0e, sibling);
+        return buildIndexRecord(right.recs.front(), sibling);
+    }
+
+    Removed removeFrom(uint32_t node, const std::vector<uint8_t>& key, uint16_t levels) {
+        if (levels == 0) return {false, false};
+        Node n = readNode(node);
+        if (n.kind == -1) {
+            auto it = std::find_if(n.recs.begin(), n.recs.end(),
+                [&](const std::vector<uint8_t>& r) {
+                    return compareExtentsKey(r.data(), key.data()) == 0;
+                });
+            if (it == n.recs.end()) return {false, false};
+            n.recs.erase(it);
+        } else if (n.kind == 0) {
+            const int slot = childSlot(n, key.data());
+            if (slot < 0) return {false, false};
+            const uint32_t child = childOf(n.recs[slot]);
+            const Removed r = removeFrom(child, key, static_cast<uint16_t>(levels - 1));
+            if (!r.found) return r;
+            if (r.emptied) {
+                n.recs.erase(n.recs.begin() + slot);
+            } else {
+                // Keep the entry's key equal to the child's first key
+                n.recs[slot] = buildIndexRecord(readNode(child).recs.front(), child);
+            }
+        } else {
+            return {false, false};
+        }
+
+        if (n.recs.empty()) {
+            unlink(node, n);
+            freeNode(node);
+            return {true, true};
+        }
+        writeNode(node, n);                        // only shrank: always fits
+        return {true, false};
+    }
+
+    std::vector<uint8_t>& m_tree;
+    uint16_t m_nodeSize;
+};
+
 } // namespace
 
+void MacintoshHFSHandler::FreeExtentIndex::clear() {
+    m_byStart.clear();
+    m_bySize.clear();
+    m_freeBlocks = 0;
+}
+
+void MacintoshHFSHandler::FreeExtentIndex::build(const std::vector<uint8_t>& raw,
+                                                 uint64_t bitmapByteBase,
+                                                 uint16_t numAllocBlocks) {
+    clear();
+    uint32_t runStart = 0;
+    uint32_t runLength = 0;
+    auto flush = [&]() {
+        if (runLength > 0) insertRun(static_cast<uint16_t>(runStart),
+                                     static_cast<uint16_t>(runLength));
+        runLength = 0;
+    };
+    for (uint32_t b = 0; b < numAllocBlocks; ) {
+        const size_t off = bitmapByteBase + (b / 8);
+        if (off >= raw.size()) break;              // past the image = used
+        const uint8_t bits = raw[off];
+        // Whole bytes that are all used or all free skip the per-bit test.
+        if ((b & 7) == 0 && b + 8 <= numAllocBlocks && (bits == 0x00 || bits == 0xFF)) {
+            if (bits == 0xFF) {
+                flush();
+            } else {
+                if (runLength == 0) runStart = b;
+                runLength += 8;
+            }
+            b += 8;
+            continue;
+        }
+        if (bits & (0x80u >> (b & 7))) {
+            flush();
+        } else {
+            if (runLength == 0) runStart = b;
+            ++runLength;
+        }
+        ++b;
+    }
+    flush();
+}
+
+std::vector<MacintoshHFSHandler::FreeExtentIndex::Run>
+MacintoshHFSHandler::FreeExtentIndex::bestFit(uint32_t needed) const {
+    if (needed == 0 || needed > m_freeBlocks) return {};
+
+    std::vector<Run> chosen;
+    uint32_t remaining = needed;
+    // Runs at or past `taken` (the largest ones) are already chosen.
+    auto taken = m_bySize.end();
+    while (remaining > 0) {
+        auto fit = remaining > 0xFFFFu
+            ? m_bySize.end()
+            : m_bySize.lower_bound({static_cast<uint16_t>(remaining), 0});
+        const bool fitFree = fit != m_bySize.end() &&
+                             (taken == m_bySize.end() || *fit < *taken);
+        if (fitFree) {
+            chosen.emplace_back(fit->second, static_cast<uint16_t>(remaining));
+            break;
+        }
+        --taken;                                   // free total >= remaining
+        chosen.emplace_back(taken->second, taken->first);
+        remaining -= taken->first;
+    }
+    std::sort(chosen.begin(), chosen.end());
+    return chosen;
+}
+
+void MacintoshHFSHandler::FreeExtentIndex::allocate(const Run& run) {
+    const uint32_t start = run.first;
+    const uint32_t end = start + run.second;
+    auto it = m_byStart.upper_bound(run.first);
+    if (it != m_byStart.begin()) --it;
+    while (it != m_byStart.end() && it->first < end) {
+        const uint32_t runStart = it->first;
+        const uint32_t runEnd = runStart + it->second;
+        auto next = std::next(it);
+        if (runEnd > start) {
+            eraseRun(it);
+            if (runStart < start) {
+                insertRun(static_cast<uint16_t>(runStart),
+                          static_cast<uint16_t>(start - runStart));
+            }
+            if (runEnd > end) {
+                insertRun(static_cast<uint16_t>(end),
+                          static_cast<uint16_t>(runEnd - end));
+            }
+        }
+        it = next;
+    }
+}
+
+void MacintoshHFSHandler::FreeExtentIndex::release(const Run& run) {
+    if (run.second == 0) return;
+    uint32_t start = run.first;
+    uint32_t end = start + run.second;
+    // Absorb every free run touching or overlapping [start, end).
+    auto it = m_byStart.upper_bound(run.first);
+    if (it != m_byStart.begin()) {
+        auto prev = std::prev(it);
+        if (static_cast<uint32_t>(prev->first) + prev->second >= start) it = prev;
+    }
+    while (it != m_byStart.end() && it->first <= end) {
+        start = std::min<uint32_t>(start, it->first);
+        end = std::max<uint32_t>(end, static_cast<uint32_t>(it->first) + it->second);
+        auto next = std::next(it);
+        eraseRun(it);
+        it = next;
+    }
+    insertRun(static_cast<uint16_t>(start), static_cast<uint16_t>(end - start));
+}
+
+void MacintoshHFSHandler::FreeExtentIndex::insertRun(uint16_t start, uint16_t count) {
+    m_byStart.emplace(start, count);
+    m_bySize.emplace(count, start);
+    m_freeBlocks += count;
+}
+
+void MacintoshHFSHandler::FreeExtentIndex::eraseRun(
+        std::map<uint16_t, uint16_t>::iterator it) {
+    m_bySize.erase({it->second, it->first});
+    m_freeBlocks -= it->second;
+    m_byStart.erase(it);
+}
+
+void MacintoshHFSHandler::buildFreeExtents() {
+    m_freeExtents.build(m_disk->getRawData(),
+                        static_cast<uint64_t>(m_mdb.bitmapStart) * 512ULL,
+                        m_mdb.numAllocBlocks);
+}
+
+uint32_t MacintoshHFSHandler::writeForkExtents(std::vector<uint8_t>& raw,
+                                                uint32_t cnid,
+                                                uint8_t forkType,
+                                                const std::vector<uint8_t>& data,
+                                                std::array<uint16_t, 6>& firstExtents,
+                                                std::vector<BlockRun>& runs) const {
+    firstExtents.fill(0);
+    runs.clear();
+    if (data.empty()) return 0;
+
+    const uint32_t blockSize = m_mdb.allocBlockSize;
+    const uint64_t firstAllocByte =
+        static_cast<uint64_t>(m_mdb.firstAllocBlock) * 512ULL;
+    const uint64_t bitmapByteBase =
+        static_cast<uint64_t>(m_mdb.bitmapStart) * 512ULL;
+    const uint64_t needed = (data.size() + blockSize - 1) / blockSize;
+    if (needed > m_mdb.numAllocBlocks) {
+        throw DiskFullException();
+    }
+
+    runs = m_freeExtents.bestFit(static_cast<uint32_t>(needed));
+    if (runs.empty()) {
+        throw DiskFullException();
+    }
+
+    // Extents past the first three go to the Extents Overflow B-tree, one
+    // record per three, keyed by the fork-relative block they start at.
+    // Done before touching the bitmap so a full tree leaves `raw` clean.
+    if (runs.size() > 3) {
+        std::vector<uint8_t> tree;
+        if (!readBTreeFile(raw, firstAllocByte, blockSize, m_mdb.extentsExtents, tree) ||
+            tree.size() < 14 + 2 * 0x20) {
+            throw NotImplementedException(
+                "Macintosh HFS write: fork needs " + std::to_string(runs.size()) +
+                " extents but the Extents Overflow B-tree is unreadable");
+        }
+        const uint16_t nodeSize = be16(tree.data() + 0x20);
+        if (nodeSize < 512 || nodeSize > 16384 || tree.size() % nodeSize != 0) {
+            throw NotImplementedException("Macintosh HFS write: extents tree node size invalid");
+        }
+        ExtentsTreeEditor editor(tree, nodeSize);
+        uint32_t fileBlock = 0;
+        for (size_t i = 0; i < 3; ++i) fileBlock += runs[i].second;
+        for (size_t i = 3; i < runs.size(); i += 3) {
+            const size_t count = std::min<size_t>(3, runs.size() - i);
+            editor.insert(buildExtentsRecord(cnid, forkType,
+                                             static_cast<uint16_t>(fileBlock),
+                                             &runs[i], count));
+            for (size_t k = 0; k < count; ++k) fileBlock += runs[i + k].second;
+        }
+        writeBTreeFile(raw, firstAllocByte, blockSize, m_mdb.extentsExtents, tree);
+    }
+
+    size_t srcOff = 0;
+    for (size_t i = 0; i < runs.size(); ++i) {
+        if (i < 3) {
+            firstExtents[i * 2] = runs[i].first;
+            firstExtents[i * 2 + 1] = runs[i].second;
+        }
+        for (uint32_t b = 0; b < runs[i].second; ++b) {
+            const uint16_t block = static_cast<uint16_t>(runs[i].first + b);
+            const uint64_t off = firstAllocByte + static_cast<uint64_t>(block) * blockSize;
+            if (off + blockSize > raw.size()) {
+                throw InvalidFormatException(
+                    "Macintosh HFS write: allocation block past end of image");
+            }
+            const size_t take = std::min<size_t>(blockSize, data.size() - srcOff);
+            std::memcpy(raw.data() + off, data.data() + srcOff, take);
+            if (take < blockSize) {
+                std::memset(raw.data() + off + take, 0, blockSize - take);
+            }
+            srcOff += take;
+        }
+        setBitmapRun(raw, bitmapByteBase, runs[i].first, runs[i].second, true);
+    }
+    return static_cast<uint32_t>(needed);
+}
+
+uint32_t MacintoshHFSHandler::releaseForkExtents(std::vector<uint8_t>& raw,
+                                                  uint32_t cnid,
+                                                  uint8_t forkType,
+                                                  const std::array<uint16_t, 6>& firstExtents,
+                                                  uint32_t logical,
+                                                  std::vector<BlockRun>& runs) const {
+    const uint32_t blockSize = m_mdb.allocBlockSize;
+    const uint32_t needed = logical == 0 ? 0u :
+        static_cast<uint32_t>((static_cast<uint64_t>(logical) + blockSize - 1) / blockSize);
+
+    // Collect the fork's extents the same way extractFork() follows them.
+    runs.clear();
+    std::vector<std::vector<uint8_t>> overflowKeys;
+    uint32_t covered = 0;
+    auto take = [&](const std::array<uint16_t, 6>& ext) {
+        for (size_t i = 0; i < 3; ++i) {
+            if (ext[i * 2 + 1] == 0) continue;
+            runs.emplace_back(ext[i * 2], ext[i * 2 + 1]);
+            covered += ext[i * 2 + 1];
+        }
+    };
+    take(firstExtents);
+    while (covered < needed && covered <= 0xFFFFu) {
+        auto e = m_extentsOverflow.find(
+            ExtentsKey{cnid, forkType, static_cast<uint16_t>(covered)});
+        if (e == m_extentsOverflow.end()) break;
+        overflowKeys.push_back(buildExtentsRecord(
+            cnid, forkType, static_cast<uint16_t>(covered), nullptr, 0));
+        const uint32_t before = covered;
+        take(e->second);
+        if (covered == before) break;              // empty record — stop
+    }
+    if (covered < needed) {
+        // Freeing a partial chain would leak (or double-free) blocks
+        throw NotImplementedException(
+            "Macintosh HFS delete: fork extents are incomplete "
+            "(missing Extents Overflow records)");
+    }
+
+    if (!overflowKeys.empty()) {
+        const uint64_t firstAllocByte =
+            static_cast<uint64_t>(m_mdb.firstAllocBlock) * 512ULL;
+        std::vector<uint8_t> tree;
+        if (!readBTreeFile(raw, firstAllocByte, blockSize, m_mdb.extentsExtents, tree) ||
+            tree.size() < 14 + 2 * 0x20) {
+            throw NotImplementedException("Macintosh HFS delete: extents tree unreadable");
+        }
+        const uint16_t nodeSize = be16(tree.data() + 0x20);
+        if (nodeSize < 512 || nodeSize > 16384 || tree.size() % nodeSize != 0) {
+            throw NotImplementedException("Macintosh HFS delete: extents tree node size invalid");
+        }
+        ExtentsTreeEditor editor(tree, nodeSize);
+        for (const auto& key : overflowKeys) {
+            editor.remove(key);
+        }
+        writeBTreeFile(raw, firstAllocByte, blockSize, m_mdb.extentsExtents, tree);
+    }
+
+    const uint64_t bitmapByteBase =
+        static_cast<uint64_t>(m_mdb.bitmapStart) * 512ULL;
+    uint32_t freed = 0;
+    for (const auto& run : runs) {
+        setBitmapRun(raw, bitmapByteBase, run.first, run.second, false);
+        freed += run.second;
+    }
+    return freed;
+}
+
 bool MacintoshHFSHandler::writeFile(const std::string& filename,
                                      const std::vector<uint8_t>& data,
                                      const FileMetadata& metadata) {
@@ -1102,85 +1996,31 @@ bool MacintoshHFSHandler::writeFile(const std::string& filename,
     }
     if (m_mdb.allocBlockSize == 0) return false;
 
-    // Compute needed allocation blocks. Out-of-scope: forks larger than
-    // 3 initial extents (= no Extents Overflow B-tree update yet).
     const uint32_t blockSize = m_mdb.allocBlockSize;
-    const uint32_t needed = data.empty() ? 0u :
-        static_cast<uint32_t>((data.size() + blockSize - 1) / blockSize);
-    if (needed > 0xFFFFu) {
-        throw NotImplementedException("Macintosh HFS write: data fork too large for a single extent");
-    }
 
     // Snapshot the disk image. All mutations happen in this buffer; we commit
     // atomically via setRawData() at the end.
     std::vector<uint8_t> raw = m_disk->getRawData();
-
-    // 1. Find a contiguous run of free allocation blocks in the volume bitmap.
-    const uint64_t bitmapByteBase =
-        static_cast<uint64_t>(m_mdb.bitmapStart) * 512ULL;
-    uint16_t firstFree = 0;
-    uint16_t runStart = 0;
-    uint16_t runLen = 0;
-    if (needed > 0) {
-        uint16_t bestLen = 0;
-        for (uint16_t b = 0; b < m_mdb.numAllocBlocks; ++b) {
-            if (!bitmapBit(raw, bitmapByteBase, b)) {
-                if (bestLen == 0) firstFree = b;
-                ++bestLen;
-                if (bestLen >= needed) {
-                    runStart = firstFree;
-                    runLen = bestLen;
-                    break;
-                }
-            } else {
-                bestLen = 0;
-            }
-        }
-        if (runLen < needed) {
-            throw NotImplementedException(
-                "Macintosh HFS write: no contiguous free run for " +
-                std::to_string(needed) + " allocation blocks (fragmented free space; "
-                "Extents Overflow B-tree updates not implemented yet)");
-        }
-    }
-
-    // 2. Write the data fork.
     const uint64_t firstAllocByte =
         static_cast<uint64_t>(m_mdb.firstAllocBlock) * 512ULL;
-    if (needed > 0) {
-        const uint64_t startOff =
-            firstAllocByte + static_cast<uint64_t>(runStart) * blockSize;
-        if (startOff + static_cast<uint64_t>(runLen) * blockSize > raw.size()) {
-            return false;
-        }
-        for (uint32_t i = 0; i < needed; ++i) {
-            const uint64_t off = firstAllocByte +
-                static_cast<uint64_t>(runStart + i) * blockSize;
-            const size_t srcOff = static_cast<size_t>(i) * blockSize;
-            const size_t take = std::min<size_t>(blockSize, data.size() - srcOff);
-            std::memcpy(raw.data() + off, data.data() + srcOff, take);
-            if (take < blockSize) {
-                std::memset(raw.data() + off + take, 0, blockSize - take);
-            }
-        }
-        // Mark the run as used in the volume bitmap.
-        for (uint32_t i = 0; i < needed; ++i) {
-            setBitmapBit(raw, bitmapByteBase, runStart + i, true);
-        }
-    }
 
-    // 3. Build the new catalog file record. SPEC §1463 layout.
+    // 1-2. Allocate the data fork (best fit, spilling into the Extents
+    //      Overflow B-tree past three extents), write it and mark the bitmap.
     const uint32_t newCNID = m_mdb.nextCNID;
+    std::array<uint16_t, 6> dataExtents{};
+    std::vector<FreeExtentIndex::Run> dataRuns;
+    const uint32_t needed =
+        writeForkExtents(raw, newCNID, HFS_FORK_DATA, data, dataExtents, dataRuns);
+
+    // 3. Build the new catalog file record. SPEC §1463 layout.
     std::vector<uint8_t> recordData(102, 0);  // catalog file record body length
     recordData[0x00] = 0x02;  // recType = file
     // Optional: fileType + creator from metadata are not exposed by the
     // FileSystemHandler interface; defaults to four-zero bytes.
     putBE32(recordData, 0x14, newCNID);
-    if (needed > 0) {
-        // dataExtents at 0x4a — 3 extents × (start, count). We only fill
-        // the first.
-        putBE16(recordData, 0x4a, runStart);
-        putBE16(recordData, 0x4c, static_cast<uint16_t>(needed));
+    // dataExtents at 0x4a — 3 extents × (start, count).
+    for (size_t i = 0; i < 6; ++i) {
+        putBE16(recordData, 0x4a + i * 2, dataExtents[i]);
     }
     putBE32(recordData, 0x1a, static_cast<uint32_t>(data.size()));   // dataLogical
     putBE32(recordData, 0x1e, static_cast<uint32_t>(needed) * blockSize); // dataPhysical
@@ -1409,7 +2249,7 @@ bool MacintoshHFSHandler::writeFile(const std::string& filename,
     }
     putBE32(raw, 0x400 + 0x1e, m_mdb.nextCNID + 1);
     putBE16(raw, 0x400 + 0x22,
-            static_cast<uint16_t>(m_mdb.freeAllocBlocks - needed));
+            static_cast<uint16_t>(m_freeExtents.freeBlocks() - needed));
 
     const std::time_t unixNow = metadata.timestamp.value_or(std::time(nullptr));
     bumpMdbWriteMetadata(raw, +1, 0, 0, toMacEpoch(unixNow));
@@ -1420,6 +2260,7 @@ bool MacintoshHFSHandler::writeFile(const std::string& filename,
 
     // 11. Commit.
     m_disk->setRawData(raw);
+    for (const auto& run : dataRuns) m_freeExtents.allocate(run);
 
     // Refresh caches.
     m_childrenByParent.clear();
@@ -1427,7 +2268,7 @@ bool MacintoshHFSHandler::writeFile(const std::string& filename,
     m_extentsOverflow.clear();
     parseMdb();
     walkExtentsOverflowLeaves();
-    walkCatalogLeaves();
+    openCatalog();
     return true;
 }
 
@@ -1445,48 +2286,21 @@ bool MacintoshHFSHandler::deleteFile(const std::string& filename) {
     const ParentResolved pr = resolveParentForMutation(filename);
     const uint32_t victimParent = pr.parentCNID;
 
-    // M10 safety: only handle files whose forks fit entirely in their initial
-    // 3 catalog extents (no Extents Overflow B-tree updates). Files larger
-    // than that surface as NotImplementedException so disk content is never
-    // partially mutated.
     const uint32_t blockSize = m_mdb.allocBlockSize;
     if (blockSize == 0) return false;
-    auto neededBlocks = [&](uint32_t logical) -> uint32_t {
-        return logical == 0 ? 0u :
-            static_cast<uint32_t>((logical + blockSize - 1) / blockSize);
-    };
-    auto extentsCover = [&](const std::array<uint16_t, 6>& ext) -> uint32_t {
-        return static_cast<uint32_t>(ext[1]) +
-               static_cast<uint32_t>(ext[3]) +
-               static_cast<uint32_t>(ext[5]);
-    };
-    const uint32_t needData = neededBlocks(victim->dataLogical);
-    const uint32_t needRsrc = neededBlocks(victim->rsrcLogical);
-    if (extentsCover(victim->dataExtents) < needData ||
-        extentsCover(victim->rsrcExtents) < needRsrc) {
-        throw NotImplementedException(
-            "Macintosh HFS delete: file uses Extents Overflow B-tree "
-            "(out of M10 scope — fork wider than 3 initial extents)");
-    }
 
     std::vector<uint8_t> raw = m_disk->getRawData();
 
-    // 1. Free both forks in the volume bitmap.
-    const uint64_t bitmapByteBase =
-        static_cast<uint64_t>(m_mdb.bitmapStart) * 512ULL;
-    uint16_t freedBlocks = 0;
-    auto freeFork = [&](const std::array<uint16_t, 6>& ext) {
-        for (size_t i = 0; i < 3; ++i) {
-            const uint16_t start = ext[i * 2];
-            const uint16_t count = ext[i * 2 + 1];
-            for (uint16_t b = 0; b < count; ++b) {
-                setBitmapBit(raw, bitmapByteBase, start + b, false);
-                ++freedBlocks;
-            }
-        }
-    };
-    freeFork(victim->dataExtents);
-    freeFork(victim->rsrcExtents);
+    // 1. Free both forks in the volume bitmap, dropping any Extents
+    //    Overflow records they own.
+    std::vector<FreeExtentIndex::Run> dataRuns, rsrcRuns;
+    uint32_t freedBlocks = 0;
+    freedBlocks += releaseForkExtents(raw, victim->cnid, HFS_FORK_DATA,
+                                      victim->dataExtents, victim->dataLogical,
+                                      dataRuns);
+    freedBlocks += releaseForkExtents(raw, victim->cnid, HFS_FORK_RESOURCE,
+                                      victim->rsrcExtents, victim->rsrcLogical,
+                                      rsrcRuns);
 
     // 2. Locate the catalog leaf node + record by walking the leaf chain.
     const uint64_t firstAllocByte =
@@ -1620,7 +2434,7 @@ bool MacintoshHFSHandler::deleteFile(const std::string& filename) {
                 static_cast<uint16_t>(m_mdb.numFiles - 1));
     }
     putBE16(raw, 0x400 + 0x22,
-            static_cast<uint16_t>(m_mdb.freeAllocBlocks + freedBlocks));
+            static_cast<uint16_t>(m_freeExtents.freeBlocks() + freedBlocks));
 
     bumpMdbWriteMetadata(raw, -1, 0, 0, toMacEpoch(std::time(nullptr)));
     applyFolderValenceByCNID(raw, m_mdb.firstAllocBlock,
@@ -1629,12 +2443,14 @@ bool MacintoshHFSHandler::deleteFile(const std::string& filename) {
                               victimParent, -1);
 
     m_disk->setRawData(raw);
+    for (const auto& run : dataRuns) m_freeExtents.release(run);
+    for (const auto& run : rsrcRuns) m_freeExtents.release(run);
     m_childrenByParent.clear();
     m_byCNID.clear();
     m_extentsOverflow.clear();
     parseMdb();
     walkExtentsOverflowLeaves();
-    walkCatalogLeaves();
+    openCatalog();
     return true;
 }
 
@@ -1663,8 +2479,12 @@ bool MacintoshHFSHandler::renameFile(const std::string& oldName,
     if (newLeaf.empty() || newLeaf.size() > 31) return false;
 
     // C1: rename preserves the file's parent. Reconstruct the full target
-    // path under the same parent as oldName, then delete-then-add.
+    // path under the same parent as oldName, then delete-then-add. The
+    // catalog key holds the stored name, which may differ in case from
+    // the one given.
     ParentResolved oldPR = resolveParentForMutation(oldName);
+    oldPR.leafName = target->macRomanName;
+    const uint32_t targetCNID = target->cnid;
     std::string newPath;
     if (oldPR.parentCNID == HFS_ROOT_CNID) {
         newPath = newLeaf;
@@ -1678,7 +2498,10 @@ bool MacintoshHFSHandler::renameFile(const std::string& oldName,
             ? std::string() : trimmed.substr(0, slash);
         newPath = parentPath.empty() ? newLeaf : (parentPath + "/" + newLeaf);
     }
-    if (lookupByPath(newPath) != nullptr) return false;
+    if (const CatalogChild* existing = lookupByPath(newPath);
+        existing && existing->cnid != targetCNID) {
+        return false;  // another entry already has the name (a case change is fine)
+    }
 
     // C3: snapshot data + rsrc forks AND the original 102-byte file record
     // body before any mutation, so we can preserve fileType / creator /
@@ -1722,17 +2545,19 @@ bool MacintoshHFSHandler::renameFile(const std::string& oldName,
         std::any_of(oldBody.begin() + 0x38, oldBody.begin() + 0x4a,
                      [](uint8_t b){ return b != 0; })) {
         std::vector<uint8_t> raw = m_disk->getRawData();
+        std::vector<FreeExtentIndex::Run> rsrcRuns;
         if (!applyRsrcForkAndMetadataPatch(raw, oldPR.parentCNID, newLeaf,
-                                             oldBody, rsrcFork)) {
+                                             oldBody, rsrcFork, rsrcRuns)) {
             return false;
         }
         m_disk->setRawData(raw);
+        for (const auto& run : rsrcRuns) m_freeExtents.allocate(run);
         m_childrenByParent.clear();
         m_byCNID.clear();
         m_extentsOverflow.clear();
         parseMdb();
         walkExtentsOverflowLeaves();
-        walkCatalogLeaves();
+        openCatalog();
     }
     return true;
 }
@@ -1765,7 +2590,9 @@ bool MacintoshHFSHandler::renameFolder(const std::string& oldName,
     // Resolve the OLD path's parent + leaf; rename happens within the same
     // parent (no move).
     ParentResolved oldPR = resolveParentForMutation(oldName);
+    oldPR.leafName = target->macRomanName;      // catalog key, as stored
     if (oldPR.leafName == newLeaf) return true;  // no-op rename
+    const uint32_t targetCNID = target->cnid;
 
     // Ensure the new name doesn't already exist under the same parent.
     std::string newPath;
@@ -1778,7 +2605,10 @@ bool MacintoshHFSHandler::renameFolder(const std::string& oldName,
             ? std::string() : trimmed.substr(0, slash);
         newPath = parentPath.empty() ? newLeaf : (parentPath + "/" + newLeaf);
     }
-    if (lookupByPath(newPath) != nullptr) return false;
+    if (const CatalogChild* existing = lookupByPath(newPath);
+        existing && existing->cnid != targetCNID) {
+        return false;  // another entry already has the name (a case change is fine)
+    }
 
     std::vector<uint8_t> raw = m_disk->getRawData();
 
@@ -1844,7 +2674,7 @@ bool MacintoshHFSHandler::renameFolder(const std::string& oldName,
     m_extentsOverflow.clear();
     parseMdb();
     walkExtentsOverflowLeaves();
-    walkCatalogLeaves();
+    openCatalog();
     return true;
 }
 
@@ -1860,63 +2690,23 @@ bool MacintoshHFSHandler::applyRsrcForkAndMetadataPatch(
         uint32_t parentCNID,
         const std::string& leaf,
         const std::vector<uint8_t>& oldBody,
-        const std::vector<uint8_t>& rsrcFork) {
+        const std::vector<uint8_t>& rsrcFork,
+        std::vector<FreeExtentIndex::Run>& rsrcRuns) {
+    rsrcRuns.clear();
     if (m_mdb.allocBlockSize == 0) return false;
     if (oldBody.size() != 102) return false;
 
     const uint32_t blockSize = m_mdb.allocBlockSize;
     const uint64_t firstAllocByte =
         static_cast<uint64_t>(m_mdb.firstAllocBlock) * 512ULL;
-    const uint64_t bitmapByteBase =
-        static_cast<uint64_t>(m_mdb.bitmapStart) * 512ULL;
 
-    // 1. Allocate a contiguous run for the rsrc fork (if non-empty).
-    uint16_t rsrcStart = 0;
-    uint32_t rsrcBlocks = 0;
-    if (!rsrcFork.empty()) {
-        rsrcBlocks = static_cast<uint32_t>(
-            (rsrcFork.size() + blockSize - 1) / blockSize);
-        if (rsrcBlocks > 0xFFFFu) {
-            throw NotImplementedException(
-                "Macintosh HFS rename: rsrc fork too large for a single extent");
-        }
-        uint16_t firstFree = 0;
-        uint16_t bestLen = 0;
-        bool found = false;
-        for (uint16_t b = 0; b < m_mdb.numAllocBlocks; ++b) {
-            if (!bitmapBit(raw, bitmapByteBase, b)) {
-                if (bestLen == 0) firstFree = b;
-                ++bestLen;
-                if (bestLen >= rsrcBlocks) {
-                    rsrcStart = firstFree;
-                    found = true;
-                    break;
-                }
-            } else {
-                bestLen = 0;
-            }
-        }
-        if (!found) {
-            throw NotImplementedException(
-                "Macintosh HFS rename: no contiguous free run for the "
-                "rsrc fork (Extents Overflow B-tree update not implemented)");
-        }
-        // Write rsrc bytes + mark bitmap.
-        for (uint32_t i = 0; i < rsrcBlocks; ++i) {
-            const uint64_t off = firstAllocByte +
-                static_cast<uint64_t>(rsrcStart + i) * blockSize;
-            const size_t srcOff = static_cast<size_t>(i) * blockSize;
-            const size_t take = std::min<size_t>(blockSize,
-                                                  rsrcFork.size() - srcOff);
-            std::memcpy(raw.data() + off, rsrcFork.data() + srcOff, take);
-            if (take < blockSize) {
-                std::memset(raw.data() + off + take, 0, blockSize - take);
-            }
-        }
-        for (uint32_t i = 0; i < rsrcBlocks; ++i) {
-            setBitmapBit(raw, bitmapByteBase, rsrcStart + i, true);
-        }
-    }
+    // 1. Allocate the rsrc fork (if non-empty) under the record's CNID.
+    const CatalogChild* target = findChild(parentCNID, leaf);
+    if (!target || target->isDirectory) return false;
+    std::array<uint16_t, 6> rsrcExtents{};
+    const uint32_t rsrcBlocks =
+        writeForkExtents(raw, target->cnid, HFS_FORK_RESOURCE, rsrcFork, rsrcExtents,
+                         rsrcRuns);
 
     // 2. Locate the new record in the catalog and patch its body bytes
     //    in place. The record was just inserted by writeFile so it lives
@@ -2011,8 +2801,8 @@ bool MacintoshHFSHandler::applyRsrcForkAndMetadataPatch(
             if (hasModifyDate) std::memcpy(body + 0x30, oldBody.data() + 0x30, 4);
 
             // Set the rsrc fork fields.
-            body[0x22] = static_cast<uint8_t>((rsrcStart >> 8) & 0xFF);
-            body[0x23] = static_cast<uint8_t>(rsrcStart & 0xFF);
+            body[0x22] = static_cast<uint8_t>((rsrcExtents[0] >> 8) & 0xFF);
+            body[0x23] = static_cast<uint8_t>(rsrcExtents[0] & 0xFF);
             const uint32_t rsrcLogical =
                 static_cast<uint32_t>(rsrcFork.size());
             const uint32_t rsrcPhysical = rsrcBlocks * blockSize;
@@ -2024,12 +2814,11 @@ bool MacintoshHFSHandler::applyRsrcForkAndMetadataPatch(
             body[0x29] = static_cast<uint8_t>((rsrcPhysical >> 16) & 0xFF);
             body[0x2a] = static_cast<uint8_t>((rsrcPhysical >> 8) & 0xFF);
             body[0x2b] = static_cast<uint8_t>(rsrcPhysical & 0xFF);
-            // rsrcExtents[0] at body+0x56
-            body[0x56] = body[0x22];
-            body[0x57] = body[0x23];
-            body[0x58] = static_cast<uint8_t>((rsrcBlocks >> 8) & 0xFF);
-            body[0x59] = static_cast<uint8_t>(rsrcBlocks & 0xFF);
-            // rsrcExtents[1..2] stay zero (allocated by writeFile).
+            // rsrcExtents at body+0x56 — the rest are in the overflow tree.
+            for (size_t k = 0; k < 6; ++k) {
+                body[0x56 + k * 2] = static_cast<uint8_t>((rsrcExtents[k] >> 8) & 0xFF);
+                body[0x57 + k * 2] = static_cast<uint8_t>(rsrcExtents[k] & 0xFF);
+            }
 
             patched = true;
             break;
@@ -2060,15 +2849,10 @@ bool MacintoshHFSHandler::applyRsrcForkAndMetadataPatch(
 
     // 3. MDB drFreeBks decrement for rsrc fork blocks consumed.
     if (rsrcBlocks > 0) {
-        // Re-read the live drFreeBks (writeFile already decremented for
-        // data fork, so we cannot use m_mdb.freeAllocBlocks which is still
-        // pre-write).
-        const uint16_t live =
-            (static_cast<uint16_t>(raw[0x400 + 0x22]) << 8) | raw[0x400 + 0x23];
-        const uint16_t newFree =
-            static_cast<uint16_t>(live - rsrcBlocks);
-        raw[0x400 + 0x22] = static_cast<uint8_t>((newFree >> 8) & 0xFF);
-        raw[0x400 + 0x23] = static_cast<uint8_t>(newFree & 0xFF);
+        // m_freeExtents already reflects the committed data fork; the
+        // rsrc runs are applied to it once the caller commits `raw`.
+        putBE16(raw, 0x400 + 0x22,
+                static_cast<uint16_t>(m_freeExtents.freeBlocks() - rsrcBlocks));
         bumpMdbWriteMetadata(raw, 0, 0, 0, toMacEpoch(std::time(nullptr)));
     }
     return true;
@@ -2138,11 +2922,13 @@ bool MacintoshHFSHandler::writeFileWithForks(
     // new record was inserted, then patch its body.
     ParentResolved pr = resolveParentForMutation(targetPath);
     std::vector<uint8_t> raw = m_disk->getRawData();
+    std::vector<FreeExtentIndex::Run> rsrcRuns;
     if (!applyRsrcForkAndMetadataPatch(raw, pr.parentCNID, pr.leafName,
-                                          templateBody, rsrcFork)) {
+                                          templateBody, rsrcFork, rsrcRuns)) {
         return false;
     }
     m_disk->setRawData(raw);
+    for (const auto& run : rsrcRuns) m_freeExtents.allocate(run);
 
     // Refresh in-memory caches so subsequent operations see the
     // updated metadata + rsrc fork extents.
@@ -2151,7 +2937,7 @@ bool MacintoshHFSHandler::writeFileWithForks(
     m_extentsOverflow.clear();
     parseMdb();
     walkExtentsOverflowLeaves();
-    walkCatalogLeaves();
+    openCatalog();
     return true;
 }
 
@@ -2434,9 +3220,10 @@ bool MacintoshHFSHandler::format(const std::string& volumeName) {
     m_extentsOverflow.clear();
     m_bootBlock = BootBlock{};
     if (!parseMdb()) return false;
+    buildFreeExtents();
     parseBootBlock();
     walkExtentsOverflowLeaves();
-    if (!walkCatalogLeaves()) return false;
+    if (!openCatalog()) return false;
     return true;
 }
 
@@ -3298,7 +4085,7 @@ bool MacintoshHFSHandler::createDirectory(const std::string& path) {
     m_extentsOverflow.clear();
     parseMdb();
     walkExtentsOverflowLeaves();
-    walkCatalogLeaves();
+    openCatalog();
     return true;
 }
 
@@ -3311,14 +4098,17 @@ bool MacintoshHFSHandler::deleteDirectory(const std::string& path) {
     // C1: resolve parent → parent CNID, allowing nested rmdir.
     ParentResolved pr = resolveParentForMutation(path);
     const uint32_t parentCNID = pr.parentCNID;
-    const std::string& leaf = pr.leafName;
-    if (leaf.empty()) return false;
+    if (pr.leafName.empty()) return false;
 
     const CatalogChild* victim = lookupByPath(path);
     if (!victim) return false;
     if (!victim->isDirectory) return false;
+    // The folder record is keyed by the stored name, not the (possibly
+    // differently cased) one in the path.
+    const std::string leaf = victim->macRomanName;
 
     // Emptiness check via cached catalog (refreshed at end of every mutator).
+    loadCatalogChildren(victim->cnid);
     auto childIt = m_childrenByParent.find(victim->cnid);
     if (childIt != m_childrenByParent.end() && !childIt->second.empty()) {
         return false;  // non-empty — POSIX rmdir semantics
@@ -3354,12 +4144,14 @@ bool MacintoshHFSHandler::deleteDirectory(const std::string& path) {
     m_extentsOverflow.clear();
     parseMdb();
     walkExtentsOverflowLeaves();
-    walkCatalogLeaves();
+    openCatalog();
     return true;
 }
 
 size_t MacintoshHFSHandler::getFreeSpace() const {
-    return static_cast<size_t>(m_mdb.freeAllocBlocks) *
+    // Counted from the volume bitmap; drFreeBks can be stale on images
+    // written by other tools.
+    return static_cast<size_t>(m_freeExtents.freeBlocks()) *
            static_cast<size_t>(m_mdb.allocBlockSize);
 }
 
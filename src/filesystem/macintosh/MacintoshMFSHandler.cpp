@@ -3,6 +3,7 @@
 #include "rdedisktool/utils/MacEpoch.h"
 #include "rdedisktool/utils/MacRoman.h"
 #include "rdedisktool/utils/PascalString.h"
+#include "rdedisktool/utils/Stats.h"
 
 #include <algorithm>
 #include <cstring>
@@ -37,16 +38,33 @@ constexpr size_t MFS_DIR_ENTRY_HEADER = 0x32;  // bytes before flNam
 } // namespace
 
 uint16_t MacintoshMFSHandler::readAllocEntry(size_t index) const {
+    return index < m_allocMap.size() ? m_allocMap[index] : MFS_FREE_OR_BAD_0;
+}
+
+// Decode the whole 12-bit map once; entries past the end of the image read
+// as free.
+void MacintoshMFSHandler::loadAllocMap() {
     const auto& raw = m_disk->getRawData();
     const size_t mapOffset = MFS_MDB_OFFSET + MFS_MAP_OFFSET_IN_MDB;
-    const size_t byteOffset = mapOffset + (index * 12) / 8;
-    if (byteOffset + 1 >= raw.size()) return MFS_FREE_OR_BAD_0;
-    const uint8_t b0 = raw[byteOffset];
-    const uint8_t b1 = raw[byteOffset + 1];
-    if ((index & 1U) == 0) {
-        return static_cast<uint16_t>((b0 << 4) | (b1 >> 4));
-    } else {
-        return static_cast<uint16_t>(((b0 & 0x0F) << 8) | b1);
+    m_allocMap.assign(m_mdb.numAllocBlocks, MFS_FREE_OR_BAD_0);
+    for (size_t index = 0; index < m_allocMap.size(); ++index) {
+        const size_t byteOffset = mapOffset + (index * 12) / 8;
+        if (byteOffset + 1 >= raw.size()) break;
+        const uint8_t b0 = raw[byteOffset];
+        const uint8_t b1 = raw[byteOffset + 1];
+        if ((index & 1U) == 0) {
+            m_allocMap[index] = static_cast<uint16_t>((b0 << 4) | (b1 >> 4));
+        } else {
+            m_allocMap[index] = static_cast<uint16_t>(((b0 & 0x0F) << 8) | b1);
+        }
+    }
+}
+
+void MacintoshMFSHandler::indexEntries() {
+    m_byName.clear();
+    m_byName.reserve(m_entries.size());
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        m_byName.emplace(m_entries[i].name, i);
     }
 }
 
@@ -65,6 +83,7 @@ bool MacintoshMFSHandler::initialize(DiskImage* disk) {
     if (!parseMdb()) return false;
     parseBootBlock();
     if (!parseDirectory()) return false;
+    loadAllocMap();
     return true;
 }
 
@@ -158,6 +177,7 @@ bool MacintoshMFSHandler::parseDirectory() {
             off += entryLen;
         }
     }
+    indexEntries();
     return true;
 }
 
@@ -176,17 +196,16 @@ MacintoshMFSHandler::findEntry(const std::string& name) const {
     // MFS is flat — name must be a leaf with no slashes.
     if (p.find('/') != std::string::npos) return nullptr;
 
-    for (const auto& e : m_entries) {
-        if (e.name == p) return &e;
-    }
-    return nullptr;
+    auto it = m_byName.find(p);
+    return it != m_byName.end() ? &m_entries[it->second] : nullptr;
 }
 
-std::vector<uint8_t> MacintoshMFSHandler::extractFork(uint16_t startBlock,
-                                                       uint32_t logical) const {
-    std::vector<uint8_t> out;
-    if (logical == 0 || startBlock < 2) return out;
-    const auto& raw = m_disk->getRawData();
+std::vector<std::pair<uint64_t, size_t>> MacintoshMFSHandler::forkSpans(
+        uint16_t startBlock, uint32_t logical) const {
+    std::vector<std::pair<uint64_t, size_t>> spans;
+    if (logical == 0 || startBlock < 2) return spans;
+    const uint64_t imageSize = m_disk->getRawData().size();
+    uint64_t remaining = logical;
 
     uint16_t block = startBlock;
     std::vector<bool> visited(static_cast<size_t>(m_mdb.numAllocBlocks) + 4, false);
@@ -198,11 +217,12 @@ std::vector<uint8_t> MacintoshMFSHandler::extractFork(uint16_t startBlock,
             visited[idx] = true;
         }
         const uint64_t off = blockOffset(block);
-        if (off >= raw.size()) break;
+        if (off >= imageSize) break;
         const uint64_t blockSize = m_mdb.allocBlockSize;
-        const uint64_t take = std::min<uint64_t>(blockSize, raw.size() - off);
-        out.insert(out.end(), raw.begin() + off, raw.begin() + off + take);
-        if (out.size() >= logical) break;
+        const uint64_t take = std::min({blockSize, imageSize - off, remaining});
+        spans.emplace_back(off, static_cast<size_t>(take));
+        remaining -= take;
+        if (remaining == 0) break;
 
         // Allocation map index for this block is (block - 2).
         const size_t mapIdx = static_cast<size_t>(block) - 2;
@@ -213,8 +233,21 @@ std::vector<uint8_t> MacintoshMFSHandler::extractFork(uint16_t startBlock,
         if (next == MFS_FREE_OR_BAD_F)          break;
         block = next;
     }
+    return spans;
+}
 
-    if (out.size() > logical) out.resize(logical);
+std::vector<uint8_t> MacintoshMFSHandler::extractFork(uint16_t startBlock,
+                                                       uint32_t logical) const {
+    const auto spans = forkSpans(startBlock, logical);
+    size_t total = 0;
+    for (const auto& span : spans) total += span.second;
+    std::vector<uint8_t> out;
+    out.reserve(total);
+    const uint8_t* image = m_disk->getRawData().data();
+    for (const auto& span : spans) {
+        out.insert(out.end(), image + span.first, image + span.first + span.second);
+        Stats::sectorRead(span.second, (span.second + 511) / 512);
+    }
     return out;
 }
 
@@ -250,6 +283,22 @@ std::vector<uint8_t> MacintoshMFSHandler::readFile(const std::string& filename)
     return extractFork(e->dataStartBlock, e->dataLogical);
 }
 
+bool MacintoshMFSHandler::getFileExtents(const std::string& filename,
+                                         std::vector<std::pair<size_t, size_t>>& extents) {
+    const DirEntry* e = findEntry(filename);
+    if (!e) {
+        throw FileNotFoundException(filename);
+    }
+    extents.clear();
+    for (const auto& span : forkSpans(e->dataStartBlock, e->dataLogical)) {
+        extents.emplace_back(static_cast<size_t>(span.first), span.second);
+    }
+    for (const auto& span : forkSpans(e->rsrcStartBlock, e->rsrcLogical)) {
+        extents.emplace_back(static_cast<size_t>(span.first), span.second);
+    }
+    return true;
+}
+
 // 12-bit BE allocation map writer. Inverse of readAllocEntry.
 void MacintoshMFSHandler::writeAllocEntry(std::vector<uint8_t>& raw,
                                             size_t index, uint16_t value) const {
@@ -276,9 +325,8 @@ std::vector<uint16_t> MacintoshMFSHandler::findFreeBlocks(
         const std::vector<uint8_t>& /*raw*/, size_t need) const {
     std::vector<uint16_t> out;
     out.reserve(need);
-    for (size_t idx = 0; idx < m_mdb.numAllocBlocks && out.size() < need; ++idx) {
-        const uint16_t v = readAllocEntry(idx);
-        if (v == MFS_FREE_OR_BAD_0) {
+    for (size_t idx = 0; idx < m_allocMap.size() && out.size() < need; ++idx) {
+        if (m_allocMap[idx] == MFS_FREE_OR_BAD_0) {
             // free
             out.push_back(static_cast<uint16_t>(idx + 2));
         }
@@ -287,7 +335,8 @@ std::vector<uint16_t> MacintoshMFSHandler::findFreeBlocks(
 }
 
 bool MacintoshMFSHandler::insertDirectoryEntry(std::vector<uint8_t>& raw,
-                                                  const DirEntry& de) const {
+                                                  const DirEntry& de,
+                                                  size_t& entryIndex) const {
     const uint64_t dirStartByte =
         static_cast<uint64_t>(m_mdb.directoryStart) * 512ULL;
     const uint64_t dirEndByte =
@@ -343,7 +392,9 @@ bool MacintoshMFSHandler::insertDirectoryEntry(std::vector<uint8_t>& raw,
 
     // Find a 512-byte directory block with enough trailing free space
     // (sentinel-zero region must be large enough to fit the new entry +
-    // a final zero terminator byte).
+    // a final zero terminator byte). Active entries passed on the way give
+    // the new entry's position in parseDirectory() order.
+    entryIndex = 0;
     for (uint64_t blockBase = dirStartByte; blockBase < dirEndByte;
          blockBase += MFS_DIR_BLOCK_SIZE) {
         size_t off = 0;
@@ -353,6 +404,7 @@ bool MacintoshMFSHandler::insertDirectoryEntry(std::vector<uint8_t>& raw,
             const uint8_t nLen = raw[blockBase + off + 0x32];
             size_t curLen = MFS_DIR_ENTRY_HEADER + 1U + nLen;
             if (curLen & 1U) curLen += 1;
+            if ((flags & 0x80) && off + curLen <= MFS_DIR_BLOCK_SIZE) ++entryIndex;
             off += curLen;
         }
         if (off + entryLen <= MFS_DIR_BLOCK_SIZE) {
@@ -468,7 +520,8 @@ bool MacintoshMFSHandler::writeFile(const std::string& filename,
     de.createDate = 0;
     de.modifyDate = 0;
 
-    if (!insertDirectoryEntry(raw, de)) {
+    size_t entryIndex = 0;
+    if (!insertDirectoryEntry(raw, de, entryIndex)) {
         // Roll back: free the blocks we just allocated.
         for (size_t i = 0; i < needed; ++i) {
             const size_t mapIdx = static_cast<size_t>(blocks[i]) - 2;
@@ -483,10 +536,20 @@ bool MacintoshMFSHandler::writeFile(const std::string& filename,
     // Commit.
     m_disk->setRawData(raw);
 
-    // Refresh the cached structures.
-    m_entries.clear();
+    // Refresh the cached structures. The entry is cached as parseDirectory()
+    // would read it back: the name bytes were stored as given.
+    for (size_t i = 0; i < needed; ++i) {
+        m_allocMap[blocks[i] - 2U] = (i + 1 < needed) ? blocks[i + 1] : MFS_CHAIN_END;
+    }
+    de.macRomanName = leaf.substr(0, 255);
+    de.name = macRomanToUtf8(de.macRomanName);
+    std::memcpy(de.flUsrWds, de.fileType, 4);
+    std::memcpy(de.flUsrWds + 4, de.creator, 4);
+    m_entries.insert(m_entries.begin() + static_cast<std::ptrdiff_t>(
+                         std::min(entryIndex, m_entries.size())),
+                     std::move(de));
+    indexEntries();
     parseMdb();
-    parseDirectory();
     return true;
 }
 
@@ -510,6 +573,7 @@ bool MacintoshMFSHandler::deleteFile(const std::string& filename) {
     const size_t blockSize = m_mdb.allocBlockSize;
     if (blockSize == 0) return false;
     int freedBlocks = 0;
+    std::vector<size_t> freedIndices;
     {
         uint16_t block = victim->dataStartBlock;
         std::vector<bool> visited(static_cast<size_t>(m_mdb.numAllocBlocks) + 4, false);
@@ -520,6 +584,7 @@ bool MacintoshMFSHandler::deleteFile(const std::string& filename) {
             visited[mapIdx] = true;
             const uint16_t next = readAllocEntry(mapIdx);
             writeAllocEntry(raw, mapIdx, MFS_FREE_OR_BAD_0);
+            freedIndices.push_back(mapIdx);
             freedBlocks++;
             if (next == MFS_CHAIN_END || next == MFS_FREE_OR_BAD_0 ||
                 next == MFS_FREE_OR_BAD_F) break;
@@ -576,9 +641,10 @@ bool MacintoshMFSHandler::deleteFile(const std::string& filename) {
     m_disk->setRawData(raw);
 
     // Refresh caches.
-    m_entries.clear();
+    for (size_t idx : freedIndices) m_allocMap[idx] = MFS_FREE_OR_BAD_0;
+    m_entries.erase(m_entries.begin() + (victim - m_entries.data()));
+    indexEntries();
     parseMdb();
-    parseDirectory();
     return true;
 }
 
@@ -714,6 +780,7 @@ bool MacintoshMFSHandler::format(const std::string& volumeName) {
     m_entries.clear();
     if (!parseMdb()) return false;
     if (!parseDirectory()) return false;
+    loadAllocMap();
     return true;
 }
 
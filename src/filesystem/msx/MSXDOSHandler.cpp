@@ -30,6 +30,7 @@ bool MSXDOSHandler::initialize(DiskImage* disk) {
         return false;
     }
     m_disk = disk;
+    m_dirCache.clear();
     return parseBPB();
 }
 
@@ -338,6 +339,8 @@ void MSXDOSHandler::writeRootDirectory(const std::vector<DirEntry>& entries) {
         return;
     }
 
+    invalidateDirectoryCache(0);
+
     // Build directory data using BinaryWriter
     std::vector<uint8_t> dirData(m_rootDirSectors * m_bytesPerSector, 0);
 
@@ -551,21 +554,21 @@ std::vector<FileEntry> MSXDOSHandler::listFiles(const std::string& path) {
 
         if (!dirName.empty()) {
             // Find the directory entry and get its cluster
-            auto parentEntries = getDirectoryEntries(parentCluster);
-            int idx = findDirectoryEntry(parentEntries, dirName);
+            const auto& parent = getCachedDirectory(parentCluster);
+            int idx = lookupEntry(parent, dirName);
             if (idx < 0) {
                 throw FileNotFoundException("Directory not found: " + path);
             }
-            if (!(parentEntries[idx].attr & ATTR_DIRECTORY)) {
+            if (!(parent.entries[idx].attr & ATTR_DIRECTORY)) {
                 throw DiskException(DiskError::InvalidParameter, "Not a directory: " + path);
             }
-            dirCluster = parentEntries[idx].startCluster;
+            dirCluster = parent.entries[idx].startCluster;
         } else {
             dirCluster = parentCluster;
         }
     }
 
-    auto entries = getDirectoryEntries(dirCluster);
+    const auto& entries = getCachedDirectory(dirCluster).entries;
 
     for (const auto& entry : entries) {
         // Skip deleted entries
@@ -591,7 +594,7 @@ std::vector<FileEntry> MSXDOSHandler::listFiles(const std::string& path) {
     return files;
 }
 
-std::vector<uint8_t> MSXDOSHandler::readFile(const std::string& filename) {
+MSXDOSHandler::DirEntry MSXDOSHandler::findFileEntry(const std::string& filename) const {
     // Resolve path to find directory and filename
     auto [dirCluster, baseName] = resolvePath(filename);
 
@@ -600,17 +603,22 @@ std::vector<uint8_t> MSXDOSHandler::readFile(const std::string& filename) {
         throw FileNotFoundException("File not found: " + filename);
     }
 
-    auto entries = getDirectoryEntries(dirCluster);
-    int index = findDirectoryEntry(entries, baseName);
+    const auto& dir = getCachedDirectory(dirCluster);
+    int index = lookupEntry(dir, baseName);
 
     if (index < 0) {
         throw FileNotFoundException("File not found: " + filename);
     }
 
-    const auto& entry = entries[index];
+    const DirEntry entry = dir.entries[index];
     if (entry.attr & ATTR_DIRECTORY) {
         throw DiskException(DiskError::InvalidParameter, "Cannot read directory as file: " + filename);
     }
+    return entry;
+}
+
+std::vector<uint8_t> MSXDOSHandler::readFile(const std::string& filename) {
+    const DirEntry entry = findFileEntry(filename);
 
     std::vector<uint8_t> data;
     data.reserve(entry.fileSize);
@@ -629,6 +637,31 @@ std::vector<uint8_t> MSXDOSHandler::readFile(const std::string& filename) {
     return data;
 }
 
+bool MSXDOSHandler::getFileExtents(const std::string& filename,
+                                   std::vector<std::pair<size_t, size_t>>& extents) {
+    const DirEntry entry = findFileEntry(filename);
+
+    extents.clear();
+    for (uint16_t cluster : getClusterChain(entry.startCluster)) {
+        // Same sector addressing as readCluster()
+        uint32_t firstSector = m_firstDataSector + ((cluster - 2) * m_sectorsPerCluster);
+        for (uint8_t i = 0; i < m_sectorsPerCluster; ++i) {
+            uint32_t sector = firstSector + i;
+            uint16_t track = sector / m_sectorsPerTrack;
+            uint16_t head = 0;
+            if (m_numberOfHeads > 1) {
+                head = track % m_numberOfHeads;
+                track /= m_numberOfHeads;
+            }
+            if (!appendSectorExtent(extents, track, head, sector % m_sectorsPerTrack,
+                                    m_bytesPerSector)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 bool MSXDOSHandler::writeFile(const std::string& filename,
                               const std::vector<uint8_t>& data,
                               const FileMetadata& metadata) {
@@ -647,7 +680,7 @@ bool MSXDOSHandler::writeFile(const std::string& filename,
     auto fat = readFAT();
 
     // Check if file already exists
-    int existingIndex = findDirectoryEntry(entries, baseName);
+    int existingIndex = lookupEntry(getCachedDirectory(dirCluster), baseName);
     if (existingIndex >= 0) {
         // Free existing clusters
         freeClusterChain(fat, entries[existingIndex].startCluster);
@@ -747,13 +780,13 @@ bool MSXDOSHandler::deleteFile(const std::string& filename) {
         return false;
     }
 
-    auto entries = getDirectoryEntries(dirCluster);
-    int index = findDirectoryEntry(entries, baseName);
+    int index = lookupEntry(getCachedDirectory(dirCluster), baseName);
 
     if (index < 0) {
         return false;
     }
 
+    auto entries = getDirectoryEntries(dirCluster);
     auto& entry = entries[index];
     if (entry.attr & ATTR_DIRECTORY) {
         // Use deleteDirectory for directories
@@ -792,9 +825,9 @@ bool MSXDOSHandler::renameFile(const std::string& oldName, const std::string& ne
         return false; // Move between directories not supported yet
     }
 
-    auto entries = getDirectoryEntries(oldDirCluster);
-    int oldIndex = findDirectoryEntry(entries, oldBaseName);
-    int newIndex = findDirectoryEntry(entries, newBaseName);
+    const auto& dir = getCachedDirectory(oldDirCluster);
+    int oldIndex = lookupEntry(dir, oldBaseName);
+    int newIndex = lookupEntry(dir, newBaseName);
 
     if (oldIndex < 0) {
         return false; // Source doesn't exist
@@ -804,6 +837,7 @@ bool MSXDOSHandler::renameFile(const std::string& oldName, const std::string& ne
         return false; // Destination already exists
     }
 
+    auto entries = dir.entries;
     parseFilename(newBaseName, entries[oldIndex].name, entries[oldIndex].ext);
     setDirectoryEntries(oldDirCluster, entries);
     return true;
@@ -823,8 +857,7 @@ bool MSXDOSHandler::fileExists(const std::string& filename) const {
         if (baseName.empty()) {
             return false;
         }
-        auto entries = getDirectoryEntries(dirCluster);
-        return findDirectoryEntry(entries, baseName) >= 0;
+        return lookupEntry(getCachedDirectory(dirCluster), baseName) >= 0;
     } catch (const FileNotFoundException&) {
         return false;  // Parent directory doesn't exist
     }
@@ -890,6 +923,8 @@ bool MSXDOSHandler::format(const std::string& volumeName) {
     m_dataSectors = m_totalSectors - m_firstDataSector;
     m_totalClusters = m_dataSectors / m_sectorsPerCluster;
 
+    m_dirCache.clear();
+
     // Clear all sectors
     std::vector<uint8_t> emptySector(m_bytesPerSector, 0);
     for (size_t t = 0; t < geom.tracks; ++t) {
@@ -1025,32 +1060,14 @@ std::pair<uint16_t, std::string> MSXDOSHandler::resolvePath(const std::string& p
     uint16_t currentCluster = 0;  // Start from root
 
     for (const auto& component : components) {
-        auto entries = getDirectoryEntries(currentCluster);
-        int idx = -1;
-
-        // Find directory entry
-        char name[8], ext[3];
-        parseFilename(component, name, ext);
+        const auto& dir = getCachedDirectory(currentCluster);
+        int idx = lookupEntry(dir, component);
 
-        for (size_t i = 0; i < entries.size(); ++i) {
-            const auto& entry = entries[i];
-            if (static_cast<uint8_t>(entry.name[0]) == DIR_FREE) continue;
-            if (static_cast<uint8_t>(entry.name[0]) == DIR_END) break;
-            // Skip volume labels (they are not directories)
-            if (entry.attr & ATTR_VOLUME_ID) continue;
-
-            if (std::memcmp(entry.name, name, 8) == 0 &&
-                std::memcmp(entry.ext, ext, 3) == 0) {
-                idx = static_cast<int>(i);
-                break;
-            }
-        }
-
-        if (idx < 0 || !(entries[idx].attr & ATTR_DIRECTORY)) {
+        if (idx < 0 || !(dir.entries[idx].attr & ATTR_DIRECTORY)) {
             throw FileNotFoundException("Directory not found: " + component);
         }
 
-        currentCluster = entries[idx].startCluster;
+        currentCluster = dir.entries[idx].startCluster;
     }
 
     return {currentCluster, targetName};
@@ -1098,6 +1115,8 @@ void MSXDOSHandler::writeDirectoryCluster(uint16_t cluster, const std::vector<Di
         return;
     }
 
+    invalidateDirectoryCache(cluster);
+
     size_t clusterSize = m_sectorsPerCluster * m_bytesPerSector;
     size_t entriesPerCluster = clusterSize / 32;
 
@@ -1159,15 +1178,48 @@ void MSXDOSHandler::writeDirectoryCluster(uint16_t cluster, const std::vector<Di
 }
 
 int MSXDOSHandler::findEntryInDirectory(uint16_t cluster, const std::string& name) const {
-    auto entries = getDirectoryEntries(cluster);
-    return findDirectoryEntry(entries, name);
+    return lookupEntry(getCachedDirectory(cluster), name);
 }
 
 std::vector<MSXDOSHandler::DirEntry> MSXDOSHandler::getDirectoryEntries(uint16_t cluster) const {
-    if (cluster == 0) {
-        return readRootDirectory();
+    return getCachedDirectory(cluster).entries;
+}
+
+const MSXDOSHandler::DirectoryCache& MSXDOSHandler::getCachedDirectory(uint16_t cluster) const {
+    auto it = m_dirCache.find(cluster);
+    if (it != m_dirCache.end()) {
+        return it->second;
     }
-    return readDirectoryCluster(cluster);
+
+    DirectoryCache dir;
+    dir.entries = (cluster == 0) ? readRootDirectory() : readDirectoryCluster(cluster);
+
+    // Index live entries by padded 8.3 name; the first match wins, as in
+    // findDirectoryEntry()
+    for (size_t i = 0; i < dir.entries.size(); ++i) {
+        const auto& entry = dir.entries[i];
+        if (static_cast<uint8_t>(entry.name[0]) == DIR_FREE ||
+            static_cast<uint8_t>(entry.name[0]) == DIR_END ||
+            (entry.attr & ATTR_VOLUME_ID)) {
+            continue;
+        }
+        std::string key(entry.name, 8);
+        key.append(entry.ext, 3);
+        dir.index.emplace(std::move(key), static_cast<int>(i));
+    }
+
+    return m_dirCache.emplace(cluster, std::move(dir)).first->second;
+}
+
+int MSXDOSHandler::lookupEntry(const DirectoryCache& dir, const std::string& filename) const {
+    char name[8], ext[3];
+    parseFilename(filename, name, ext);
+
+    std::string key(name, 8);
+    key.append(ext, 3);
+
+    auto it = dir.index.find(key);
+    return it != dir.index.end() ? it->second : -1;
 }
 
 void MSXDOSHandler::setDirectoryEntries(uint16_t cluster, const std::vector<DirEntry>& entries) {
@@ -1191,10 +1243,10 @@ bool MSXDOSHandler::createDirectory(const std::string& path) {
     }
 
     // Check if already exists
-    auto parentEntries = getDirectoryEntries(parentCluster);
-    if (findDirectoryEntry(parentEntries, dirName) >= 0) {
+    if (lookupEntry(getCachedDirectory(parentCluster), dirName) >= 0) {
         return false;  // Already exists
     }
+    auto parentEntries = getDirectoryEntries(parentCluster);
 
     // Allocate a cluster for the new directory
     auto fat = readFAT();
@@ -1252,6 +1304,7 @@ bool MSXDOSHandler::createDirectory(const std::string& path) {
     }
 
     writeCluster(newCluster, dirData);
+    invalidateDirectoryCache(newCluster);
 
     // Create entry in parent directory
     DirEntry newEntry{};
@@ -1296,13 +1349,13 @@ bool MSXDOSHandler::deleteDirectory(const std::string& path) {
         return false;
     }
 
-    auto parentEntries = getDirectoryEntries(parentCluster);
-    int idx = findDirectoryEntry(parentEntries, dirName);
+    int idx = lookupEntry(getCachedDirectory(parentCluster), dirName);
 
     if (idx < 0) {
         return false;  // Not found
     }
 
+    auto parentEntries = getDirectoryEntries(parentCluster);
     auto& entry = parentEntries[idx];
 
     if (!(entry.attr & ATTR_DIRECTORY)) {
@@ -1329,6 +1382,7 @@ bool MSXDOSHandler::deleteDirectory(const std::string& path) {
     // Free directory clusters
     auto fat = readFAT();
     freeClusterChain(fat, entry.startCluster);
+    invalidateDirectoryCache(entry.startCluster);
 
     // Mark entry as deleted
     entry.name[0] = static_cast<char>(DIR_FREE);
@@ -1351,14 +1405,14 @@ bool MSXDOSHandler::isDirectory(const std::string& path) const {
         return true;  // Path resolved to root
     }
 
-    auto entries = getDirectoryEntries(parentCluster);
-    int idx = findDirectoryEntry(entries, targetName);
+    const auto& dir = getCachedDirectory(parentCluster);
+    int idx = lookupEntry(dir, targetName);
 
     if (idx < 0) {
         return false;  // Not found
     }
 
-    return (entries[idx].attr & ATTR_DIRECTORY) != 0;
+    return (dir.entries[idx].attr & ATTR_DIRECTORY) != 0;
 }
 
 } // namespace rde
@@ -51,6 +51,70 @@ void Human68kHandler::writeLogicalSector(uint32_t logicalSector, const std::vect
     m_disk->writeSector(cylinder, side, sector + 1, data);
 }
 
+void Human68kHandler::readSectors(uint32_t firstSector, uint32_t count, uint8_t* out) const {
+    if (!m_directImage) {
+        for (uint32_t i = 0; i < count; ++i) {
+            auto sector = readLogicalSector(firstSector + i);
+            std::memcpy(out + i * m_bytesPerSector, sector.data(),
+                        std::min<size_t>(sector.size(), m_bytesPerSector));
+        }
+        return;
+    }
+
+    // Linear track == logical sector / sectors per track (2 heads); copy
+    // each run of sectors that stays within one track in one go
+    uint32_t logical = firstSector;
+    uint32_t remaining = count;
+    while (remaining > 0) {
+        size_t track = logical / m_sectorsPerTrack;
+        size_t sector = logical % m_sectorsPerTrack;
+        uint32_t run = std::min<uint32_t>(remaining, m_sectorsPerTrack - sector);
+        size_t bytes = static_cast<size_t>(run) * m_bytesPerSector;
+
+        const uint8_t* src = m_directImage->sectorData(track, sector + 1);
+        if (src) {
+            std::memcpy(out, src, bytes);
+        } else {
+            // Not stored contiguously (absent DIM track): per-sector read
+            for (uint32_t i = 0; i < run; ++i) {
+                auto data = readLogicalSector(logical + i);
+                std::memcpy(out + i * m_bytesPerSector, data.data(),
+                            std::min<size_t>(data.size(), m_bytesPerSector));
+            }
+        }
+
+        out += bytes;
+        logical += run;
+        remaining -= run;
+    }
+}
+
+void Human68kHandler::writeSectors(uint32_t firstSector, uint32_t count, const uint8_t* data) {
+    if (!m_directImage) {
+        for (uint32_t i = 0; i < count; ++i) {
+            std::vector<uint8_t> sector(data + i * m_bytesPerSector,
+                                        data + (i + 1) * m_bytesPerSector);
+            writeLogicalSector(firstSector + i, sector);
+        }
+        return;
+    }
+
+    uint32_t logical = firstSector;
+    uint32_t remaining = count;
+    while (remaining > 0) {
+        size_t track = logical / m_sectorsPerTrack;
+        size_t sector = logical % m_sectorsPerTrack;
+        uint32_t run = std::min<uint32_t>(remaining, m_sectorsPerTrack - sector);
+        size_t bytes = static_cast<size_t>(run) * m_bytesPerSector;
+
+        std::memcpy(m_directImage->mutableSectorData(track, sector + 1), data, bytes);
+
+        data += bytes;
+        logical += run;
+        remaining -= run;
+    }
+}
+
 //=============================================================================
 // BPB Parsing
 //=============================================================================
@@ -114,45 +178,96 @@ bool Human68kHandler::parseBPB() {
         return false;
     }
 
+    updateGeometryCache();
     return true;
 }
 
+void Human68kHandler::updateGeometryCache() {
+    m_rootDirStart = m_reservedSectors + (m_numberOfFATs * m_sectorsPerFAT);
+    m_bytesPerCluster = static_cast<size_t>(m_sectorsPerCluster) * m_bytesPerSector;
+
+    // XDF and DIM keep each track contiguous; the linear-track mapping only
+    // holds when the BPB layout matches the image geometry exactly
+    m_directImage = dynamic_cast<X68000DiskImage*>(m_disk);
+    if (m_directImage) {
+        const DiskGeometry geom = m_directImage->getGeometry();
+        if (geom.bytesPerSector != m_bytesPerSector ||
+            geom.sectorsPerTrack != m_sectorsPerTrack ||
+            m_numberOfHeads != 2) {
+            m_directImage = nullptr;
+        }
+    }
+
+    m_fatCache.clear();
+    m_fatRaw.clear();
+    m_fatLoaded = false;
+    m_fatDirty = false;
+    m_dirCache.clear();
+}
+
 //=============================================================================
 // FAT Operations
 //=============================================================================
 
-std::vector<uint8_t> Human68kHandler::readFAT() const {
-    std::vector<uint8_t> fat;
-    fat.reserve(m_sectorsPerFAT * m_bytesPerSector);
+const std::vector<uint16_t>& Human68kHandler::fatTable() const {
+    if (!m_fatLoaded) {
+        // Decode the first FAT copy once; later lookups hit the cache
+        m_fatRaw.assign(static_cast<size_t>(m_sectorsPerFAT) * m_bytesPerSector, 0);
+        readSectors(m_reservedSectors, m_sectorsPerFAT, m_fatRaw.data());
 
-    for (uint16_t i = 0; i < m_sectorsPerFAT; ++i) {
-        auto sector = readLogicalSector(m_reservedSectors + i);
-        fat.insert(fat.end(), sector.begin(), sector.end());
+        m_fatCache.assign(static_cast<size_t>(m_totalClusters) + 2, FAT12_EOF);
+        for (size_t cluster = 0; cluster < m_fatCache.size(); ++cluster) {
+            m_fatCache[cluster] = decodeFATEntry(m_fatRaw, static_cast<uint16_t>(cluster));
+        }
+        m_fatLoaded = true;
     }
+    return m_fatCache;
+}
 
-    return fat;
+uint16_t Human68kHandler::getFATEntry(uint16_t cluster) const {
+    const auto& fat = fatTable();
+    return cluster < fat.size() ? fat[cluster] : FAT12_EOF;
 }
 
-void Human68kHandler::writeFAT(const std::vector<uint8_t>& fat) {
-    // Write to all FAT copies
-    for (uint8_t fatNum = 0; fatNum < m_numberOfFATs; ++fatNum) {
-        uint32_t fatStart = m_reservedSectors + (fatNum * m_sectorsPerFAT);
+void Human68kHandler::setFATEntry(uint16_t cluster, uint16_t value) {
+    fatTable();
+    if (cluster < m_fatCache.size()) {
+        m_fatCache[cluster] = value & 0x0FFF;
+        m_fatDirty = true;
+    }
+}
 
-        for (uint16_t i = 0; i < m_sectorsPerFAT; ++i) {
-            std::vector<uint8_t> sector(m_bytesPerSector, 0);
-            size_t offset = i * m_bytesPerSector;
-            size_t copySize = std::min(static_cast<size_t>(m_bytesPerSector), fat.size() - offset);
+void Human68kHandler::commitFAT() {
+    if (!m_fatDirty) {
+        return;
+    }
 
-            if (offset < fat.size()) {
-                std::copy(fat.begin() + offset, fat.begin() + offset + copySize, sector.begin());
-            }
+    for (size_t cluster = 0; cluster < m_fatCache.size(); ++cluster) {
+        encodeFATEntry(m_fatRaw, static_cast<uint16_t>(cluster), m_fatCache[cluster]);
+    }
+    writeFATCopies(m_fatRaw);
+    m_fatDirty = false;
+}
 
-            writeLogicalSector(fatStart + i, sector);
-        }
+void Human68kHandler::discardFATChanges() {
+    m_fatCache.clear();
+    m_fatRaw.clear();
+    m_fatLoaded = false;
+    m_fatDirty = false;
+}
+
+void Human68kHandler::writeFATCopies(const std::vector<uint8_t>& fat) {
+    // Write to all FAT copies
+    std::vector<uint8_t> image(static_cast<size_t>(m_sectorsPerFAT) * m_bytesPerSector, 0);
+    std::copy(fat.begin(), fat.begin() + std::min(fat.size(), image.size()), image.begin());
+
+    for (uint8_t fatNum = 0; fatNum < m_numberOfFATs; ++fatNum) {
+        uint32_t fatStart = m_reservedSectors + (fatNum * m_sectorsPerFAT);
+        writeSectors(fatStart, m_sectorsPerFAT, image.data());
     }
 }
 
-uint16_t Human68kHandler::getFATEntry(const std::vector<uint8_t>& fat, uint16_t cluster) const {
+uint16_t Human68kHandler::decodeFATEntry(const std::vector<uint8_t>& fat, uint16_t cluster) {
     // FAT12 entry extraction
     size_t offset = cluster + (cluster / 2);
 
@@ -171,7 +286,7 @@ uint16_t Human68kHandler::getFATEntry(const std::vector<uint8_t>& fat, uint16_t
     return value;
 }
 
-void Human68kHandler::setFATEntry(std::vector<uint8_t>& fat, uint16_t cluster, uint16_t value) {
+void Human68kHandler::encodeFATEntry(std::vector<uint8_t>& fat, uint16_t cluster, uint16_t value) {
     // FAT12 entry setting
     size_t offset = cluster + (cluster / 2);
 
@@ -190,12 +305,11 @@ void Human68kHandler::setFATEntry(std::vector<uint8_t>& fat, uint16_t cluster, u
 
 std::vector<uint16_t> Human68kHandler::getClusterChain(uint16_t startCluster) const {
     std::vector<uint16_t> chain;
-    auto fat = readFAT();
 
     uint16_t cluster = startCluster;
     while (cluster >= 2 && cluster < FAT12_RESERVED) {
         chain.push_back(cluster);
-        cluster = getFATEntry(fat, cluster);
+        cluster = getFATEntry(cluster);
 
         // Prevent infinite loops
         if (chain.size() > m_totalClusters) {
@@ -206,22 +320,23 @@ std::vector<uint16_t> Human68kHandler::getClusterChain(uint16_t startCluster) co
     return chain;
 }
 
-uint16_t Human68kHandler::allocateCluster(std::vector<uint8_t>& fat) {
+uint16_t Human68kHandler::allocateCluster() {
     // Start from cluster 2 (0 and 1 are reserved)
     for (uint16_t cluster = 2; cluster < m_totalClusters + 2; ++cluster) {
-        if (getFATEntry(fat, cluster) == FAT12_FREE) {
-            setFATEntry(fat, cluster, FAT12_EOF);
+        if (getFATEntry(cluster) == FAT12_FREE) {
+            setFATEntry(cluster, FAT12_EOF);
             return cluster;
         }
     }
     return 0;  // No free clusters
 }
 
-void Human68kHandler::freeClusterChain(std::vector<uint8_t>& fat, uint16_t startCluster) {
+void Human68kHandler::freeClusterChain(uint16_t startCluster) {
     uint16_t cluster = startCluster;
-    while (cluster >= 2 && cluster < FAT12_RESERVED) {
-        uint16_t next = getFATEntry(fat, cluster);
-        setFATEntry(fat, cluster, FAT12_FREE);
+    size_t steps = 0;
+    while (cluster >= 2 && cluster < FAT12_RESERVED && steps++ <= m_totalClusters) {
+        uint16_t next = getFATEntry(cluster);
+        setFATEntry(cluster, FAT12_FREE);
         cluster = next;
     }
 }
@@ -231,15 +346,10 @@ void Human68kHandler::freeClusterChain(std::vector<uint8_t>& fat, uint16_t start
 //=============================================================================
 
 std::vector<uint8_t> Human68kHandler::readCluster(uint16_t cluster) const {
-    std::vector<uint8_t> data;
-    data.reserve(m_sectorsPerCluster * m_bytesPerSector);
+    std::vector<uint8_t> data(m_bytesPerCluster);
 
     uint32_t firstSector = m_firstDataSector + (cluster - 2) * m_sectorsPerCluster;
-
-    for (uint8_t i = 0; i < m_sectorsPerCluster; ++i) {
-        auto sector = readLogicalSector(firstSector + i);
-        data.insert(data.end(), sector.begin(), sector.end());
-    }
+    readSectors(firstSector, m_sectorsPerCluster, data.data());
 
     return data;
 }
@@ -247,18 +357,37 @@ std::vector<uint8_t> Human68kHandler::readCluster(uint16_t cluster) const {
 void Human68kHandler::writeCluster(uint16_t cluster, const std::vector<uint8_t>& data) {
     uint32_t firstSector = m_firstDataSector + (cluster - 2) * m_sectorsPerCluster;
 
-    for (uint8_t i = 0; i < m_sectorsPerCluster; ++i) {
-        std::vector<uint8_t> sector(m_bytesPerSector, 0);
-        size_t offset = i * m_bytesPerSector;
-        size_t copySize = std::min(static_cast<size_t>(m_bytesPerSector),
-                                   data.size() > offset ? data.size() - offset : 0);
+    if (data.size() >= m_bytesPerCluster) {
+        writeSectors(firstSector, m_sectorsPerCluster, data.data());
+        return;
+    }
+
+    // Zero-pad short cluster data
+    std::vector<uint8_t> padded(m_bytesPerCluster, 0);
+    std::copy(data.begin(), data.end(), padded.begin());
+    writeSectors(firstSector, m_sectorsPerCluster, padded.data());
+}
 
-        if (copySize > 0) {
-            std::copy(data.begin() + offset, data.begin() + offset + copySize, sector.begin());
-        }
+std::vector<bool> Human68kHandler::getUsedTrackMap() const {
+    const size_t trackCount = (m_totalSectors + m_sectorsPerTrack - 1) / m_sectorsPerTrack;
+    std::vector<bool> used(trackCount, false);
 
-        writeLogicalSector(firstSector + i, sector);
+    // System area: boot sector, FAT copies and root directory
+    for (uint32_t s = 0; s < m_firstDataSector; ++s) {
+        used[s / m_sectorsPerTrack] = true;
+    }
+
+    for (uint16_t cluster = 2; cluster < m_totalClusters + 2; ++cluster) {
+        if (getFATEntry(cluster) == FAT12_FREE) {
+            continue;
+        }
+        uint32_t first = m_firstDataSector + (cluster - 2) * m_sectorsPerCluster;
+        for (uint32_t s = first; s < first + m_sectorsPerCluster && s < m_totalSectors; ++s) {
+            used[s / m_sectorsPerTrack] = true;
+        }
     }
+
+    return used;
 }
 
 //=============================================================================
@@ -266,41 +395,21 @@ void Human68kHandler::writeCluster(uint16_t cluster, const std::vector<uint8_t>&
 //=============================================================================
 
 std::vector<Human68kHandler::DirEntry> Human68kHandler::readRootDirectory() const {
-    std::vector<DirEntry> entries;
-
-    uint32_t rootStart = m_reservedSectors + (m_numberOfFATs * m_sectorsPerFAT);
+    size_t entriesPerSector = m_bytesPerSector / sizeof(DirEntry);
+    std::vector<DirEntry> entries(m_rootDirSectors * entriesPerSector);
 
-    for (uint16_t i = 0; i < m_rootDirSectors; ++i) {
-        auto sector = readLogicalSector(rootStart + i);
-
-        size_t entriesPerSector = m_bytesPerSector / sizeof(DirEntry);
-        for (size_t j = 0; j < entriesPerSector; ++j) {
-            DirEntry entry;
-            std::memcpy(&entry, sector.data() + j * sizeof(DirEntry), sizeof(DirEntry));
-            entries.push_back(entry);
-        }
-    }
+    readSectors(m_rootDirStart, m_rootDirSectors, reinterpret_cast<uint8_t*>(entries.data()));
 
     return entries;
 }
 
 void Human68kHandler::writeRootDirectory(const std::vector<DirEntry>& entries) {
-    uint32_t rootStart = m_reservedSectors + (m_numberOfFATs * m_sectorsPerFAT);
-    size_t entriesPerSector = m_bytesPerSector / sizeof(DirEntry);
-
-    for (uint16_t i = 0; i < m_rootDirSectors; ++i) {
-        std::vector<uint8_t> sector(m_bytesPerSector, 0);
-
-        for (size_t j = 0; j < entriesPerSector; ++j) {
-            size_t entryIdx = i * entriesPerSector + j;
-            if (entryIdx < entries.size()) {
-                std::memcpy(sector.data() + j * sizeof(DirEntry),
-                           &entries[entryIdx], sizeof(DirEntry));
-            }
-        }
+    std::vector<uint8_t> data(static_cast<size_t>(m_rootDirSectors) * m_bytesPerSector, 0);
+    size_t copySize = std::min(data.size(), entries.size() * sizeof(DirEntry));
+    std::memcpy(data.data(), entries.data(), copySize);
 
-        writeLogicalSector(rootStart + i, sector);
-    }
+    invalidateDirectoryCache(0);
+    writeSectors(m_rootDirStart, m_rootDirSectors, data.data());
 }
 
 int Human68kHandler::findDirectoryEntry(const std::vector<DirEntry>& entries,
@@ -412,7 +521,7 @@ std::vector<FileEntry> Human68kHandler::listFiles(const std::string& path) {
 
     if (path.empty() || path == "/" || path == "\\") {
         // List root directory
-        auto entries = readRootDirectory();
+        const auto& entries = getCachedDirectory(0).entries;
 
         for (const auto& entry : entries) {
             if (static_cast<uint8_t>(entry.name[0]) == DIR_FREE ||
@@ -433,7 +542,7 @@ std::vector<FileEntry> Human68kHandler::listFiles(const std::string& path) {
             return files;  // Path not found
         }
 
-        auto entries = getDirectoryEntries(cluster);
+        const auto& entries = getCachedDirectory(cluster).entries;
         for (const auto& entry : entries) {
             if (static_cast<uint8_t>(entry.name[0]) == DIR_FREE ||
                 static_cast<uint8_t>(entry.name[0]) == DIR_END) {
@@ -479,9 +588,9 @@ FileEntry Human68kHandler::dirEntryToFileEntry(const DirEntry& entry) const {
     return fe;
 }
 
-std::vector<uint8_t> Human68kHandler::readFile(const std::string& filename) {
-    auto entries = readRootDirectory();
-    int idx = findDirectoryEntry(entries, filename);
+Human68kHandler::DirEntry Human68kHandler::findFileEntry(const std::string& filename) const {
+    const DirectoryCache* dir = &getCachedDirectory(0);
+    int idx = lookupEntry(*dir, filename);
 
     if (idx < 0) {
         // Try subdirectory path
@@ -496,11 +605,8 @@ std::vector<uint8_t> Human68kHandler::readFile(const std::string& filename) {
 
             auto [cluster, resolved] = resolvePath(dirPath);
             if (cluster != 0) {
-                auto dirEntries = getDirectoryEntries(cluster);
-                idx = findDirectoryEntry(dirEntries, name);
-                if (idx >= 0) {
-                    entries = dirEntries;
-                }
+                dir = &getCachedDirectory(cluster);
+                idx = lookupEntry(*dir, name);
             }
         }
 
@@ -509,7 +615,11 @@ std::vector<uint8_t> Human68kHandler::readFile(const std::string& filename) {
         }
     }
 
-    const auto& entry = entries[idx];
+    return dir->entries[idx];
+}
+
+std::vector<uint8_t> Human68kHandler::readFile(const std::string& filename) {
+    const DirEntry entry = findFileEntry(filename);
     std::vector<uint8_t> data;
     data.reserve(entry.fileSize);
 
@@ -528,14 +638,35 @@ std::vector<uint8_t> Human68kHandler::readFile(const std::string& filename) {
     return data;
 }
 
+bool Human68kHandler::getFileExtents(const std::string& filename,
+                                     std::vector<std::pair<size_t, size_t>>& extents) {
+    const DirEntry entry = findFileEntry(filename);
+
+    extents.clear();
+    for (uint16_t cluster : getClusterChain(entry.startCluster)) {
+        uint32_t firstSector = m_firstDataSector + (cluster - 2) * m_sectorsPerCluster;
+        for (uint32_t i = 0; i < m_sectorsPerCluster; ++i) {
+            // Same addressing as readLogicalSector()
+            size_t track, head, sector;
+            logicalToPhysical(firstSector + i, track, head, sector);
+            if (!appendSectorExtent(extents, track / m_numberOfHeads, track % m_numberOfHeads,
+                                    sector + 1, m_bytesPerSector)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 bool Human68kHandler::writeFile(const std::string& filename,
                                const std::vector<uint8_t>& data,
                                const FileMetadata& metadata) {
     // Delete existing file if present
     deleteFile(filename);
 
+    FATRollback fatRollback(*this);
+
     auto entries = readRootDirectory();
-    auto fat = readFAT();
 
     // Find free directory entry
     int freeIdx = -1;
@@ -562,13 +693,9 @@ bool Human68kHandler::writeFile(const std::string& filename,
     }
 
     for (size_t i = 0; i < clustersNeeded; ++i) {
-        uint16_t cluster = allocateCluster(fat);
+        uint16_t cluster = allocateCluster();
         if (cluster == 0) {
-            // Out of space - free already allocated clusters
-            if (firstCluster != 0) {
-                freeClusterChain(fat, firstCluster);
-            }
-            return false;
+            return false;  // Out of space; fatRollback drops the allocations
         }
 
         if (firstCluster == 0) {
@@ -576,7 +703,7 @@ bool Human68kHandler::writeFile(const std::string& filename,
         }
 
         if (prevCluster != 0) {
-            setFATEntry(fat, prevCluster, cluster);
+            setFATEntry(prevCluster, cluster);
         }
 
         // Write data to cluster
@@ -605,20 +732,23 @@ bool Human68kHandler::writeFile(const std::string& filename,
     entry.time = (12 << 11) | (0 << 5) | 0;  // 12:00:00
 
     // Write FAT and directory
-    writeFAT(fat);
+    commitFAT();
     writeRootDirectory(entries);
 
     return true;
 }
 
 bool Human68kHandler::deleteFile(const std::string& filename) {
-    auto entries = readRootDirectory();
-    int idx = findDirectoryEntry(entries, filename);
+    FATRollback fatRollback(*this);
+
+    int idx = lookupEntry(getCachedDirectory(0), filename);
 
     if (idx < 0) {
         return false;  // File not found
     }
 
+    auto entries = getDirectoryEntries(0);
+
     auto& entry = entries[idx];
 
     // Cannot delete directories with this method
@@ -627,15 +757,14 @@ bool Human68kHandler::deleteFile(const std::string& filename) {
     }
 
     // Free cluster chain
-    auto fat = readFAT();
     if (entry.startCluster >= 2) {
-        freeClusterChain(fat, entry.startCluster);
+        freeClusterChain(entry.startCluster);
     }
 
     // Mark entry as deleted
     entry.name[0] = static_cast<char>(DIR_FREE);
 
-    writeFAT(fat);
+    commitFAT();
     writeRootDirectory(entries);
 
     return true;
@@ -700,19 +829,21 @@ bool Human68kHandler::renameFile(const std::string& oldName, const std::string&
         return false;
     }
 
-    // Read parent directory entries
-    auto entries = getDirectoryEntries(parentCluster);
+    // Look up both names in the parent directory
+    const auto& dir = getCachedDirectory(parentCluster);
 
-    int oldIndex = findDirectoryEntry(entries, oldBaseName);
+    int oldIndex = lookupEntry(dir, oldBaseName);
     if (oldIndex < 0) {
         return false;  // Source not found
     }
 
-    int newIndex = findDirectoryEntry(entries, newBaseName);
+    int newIndex = lookupEntry(dir, newBaseName);
     if (newIndex >= 0 && newIndex != oldIndex) {
         return false;  // Destination name collision
     }
 
+    auto entries = dir.entries;
+
     // Update the entry name (baseName only — parseFilename doesn't handle path separators)
     parseFilename(newBaseName, entries[oldIndex].name, entries[oldIndex].ext);
 
@@ -731,8 +862,7 @@ size_t Human68kHandler::getTotalSpace() const {
 }
 
 bool Human68kHandler::fileExists(const std::string& filename) const {
-    auto entries = readRootDirectory();
-    return findDirectoryEntry(entries, filename) >= 0;
+    return lookupEntry(getCachedDirectory(0), filename) >= 0;
 }
 
 bool Human68kHandler::format(const std::string& volumeName) {
@@ -768,6 +898,7 @@ bool Human68kHandler::format(const std::string& volumeName) {
     if (m_totalClusters == 0) {
         return false;
     }
+    updateGeometryCache();
 
     // Initialize boot sector
     std::vector<uint8_t> bootSector(m_bytesPerSector, 0);
@@ -809,7 +940,7 @@ bool Human68kHandler::format(const std::string& volumeName) {
     fat[1] = 0xFF;
     fat[2] = 0xFF;
 
-    writeFAT(fat);
+    writeFATCopies(fat);
 
     // Initialize root directory
     std::vector<DirEntry> entries(m_rootEntryCount);
@@ -856,11 +987,10 @@ std::string Human68kHandler::getVolumeName() const {
 }
 
 uint16_t Human68kHandler::countFreeClusters() const {
-    auto fat = readFAT();
     uint16_t freeCount = 0;
 
     for (uint16_t cluster = 2; cluster < m_totalClusters + 2; ++cluster) {
-        if (getFATEntry(fat, cluster) == FAT12_FREE) {
+        if (getFATEntry(cluster) == FAT12_FREE) {
             ++freeCount;
         }
     }
@@ -870,12 +1000,11 @@ uint16_t Human68kHandler::countFreeClusters() const {
 
 Human68kHandler::ClusterInfo Human68kHandler::getClusterInfo() const {
     ClusterInfo info = {};
-    auto fat = readFAT();
 
     info.totalClusters = m_totalClusters;
 
     for (uint16_t cluster = 2; cluster < m_totalClusters + 2; ++cluster) {
-        uint16_t entry = getFATEntry(fat, cluster);
+        uint16_t entry = getFATEntry(cluster);
 
         if (entry == FAT12_FREE) {
             ++info.freeClusters;
@@ -896,6 +1025,8 @@ Human68kHandler::ClusterInfo Human68kHandler::getClusterInfo() const {
 //=============================================================================
 
 bool Human68kHandler::createDirectory(const std::string& path) {
+    FATRollback fatRollback(*this);
+
     // Find parent directory
     size_t lastSlash = path.rfind('/');
     if (lastSlash == std::string::npos) {
@@ -915,16 +1046,15 @@ bool Human68kHandler::createDirectory(const std::string& path) {
             return false;  // Parent not found
         }
         parentCluster = cluster;
-        parentEntries = (parentCluster == 0) ? readRootDirectory() : getDirectoryEntries(parentCluster);
     } else {
         dirName = (lastSlash == 0) ? path.substr(1) : path;
-        parentEntries = readRootDirectory();
     }
 
     // Check if directory already exists
-    if (findDirectoryEntry(parentEntries, dirName) >= 0) {
+    if (lookupEntry(getCachedDirectory(parentCluster), dirName) >= 0) {
         return false;
     }
+    parentEntries = getDirectoryEntries(parentCluster);
 
     // Find free entry
     int freeIdx = -1;
@@ -941,8 +1071,7 @@ bool Human68kHandler::createDirectory(const std::string& path) {
     }
 
     // Allocate cluster for new directory
-    auto fat = readFAT();
-    uint16_t newCluster = allocateCluster(fat);
+    uint16_t newCluster = allocateCluster();
     if (newCluster == 0) {
         return false;
     }
@@ -976,9 +1105,10 @@ bool Human68kHandler::createDirectory(const std::string& path) {
     std::memcpy(clusterData.data(), newDirEntries.data(),
                 std::min(clusterData.size(), newDirEntries.size() * sizeof(DirEntry)));
     writeCluster(newCluster, clusterData);
+    invalidateDirectoryCache(newCluster);
 
     // Write FAT and parent directory
-    writeFAT(fat);
+    commitFAT();
 
     if (parentCluster == 0) {
         writeRootDirectory(parentEntries);
@@ -990,13 +1120,15 @@ bool Human68kHandler::createDirectory(const std::string& path) {
 }
 
 bool Human68kHandler::deleteDirectory(const std::string& path) {
+    FATRollback fatRollback(*this);
+
     auto [cluster, name] = resolvePath(path);
     if (cluster == 0) {
         return false;  // Directory not found
     }
 
     // Check if directory is empty
-    auto entries = getDirectoryEntries(cluster);
+    const auto& entries = getCachedDirectory(cluster).entries;
     for (const auto& entry : entries) {
         if (static_cast<uint8_t>(entry.name[0]) == DIR_FREE ||
             static_cast<uint8_t>(entry.name[0]) == DIR_END) {
@@ -1026,23 +1158,22 @@ bool Human68kHandler::deleteDirectory(const std::string& path) {
         dirName = path.substr(lastSlash + 1);
         auto [pCluster, pName] = resolvePath(parentPath);
         parentCluster = pCluster;
-        parentEntries = (parentCluster == 0) ? readRootDirectory() : getDirectoryEntries(parentCluster);
     } else {
         dirName = (lastSlash == 0) ? path.substr(1) : path;
-        parentEntries = readRootDirectory();
     }
 
-    int idx = findDirectoryEntry(parentEntries, dirName);
+    int idx = lookupEntry(getCachedDirectory(parentCluster), dirName);
     if (idx < 0) {
         return false;
     }
+    parentEntries = getDirectoryEntries(parentCluster);
 
     // Free cluster and mark entry as deleted
-    auto fat = readFAT();
-    freeClusterChain(fat, parentEntries[idx].startCluster);
+    freeClusterChain(parentEntries[idx].startCluster);
+    invalidateDirectoryCache(parentEntries[idx].startCluster);
     parentEntries[idx].name[0] = static_cast<char>(DIR_FREE);
 
-    writeFAT(fat);
+    commitFAT();
 
     if (parentCluster == 0) {
         writeRootDirectory(parentEntries);
@@ -1091,10 +1222,11 @@ std::pair<uint16_t, std::string> Human68kHandler::resolvePath(const std::string&
 
     // Traverse path
     uint16_t currentCluster = 0;  // Start at root
-    auto entries = readRootDirectory();
 
     for (size_t i = 0; i < components.size(); ++i) {
-        int idx = findDirectoryEntry(entries, components[i]);
+        const auto& dir = getCachedDirectory(currentCluster);
+        const auto& entries = dir.entries;
+        int idx = lookupEntry(dir, components[i]);
         if (idx < 0) {
             return {0, ""};  // Not found
         }
@@ -1108,10 +1240,6 @@ std::pair<uint16_t, std::string> Human68kHandler::resolvePath(const std::string&
         }
 
         currentCluster = entries[idx].startCluster;
-
-        if (i < components.size() - 1) {
-            entries = getDirectoryEntries(currentCluster);
-        }
     }
 
     return {currentCluster, components.back()};
@@ -1132,28 +1260,60 @@ void Human68kHandler::writeDirectoryCluster(uint16_t cluster, const std::vector<
     std::vector<uint8_t> data(m_sectorsPerCluster * m_bytesPerSector, 0);
     size_t copySize = std::min(data.size(), entries.size() * sizeof(DirEntry));
     std::memcpy(data.data(), entries.data(), copySize);
+    invalidateDirectoryCache(cluster);
     writeCluster(cluster, data);
 }
 
 int Human68kHandler::findEntryInDirectory(uint16_t cluster, const std::string& name) const {
-    auto entries = getDirectoryEntries(cluster);
-    return findDirectoryEntry(entries, name);
+    return lookupEntry(getCachedDirectory(cluster), name);
 }
 
 std::vector<Human68kHandler::DirEntry> Human68kHandler::getDirectoryEntries(uint16_t cluster) const {
-    if (cluster == 0) {
-        return readRootDirectory();
+    return getCachedDirectory(cluster).entries;
+}
+
+const Human68kHandler::DirectoryCache& Human68kHandler::getCachedDirectory(uint16_t cluster) const {
+    auto it = m_dirCache.find(cluster);
+    if (it != m_dirCache.end()) {
+        return it->second;
     }
 
-    std::vector<DirEntry> allEntries;
-    auto chain = getClusterChain(cluster);
+    DirectoryCache dir;
+    if (cluster == 0) {
+        dir.entries = readRootDirectory();
+    } else {
+        for (uint16_t c : getClusterChain(cluster)) {
+            auto entries = readDirectoryCluster(c);
+            dir.entries.insert(dir.entries.end(), entries.begin(), entries.end());
+        }
+    }
 
-    for (uint16_t c : chain) {
-        auto entries = readDirectoryCluster(c);
-        allEntries.insert(allEntries.end(), entries.begin(), entries.end());
+    // Index live entries by padded 8.3 name; the first match wins, as in
+    // findDirectoryEntry()
+    for (size_t i = 0; i < dir.entries.size(); ++i) {
+        const auto& entry = dir.entries[i];
+        if (static_cast<uint8_t>(entry.name[0]) == DIR_FREE ||
+            static_cast<uint8_t>(entry.name[0]) == DIR_END ||
+            (entry.attr & ATTR_VOLUME_ID)) {
+            continue;
+        }
+        std::string key(entry.name, 8);
+        key.append(entry.ext, 3);
+        dir.index.emplace(std::move(key), static_cast<int>(i));
     }
 
-    return allEntries;
+    return m_dirCache.emplace(cluster, std::move(dir)).first->second;
+}
+
+int Human68kHandler::lookupEntry(const DirectoryCache& dir, const std::string& filename) const {
+    char name[8], ext[3];
+    parseFilename(filename, name, ext);
+
+    std::string key(name, 8);
+    key.append(ext, 3);
+
+    auto it = dir.index.find(key);
+    return it != dir.index.end() ? it->second : -1;
 }
 
 void Human68kHandler::setDirectoryEntries(uint16_t cluster, const std::vector<DirEntry>& entries) {
@@ -1162,6 +1322,8 @@ void Human68kHandler::setDirectoryEntries(uint16_t cluster, const std::vector<Di
         return;
     }
 
+    invalidateDirectoryCache(cluster);
+
     auto chain = getClusterChain(cluster);
     size_t entriesPerCluster = (m_sectorsPerCluster * m_bytesPerSector) / sizeof(DirEntry);
 
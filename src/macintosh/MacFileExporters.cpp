@@ -21,6 +21,14 @@ inline void putBE32(std::vector<uint8_t>& out, size_t off, uint32_t v) {
 } // namespace
 
 std::vector<uint8_t> buildAppleDoubleSidecar(const AppleDoubleInput& in) {
+    const uint32_t rsrcLen = static_cast<uint32_t>(in.resourceFork.size());
+    std::vector<uint8_t> out = buildAppleDoubleHeader(in, rsrcLen);
+    out.insert(out.end(), in.resourceFork.begin(), in.resourceFork.end());
+    return out;
+}
+
+std::vector<uint8_t> buildAppleDoubleHeader(const AppleDoubleInput& in,
+                                            uint32_t rsrcLen) {
     // Always emit the three entries (3, 9, 2) — even when payloads are empty.
     // SPEC §1648 example shows this layout matches the Python writer.
     constexpr uint16_t kEntryCount = 3;
@@ -30,14 +38,12 @@ std::vector<uint8_t> buildAppleDoubleSidecar(const AppleDoubleInput& in) {
 
     const uint32_t nameLen = static_cast<uint32_t>(in.macRomanName.size());
     const uint32_t finderLen = static_cast<uint32_t>(in.finderInfo.size());
-    const uint32_t rsrcLen = static_cast<uint32_t>(in.resourceFork.size());
 
     const uint32_t nameOff   = static_cast<uint32_t>(firstPayloadOff);
     const uint32_t finderOff = nameOff + nameLen;
     const uint32_t rsrcOff   = finderOff + finderLen;
 
-    const size_t total = static_cast<size_t>(rsrcOff) + rsrcLen;
-    std::vector<uint8_t> out(total, 0);
+    std::vector<uint8_t> out(rsrcOff, 0);
 
     putBE32(out, 0,  0x00051607u);   // magic
     putBE32(out, 4,  0x00020000u);   // version
@@ -64,10 +70,6 @@ std::vector<uint8_t> buildAppleDoubleSidecar(const AppleDoubleInput& in) {
         std::memcpy(out.data() + finderOff,
                     in.finderInfo.data(), finderLen);
     }
-    if (rsrcLen > 0) {
-        std::memcpy(out.data() + rsrcOff,
-                    in.resourceFork.data(), rsrcLen);
-    }
     return out;
 }
 
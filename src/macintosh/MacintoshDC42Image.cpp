@@ -4,6 +4,7 @@
 #include "rdedisktool/macintosh/DC42Checksum.h"
 #include "rdedisktool/DiskImageFactory.h"
 #include "rdedisktool/Exceptions.h"
+#include "rdedisktool/utils/Stats.h"
 
 #include <cstring>
 #include <fstream>
@@ -151,6 +152,7 @@ void MacintoshDC42Image::load(const std::filesystem::path& path) {
 }
 
 void MacintoshDC42Image::save(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Save);
     const std::filesystem::path target = path.empty() ? m_filePath : path;
     if (target.empty()) {
         throw InvalidFormatException("Macintosh DC42 save: no destination path");
@@ -243,6 +245,7 @@ bool MacintoshDC42Image::canConvertTo(DiskFormat format) const {
         case DiskFormat::AppleNIB2:
         case DiskFormat::AppleWOZ1:
         case DiskFormat::AppleWOZ2:
+        case DiskFormat::AppleHDV:
         case DiskFormat::MSXDSK:
         case DiskFormat::MSXDMK:
         case DiskFormat::MSXXSA:
@@ -1,5 +1,6 @@
 #include "rdedisktool/macintosh/MacintoshDiskImage.h"
 #include "rdedisktool/Exceptions.h"
+#include "rdedisktool/utils/Stats.h"
 
 #include <algorithm>
 
@@ -13,7 +14,8 @@ MacintoshDiskImage::MacintoshDiskImage() {
 }
 
 void MacintoshDiskImage::setRawData(const std::vector<uint8_t>& data) {
-    m_data = data;
+    assignRawData(data);
+    initGeometryFromSize(data.size());
     m_modified = true;
     m_fileSystemDetected = false;
 }
@@ -40,6 +42,7 @@ FileSystemType MacintoshDiskImage::getFileSystemType() const {
 }
 
 SectorBuffer MacintoshDiskImage::readSector(size_t track, size_t side, size_t sector) {
+    Stats::sectorRead(m_geometry.bytesPerSector);
     if (m_geometry.sides == 0 || m_geometry.sectorsPerTrack == 0) {
         throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
     }
@@ -60,6 +63,7 @@ SectorBuffer MacintoshDiskImage::readSector(size_t track, size_t side, size_t se
 
 void MacintoshDiskImage::writeSector(size_t track, size_t side, size_t sector,
                                      const SectorBuffer& data) {
+    Stats::sectorWritten(data.size());
     if (m_writeProtected) {
         throw WriteProtectedException();
     }
@@ -81,6 +85,7 @@ void MacintoshDiskImage::writeSector(size_t track, size_t side, size_t sector,
         throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
     }
     std::copy(data.begin(), data.end(), m_data.begin() + offset);
+    markDirty(offset, data.size());
     m_modified = true;
 }
 
@@ -119,6 +124,7 @@ void MacintoshDiskImage::writeTrack(size_t track, size_t side, const TrackBuffer
         throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(0));
     }
     std::copy(data.begin(), data.end(), m_data.begin() + offset);
+    markDirty(offset, data.size());
     m_modified = true;
 }
 
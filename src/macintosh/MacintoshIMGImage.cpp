@@ -3,6 +3,7 @@
 #include "rdedisktool/macintosh/MacintoshMOOFImage.h"
 #include "rdedisktool/DiskImageFactory.h"
 #include "rdedisktool/Exceptions.h"
+#include "rdedisktool/utils/Stats.h"
 
 #include <fstream>
 #include <iterator>
@@ -53,12 +54,14 @@ void MacintoshIMGImage::load(const std::filesystem::path& path) {
 
     m_filePath = path;
     m_modified = false;
+    clearDirty();
     m_writeProtected = false;
     m_fileSystemDetected = false;
     initGeometryFromSize(sz);
 }
 
 void MacintoshIMGImage::save(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Save);
     const std::filesystem::path target = path.empty() ? m_filePath : path;
     if (target.empty()) {
         throw InvalidFormatException("Macintosh IMG save: no destination path");
@@ -95,6 +98,7 @@ void MacintoshIMGImage::create(const DiskGeometry& geometry) {
                                       "a non-zero multiple of 512 bytes");
     }
     m_data.assign(total, 0);
+    markDirty(0, total);
     m_geometry = geometry;
     m_modified = true;
     m_writeProtected = false;
@@ -113,6 +117,7 @@ bool MacintoshIMGImage::canConvertTo(DiskFormat format) const {
         case DiskFormat::AppleNIB2:
         case DiskFormat::AppleWOZ1:
         case DiskFormat::AppleWOZ2:
+        case DiskFormat::AppleHDV:
         case DiskFormat::MSXDSK:
         case DiskFormat::MSXDMK:
         case DiskFormat::MSXXSA:
@@ -7,6 +7,7 @@
 #include "rdedisktool/macintosh/MacintoshDC42Image.h"
 #include "rdedisktool/DiskImageFactory.h"
 #include "rdedisktool/Exceptions.h"
+#include "rdedisktool/utils/Stats.h"
 
 #include <algorithm>
 #include <cstring>
@@ -347,6 +348,7 @@ void MacintoshMOOFImage::parseChunks(const std::vector<uint8_t>& bytes) {
 }
 
 void MacintoshMOOFImage::save(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Save);
     const std::filesystem::path target = path.empty() ? m_filePath : path;
     if (target.empty()) {
         throw InvalidFormatException("Macintosh MOOF save: no destination path");
@@ -604,6 +606,7 @@ bool MacintoshMOOFImage::canConvertTo(DiskFormat format) const {
         case DiskFormat::AppleNIB2:
         case DiskFormat::AppleWOZ1:
         case DiskFormat::AppleWOZ2:
+        case DiskFormat::AppleHDV:
         case DiskFormat::MSXDSK:
         case DiskFormat::MSXDMK:
         case DiskFormat::MSXXSA:
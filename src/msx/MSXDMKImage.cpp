@@ -2,6 +2,7 @@
 #include "rdedisktool/msx/MSXDSKImage.h"
 #include "rdedisktool/DiskImageFactory.h"
 #include "rdedisktool/CRC.h"
+#include "rdedisktool/utils/Stats.h"
 #include <fstream>
 #include <sstream>
 #include <cstring>
@@ -60,9 +61,15 @@ void MSXDMKImage::load(const std::filesystem::path& path) {
         throw InvalidFormatException("Invalid DMK header");
     }
 
-    // Set geometry from header
+    // Set geometry from header; sectors/track comes from track 0's IDAM
+    // table so 8- and 10-sector layouts are addressed correctly.
     size_t sides = isSingleSided() ? 1 : 2;
     initGeometry(m_numTracks, sides, SECTORS_9);
+    size_t sectors = countSectorsInTrack(0, 0);
+    if (sectors > 0) {
+        initGeometry(m_numTracks, sides, sectors);
+        m_layout.sectorsPerTrack = sectors;
+    }
 
     m_filePath = path;
     m_modified = false;
@@ -71,6 +78,7 @@ void MSXDMKImage::load(const std::filesystem::path& path) {
 }
 
 void MSXDMKImage::save(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Save);
     std::filesystem::path savePath = path.empty() ? m_filePath : path;
 
     if (savePath.empty()) {
@@ -111,10 +119,17 @@ void MSXDMKImage::create(const DiskGeometry& geometry) {
     size_t sides = geometry.sides > 0 ? geometry.sides : SIDES_2;
     size_t sectors = geometry.sectorsPerTrack > 0 ? geometry.sectorsPerTrack : SECTORS_9;
 
+    m_trackLength = DMK_TRACK_LENGTH_DD;
+    m_layout.sectorsPerTrack = sectors;
+    if (!m_layout.isValid(m_trackLength - DMK_IDAM_SIZE, BYTES_PER_SECTOR)) {
+        throw DiskException(DiskError::InvalidParameter,
+            "Invalid DMK track layout: " + std::to_string(sectors) +
+            " sectors/track, interleave " + std::to_string(m_layout.interleave));
+    }
+
     initGeometry(tracks, sides, sectors);
 
     m_numTracks = static_cast<uint8_t>(tracks);
-    m_trackLength = DMK_TRACK_LENGTH_DD;
     m_dmkFlags = (sides == 1) ? 0x10 : 0x00;  // Set single-sided flag if needed
 
     // Calculate file size: header + (tracks * sides * track_length)
@@ -133,11 +148,9 @@ void MSXDMKImage::create(const DiskGeometry& geometry) {
     // Initialize each track with formatted data
     for (size_t track = 0; track < tracks; ++track) {
         for (size_t side = 0; side < sides; ++side) {
-            // Create empty sectors
-            std::array<SectorBuffer, 9> sectorData;
-            for (auto& sector : sectorData) {
-                sector.resize(BYTES_PER_SECTOR, 0xE5);  // Fill with 0xE5 (formatted)
-            }
+            // Create empty sectors (filled with 0xE5, as after a format)
+            std::vector<SectorBuffer> sectorData(
+                sectors, SectorBuffer(BYTES_PER_SECTOR, 0xE5));
 
             // Build formatted track
             auto trackData = buildFormattedTrack(track, side, sectorData);
@@ -172,6 +185,27 @@ size_t MSXDMKImage::calculateOffset(size_t track, size_t side, size_t sector) co
     return getTrackOffset(track, side);
 }
 
+size_t MSXDMKImage::countSectorsInTrack(size_t track, size_t side) const {
+    size_t offset = getTrackOffset(track, side);
+    if (offset + m_trackLength > m_data.size()) {
+        return 0;
+    }
+
+    const uint8_t* trackData = m_data.data() + offset;
+    size_t count = 0;
+    for (size_t i = 0; i < DMK_IDAM_COUNT; ++i) {
+        uint16_t idamPtr = trackData[i * 2] | (trackData[i * 2 + 1] << 8);
+        if (idamPtr == 0) {
+            break;  // End of IDAM table
+        }
+        auto entry = parseIDAM(trackData, idamPtr);
+        if (entry.sector >= 1 && entry.sizeCode == SIZE_512) {
+            ++count;
+        }
+    }
+    return count;
+}
+
 MSXDMKImage::DMKHeader MSXDMKImage::getDMKHeader() const {
     return {
         m_data[0],
@@ -261,6 +295,7 @@ int MSXDMKImage::findSectorInTrack(const TrackBuffer& trackData, size_t sector)
 }
 
 SectorBuffer MSXDMKImage::readSector(size_t track, size_t side, size_t sector) {
+    Stats::sectorRead(m_geometry.bytesPerSector);
     if (track >= m_geometry.tracks) {
         throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
     }
@@ -308,6 +343,7 @@ SectorBuffer MSXDMKImage::readSector(size_t track, size_t side, size_t sector) {
 
 void MSXDMKImage::writeSector(size_t track, size_t side, size_t sector,
                               const SectorBuffer& data) {
+    Stats::sectorWritten(data.size());
     if (m_writeProtected) {
         throw WriteProtectedException();
     }
@@ -401,36 +437,20 @@ void MSXDMKImage::writeTrack(size_t track, size_t side, const TrackBuffer& data)
 }
 
 TrackBuffer MSXDMKImage::buildFormattedTrack(size_t track, size_t side,
-                                              const std::array<SectorBuffer, 9>& sectors) {
+                                              const std::vector<SectorBuffer>& sectors) {
     TrackBuffer result(m_trackLength, 0);
 
-    // Build sector order based on interleave factor
-    std::array<size_t, 9> sectorOrder;
-    if (m_interleave <= 1) {
-        // No interleave: 0, 1, 2, 3, 4, 5, 6, 7, 8
-        for (size_t i = 0; i < 9; ++i) {
-            sectorOrder[i] = i;
-        }
-    } else {
-        // Interleave: distribute sectors
-        size_t pos = 0;
-        std::fill(sectorOrder.begin(), sectorOrder.end(), 9);  // Mark as unused
-        for (size_t i = 0; i < 9; ++i) {
-            while (sectorOrder[pos] != 9) {
-                pos = (pos + 1) % 9;
-            }
-            sectorOrder[pos] = i;
-            pos = (pos + m_interleave) % 9;
-        }
-    }
+    // Physical slot -> logical sector, with interleave and track/head skew
+    const auto sectorOrder = m_layout.sectorOrder(track, side);
+    const size_t gap3 = m_layout.gap3Length(m_trackLength - DMK_IDAM_SIZE, BYTES_PER_SECTOR);
 
     // IDAM table (128 bytes)
     size_t idamIdx = 0;
     size_t dataPos = DMK_IDAM_SIZE;
 
     // Gap 4a (80 bytes of 0x4E)
-    std::fill(result.begin() + dataPos, result.begin() + dataPos + 80, 0x4E);
-    dataPos += 80;
+    std::fill(result.begin() + dataPos, result.begin() + dataPos + TrackLayout::GAP4A_LENGTH, 0x4E);
+    dataPos += TrackLayout::GAP4A_LENGTH;
 
     // Sync (12 bytes of 0x00)
     std::fill(result.begin() + dataPos, result.begin() + dataPos + 12, 0x00);
@@ -443,11 +463,11 @@ TrackBuffer MSXDMKImage::buildFormattedTrack(size_t track, size_t side,
     result[dataPos++] = 0xFC;
 
     // Gap 1 (50 bytes of 0x4E)
-    std::fill(result.begin() + dataPos, result.begin() + dataPos + 50, 0x4E);
-    dataPos += 50;
+    std::fill(result.begin() + dataPos, result.begin() + dataPos + TrackLayout::GAP1_LENGTH, 0x4E);
+    dataPos += TrackLayout::GAP1_LENGTH;
 
-    // Write sectors in interleaved order
-    for (size_t i = 0; i < 9 && idamIdx < DMK_IDAM_COUNT; ++i) {
+    // Write sectors in layout order
+    for (size_t i = 0; i < sectorOrder.size() && idamIdx < DMK_IDAM_COUNT; ++i) {
         size_t sect = sectorOrder[i];
         // Sync (12 bytes of 0x00)
         std::fill(result.begin() + dataPos, result.begin() + dataPos + 12, 0x00);
@@ -508,9 +528,9 @@ TrackBuffer MSXDMKImage::buildFormattedTrack(size_t track, size_t side,
         result[dataPos++] = (dataCrc >> 8) & 0xFF;
         result[dataPos++] = dataCrc & 0xFF;
 
-        // Gap 3 (54 bytes of 0x4E)
-        std::fill(result.begin() + dataPos, result.begin() + dataPos + 54, 0x4E);
-        dataPos += 54;
+        // Gap 3 (54 bytes of 0x4E, shortened for 10-sector tracks)
+        std::fill(result.begin() + dataPos, result.begin() + dataPos + gap3, 0x4E);
+        dataPos += gap3;
     }
 
     // Gap 4b (fill rest with 0x4E)
@@ -530,6 +550,7 @@ bool MSXDMKImage::canConvertTo(DiskFormat format) const {
         case DiskFormat::AppleNIB2:
         case DiskFormat::AppleWOZ1:
         case DiskFormat::AppleWOZ2:
+        case DiskFormat::AppleHDV:
         case DiskFormat::MSXDMK:
         case DiskFormat::MSXXSA:
         case DiskFormat::X68000XDF:
@@ -627,6 +648,7 @@ std::string MSXDMKImage::getDiagnostics() const {
     oss << "Tracks: " << static_cast<int>(m_numTracks) << "\n";
     oss << "Track Length: " << m_trackLength << " bytes\n";
     oss << "Sides: " << (isSingleSided() ? 1 : 2) << "\n";
+    oss << "Sectors/Track: " << m_geometry.sectorsPerTrack << "\n";
     oss << "Density: " << (isSingleDensity() ? "Single" : "Double") << "\n";
     oss << "Flags: 0x" << std::hex << static_cast<int>(m_dmkFlags) << std::dec << "\n";
     oss << "Write Protected: " << (m_writeProtected ? "Yes" : "No") << "\n";
@@ -1,6 +1,7 @@
 #include "rdedisktool/msx/MSXDSKImage.h"
 #include "rdedisktool/msx/MSXDMKImage.h"
 #include "rdedisktool/DiskImageFactory.h"
+#include "rdedisktool/utils/Stats.h"
 #include <fstream>
 #include <sstream>
 #include <cstring>
@@ -55,10 +56,12 @@ void MSXDSKImage::load(const std::filesystem::path& path) {
     detectGeometry();
 
     m_modified = false;
+    clearDirty();
     m_fileSystemDetected = false;
 }
 
 void MSXDSKImage::save(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Save);
     std::filesystem::path savePath = path.empty() ? m_filePath : path;
 
     if (savePath.empty()) {
@@ -96,12 +99,26 @@ void MSXDSKImage::create(const DiskGeometry& geometry) {
 
     // Create blank disk image
     m_data.resize(m_geometry.totalSize(), 0);
+    markDirty(0, m_data.size());
     m_modified = true;
     m_fileSystemDetected = false;
     m_filePath.clear();
 }
 
+std::optional<size_t> MSXDSKImage::sectorOffset(size_t track, size_t side, size_t sector) const {
+    if (track >= m_geometry.tracks || side >= m_geometry.sides ||
+        sector >= m_geometry.sectorsPerTrack) {
+        return std::nullopt;
+    }
+    const size_t offset = calculateOffset(track, side, sector);
+    if (offset + BYTES_PER_SECTOR > m_data.size()) {
+        return std::nullopt;
+    }
+    return offset;
+}
+
 SectorBuffer MSXDSKImage::readSector(size_t track, size_t side, size_t sector) {
+    Stats::sectorRead(m_geometry.bytesPerSector);
     if (track >= m_geometry.tracks) {
         throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
     }
@@ -123,6 +140,7 @@ SectorBuffer MSXDSKImage::readSector(size_t track, size_t side, size_t sector) {
 
 void MSXDSKImage::writeSector(size_t track, size_t side, size_t sector,
                               const SectorBuffer& data) {
+    Stats::sectorWritten(data.size());
     if (m_writeProtected) {
         throw WriteProtectedException();
     }
@@ -144,6 +162,7 @@ void MSXDSKImage::writeSector(size_t track, size_t side, size_t sector,
 
     size_t copySize = std::min(data.size(), BYTES_PER_SECTOR);
     std::copy(data.begin(), data.begin() + copySize, m_data.begin() + offset);
+    markDirty(offset, BYTES_PER_SECTOR);
 
     // Zero-fill if data is short
     if (copySize < BYTES_PER_SECTOR) {
@@ -180,6 +199,7 @@ void MSXDSKImage::writeTrack(size_t track, size_t side, const TrackBuffer& data)
     size_t copySize = std::min(data.size(), trackSize);
 
     std::copy(data.begin(), data.begin() + copySize, m_data.begin() + offset);
+    markDirty(offset, trackSize);
 
     if (copySize < trackSize) {
         std::fill(m_data.begin() + offset + copySize,
@@ -196,6 +216,7 @@ void MSXDSKImage::formatMSXDOS(const std::string& volumeLabel, uint8_t mediaDesc
 
     // Clear entire disk
     std::fill(m_data.begin(), m_data.end(), 0);
+    markDirty(0, m_data.size());
 
     // Build boot sector
     MSXBootSector boot = {};
@@ -294,6 +315,7 @@ bool MSXDSKImage::canConvertTo(DiskFormat format) const {
         case DiskFormat::AppleNIB2:
         case DiskFormat::AppleWOZ1:
         case DiskFormat::AppleWOZ2:
+        case DiskFormat::AppleHDV:
         case DiskFormat::MSXDSK:
         case DiskFormat::MSXXSA:
         case DiskFormat::X68000XDF:
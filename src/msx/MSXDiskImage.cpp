@@ -37,7 +37,7 @@ void MSXDiskImage::initGeometryFromSize(size_t fileSize) {
 }
 
 void MSXDiskImage::setRawData(const std::vector<uint8_t>& data) {
-    m_data = data;
+    assignRawData(data);
     m_modified = true;
     m_fileSystemDetected = false;
 }
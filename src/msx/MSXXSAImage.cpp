@@ -6,6 +6,7 @@
 #include "rdedisktool/msx/XSAHeader.h"
 #include "rdedisktool/DiskImageFactory.h"
 #include "rdedisktool/utils/BinaryReader.h"
+#include "rdedisktool/utils/Stats.h"
 #include <fstream>
 #include <sstream>
 
@@ -81,6 +82,7 @@ void MSXXSAImage::load(const std::filesystem::path& path) {
 }
 
 void MSXXSAImage::save(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Save);
     std::filesystem::path savePath = path.empty() ? m_filePath : path;
 
     if (savePath.empty()) {
@@ -126,6 +128,7 @@ void MSXXSAImage::setWriteProtected(bool /*protect*/) {
 }
 
 SectorBuffer MSXXSAImage::readSector(size_t track, size_t side, size_t sector) {
+    Stats::sectorRead(m_geometry.bytesPerSector);
     if (track >= m_geometry.tracks) {
         throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
     }
@@ -185,6 +188,7 @@ bool MSXXSAImage::canConvertTo(DiskFormat format) const {
         case DiskFormat::AppleNIB2:
         case DiskFormat::AppleWOZ1:
         case DiskFormat::AppleWOZ2:
+        case DiskFormat::AppleHDV:
         case DiskFormat::MSXXSA:
         case DiskFormat::X68000XDF:
         case DiskFormat::X68000DIM:
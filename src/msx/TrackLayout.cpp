@@ -0,0 +1,69 @@
+#include "rdedisktool/msx/TrackLayout.h"
+#include <algorithm>
+
+namespace rde {
+
+std::vector<uint8_t> TrackLayout::sectorOrder(size_t track, size_t side) const {
+    const size_t count = sectorsPerTrack;
+    std::vector<uint8_t> base(count);
+
+    if (interleave <= 1) {
+        // No interleave: 0, 1, 2, ...
+        for (size_t i = 0; i < count; ++i) {
+            base[i] = static_cast<uint8_t>(i);
+        }
+    } else {
+        // Interleave: place each logical sector `interleave` slots after the
+        // previous one, sliding forward when the slot is already taken
+        // (needed when interleave and the sector count share a factor).
+        std::vector<bool> used(count, false);
+        size_t pos = 0;
+        for (size_t i = 0; i < count; ++i) {
+            while (used[pos]) {
+                pos = (pos + 1) % count;
+            }
+            base[pos] = static_cast<uint8_t>(i);
+            used[pos] = true;
+            pos = (pos + interleave) % count;
+        }
+    }
+
+    const size_t skew = (track * trackSkew + side * headSkew) % (count ? count : 1);
+    if (skew == 0) {
+        return base;
+    }
+
+    // Rotate so logical sector 0 starts `skew` slots after the index hole
+    std::vector<uint8_t> order(count);
+    for (size_t i = 0; i < count; ++i) {
+        order[(i + skew) % count] = base[i];
+    }
+    return order;
+}
+
+size_t TrackLayout::gap3Length(size_t trackLength, size_t bytesPerSector) const {
+    if (sectorsPerTrack == 0 || trackLength <= PREAMBLE_LENGTH) {
+        return 0;
+    }
+
+    const size_t available = trackLength - PREAMBLE_LENGTH;
+    const size_t needed = sectorsPerTrack * sectorOverhead(bytesPerSector);
+    if (needed >= available) {
+        return 0;
+    }
+
+    const size_t gap3 = (available - needed) / sectorsPerTrack;
+    return std::min(gap3, GAP3_LENGTH);
+}
+
+bool TrackLayout::isValid(size_t trackLength, size_t bytesPerSector) const {
+    if (sectorsPerTrack == 0 || interleave == 0) {
+        return false;
+    }
+    if (sectorsPerTrack > 1 && interleave >= sectorsPerTrack) {
+        return false;
+    }
+    return gap3Length(trackLength, bytesPerSector) >= GAP3_MIN_LENGTH;
+}
+
+} // namespace rde
@@ -0,0 +1,53 @@
+#include "rdedisktool/utils/FileSync.h"
+#include "rdedisktool/Exceptions.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace rde {
+
+namespace {
+
+[[noreturn]] void throwSyncError(const std::filesystem::path& path) {
+    throw WriteException("fsync failed: " + path.string() + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+void syncFile(const std::filesystem::path& path) {
+#ifdef _WIN32
+    const int fd = _wopen(path.c_str(), _O_RDWR | _O_BINARY);
+    if (fd < 0) throwSyncError(path);
+    const int rc = _commit(fd);
+    _close(fd);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throwSyncError(path);
+    const int rc = ::fsync(fd);
+    ::close(fd);
+#endif
+    if (rc != 0) throwSyncError(path);
+}
+
+void syncDirectory(const std::filesystem::path& dir) {
+#ifdef _WIN32
+    (void)dir;  // NTFS renames are journaled; there is no directory handle to flush
+#else
+    const std::filesystem::path target = dir.empty() ? std::filesystem::path(".") : dir;
+    const int fd = ::open(target.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) throwSyncError(target);
+    const int rc = ::fsync(fd);
+    ::close(fd);
+    if (rc != 0) throwSyncError(target);
+#endif
+}
+
+} // namespace rde
@@ -0,0 +1,299 @@
+#include "rdedisktool/utils/ImageIndex.h"
+#include "rdedisktool/CRC.h"
+#include "rdedisktool/Exceptions.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <system_error>
+
+namespace rde {
+
+namespace {
+
+constexpr char INDEX_MAGIC[8] = {'R', 'D', 'E', 'I', 'D', 'X', '0', '1'};
+constexpr uint32_t INDEX_VERSION = 1;
+constexpr size_t HEADER_SIZE = 64;
+constexpr size_t IMAGE_RECORD_SIZE = 64;
+constexpr size_t FILE_RECORD_SIZE = 56;
+constexpr size_t HASH_SIZE = 32;
+
+void putLE(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void setLE(std::vector<uint8_t>& out, size_t pos, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out[pos + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint64_t getLE(const uint8_t* p, int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+// Deduplicating string pool; offset 0 is always the empty string.
+class StringPool {
+public:
+    StringPool() : m_bytes(1, 0) {}
+
+    uint32_t add(const std::string& s) {
+        if (s.empty()) return 0;
+        auto it = m_offsets.find(s);
+        if (it != m_offsets.end()) return it->second;
+        const auto offset = static_cast<uint32_t>(m_bytes.size());
+        m_bytes.insert(m_bytes.end(), s.begin(), s.end());
+        m_bytes.push_back(0);
+        m_offsets.emplace(s, offset);
+        return offset;
+    }
+
+    const std::vector<uint8_t>& bytes() const { return m_bytes; }
+
+private:
+    std::vector<uint8_t> m_bytes;
+    std::map<std::string, uint32_t> m_offsets;
+};
+
+[[noreturn]] void corrupt(const std::filesystem::path& file, const std::string& what) {
+    throw InvalidFormatException("Corrupt index " + file.string() + ": " + what);
+}
+
+} // anonymous namespace
+
+void writeImageIndex(const std::filesystem::path& file, std::vector<IndexedImage> images) {
+    std::sort(images.begin(), images.end(),
+              [](const IndexedImage& a, const IndexedImage& b) { return a.path < b.path; });
+
+    struct FileRef {
+        uint32_t image;
+        const IndexedFile* file;
+    };
+    std::vector<FileRef> files;
+    for (size_t i = 0; i < images.size(); ++i) {
+        for (const auto& f : images[i].files) {
+            files.push_back({static_cast<uint32_t>(i), &f});
+        }
+    }
+    if (images.size() > UINT32_MAX || files.size() > UINT32_MAX) {
+        throw WriteException("Too many entries for an index: " + file.string());
+    }
+    std::sort(files.begin(), files.end(), [](const FileRef& a, const FileRef& b) {
+        if (a.file->hash != b.file->hash) return a.file->hash < b.file->hash;
+        if (a.image != b.image) return a.image < b.image;
+        return a.file->path < b.file->path;
+    });
+    std::vector<uint32_t> sizeOrder(files.size());
+    std::iota(sizeOrder.begin(), sizeOrder.end(), 0u);
+    std::stable_sort(sizeOrder.begin(), sizeOrder.end(), [&files](uint32_t a, uint32_t b) {
+        return files[a].file->size < files[b].file->size;
+    });
+
+    StringPool strings;
+    std::vector<uint8_t> out(HEADER_SIZE, 0);
+    const size_t imagesOffset = out.size();
+    for (const auto& image : images) {
+        out.insert(out.end(), image.hash.begin(), image.hash.end());
+        putLE(out, strings.add(image.path), 4);
+        putLE(out, strings.add(image.format), 4);
+        putLE(out, strings.add(image.fileSystem), 4);
+        putLE(out, strings.add(image.volume), 4);
+        putLE(out, image.files.size(), 4);
+        putLE(out, image.geometry.tracks, 4);
+        putLE(out, image.geometry.sides, 2);
+        putLE(out, image.geometry.sectorsPerTrack, 2);
+        putLE(out, image.geometry.bytesPerSector, 2);
+        putLE(out, 0, 2);
+    }
+    const size_t filesOffset = out.size();
+    for (const auto& ref : files) {
+        out.insert(out.end(), ref.file->hash.begin(), ref.file->hash.end());
+        putLE(out, ref.file->size, 8);
+        putLE(out, ref.image, 4);
+        putLE(out, strings.add(ref.file->path), 4);
+        putLE(out, ref.file->fileType, 1);
+        putLE(out, ref.file->attributes, 1);
+        putLE(out, 0, 2);
+        putLE(out, 0, 4);
+    }
+    const size_t sizeOrderOffset = out.size();
+    for (uint32_t n : sizeOrder) {
+        putLE(out, n, 4);
+    }
+    const size_t stringsOffset = out.size();
+    out.insert(out.end(), strings.bytes().begin(), strings.bytes().end());
+
+    std::memcpy(out.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    setLE(out, 8, INDEX_VERSION, 4);
+    setLE(out, 12, images.size(), 4);
+    setLE(out, 16, files.size(), 4);
+    setLE(out, 20, strings.bytes().size(), 4);
+    setLE(out, 24, imagesOffset, 8);
+    setLE(out, 32, filesOffset, 8);
+    setLE(out, 40, sizeOrderOffset, 8);
+    setLE(out, 48, stringsOffset, 8);
+    setLE(out, 56, CRC::crc32(out.data() + HEADER_SIZE, out.size() - HEADER_SIZE), 4);
+
+    // Write beside the target and rename, so readers never see half an index.
+    std::filesystem::path temp = file;
+    temp += ".tmp";
+    {
+        std::ofstream stream(temp, std::ios::binary | std::ios::trunc);
+        stream.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+        if (!stream) {
+            throw WriteException("Cannot write index: " + temp.string());
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, file, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        throw WriteException("Cannot replace index: " + file.string());
+    }
+}
+
+ImageIndex::ImageIndex(const std::filesystem::path& file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        std::error_code ec;
+        if (!std::filesystem::exists(file, ec)) {
+            throw FileNotFoundException(file.string());
+        }
+        throw ReadException("Cannot open index: " + file.string());
+    }
+    m_data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    if (m_data.size() < HEADER_SIZE || std::memcmp(m_data.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        throw InvalidFormatException("Not an rdedisktool index: " + file.string());
+    }
+    const uint8_t* h = m_data.data();
+    if (getLE(h + 8, 4) != INDEX_VERSION) {
+        corrupt(file, "unsupported version " + std::to_string(getLE(h + 8, 4)));
+    }
+    m_imageCount = static_cast<uint32_t>(getLE(h + 12, 4));
+    m_fileCount = static_cast<uint32_t>(getLE(h + 16, 4));
+    m_stringsSize = static_cast<size_t>(getLE(h + 20, 4));
+
+    // Tables are contiguous and in a fixed order; anything else is damage.
+    const uint64_t imagesOffset = getLE(h + 24, 8);
+    const uint64_t filesOffset = getLE(h + 32, 8);
+    const uint64_t sizeOrderOffset = getLE(h + 40, 8);
+    const uint64_t stringsOffset = getLE(h + 48, 8);
+    if (imagesOffset != HEADER_SIZE ||
+        filesOffset != imagesOffset + uint64_t{m_imageCount} * IMAGE_RECORD_SIZE ||
+        sizeOrderOffset != filesOffset + uint64_t{m_fileCount} * FILE_RECORD_SIZE ||
+        stringsOffset != sizeOrderOffset + uint64_t{m_fileCount} * 4 ||
+        stringsOffset + m_stringsSize != m_data.size() ||
+        m_stringsSize == 0 || m_data.back() != 0) {
+        corrupt(file, "table layout does not match its size");
+    }
+    if (CRC::crc32(m_data.data() + HEADER_SIZE, m_data.size() - HEADER_SIZE) != getLE(h + 56, 4)) {
+        corrupt(file, "checksum mismatch");
+    }
+    m_imagesOffset = static_cast<size_t>(imagesOffset);
+    m_filesOffset = static_cast<size_t>(filesOffset);
+    m_sizeOrderOffset = static_cast<size_t>(sizeOrderOffset);
+    m_stringsOffset = static_cast<size_t>(stringsOffset);
+}
+
+std::string ImageIndex::string(uint32_t offset) const {
+    if (offset >= m_stringsSize) {
+        throw InvalidFormatException("Corrupt index: string offset out of range");
+    }
+    return reinterpret_cast<const char*>(m_data.data() + m_stringsOffset + offset);
+}
+
+ImageIndex::Image ImageIndex::image(uint32_t index) const {
+    if (index >= m_imageCount) {
+        throw InvalidFormatException("Corrupt index: image number out of range");
+    }
+    const uint8_t* r = m_data.data() + m_imagesOffset + size_t{index} * IMAGE_RECORD_SIZE;
+    Image image;
+    std::memcpy(image.hash.data(), r, HASH_SIZE);
+    image.path = string(static_cast<uint32_t>(getLE(r + 32, 4)));
+    image.format = string(static_cast<uint32_t>(getLE(r + 36, 4)));
+    image.fileSystem = string(static_cast<uint32_t>(getLE(r + 40, 4)));
+    image.volume = string(static_cast<uint32_t>(getLE(r + 44, 4)));
+    image.fileCount = static_cast<uint32_t>(getLE(r + 48, 4));
+    image.geometry.tracks = static_cast<size_t>(getLE(r + 52, 4));
+    image.geometry.sides = static_cast<size_t>(getLE(r + 56, 2));
+    image.geometry.sectorsPerTrack = static_cast<size_t>(getLE(r + 58, 2));
+    image.geometry.bytesPerSector = static_cast<size_t>(getLE(r + 60, 2));
+    return image;
+}
+
+const uint8_t* ImageIndex::fileRecord(uint32_t index) const {
+    return m_data.data() + m_filesOffset + size_t{index} * FILE_RECORD_SIZE;
+}
+
+uint64_t ImageIndex::fileSize(uint32_t index) const {
+    return getLE(fileRecord(index) + 32, 8);
+}
+
+ImageIndex::File ImageIndex::file(uint32_t index) const {
+    if (index >= m_fileCount) {
+        throw InvalidFormatException("Corrupt index: file number out of range");
+    }
+    const uint8_t* r = fileRecord(index);
+    File file;
+    std::memcpy(file.hash.data(), r, HASH_SIZE);
+    file.size = getLE(r + 32, 8);
+    file.image = static_cast<uint32_t>(getLE(r + 40, 4));
+    file.path = string(static_cast<uint32_t>(getLE(r + 44, 4)));
+    file.fileType = r[48];
+    file.attributes = r[49];
+    if (file.image >= m_imageCount) {
+        throw InvalidFormatException("Corrupt index: image number out of range");
+    }
+    return file;
+}
+
+std::vector<uint32_t> ImageIndex::findByHash(const SHA256::Digest& hash) const {
+    auto less = [this](uint32_t n, const SHA256::Digest& key) {
+        return std::memcmp(fileRecord(n), key.data(), HASH_SIZE) < 0;
+    };
+    uint32_t lo = 0, hi = m_fileCount;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (less(mid, hash)) lo = mid + 1; else hi = mid;
+    }
+    std::vector<uint32_t> found;
+    for (uint32_t n = lo; n < m_fileCount && std::memcmp(fileRecord(n), hash.data(), HASH_SIZE) == 0; ++n) {
+        found.push_back(n);
+    }
+    return found;
+}
+
+std::vector<uint32_t> ImageIndex::findBySize(uint64_t min, uint64_t max) const {
+    const uint8_t* order = m_data.data() + m_sizeOrderOffset;
+    auto entry = [this, order](uint32_t pos) {
+        const auto n = static_cast<uint32_t>(getLE(order + size_t{pos} * 4, 4));
+        if (n >= m_fileCount) {
+            throw InvalidFormatException("Corrupt index: file number out of range");
+        }
+        return n;
+    };
+    uint32_t lo = 0, hi = m_fileCount;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (fileSize(entry(mid)) < min) lo = mid + 1; else hi = mid;
+    }
+    std::vector<uint32_t> found;
+    for (uint32_t pos = lo; pos < m_fileCount; ++pos) {
+        const uint32_t n = entry(pos);
+        if (fileSize(n) > max) break;
+        found.push_back(n);
+    }
+    return found;
+}
+
+} // namespace rde
@@ -0,0 +1,219 @@
+#include "rdedisktool/utils/JsonWriter.h"
+
+#include <cstdio>
+
+namespace rde {
+
+namespace {
+
+// Length of the well-formed UTF-8 sequence starting at s[i], or 0 if the
+// bytes there are not one (stray continuation, truncated, overlong,
+// surrogate or above U+10FFFF).
+size_t utf8SequenceLength(const std::string& s, size_t i) {
+    const auto byte = [&](size_t k) { return static_cast<unsigned char>(s[k]); };
+    const unsigned char lead = byte(i);
+    size_t len = 0;
+    unsigned char lo = 0x80;
+    unsigned char hi = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        len = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        len = 3;
+        if (lead == 0xE0) lo = 0xA0;
+        if (lead == 0xED) hi = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        len = 4;
+        if (lead == 0xF0) lo = 0x90;
+        if (lead == 0xF4) hi = 0x8F;
+    } else {
+        return 0;
+    }
+    if (i + len > s.size()) return 0;
+    if (byte(i + 1) < lo || byte(i + 1) > hi) return 0;
+    for (size_t k = 2; k < len; ++k) {
+        if ((byte(i + k) & 0xC0) != 0x80) return 0;
+    }
+    return len;
+}
+
+} // namespace
+
+JsonWriter::JsonWriter(std::ostream& out, bool pretty, size_t flushThreshold)
+    : m_out(out), m_pretty(pretty), m_flushThreshold(flushThreshold) {
+    m_buffer.reserve(flushThreshold + 4096);
+}
+
+void JsonWriter::newline() {
+    if (!m_pretty) return;
+    m_buffer += '\n';
+    m_buffer.append(m_hasItems.size() * 2, ' ');
+}
+
+// Comma/indent before a value or key; a value right after its key gets none.
+void JsonWriter::separate() {
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if (m_hasItems.empty()) return;
+    if (m_hasItems.back()) m_buffer += ',';
+    m_hasItems.back() = true;
+    newline();
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    m_buffer += '{';
+    m_hasItems.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    const bool hadItems = m_hasItems.back();
+    m_hasItems.pop_back();
+    if (hadItems) newline();
+    m_buffer += '}';
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    m_buffer += '[';
+    m_hasItems.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    const bool hadItems = m_hasItems.back();
+    m_hasItems.pop_back();
+    if (hadItems) newline();
+    m_buffer += ']';
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* name) {
+    separate();
+    appendString(m_buffer, name);
+    m_buffer += m_pretty ? ": " : ":";
+    m_afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const std::string& s) {
+    separate();
+    appendString(m_buffer, s);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* s) {
+    return value(std::string(s));
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+    separate();
+    m_buffer += b ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    m_buffer += "null";
+    return *this;
+}
+
+void JsonWriter::endRecord() {
+    m_buffer += '\n';
+    if (m_buffer.size() >= m_flushThreshold) {
+        flushTo();
+    }
+}
+
+void JsonWriter::flushTo() {
+    if (m_buffer.empty()) return;
+    m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_buffer.clear();
+}
+
+// Names come straight from disk in the file system's own encoding
+// (Shift-JIS, Mac-Roman, ...). Well-formed UTF-8 passes through; any other
+// byte is escaped as the Latin-1 code point of the same value, so the
+// output is always valid UTF-8 JSON.
+void JsonWriter::appendString(std::string& out, const std::string& s) {
+    out += '"';
+    size_t i = 0;
+    while (i < s.size()) {
+        const unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x80) {
+            const size_t len = utf8SequenceLength(s, i);
+            if (len != 0) {
+                out.append(s, i, len);
+                i += len;
+            } else {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+                ++i;
+            }
+            continue;
+        }
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+        ++i;
+    }
+    out += '"';
+}
+
+void writeJson(JsonWriter& w, const FileEntry& entry) {
+    w.field("name", entry.name)
+     .field("size", entry.size)
+     .field("isDirectory", entry.isDirectory)
+     .field("isDeleted", entry.isDeleted)
+     .field("fileType", entry.fileType)
+     .field("attributes", entry.attributes)
+     .field("loadAddress", entry.loadAddress)
+     .field("execAddress", entry.execAddress)
+     .field("createdTime", entry.createdTime)
+     .field("modifiedTime", entry.modifiedTime);
+}
+
+void writeJson(JsonWriter& w, const DiskGeometry& geometry) {
+    w.field("tracks", geometry.tracks)
+     .field("sides", geometry.sides)
+     .field("sectorsPerTrack", geometry.sectorsPerTrack)
+     .field("bytesPerSector", geometry.bytesPerSector)
+     .field("totalSectors", geometry.totalSectors())
+     .field("totalSize", geometry.totalSize());
+}
+
+void writeJson(JsonWriter& w, const ValidationResult& result) {
+    w.field("isValid", result.isValid)
+     .field("errorCount", result.errorCount)
+     .field("warningCount", result.warningCount);
+    w.key("issues").beginArray();
+    for (const auto& issue : result.issues) {
+        const char* severity = "info";
+        if (issue.severity == ValidationSeverity::Error) severity = "error";
+        else if (issue.severity == ValidationSeverity::Warning) severity = "warning";
+        w.beginObject()
+         .field("severity", severity)
+         .field("message", issue.message)
+         .field("location", issue.location)
+         .endObject();
+    }
+    w.endArray();
+}
+
+} // namespace rde
@@ -46,8 +46,94 @@ void appendUtf8(std::string& out, uint32_t cp) {
     }
 }
 
+// Decode the code point at name[i] and advance i. Malformed sequences
+// decode as the single raw byte so every input still compares stably.
+uint32_t nextCodePoint(std::string_view name, size_t& i) {
+    const uint8_t b = static_cast<uint8_t>(name[i]);
+    size_t len = 1;
+    uint32_t cp = b;
+    if (b >= 0xF0 && b < 0xF8) { len = 4; cp = b & 0x07; }
+    else if (b >= 0xE0)        { len = 3; cp = b & 0x0F; }
+    else if (b >= 0xC0)        { len = 2; cp = b & 0x1F; }
+    if (len > 1 && b < 0xF8) {
+        if (i + len > name.size()) len = 0;
+        for (size_t k = 1; k < len; ++k) {
+            const uint8_t c = static_cast<uint8_t>(name[i + k]);
+            if ((c & 0xC0) != 0x80) { len = 0; break; }
+            cp = (cp << 6) | (c & 0x3F);
+        }
+        if (len == 0) { len = 1; cp = b; }
+    } else {
+        len = 1;
+        cp = b;
+    }
+    i += len;
+    return cp;
+}
+
+// Upper-case a code point: ASCII plus the Latin-1 / Latin Extended-A
+// letters that have both cases in Mac-Roman.
+uint32_t foldCase(uint32_t cp) {
+    if (cp >= 'a' && cp <= 'z') return cp - 0x20;
+    if (cp >= 0xE0 && cp <= 0xFE && cp != 0xF7) return cp - 0x20;
+    if (cp == 0xFF) return 0x178;                  // y diaeresis
+    if (cp == 0x153) return 0x152;                 // oe ligature
+    return cp;
+}
+
+// foldCase() applied to each Mac-Roman byte; letters whose upper-case form
+// Mac-Roman cannot encode are left as they are.
+std::array<uint8_t, 256> buildFoldedBytes() {
+    std::array<uint8_t, 256> out{};
+    for (size_t b = 0; b < out.size(); ++b) {
+        out[b] = static_cast<uint8_t>(b);
+        if (b < 0x80) {
+            out[b] = static_cast<uint8_t>(foldCase(static_cast<uint32_t>(b)));
+            continue;
+        }
+        const uint32_t folded = foldCase(kMacRomanHigh[b - 0x80]);
+        for (size_t k = 0; k < kMacRomanHigh.size(); ++k) {
+            if (kMacRomanHigh[k] == folded) {
+                out[b] = static_cast<uint8_t>(0x80 + k);
+                break;
+            }
+        }
+    }
+    return out;
+}
+
 } // namespace
 
+uint8_t macRomanFoldByte(uint8_t b) {
+    static const std::array<uint8_t, 256> kFolded = buildFoldedBytes();
+    return kFolded[b];
+}
+
+bool macNamesEqual(std::string_view a, std::string_view b) {
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (foldCase(nextCodePoint(a, i)) != foldCase(nextCodePoint(b, j))) {
+            return false;
+        }
+    }
+    return i == a.size() && j == b.size();
+}
+
+size_t macNameHash(std::string_view name) {
+    // FNV-1a over the folded code points
+    uint64_t h = 1469598103934665603ULL;
+    size_t i = 0;
+    while (i < name.size()) {
+        const uint32_t cp = foldCase(nextCodePoint(name, i));
+        for (int k = 0; k < 3; ++k) {
+            h ^= (cp >> (8 * k)) & 0xFF;
+            h *= 1099511628211ULL;
+        }
+    }
+    return static_cast<size_t>(h);
+}
+
 std::string macRomanToUtf8(const uint8_t* data, size_t length) {
     std::string out;
     out.reserve(length);
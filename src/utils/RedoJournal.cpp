@@ -0,0 +1,205 @@
+#include "rdedisktool/utils/RedoJournal.h"
+#include "rdedisktool/utils/FileSync.h"
+#include "rdedisktool/CRC.h"
+#include "rdedisktool/Exceptions.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+namespace rde {
+
+namespace {
+
+constexpr char JOURNAL_MAGIC[8] = {'R', 'D', 'E', 'J', 'R', 'N', 'L', '2'};
+// magic, file size, check offset, check length, check CRC, range count
+constexpr size_t JOURNAL_HEADER_SIZE = sizeof(JOURNAL_MAGIC) + 8 + 8 + 8 + 4 + 4;
+constexpr size_t RANGE_HEADER_SIZE = 8 + 4;
+
+void putLE(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+uint64_t getLE(const uint8_t* p, int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+struct JournalRange {
+    uint64_t offset;
+    const uint8_t* bytes;
+    size_t length;
+};
+
+// Identity of the image state a journal produces
+struct JournalCheck {
+    uint64_t fileSize = 0;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    uint32_t crc = 0;
+};
+
+// Splits a journal into ranges; false if it is torn or corrupt.
+bool parseJournal(const std::vector<uint8_t>& journal, JournalCheck& check,
+                  std::vector<JournalRange>& ranges) {
+    if (journal.size() < JOURNAL_HEADER_SIZE + 4 ||
+        std::memcmp(journal.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0) {
+        return false;
+    }
+    const size_t body = journal.size() - 4;
+    if (CRC::crc32(journal.data(), body) != getLE(journal.data() + body, 4)) {
+        return false;
+    }
+    const uint8_t* header = journal.data() + sizeof(JOURNAL_MAGIC);
+    check.fileSize = getLE(header, 8);
+    check.offset = getLE(header + 8, 8);
+    check.length = getLE(header + 16, 8);
+    check.crc = static_cast<uint32_t>(getLE(header + 24, 4));
+    const uint64_t count = getLE(header + 28, 4);
+    if (check.offset > check.fileSize || check.length > check.fileSize - check.offset) {
+        return false;
+    }
+    size_t pos = JOURNAL_HEADER_SIZE;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (body - pos < RANGE_HEADER_SIZE) return false;
+        const uint64_t offset = getLE(journal.data() + pos, 8);
+        const size_t length = static_cast<size_t>(getLE(journal.data() + pos + 8, 4));
+        pos += RANGE_HEADER_SIZE;
+        if (body - pos < length || offset > check.fileSize || length > check.fileSize - offset) {
+            return false;
+        }
+        ranges.push_back({offset, journal.data() + pos, length});
+        pos += length;
+    }
+    return pos == body;
+}
+
+// True if `image` is the file the journal was written for: the recorded
+// size, and the recorded checksum once the ranges are applied in memory.
+bool journalMatches(const std::filesystem::path& image, const JournalCheck& check,
+                    const std::vector<JournalRange>& ranges) {
+    std::error_code ec;
+    if (std::filesystem::file_size(image, ec) != check.fileSize || ec) {
+        return false;
+    }
+    std::ifstream in(image, std::ios::binary);
+    std::vector<uint8_t> contents((std::istreambuf_iterator<char>(in)),
+                                  std::istreambuf_iterator<char>());
+    if (contents.size() != check.fileSize) {
+        return false;
+    }
+    for (const auto& r : ranges) {
+        std::memcpy(contents.data() + r.offset, r.bytes, r.length);
+    }
+    return CRC::crc32(contents.data() + check.offset, static_cast<size_t>(check.length)) ==
+           check.crc;
+}
+
+void applyRanges(const std::filesystem::path& image, const std::vector<JournalRange>& ranges) {
+    std::fstream out(image, std::ios::binary | std::ios::in | std::ios::out);
+    if (!out) {
+        throw WriteException("Cannot open for in-place write: " + image.string());
+    }
+    for (const auto& r : ranges) {
+        out.seekp(static_cast<std::streamoff>(r.offset));
+        out.write(reinterpret_cast<const char*>(r.bytes), static_cast<std::streamsize>(r.length));
+    }
+    out.flush();
+    if (!out) {
+        throw WriteException("In-place write failed: " + image.string());
+    }
+}
+
+} // namespace
+
+std::filesystem::path redoJournalPath(const std::filesystem::path& image) {
+    std::filesystem::path journal = image;
+    journal += ".rdejournal";
+    return journal;
+}
+
+uint64_t writeRangesInPlace(const std::filesystem::path& image,
+                            const std::vector<uint8_t>& data,
+                            uint64_t dataOffset,
+                            const std::map<size_t, size_t>& ranges) {
+    if (ranges.empty()) return 0;
+
+    std::error_code ec;
+    const uint64_t fileSize = std::filesystem::file_size(image, ec);
+    if (ec || fileSize < dataOffset + data.size()) {
+        throw WriteException("Image is smaller than its data: " + image.string());
+    }
+
+    std::vector<uint8_t> journal(JOURNAL_MAGIC, JOURNAL_MAGIC + sizeof(JOURNAL_MAGIC));
+    putLE(journal, fileSize, 8);
+    putLE(journal, dataOffset, 8);
+    putLE(journal, data.size(), 8);
+    putLE(journal, CRC::crc32(data.data(), data.size()), 4);
+    putLE(journal, ranges.size(), 4);
+    uint64_t payload = 0;
+    for (const auto& [begin, end] : ranges) {
+        if (begin >= end || end > data.size()) {
+            throw WriteException("Dirty range outside image data");
+        }
+        putLE(journal, dataOffset + begin, 8);
+        putLE(journal, end - begin, 4);
+        journal.insert(journal.end(), data.begin() + begin, data.begin() + end);
+        payload += end - begin;
+    }
+    putLE(journal, CRC::crc32(journal.data(), journal.size()), 4);
+
+    const std::filesystem::path journalPath = redoJournalPath(image);
+    {
+        std::ofstream out(journalPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(journal.data()),
+                  static_cast<std::streamsize>(journal.size()));
+        if (!out) {
+            throw WriteException("Cannot write journal: " + journalPath.string());
+        }
+    }
+    syncFile(journalPath);
+    // The journal's directory entry must be durable before the image is torn
+    syncDirectory(journalPath.parent_path());
+
+    JournalCheck check;
+    std::vector<JournalRange> parsed;
+    parseJournal(journal, check, parsed);
+    applyRanges(image, parsed);
+    syncFile(image);
+
+    std::filesystem::remove(journalPath, ec);
+    return payload;
+}
+
+JournalRecovery recoverRedoJournal(const std::filesystem::path& image) {
+    const std::filesystem::path journalPath = redoJournalPath(image);
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(journalPath, ec)) return JournalRecovery::None;
+
+    std::ifstream in(journalPath, std::ios::binary);
+    std::vector<uint8_t> journal((std::istreambuf_iterator<char>(in)),
+                                 std::istreambuf_iterator<char>());
+    in.close();
+
+    JournalCheck check;
+    std::vector<JournalRange> ranges;
+    JournalRecovery result = JournalRecovery::Torn;
+    if (parseJournal(journal, check, ranges)) {
+        result = JournalRecovery::Mismatch;
+        if (journalMatches(image, check, ranges)) {
+            applyRanges(image, ranges);
+            syncFile(image);
+            result = JournalRecovery::Replayed;
+        }
+    }
+    std::filesystem::remove(journalPath, ec);
+    return result;
+}
+
+} // namespace rde
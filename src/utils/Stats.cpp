@@ -0,0 +1,84 @@
+#include "rdedisktool/utils/Stats.h"
+#include "rdedisktool/utils/JsonWriter.h"
+
+#include <cstdio>
+
+namespace rde {
+
+std::atomic<bool> Stats::s_enabled{false};
+std::atomic<uint64_t> Stats::s_counters[static_cast<size_t>(Stats::Counter::Count_)];
+std::atomic<uint64_t> Stats::s_phaseCalls[static_cast<size_t>(Stats::Phase::Count_)];
+std::atomic<uint64_t> Stats::s_phaseNanos[static_cast<size_t>(Stats::Phase::Count_)];
+
+namespace {
+
+constexpr const char* PHASE_NAMES[] = {"detect", "load", "fsInit", "save", "command"};
+constexpr const char* COUNTER_NAMES[] = {
+    "sectorReads", "sectorBytesRead", "sectorWrites", "sectorBytesWritten", "bytesLoaded"};
+
+static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) ==
+              static_cast<size_t>(Stats::Phase::Count_));
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) ==
+              static_cast<size_t>(Stats::Counter::Count_));
+
+uint64_t load(const std::atomic<uint64_t>& a) {
+    return a.load(std::memory_order_relaxed);
+}
+
+} // anonymous namespace
+
+void Stats::addTime(Phase p, uint64_t nanoseconds) {
+    if (!enabled()) return;
+    const auto i = static_cast<size_t>(p);
+    s_phaseCalls[i].fetch_add(1, std::memory_order_relaxed);
+    s_phaseNanos[i].fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+void Stats::reset() {
+    for (auto& c : s_counters) c.store(0, std::memory_order_relaxed);
+    for (auto& c : s_phaseCalls) c.store(0, std::memory_order_relaxed);
+    for (auto& c : s_phaseNanos) c.store(0, std::memory_order_relaxed);
+}
+
+void Stats::report(std::ostream& out, bool json) {
+    constexpr size_t phases = static_cast<size_t>(Phase::Count_);
+    constexpr size_t counters = static_cast<size_t>(Counter::Count_);
+
+    if (json) {
+        JsonWriter w(out, false);
+        w.beginObject();
+        w.key("phases").beginObject();
+        for (size_t i = 0; i < phases; ++i) {
+            w.key(PHASE_NAMES[i]).beginObject();
+            w.field("calls", load(s_phaseCalls[i]));
+            w.field("nanoseconds", load(s_phaseNanos[i]));
+            w.endObject();
+        }
+        w.endObject();
+        w.key("counters").beginObject();
+        for (size_t i = 0; i < counters; ++i) {
+            w.field(COUNTER_NAMES[i], load(s_counters[i]));
+        }
+        w.endObject();
+        w.endObject();
+        w.endRecord();
+        w.flushTo();
+        return;
+    }
+
+    out << "Statistics:\n";
+    char line[96];
+    for (size_t i = 0; i < phases; ++i) {
+        std::snprintf(line, sizeof(line), "  %-20s %8llu calls %12.3f ms\n", PHASE_NAMES[i],
+                      static_cast<unsigned long long>(load(s_phaseCalls[i])),
+                      static_cast<double>(load(s_phaseNanos[i])) / 1e6);
+        out << line;
+    }
+    for (size_t i = 0; i < counters; ++i) {
+        std::snprintf(line, sizeof(line), "  %-20s %14llu\n", COUNTER_NAMES[i],
+                      static_cast<unsigned long long>(load(s_counters[i])));
+        out << line;
+    }
+}
+
+} // namespace rde
@@ -0,0 +1,99 @@
+#include "rdedisktool/utils/WorkStealingPool.h"
+
+namespace rde {
+
+WorkStealingPool::WorkStealingPool(size_t threads) {
+    if (threads == 0) threads = 1;
+    for (size_t i = 0; i < threads; ++i) {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        m_threads.emplace_back([this, i] { run(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_workAvailable.notify_all();
+    for (auto& t : m_threads) {
+        t.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    // Count first so the task can never finish before it is counted.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_queued;
+        ++m_unfinished;
+    }
+    Queue& q = *m_queues[m_next++ % m_queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back(std::move(task));
+    }
+    m_workAvailable.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_allDone.wait(lock, [this] { return m_unfinished == 0; });
+}
+
+// Own deque newest-first, then steal oldest-first from the others.
+bool WorkStealingPool::takeTask(size_t self, Task& task) {
+    {
+        Queue& own = *m_queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < m_queues.size(); ++i) {
+        Queue& victim = *m_queues[(self + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(size_t self) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workAvailable.wait(lock, [this] { return m_stop || m_queued > 0; });
+            if (m_stop && m_queued == 0) {
+                return;
+            }
+        }
+
+        Task task;
+        if (!takeTask(self, task)) {
+            // Another worker took it between the wake-up and the scan.
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_queued;
+        }
+        task();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_unfinished == 0) {
+                m_allDone.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace rde
@@ -1,6 +1,8 @@
 #include "rdedisktool/x68000/X68000DIMImage.h"
 #include "rdedisktool/x68000/X68000XDFImage.h"
 #include "rdedisktool/DiskImageFactory.h"
+#include "rdedisktool/utils/Stats.h"
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <cstring>
@@ -32,8 +34,10 @@ X68000DIMImage::X68000DIMImage() : X68000DiskImage() {
     std::memset(&m_header, 0, sizeof(m_header));
     m_header.type = static_cast<uint8_t>(m_dimType);
 
-    // Set all track flags to present by default
-    std::memset(m_header.trkflag, 1, sizeof(m_header.trkflag));
+    // No tracks stored until written
+    m_tracks.resize(DIM_MAX_TRACKS);
+    m_data.resize(DIM_HEADER_SIZE);
+    buildHeader();
 
     // Initialize geometry for 2HD
     initGeometry(154, 2, 8, 1024);
@@ -57,13 +61,27 @@ void X68000DIMImage::load(const std::filesystem::path& path) {
         throw InvalidFormatException("File too small for DIM format");
     }
 
-    // Read header first
-    file.read(reinterpret_cast<char*>(&m_header), sizeof(m_header));
+    std::vector<uint8_t> image(fileSize);
+    file.read(reinterpret_cast<char*>(image.data()), static_cast<std::streamsize>(fileSize));
 
     if (!file) {
-        throw ReadException("Failed to read DIM header");
+        throw ReadException("Failed to read DIM image: " + path.string());
     }
 
+    parseImage(image);
+
+    m_filePath = path;
+    m_modified = false;
+    m_fileSystemDetected = false;
+}
+
+void X68000DIMImage::parseImage(const std::vector<uint8_t>& image) {
+    if (image.size() < DIM_HEADER_SIZE) {
+        throw InvalidFormatException("File too small for DIM format");
+    }
+
+    std::memcpy(&m_header, image.data(), sizeof(m_header));
+
     // Validate header
     if (!isValidDIMType(m_header.type)) {
         throw InvalidFormatException("Invalid DIM type: " + std::to_string(m_header.type));
@@ -77,40 +95,46 @@ void X68000DIMImage::load(const std::filesystem::path& path) {
     size_t maxTracks = MAX_TRACKS[m_header.type];
     initGeometry(maxTracks, 2, sectorsPerTrack, sectorSize);
 
-    // Calculate expected size and allocate
     size_t trackSize = TRACK_SIZES[m_header.type];
-    size_t maxDataSize = DIM_HEADER_SIZE + (trackSize * DIM_MAX_TRACKS);
-
-    m_data.resize(maxDataSize, 0xE5);
+    size_t flaggedTracks = 0;
+    for (size_t track = 0; track < DIM_MAX_TRACKS; ++track) {
+        if (m_header.trkflag[track]) ++flaggedTracks;
+    }
 
-    // Copy header to data
-    std::memcpy(m_data.data(), &m_header, sizeof(m_header));
+    // Without the overtrack flag, images whose size does not match the
+    // track flags store every track back to back (flags are unreliable)
+    const bool sequential = m_header.overtrack == 0 &&
+        image.size() != DIM_HEADER_SIZE + flaggedTracks * trackSize;
 
-    // Read track data based on track flags
+    m_tracks.assign(DIM_MAX_TRACKS, {});
     size_t dataOffset = DIM_HEADER_SIZE;
 
-    // If overtrack is 0, all tracks are present
-    if (m_header.overtrack == 0) {
-        std::memset(m_header.trkflag, 1, sizeof(m_header.trkflag));
-    }
-
     for (size_t track = 0; track < DIM_MAX_TRACKS; ++track) {
-        if (m_header.trkflag[track]) {
-            // Read track data from file
-            size_t readSize = std::min(trackSize, fileSize - static_cast<size_t>(file.tellg()));
-            if (readSize > 0) {
-                file.read(reinterpret_cast<char*>(m_data.data() + dataOffset), readSize);
-            }
+        if (!sequential && !m_header.trkflag[track]) {
+            continue;
         }
+
+        // Tracks beyond the end of the file stay absent
+        if (dataOffset >= image.size()) {
+            m_header.trkflag[track] = 0;
+            continue;
+        }
+
+        size_t readSize = std::min(trackSize, image.size() - dataOffset);
+        auto& buffer = m_tracks[track];
+        buffer.assign(trackSize, FILLER_BYTE);
+        std::copy(image.begin() + dataOffset, image.begin() + dataOffset + readSize,
+                  buffer.begin());
+        m_header.trkflag[track] = 1;
         dataOffset += trackSize;
     }
 
-    m_filePath = path;
-    m_modified = false;
-    m_fileSystemDetected = false;
+    m_data.resize(DIM_HEADER_SIZE);
+    buildHeader();
 }
 
 void X68000DIMImage::save(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Save);
     std::filesystem::path savePath = path.empty() ? m_filePath : path;
 
     if (savePath.empty()) {
@@ -133,14 +157,12 @@ void X68000DIMImage::save(const std::filesystem::path& path) {
     file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
 
     // Write track data (only tracks that are present)
-    size_t trackSize = TRACK_SIZES[m_header.type];
-    size_t dataOffset = DIM_HEADER_SIZE;
-
     for (size_t track = 0; track < DIM_MAX_TRACKS; ++track) {
         if (m_header.trkflag[track]) {
-            file.write(reinterpret_cast<const char*>(m_data.data() + dataOffset), trackSize);
+            const auto& buffer = m_tracks[track];
+            file.write(reinterpret_cast<const char*>(buffer.data()),
+                       static_cast<std::streamsize>(buffer.size()));
         }
-        dataOffset += trackSize;
     }
 
     if (!file) {
@@ -170,10 +192,9 @@ void X68000DIMImage::create(const DiskGeometry& geometry) {
         }
     }
 
-    // Initialize header
+    // Initialize header; tracks are materialized as they are written
     std::memset(&m_header, 0, sizeof(m_header));
     m_header.type = static_cast<uint8_t>(m_dimType);
-    std::memset(m_header.trkflag, 1, sizeof(m_header.trkflag));
     m_header.overtrack = 0;
 
     // Update geometry
@@ -182,19 +203,40 @@ void X68000DIMImage::create(const DiskGeometry& geometry) {
     size_t maxTracks = MAX_TRACKS[m_header.type];
     initGeometry(maxTracks, 2, sectorsPerTrack, sectorSize);
 
-    // Allocate data
-    size_t trackSize = TRACK_SIZES[m_header.type];
-    size_t totalSize = DIM_HEADER_SIZE + (trackSize * DIM_MAX_TRACKS);
-    m_data.resize(totalSize, 0xE5);
+    m_tracks.assign(DIM_MAX_TRACKS, {});
 
     // Copy header to data
-    std::memcpy(m_data.data(), &m_header, sizeof(m_header));
+    m_data.resize(DIM_HEADER_SIZE);
+    buildHeader();
 
     m_modified = true;
     m_fileSystemDetected = false;
     m_filePath.clear();
 }
 
+const std::vector<uint8_t>& X68000DIMImage::getRawData() const {
+    DIMHeader header = m_header;
+    header.type = static_cast<uint8_t>(m_dimType);
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&header);
+    m_rawView.assign(bytes, bytes + sizeof(header));
+    m_rawView.reserve(sizeof(header) + getPresentTrackCount() * getTrackSize());
+    for (size_t track = 0; track < DIM_MAX_TRACKS; ++track) {
+        if (m_header.trkflag[track]) {
+            const auto& buffer = m_tracks[track];
+            m_rawView.insert(m_rawView.end(), buffer.begin(), buffer.end());
+        }
+    }
+    return m_rawView;
+}
+
+void X68000DIMImage::setRawData(const std::vector<uint8_t>& data) {
+    parseImage(data);
+    Stats::sectorWritten(data.size(), data.size() / getSectorSize());
+    m_modified = true;
+    m_fileSystemDetected = false;
+}
+
 void X68000DIMImage::parseHeader() {
     if (m_data.size() >= sizeof(m_header)) {
         std::memcpy(&m_header, m_data.data(), sizeof(m_header));
@@ -209,14 +251,19 @@ void X68000DIMImage::buildHeader() {
     }
 }
 
-size_t X68000DIMImage::getDataOffset(size_t track) const {
-    size_t trackSize = TRACK_SIZES[static_cast<uint8_t>(m_dimType)];
-    return DIM_HEADER_SIZE + (track * trackSize);
+std::vector<uint8_t>& X68000DIMImage::materializeTrack(size_t track) {
+    auto& buffer = m_tracks[track];
+    if (buffer.empty()) {
+        buffer.assign(getTrackSize(), FILLER_BYTE);
+        m_header.trkflag[track] = 1;
+        m_modified = true;
+    }
+    return buffer;
 }
 
-size_t X68000DIMImage::calculateOffset(size_t track, size_t sector) const {
+size_t X68000DIMImage::calculateOffset(size_t /*track*/, size_t sector) const {
     size_t sectorSize = SECTOR_SIZES[static_cast<uint8_t>(m_dimType)];
-    return getDataOffset(track) + ((sector - 1) * sectorSize);
+    return (sector - 1) * sectorSize;
 }
 
 void X68000DIMImage::validateParameters(size_t track, size_t sector) const {
@@ -236,28 +283,33 @@ bool X68000DIMImage::isValidDIMType(uint8_t type) {
 }
 
 SectorBuffer X68000DIMImage::readSector(size_t track, size_t side, size_t sector) {
+    Stats::sectorRead(m_geometry.bytesPerSector);
     // Convert track/side to linear track
     size_t linearTrack = (track << 1) | (side & 1);
 
     validateParameters(linearTrack, sector);
 
+    size_t sectorSize = getSectorSize();
+
+    // Absent tracks read as unformatted filler
     if (!isTrackPresent(linearTrack)) {
-        throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
+        return SectorBuffer(sectorSize, FILLER_BYTE);
     }
 
+    const auto& buffer = m_tracks[linearTrack];
     size_t offset = calculateOffset(linearTrack, sector);
-    size_t sectorSize = getSectorSize();
 
-    if (offset + sectorSize > m_data.size()) {
+    if (offset + sectorSize > buffer.size()) {
         throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
     }
 
-    return SectorBuffer(m_data.begin() + offset,
-                        m_data.begin() + offset + sectorSize);
+    return SectorBuffer(buffer.begin() + offset,
+                        buffer.begin() + offset + sectorSize);
 }
 
 void X68000DIMImage::writeSector(size_t track, size_t side, size_t sector,
                                   const SectorBuffer& data) {
+    Stats::sectorWritten(data.size());
     if (m_writeProtected) {
         throw WriteProtectedException();
     }
@@ -267,22 +319,22 @@ void X68000DIMImage::writeSector(size_t track, size_t side, size_t sector,
 
     validateParameters(linearTrack, sector);
 
-    // Mark track as present
-    setTrackPresent(linearTrack, true);
+    // Materialize the track on first write
+    auto& buffer = materializeTrack(linearTrack);
 
     size_t offset = calculateOffset(linearTrack, sector);
     size_t sectorSize = getSectorSize();
 
-    if (offset + sectorSize > m_data.size()) {
+    if (offset + sectorSize > buffer.size()) {
         throw SectorNotFoundException(static_cast<int>(track), static_cast<int>(sector));
     }
 
     size_t copySize = std::min(data.size(), sectorSize);
-    std::copy(data.begin(), data.begin() + copySize, m_data.begin() + offset);
+    std::copy(data.begin(), data.begin() + copySize, buffer.begin() + offset);
 
     if (copySize < sectorSize) {
-        std::fill(m_data.begin() + offset + copySize,
-                  m_data.begin() + offset + sectorSize, 0xE5);
+        std::fill(buffer.begin() + offset + copySize,
+                  buffer.begin() + offset + sectorSize, FILLER_BYTE);
     }
 
     m_modified = true;
@@ -296,11 +348,11 @@ TrackBuffer X68000DIMImage::readTrack(size_t track, size_t side) {
         throw SectorNotFoundException(static_cast<int>(track), 0);
     }
 
-    size_t trackSize = getTrackSize();
-    size_t offset = getDataOffset(linearTrack);
+    if (!isTrackPresent(linearTrack)) {
+        return TrackBuffer(getTrackSize(), FILLER_BYTE);
+    }
 
-    return TrackBuffer(m_data.begin() + offset,
-                       m_data.begin() + offset + trackSize);
+    return m_tracks[linearTrack];
 }
 
 void X68000DIMImage::writeTrack(size_t track, size_t side, const TrackBuffer& data) {
@@ -315,20 +367,38 @@ void X68000DIMImage::writeTrack(size_t track, size_t side, const TrackBuffer& da
         throw SectorNotFoundException(static_cast<int>(track), 0);
     }
 
-    setTrackPresent(linearTrack, true);
+    auto& buffer = materializeTrack(linearTrack);
+    size_t copySize = std::min(data.size(), buffer.size());
 
-    size_t trackSize = getTrackSize();
-    size_t offset = getDataOffset(linearTrack);
-    size_t copySize = std::min(data.size(), trackSize);
+    std::copy(data.begin(), data.begin() + copySize, buffer.begin());
 
-    std::copy(data.begin(), data.begin() + copySize, m_data.begin() + offset);
+    if (copySize < buffer.size()) {
+        std::fill(buffer.begin() + copySize, buffer.end(), FILLER_BYTE);
+    }
 
-    if (copySize < trackSize) {
-        std::fill(m_data.begin() + offset + copySize,
-                  m_data.begin() + offset + trackSize, 0xE5);
+    m_modified = true;
+}
+
+const uint8_t* X68000DIMImage::sectorData(size_t linearTrack, size_t sector) const {
+    if (linearTrack >= MAX_TRACKS[static_cast<uint8_t>(m_dimType)] ||
+        sector < 1 || sector > getSectorsPerTrack() || !isTrackPresent(linearTrack)) {
+        return nullptr;
     }
+    Stats::sectorRead(getSectorSize());
+    return m_tracks[linearTrack].data() + calculateOffset(linearTrack, sector);
+}
 
+uint8_t* X68000DIMImage::mutableSectorData(size_t linearTrack, size_t sector) {
+    if (m_writeProtected) {
+        throw WriteProtectedException();
+    }
+
+    validateParameters(linearTrack, sector);
+
+    auto& buffer = materializeTrack(linearTrack);
+    Stats::sectorWritten(getSectorSize());
     m_modified = true;
+    return buffer.data() + calculateOffset(linearTrack, sector);
 }
 
 void X68000DIMImage::setDIMType(X68000DIMType type) {
@@ -341,6 +411,13 @@ void X68000DIMImage::setDIMType(X68000DIMType type) {
     size_t maxTracks = MAX_TRACKS[m_header.type];
     initGeometry(maxTracks, 2, sectorsPerTrack, sectorSize);
 
+    // Keep stored tracks sized for the new type
+    for (auto& buffer : m_tracks) {
+        if (!buffer.empty()) {
+            buffer.resize(TRACK_SIZES[m_header.type], FILLER_BYTE);
+        }
+    }
+
     m_modified = true;
 }
 
@@ -364,10 +441,59 @@ bool X68000DIMImage::isTrackPresent(size_t track) const {
 }
 
 void X68000DIMImage::setTrackPresent(size_t track, bool present) {
-    if (track < DIM_MAX_TRACKS) {
-        m_header.trkflag[track] = present ? 1 : 0;
-        m_modified = true;
+    if (track >= DIM_MAX_TRACKS) {
+        return;
+    }
+
+    if (present) {
+        materializeTrack(track);
+    } else {
+        std::vector<uint8_t>().swap(m_tracks[track]);
+        m_header.trkflag[track] = 0;
+    }
+    m_modified = true;
+}
+
+size_t X68000DIMImage::getPresentTrackCount() const {
+    size_t count = 0;
+    for (size_t i = 0; i < DIM_MAX_TRACKS; ++i) {
+        if (m_header.trkflag[i]) ++count;
     }
+    return count;
+}
+
+bool X68000DIMImage::isTrackBlank(size_t track) const {
+    if (!isTrackPresent(track)) {
+        return false;
+    }
+
+    const auto& buffer = m_tracks[track];
+    if (buffer.empty() || (buffer[0] != 0x00 && buffer[0] != FILLER_BYTE)) {
+        return false;
+    }
+    return std::all_of(buffer.begin(), buffer.end(),
+                       [first = buffer[0]](uint8_t b) { return b == first; });
+}
+
+size_t X68000DIMImage::compactTracks(const std::optional<std::vector<bool>>& usedTracks) {
+    size_t removed = 0;
+
+    for (size_t track = 0; track < DIM_MAX_TRACKS; ++track) {
+        if (!isTrackBlank(track)) {
+            continue;
+        }
+
+        // Zero-filled tracks would read back as filler once dropped
+        const bool zeroFilled = m_tracks[track][0] == 0x00;
+        if (zeroFilled && (!usedTracks || (track < usedTracks->size() && (*usedTracks)[track]))) {
+            continue;
+        }
+
+        setTrackPresent(track, false);
+        ++removed;
+    }
+
+    return removed;
 }
 
 size_t X68000DIMImage::getSectorSize() const {
@@ -405,6 +531,7 @@ bool X68000DIMImage::canConvertTo(DiskFormat format) const {
         case DiskFormat::AppleNIB2:
         case DiskFormat::AppleWOZ1:
         case DiskFormat::AppleWOZ2:
+        case DiskFormat::AppleHDV:
         case DiskFormat::MSXDSK:
         case DiskFormat::MSXDMK:
         case DiskFormat::MSXXSA:
@@ -431,10 +558,11 @@ std::unique_ptr<DiskImage> X68000DIMImage::convertTo(DiskFormat format) const {
         // Only first 154 tracks (XDF limit)
         for (size_t track = 0; track < X68000DiskImage::XDF_TOTAL_TRACKS; ++track) {
             if (isTrackPresent(track)) {
+                const auto& buffer = m_tracks[track];
                 for (size_t sector = 1; sector <= 8; ++sector) {
                     size_t offset = calculateOffset(track, sector);
-                    SectorBuffer sectorData(m_data.begin() + offset,
-                                           m_data.begin() + offset + 1024);
+                    SectorBuffer sectorData(buffer.begin() + offset,
+                                           buffer.begin() + offset + 1024);
                     xdfImage->writeSector(track, 0, sector, sectorData);
                 }
             }
@@ -457,6 +585,13 @@ bool X68000DIMImage::validate() const {
         return false;
     }
 
+    // Every stored track must match the type's track size
+    for (size_t track = 0; track < DIM_MAX_TRACKS; ++track) {
+        if (m_header.trkflag[track] && m_tracks[track].size() != getTrackSize()) {
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -465,18 +600,13 @@ std::string X68000DIMImage::getDiagnostics() const {
 
     oss << "Format: X68000 DIM (.dim)\n";
     oss << "DIM Type: " << getDIMTypeName(m_dimType) << "\n";
-    oss << "Size: " << m_data.size() << " bytes\n";
+    oss << "Size: " << DIM_HEADER_SIZE + getPresentTrackCount() * getTrackSize() << " bytes\n";
     oss << "Max Tracks: " << MAX_TRACKS[static_cast<uint8_t>(m_dimType)] << "\n";
     oss << "Sectors/Track: " << getSectorsPerTrack() << "\n";
     oss << "Bytes/Sector: " << getSectorSize() << "\n";
     oss << "Track Size: " << getTrackSize() << " bytes\n";
 
-    // Count present tracks
-    size_t presentTracks = 0;
-    for (size_t i = 0; i < DIM_MAX_TRACKS; ++i) {
-        if (m_header.trkflag[i]) ++presentTracks;
-    }
-    oss << "Present Tracks: " << presentTracks << "/" << DIM_MAX_TRACKS << "\n";
+    oss << "Present Tracks: " << getPresentTrackCount() << "/" << DIM_MAX_TRACKS << "\n";
 
     std::string comment = getComment();
     if (!comment.empty()) {
@@ -1,4 +1,5 @@
 #include "rdedisktool/x68000/X68000DiskImage.h"
+#include "rdedisktool/utils/Stats.h"
 #include <cstring>
 
 namespace rde {
@@ -72,7 +73,7 @@ FileSystemType X68000DiskImage::getFileSystemType() const {
 }
 
 void X68000DiskImage::setRawData(const std::vector<uint8_t>& data) {
-    m_data = data;
+    assignRawData(data);
     m_modified = true;
     m_fileSystemDetected = false;
 }
@@ -81,6 +82,36 @@ bool X68000DiskImage::isHuman68k() const {
     return getFileSystemType() == FileSystemType::Human68k;
 }
 
+const uint8_t* X68000DiskImage::sectorData(size_t linearTrack, size_t sector) const {
+    if (linearTrack >= m_geometry.tracks || sector < 1 || sector > m_geometry.sectorsPerTrack) {
+        return nullptr;
+    }
+
+    size_t offset = calculateOffset(linearTrack, sector);
+    if (offset + m_geometry.bytesPerSector > m_data.size()) {
+        return nullptr;
+    }
+    Stats::sectorRead(m_geometry.bytesPerSector);
+    return m_data.data() + offset;
+}
+
+uint8_t* X68000DiskImage::mutableSectorData(size_t linearTrack, size_t sector) {
+    if (m_writeProtected) {
+        throw WriteProtectedException();
+    }
+
+    const size_t offset = calculateOffset(linearTrack, sector);
+    if (linearTrack >= m_geometry.tracks || sector < 1 || sector > m_geometry.sectorsPerTrack ||
+        offset + m_geometry.bytesPerSector > m_data.size()) {
+        throw SectorNotFoundException(static_cast<int>(linearTrack), static_cast<int>(sector));
+    }
+
+    Stats::sectorWritten(m_geometry.bytesPerSector);
+    markDirty(offset, m_geometry.bytesPerSector);
+    m_modified = true;
+    return m_data.data() + offset;
+}
+
 void X68000DiskImage::initGeometry(size_t tracks, size_t sides, size_t sectorsPerTrack, size_t bytesPerSector) {
     m_geometry.tracks = tracks;
     m_geometry.sides = sides;
@@ -1,5 +1,6 @@
 #include "rdedisktool/x68000/X68000XDFImage.h"
 #include "rdedisktool/DiskImageFactory.h"
+#include "rdedisktool/utils/Stats.h"
 #include <fstream>
 #include <sstream>
 #include <cstring>
@@ -58,9 +59,11 @@ void X68000XDFImage::load(const std::filesystem::path& path) {
     m_filePath = path;
     m_modified = false;
     m_fileSystemDetected = false;
+    clearDirty();
 }
 
 void X68000XDFImage::save(const std::filesystem::path& path) {
+    ScopedTimer timer(Stats::Phase::Save);
     std::filesystem::path savePath = path.empty() ? m_filePath : path;
 
     if (savePath.empty()) {
@@ -97,6 +100,7 @@ void X68000XDFImage::create(const DiskGeometry& geometry) {
 
     // Create blank disk image filled with 0xE5
     m_data.resize(XDF_FILE_SIZE, 0xE5);
+    markDirty(0, m_data.size());
 
     m_modified = true;
     m_fileSystemDetected = false;
@@ -118,7 +122,21 @@ void X68000XDFImage::validateParameters(size_t track, size_t sector) const {
     }
 }
 
+std::optional<size_t> X68000XDFImage::sectorOffset(size_t track, size_t side, size_t sector) const {
+    // Same track/side folding as readSector()
+    const size_t linearTrack = (side <= 1 && track < XDF_CYLINDERS) ? ((track << 1) | side) : track;
+    if (linearTrack >= XDF_TOTAL_TRACKS || sector < 1 || sector > XDF_SECTORS_PER_TRACK) {
+        return std::nullopt;
+    }
+    const size_t offset = calculateOffset(linearTrack, sector);
+    if (offset + XDF_SECTOR_SIZE > m_data.size()) {
+        return std::nullopt;
+    }
+    return offset;
+}
+
 SectorBuffer X68000XDFImage::readSector(size_t track, size_t side, size_t sector) {
+    Stats::sectorRead(m_geometry.bytesPerSector);
     // Convert track/side to linear track if needed
     size_t linearTrack = track;
     if (side == 0 && track < XDF_CYLINDERS) {
@@ -142,6 +160,7 @@ SectorBuffer X68000XDFImage::readSector(size_t track, size_t side, size_t sector
 
 void X68000XDFImage::writeSector(size_t track, size_t side, size_t sector,
                                   const SectorBuffer& data) {
+    Stats::sectorWritten(data.size());
     if (m_writeProtected) {
         throw WriteProtectedException();
     }
@@ -163,6 +182,7 @@ void X68000XDFImage::writeSector(size_t track, size_t side, size_t sector,
 
     size_t copySize = std::min(data.size(), XDF_SECTOR_SIZE);
     std::copy(data.begin(), data.begin() + copySize, m_data.begin() + offset);
+    markDirty(offset, XDF_SECTOR_SIZE);
 
     // Fill remaining with 0xE5 if data is short
     if (copySize < XDF_SECTOR_SIZE) {
@@ -211,6 +231,7 @@ void X68000XDFImage::writeTrack(size_t track, size_t side, const TrackBuffer& da
     size_t copySize = std::min(data.size(), trackSize);
 
     std::copy(data.begin(), data.begin() + copySize, m_data.begin() + offset);
+    markDirty(offset, trackSize);
 
     if (copySize < trackSize) {
         std::fill(m_data.begin() + offset + copySize,
@@ -231,6 +252,7 @@ bool X68000XDFImage::canConvertTo(DiskFormat format) const {
         case DiskFormat::AppleNIB2:
         case DiskFormat::AppleWOZ1:
         case DiskFormat::AppleWOZ2:
+        case DiskFormat::AppleHDV:
         case DiskFormat::MSXDSK:
         case DiskFormat::MSXDMK:
         case DiskFormat::MSXXSA:
@@ -0,0 +1,90 @@
+#!/usr/bin/env bash
+# diff: block- and file-level image comparison.
+#
+# Verifies that:
+#   * an image compared with itself is identical (exit 0)
+#   * changed blocks and added/removed/modified files are reported
+#     (exit 1), with SHA-256 of the file contents
+#   * unchanged files are matched by extent on an HFS volume
+#   * a sparse DIM is compared on its decoded sectors: a same-size file
+#     rewritten with other content is reported, not matched by extent
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+FIXTURES="$SCRIPT_DIR/fixtures"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+command -v python3 >/dev/null 2>&1 || { echo "missing python3" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_diff_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+tool() { "$RDEDISKTOOL" --bootdisk-mode off "$@"; }
+fail() { echo "$1" >&2; exit 1; }
+
+tool create "$WORK/a.po" -f po --fs prodos -n DIFF >/dev/null
+tool add "$WORK/a.po" "$FIXTURES/README.TXT" README >/dev/null
+tool add "$WORK/a.po" "$FIXTURES/HELLO.BAS" HELLO >/dev/null
+tool add "$WORK/a.po" "$FIXTURES/BIG.bin" BIG >/dev/null
+cp "$WORK/a.po" "$WORK/b.po"
+tool delete "$WORK/b.po" HELLO >/dev/null
+tool add "$WORK/b.po" "$FIXTURES/PATCH.BIN" PATCH >/dev/null
+tool delete "$WORK/b.po" README >/dev/null
+tool add "$WORK/b.po" "$FIXTURES/CHAPTER1.TXT" README >/dev/null
+
+rc=0; tool diff "$WORK/a.po" "$WORK/a.po" >/dev/null || rc=$?
+[[ $rc -eq 0 ]] || fail "C1: identical images gave exit $rc"
+
+rc=0; tool --json diff "$WORK/a.po" "$WORK/b.po" > "$WORK/diff.json" || rc=$?
+[[ $rc -eq 1 ]] || fail "C2: differing images gave exit $rc"
+
+python3 - "$WORK/diff.json" "$FIXTURES" <<'PY'
+import hashlib, json, sys
+d = json.load(open(sys.argv[1]))
+sha = lambda name: hashlib.sha256(open(f"{sys.argv[2]}/{name}", "rb").read()).hexdigest()
+assert not d['identical'] and d['blocks']['ranges'], d['blocks']
+changes = {c['path']: c for c in d['files']['changes']}
+assert sorted(changes) == ['HELLO', 'PATCH', 'README'], changes
+assert changes['HELLO']['change'] == 'removed' and changes['HELLO']['sha256A'] == sha('HELLO.BAS')
+assert changes['PATCH']['change'] == 'added' and changes['PATCH']['sha256B'] == sha('PATCH.BIN')
+assert changes['README']['change'] == 'modified'
+assert changes['README']['sha256A'] == sha('README.TXT') and changes['README']['sha256B'] == sha('CHAPTER1.TXT')
+assert d['files']['unchanged'] == 1, d['files']
+PY
+
+cp "$FIXTURES/macintosh/608_SystemTools.img" "$WORK/h1.img"
+cp "$WORK/h1.img" "$WORK/h2.img"
+tool add "$WORK/h2.img" "$FIXTURES/README.TXT" NEWFILE >/dev/null
+rc=0; tool --json diff "$WORK/h1.img" "$WORK/h2.img" --files > "$WORK/hfs.json" || rc=$?
+[[ $rc -eq 1 ]] || fail "C3: HFS diff gave exit $rc"
+python3 - "$WORK/hfs.json" <<'PY'
+import json, sys
+f = json.load(open(sys.argv[1]))['files']
+assert [(c['change'], c['path']) for c in f['changes']] == [('added', 'NEWFILE')], f
+assert f['unchanged'] > 0 and f['unchangedByExtent'] == f['unchanged'], f
+PY
+
+tool create "$WORK/p.dim" -f dim --fs human68k -n DIFF >/dev/null
+tool mkdir "$WORK/p.dim" SUB >/dev/null
+tool add "$WORK/p.dim" "$FIXTURES/BIG.bin" SUB/BIG.BIN >/dev/null
+cp "$WORK/p.dim" "$WORK/q.dim"
+python3 -c 'import sys; d = open(sys.argv[1], "rb").read(); open(sys.argv[2], "wb").write(bytes(b ^ 0x5a for b in d))' \
+  "$FIXTURES/BIG.bin" "$WORK/big.xor"
+tool delete "$WORK/q.dim" SUB/BIG.BIN >/dev/null
+tool add "$WORK/q.dim" "$WORK/big.xor" SUB/BIG.BIN >/dev/null
+rc=0; tool --json diff "$WORK/p.dim" "$WORK/q.dim" > "$WORK/dim.json" || rc=$?
+[[ $rc -eq 1 ]] || fail "C4: DIM diff gave exit $rc"
+python3 - "$WORK/dim.json" <<'PY'
+import json, sys
+d = json.load(open(sys.argv[1]))
+assert d['blocks']['changedBlocks'] == 100, d['blocks']
+f = d['files']
+assert [(c['change'], c['path']) for c in f['changes']] == [('modified', 'SUB/BIG.BIN')], f
+assert f['unchangedByExtent'] == 0, f
+PY
+
+echo "[PASS] diff"
@@ -0,0 +1,95 @@
+#!/usr/bin/env bash
+# X68000 DIM sparse tracks and `compact`.
+#
+# Pass conditions:
+#   * a freshly formatted DIM only stores the tracks Human68k wrote
+#   * add/extract round-trips byte-identical on a sparse DIM
+#   * compact drops blank tracks, keeps zero-filled tracks owned by files,
+#     and the image still validates and extracts identically
+#   * without a Human68k volume, compact drops only filler tracks
+#   * compact rejects non-DIM images
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+
+FIXTURE="$TOOL_ROOT/tests/fixtures/BIG.bin"
+[[ -f "$FIXTURE" ]] || { echo "missing $FIXTURE" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_dim_sparse_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+TRACK_SIZE=8192
+HEADER_SIZE=256
+
+# Number of trkflag bytes set in a DIM header
+present_tracks() {
+  od -An -tu1 -j1 -N170 -v "$1" | tr -s ' ' '\n' | grep -c '^1$' || true
+}
+
+check_size() {
+  local file="$1" label="$2"
+  local n; n=$(present_tracks "$file")
+  local expected=$(( HEADER_SIZE + n * TRACK_SIZE ))
+  local actual; actual=$(stat -c %s "$file")
+  [[ "$actual" -eq "$expected" ]] || {
+    echo "$label: size $actual != header + $n tracks ($expected)" >&2; exit 1
+  }
+}
+
+# C1: fresh format stores only the tracks it touched
+"$RDEDISKTOOL" create "$WORK/a.dim" -f dim --fs human68k -n SPARSE >/dev/null
+check_size "$WORK/a.dim" "C1"
+[[ $(present_tracks "$WORK/a.dim") -le 2 ]] || {
+  echo "C1: fresh DIM stores $(present_tracks "$WORK/a.dim") tracks" >&2; exit 1
+}
+
+# C2: add/extract on a sparse DIM
+"$RDEDISKTOOL" add "$WORK/a.dim" "$FIXTURE" BIG.BIN >/dev/null
+"$RDEDISKTOOL" extract "$WORK/a.dim" BIG.BIN "$WORK/big.out" >/dev/null
+cmp -s "$FIXTURE" "$WORK/big.out" || { echo "C2: round-trip mismatch" >&2; exit 1; }
+check_size "$WORK/a.dim" "C2"
+
+# C3: compact keeps zero-filled file data, drops freed blank tracks
+head -c 24576 /dev/zero > "$WORK/zero.bin"
+"$RDEDISKTOOL" add "$WORK/a.dim" "$WORK/zero.bin" ZERO.BIN >/dev/null
+"$RDEDISKTOOL" add "$WORK/a.dim" "$FIXTURE" BIG2.BIN >/dev/null
+"$RDEDISKTOOL" delete "$WORK/a.dim" BIG.BIN >/dev/null
+before=$(present_tracks "$WORK/a.dim")
+"$RDEDISKTOOL" compact "$WORK/a.dim" >/dev/null
+after=$(present_tracks "$WORK/a.dim")
+[[ "$after" -lt "$before" ]] || { echo "C3: compact removed nothing ($before)" >&2; exit 1; }
+check_size "$WORK/a.dim" "C3"
+"$RDEDISKTOOL" extract "$WORK/a.dim" ZERO.BIN "$WORK/zero.out" >/dev/null
+cmp -s "$WORK/zero.bin" "$WORK/zero.out" || { echo "C3: zero file damaged" >&2; exit 1; }
+"$RDEDISKTOOL" extract "$WORK/a.dim" BIG2.BIN "$WORK/big2.out" >/dev/null
+cmp -s "$FIXTURE" "$WORK/big2.out" || { echo "C3: BIG2 damaged" >&2; exit 1; }
+"$RDEDISKTOOL" validate "$WORK/a.dim" >/dev/null || { echo "C3: validate failed" >&2; exit 1; }
+
+# C4: no filesystem map, so the zero-filled track must survive
+python3 - "$WORK/raw.dim" <<'PY'
+import sys
+header = bytearray(256)
+header[1] = header[2] = 1          # track 0 zero-filled, track 1 filler
+open(sys.argv[1], 'wb').write(bytes(header) + bytes(8192) + b'\xe5' * 8192)
+PY
+"$RDEDISKTOOL" --bootdisk-mode off compact "$WORK/raw.dim" >/dev/null
+[[ $(present_tracks "$WORK/raw.dim") -eq 1 ]] || {
+  echo "C4: expected only the zero-filled track to remain" >&2; exit 1
+}
+cmp -s <(head -c 8192 /dev/zero) <(tail -c +257 "$WORK/raw.dim") || {
+  echo "C4: zero-filled track lost" >&2; exit 1
+}
+
+# C5: compact is DIM-only
+"$RDEDISKTOOL" create "$WORK/b.xdf" -f xdf --fs human68k >/dev/null
+if "$RDEDISKTOOL" compact "$WORK/b.xdf" >/dev/null 2>&1; then
+  echo "C5: compact accepted an XDF image" >&2; exit 1
+fi
+
+echo "[PASS] DIM sparse tracks and compact"
@@ -0,0 +1,84 @@
+#!/usr/bin/env bash
+# DMK track layout (interleave / track skew / head skew / sectors per track).
+#
+# Pass conditions:
+#   * 10-sector DMK with interleave + skew formats, accepts add, extracts
+#     byte-identical, and validates
+#   * IDAM order on disk matches the requested interleave and skew
+#   * convert DSK -> DMK honours the layout options
+#   * layouts that cannot fit a track (11 sectors, interleave >= sectors)
+#     and layout options on non-DMK targets are rejected
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+
+FIXTURE="$TOOL_ROOT/tests/fixtures/BIG.bin"
+[[ -f "$FIXTURE" ]] || { echo "missing $FIXTURE" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_dmk_layout_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+# Sector IDs (in IDAM order) of a DMK track: idam_order <file> <track> <side>
+idam_order() {
+  local file="$1" track="$2" side="$3"
+  local tlen=$(( $(od -An -tu2 -j2 -N2 "$file") ))
+  local off=$(( 16 + (track * 2 + side) * tlen ))
+  local out=""
+  for i in $(seq 0 63); do
+    local p=$(( $(od -An -tu2 -j $((off + i * 2)) -N2 "$file") ))
+    [[ $p -eq 0 ]] && break
+    local id=$(( $(od -An -tu1 -j $((off + (p & 0x3FFF) + 3)) -N1 "$file") ))
+    out+="$id "
+  done
+  echo "${out% }"
+}
+
+# C1: 10 sectors, interleave 3, track skew 2, head skew 1
+"$RDEDISKTOOL" create "$WORK/ten.dmk" -f dmk --fs msxdos -g 80:2:10:512 \
+    --interleave 3 --track-skew 2 --head-skew 1 -n TEN >/dev/null
+"$RDEDISKTOOL" add "$WORK/ten.dmk" "$FIXTURE" BIG.BIN >/dev/null
+"$RDEDISKTOOL" extract "$WORK/ten.dmk" BIG.BIN "$WORK/out.bin" >/dev/null
+cmp -s "$FIXTURE" "$WORK/out.bin" || { echo "C1: round-trip mismatch" >&2; exit 1; }
+"$RDEDISKTOOL" validate "$WORK/ten.dmk" >/dev/null || { echo "C1: validate failed" >&2; exit 1; }
+"$RDEDISKTOOL" info "$WORK/ten.dmk" | grep -q "Sectors/Track: 10" || {
+  echo "C1: geometry not detected as 10 sectors/track" >&2; exit 1
+}
+
+# C2: on-disk order reflects interleave and skew
+[[ "$(idam_order "$WORK/ten.dmk" 0 0)" == "1 8 5 2 9 6 3 10 7 4" ]] || {
+  echo "C2: T0/H0 order: $(idam_order "$WORK/ten.dmk" 0 0)" >&2; exit 1
+}
+[[ "$(idam_order "$WORK/ten.dmk" 0 1)" == "4 1 8 5 2 9 6 3 10 7" ]] || {
+  echo "C2: T0/H1 order: $(idam_order "$WORK/ten.dmk" 0 1)" >&2; exit 1
+}
+[[ "$(idam_order "$WORK/ten.dmk" 1 0)" == "7 4 1 8 5 2 9 6 3 10" ]] || {
+  echo "C2: T1/H0 order: $(idam_order "$WORK/ten.dmk" 1 0)" >&2; exit 1
+}
+
+# C3: convert DSK -> DMK with layout
+"$RDEDISKTOOL" create "$WORK/src.dsk" -f msxdsk --fs msxdos >/dev/null
+"$RDEDISKTOOL" add "$WORK/src.dsk" "$FIXTURE" BIG.BIN >/dev/null
+"$RDEDISKTOOL" convert "$WORK/src.dsk" "$WORK/conv.dmk" --interleave 2 >/dev/null
+[[ "$(idam_order "$WORK/conv.dmk" 0 0)" == "1 6 2 7 3 8 4 9 5" ]] || {
+  echo "C3: convert order: $(idam_order "$WORK/conv.dmk" 0 0)" >&2; exit 1
+}
+"$RDEDISKTOOL" extract "$WORK/conv.dmk" BIG.BIN "$WORK/conv.bin" >/dev/null
+cmp -s "$FIXTURE" "$WORK/conv.bin" || { echo "C3: convert round-trip mismatch" >&2; exit 1; }
+
+# C4: rejected layouts
+expect_fail() {
+  if "$@" >/dev/null 2>&1; then
+    echo "C4: expected failure: $*" >&2; exit 1
+  fi
+}
+expect_fail "$RDEDISKTOOL" create "$WORK/bad1.dmk" -f dmk -g 80:2:11:512
+expect_fail "$RDEDISKTOOL" create "$WORK/bad2.dmk" -f dmk --interleave 9
+expect_fail "$RDEDISKTOOL" create "$WORK/bad3.dsk" -f msxdsk --interleave 2
+
+echo "[PASS] DMK track layout"
@@ -0,0 +1,100 @@
+#!/usr/bin/env bash
+# extract: output is staged and fork headers match what the image holds.
+#
+# Verifies that:
+#   * an HFS extract that fails while streaming a fork leaves an existing
+#     output file untouched and no temporary file behind, for plain
+#     extract and --apple-double
+#   * on an image truncated inside a resource fork, the AppleDouble and
+#     MacBinary headers declare the bytes actually written, not the
+#     catalog's logical length
+#   * on an intact image both exports carry the full fork
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+command -v python3 >/dev/null 2>&1 || { echo "missing python3" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_extract_staged_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+tool() { "$RDEDISKTOOL" --bootdisk-mode off "$@"; }
+
+# A file with a 2000-byte resource fork, imported from AppleDouble.
+python3 - "$WORK" <<'PY'
+import struct, sys
+work = sys.argv[1]
+rsrc = bytes(i % 251 for i in range(2000))
+entries, body = [], b''
+for eid, data in ((3, b'Big'), (9, b'TEXTttxt' + bytes(24)), (2, rsrc)):
+    entries.append(struct.pack('>III', eid, 26 + 12 * 3 + len(body), len(data)))
+    body += data
+open(f'{work}/._Big', 'wb').write(
+    struct.pack('>II16sH', 0x00051607, 0x00020000, bytes(16), 3) + b''.join(entries) + body)
+open(f'{work}/Big', 'wb').write(b'data fork\n')
+open(f'{work}/rsrc.bin', 'wb').write(rsrc)
+PY
+head -c 100000 /dev/urandom > "$WORK/large.bin"
+
+tool create "$WORK/h.img" -f mac_img --fs hfs -n Staged >/dev/null
+tool add "$WORK/h.img" "$WORK/Big" --apple-double Big >/dev/null
+tool add "$WORK/h.img" "$WORK/large.bin" Large >/dev/null
+
+# 1. A write failure part way through the fork keeps the old output. The
+#    file size limit makes the stream fail once 16 KiB have been written.
+for mode in plain apple-double; do
+  args=("$WORK/h.img" Large "$WORK/out.bin")
+  [[ "$mode" == plain ]] || args=("$WORK/h.img" Large --apple-double "$WORK/out.bin")
+  echo old > "$WORK/out.bin"; cp "$WORK/out.bin" "$WORK/old.bin"
+  if ( trap '' XFSZ; ulimit -f 16; tool extract "${args[@]}" ) >/dev/null 2>&1; then
+    echo "C1: $mode: extract past the file size limit succeeded" >&2; exit 1
+  fi
+  cmp -s "$WORK/out.bin" "$WORK/old.bin" || { echo "C1: $mode: output was overwritten" >&2; exit 1; }
+  leftovers=$(find "$WORK" -name '*.tmp.rdedisktool')
+  [[ -z "$leftovers" ]] || { echo "C1: $mode: temporary file left: $leftovers" >&2; exit 1; }
+  [[ ! -e "$WORK/._out.bin" ]] || { echo "C1: $mode: sidecar written" >&2; exit 1; }
+done
+
+# 2. Truncate the image 1024 bytes into the resource fork.
+rsrc_at=$(python3 -c "import sys; print(open(sys.argv[1],'rb').read().find(open(sys.argv[2],'rb').read()))" \
+          "$WORK/h.img" "$WORK/rsrc.bin")
+[[ "$rsrc_at" -gt 0 && $((rsrc_at % 512)) -eq 0 ]] || { echo "C2: resource fork not found" >&2; exit 1; }
+head -c $((rsrc_at + 1024)) "$WORK/h.img" > "$WORK/t.img"
+
+check_exports() {
+  local img="$1" want="$2"
+  rm -f "$WORK/ad" "$WORK/._ad" "$WORK/mb.bin"
+  tool extract "$img" Big --apple-double "$WORK/ad" >/dev/null
+  tool extract "$img" Big --macbinary "$WORK/mb.bin" >/dev/null
+  python3 - "$WORK" "$want" <<'PY'
+import struct, sys
+work, want = sys.argv[1], int(sys.argv[2])
+rsrc = open(f'{work}/rsrc.bin', 'rb').read()[:want]
+
+ad = open(f'{work}/._ad', 'rb').read()
+count = struct.unpack('>H', ad[24:26])[0]
+entries = {e[0]: e[1:] for e in (struct.unpack('>III', ad[26 + 12 * i:38 + 12 * i]) for i in range(count))}
+off, length = entries[2]
+assert length == want, f'AppleDouble declares {length} resource bytes, want {want}'
+assert off + length == len(ad), f'sidecar is {len(ad)} bytes, header ends the fork at {off + length}'
+assert ad[off:] == rsrc, 'AppleDouble resource fork differs'
+
+mb = open(f'{work}/mb.bin', 'rb').read()
+data_len, rsrc_len = struct.unpack('>II', mb[83:91])
+assert data_len == 10 and rsrc_len == want, (data_len, rsrc_len)
+rsrc_off = 128 + ((data_len + 127) // 128) * 128
+assert mb[rsrc_off:rsrc_off + rsrc_len] == rsrc, 'MacBinary resource fork differs'
+PY
+}
+
+check_exports "$WORK/t.img" 1024 || { echo "C2: truncated image exports" >&2; exit 1; }
+
+# 3. The intact image exports the whole fork.
+check_exports "$WORK/h.img" 2000 || { echo "C3: intact image exports" >&2; exit 1; }
+
+echo "[PASS] extract staged output"
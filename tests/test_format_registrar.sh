@@ -34,6 +34,7 @@ required=(
   "AppleNIB"
   "AppleWOZ1"
   "AppleWOZ2"
+  "AppleHDV"
   "MSXDSK"
   "MSXDMK"
   "MSXXSA"
@@ -0,0 +1,98 @@
+#!/usr/bin/env bash
+# --in-place saves and the .rdejournal redo journal.
+#
+# Verifies that:
+#   * an --in-place add produces the same file as a normal save and
+#     leaves no journal behind
+#   * a complete journal is replayed on the next load, even a read-only
+#     list, and removed
+#   * a torn journal is removed without touching the image
+#   * a journal whose size or checksum does not match the image (the file
+#     was replaced since) is removed without touching the image
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+FIXTURES="$SCRIPT_DIR/fixtures"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+command -v python3 >/dev/null 2>&1 || { echo "missing python3" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_in_place_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+tool() { "$RDEDISKTOOL" --bootdisk-mode off "$@"; }
+fail() { echo "$1" >&2; exit 1; }
+
+# Write the journal that turns file $1 into file $2 (data offset 0) to $3,
+# optionally cut short by $4 bytes.
+make_journal() {
+  python3 - "$@" <<'PY'
+import struct, sys, zlib
+pre, post = open(sys.argv[1], 'rb').read(), open(sys.argv[2], 'rb').read()
+assert len(pre) == len(post)
+ranges, i = [], 0
+while i < len(post):
+    if pre[i] != post[i]:
+        j = i
+        while j < len(post) and pre[j] != post[j]:
+            j += 1
+        ranges.append((i, post[i:j]))
+        i = j
+    else:
+        i += 1
+body = b'RDEJRNL2' + struct.pack('<QQQII', len(post), 0, len(post), zlib.crc32(post), len(ranges))
+for off, data in ranges:
+    body += struct.pack('<QI', off, len(data)) + data
+body += struct.pack('<I', zlib.crc32(body))
+cut = int(sys.argv[4]) if len(sys.argv) > 4 else 0
+open(sys.argv[3], 'wb').write(body[:len(body) - cut])
+PY
+}
+
+tool create "$WORK/pre.dsk" -f msxdsk --fs msxdos -n INPLACE >/dev/null
+cp "$WORK/pre.dsk" "$WORK/plain.dsk"
+cp "$WORK/pre.dsk" "$WORK/inplace.dsk"
+tool add "$WORK/plain.dsk" "$FIXTURES/README.TXT" README.TXT >/dev/null
+out=$(tool -v --in-place add "$WORK/inplace.dsk" "$FIXTURES/README.TXT" README.TXT)
+
+# C1: in-place save writes what a full save writes
+[[ "$out" == *"In-place save:"* ]] || fail "C1: --in-place did not take the in-place path"
+cmp -s "$WORK/plain.dsk" "$WORK/inplace.dsk" || fail "C1: in-place result differs from a full save"
+[[ ! -e "$WORK/inplace.dsk.rdejournal" ]] || fail "C1: journal left behind"
+
+# C2: a complete journal is replayed by a read-only command
+cp "$WORK/pre.dsk" "$WORK/r.dsk"
+make_journal "$WORK/pre.dsk" "$WORK/plain.dsk" "$WORK/r.dsk.rdejournal"
+err=$(tool list "$WORK/r.dsk" 2>&1 >/dev/null)
+[[ "$err" == *"Replayed interrupted in-place save"* ]] || fail "C2: no replay warning: $err"
+cmp -s "$WORK/plain.dsk" "$WORK/r.dsk" || fail "C2: replay did not produce the saved image"
+[[ ! -e "$WORK/r.dsk.rdejournal" ]] || fail "C2: journal not removed"
+
+# C3: a torn journal is dropped
+cp "$WORK/pre.dsk" "$WORK/t.dsk"
+make_journal "$WORK/pre.dsk" "$WORK/plain.dsk" "$WORK/t.dsk.rdejournal" 7
+tool list "$WORK/t.dsk" >/dev/null 2>&1
+cmp -s "$WORK/pre.dsk" "$WORK/t.dsk" || fail "C3: torn journal touched the image"
+[[ ! -e "$WORK/t.dsk.rdejournal" ]] || fail "C3: torn journal not removed"
+
+# C4: the image was replaced after the crash: same size, other contents
+tool create "$WORK/other.dsk" -f msxdsk --fs msxdos -n OTHER >/dev/null
+tool add "$WORK/other.dsk" "$FIXTURES/HELLO.BAS" HELLO.BAS >/dev/null
+cp "$WORK/other.dsk" "$WORK/m.dsk"
+make_journal "$WORK/pre.dsk" "$WORK/plain.dsk" "$WORK/m.dsk.rdejournal"
+err=$(tool list "$WORK/m.dsk" 2>&1 >/dev/null)
+[[ "$err" == *"does not match the image"* ]] || fail "C4: no mismatch warning: $err"
+cmp -s "$WORK/other.dsk" "$WORK/m.dsk" || fail "C4: mismatched journal was replayed"
+[[ ! -e "$WORK/m.dsk.rdejournal" ]] || fail "C4: mismatched journal not removed"
+
+# C5: ... or resized
+head -c 1024 "$WORK/pre.dsk" > "$WORK/s.dsk"
+make_journal "$WORK/pre.dsk" "$WORK/plain.dsk" "$WORK/s.dsk.rdejournal"
+tool list "$WORK/s.dsk" >/dev/null 2>&1 || true
+cmp -s <(head -c 1024 "$WORK/pre.dsk") "$WORK/s.dsk" || fail "C5: journal replayed onto a resized image"
+
+echo "[PASS] in-place save and redo journal"
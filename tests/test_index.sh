@@ -0,0 +1,68 @@
+#!/usr/bin/env bash
+# index: content-hash index of an image collection.
+#
+# Verifies that:
+#   * file hashes in the index are the SHA-256 of the file contents
+#   * --hash, --name and --size find the expected files across images
+#   * --duplicates groups byte-identical images
+#   * --jobs 1 and --jobs 4 write the same index
+#   * a damaged index is rejected
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+FIXTURES="$SCRIPT_DIR/fixtures"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+command -v python3 >/dev/null 2>&1 || { echo "missing python3" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_index_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK/tree/sub"
+trap 'rm -rf "$WORK"' EXIT
+
+tool() { "$RDEDISKTOOL" --bootdisk-mode off "$@"; }
+fail() { echo "$1" >&2; exit 1; }
+
+tool create "$WORK/tree/a.po" -f po --fs prodos -n IDX >/dev/null
+tool add "$WORK/tree/a.po" "$FIXTURES/README.TXT" README >/dev/null
+tool add "$WORK/tree/a.po" "$FIXTURES/HELLO.BAS" HELLO >/dev/null
+tool create "$WORK/tree/sub/m.dsk" -f msxdsk --fs msxdos -n IDX >/dev/null
+tool add "$WORK/tree/sub/m.dsk" "$FIXTURES/README.TXT" README.TXT >/dev/null
+tool add "$WORK/tree/sub/m.dsk" "$FIXTURES/PATCH.BIN" PATCH.BIN >/dev/null
+cp "$WORK/tree/a.po" "$WORK/tree/sub/copy.po"
+cp "$FIXTURES/README.TXT" "$WORK/tree/notes.txt"
+
+tool index build "$WORK/tree" "$WORK/j1.idx" --jobs 1 2>/dev/null
+tool index build "$WORK/tree" "$WORK/j4.idx" --jobs 4 2>/dev/null
+cmp -s "$WORK/j1.idx" "$WORK/j4.idx" || fail "C1: --jobs 4 index differs from --jobs 1"
+
+README_HASH="$(python3 -c 'import hashlib,sys; print(hashlib.sha256(open(sys.argv[1],"rb").read()).hexdigest())' "$FIXTURES/README.TXT")"
+tool --ndjson index query "$WORK/j1.idx" --hash "$README_HASH" > "$WORK/hash.ndjson"
+tool --ndjson index query "$WORK/j1.idx" --name 'readme*' > "$WORK/name.ndjson"
+PATCH_SIZE="$(wc -c < "$FIXTURES/PATCH.BIN" | tr -d ' ')"
+tool --ndjson index query "$WORK/j1.idx" --size "$PATCH_SIZE" > "$WORK/size.ndjson"
+tool --json index query "$WORK/j1.idx" --duplicates > "$WORK/dups.json"
+
+python3 - "$WORK" <<'PY'
+import json, sys
+work = sys.argv[1]
+def load(name):
+    return [json.loads(l) for l in open(f"{work}/{name}")]
+def where(recs):
+    return sorted((r['image'][len(work) + 6:], r['path']) for r in recs)
+expected = [('a.po', 'README'), ('sub/copy.po', 'README'), ('sub/m.dsk', 'README.TXT')]
+assert where(load('hash.ndjson')) == expected, where(load('hash.ndjson'))
+assert where(load('name.ndjson')) == expected, where(load('name.ndjson'))
+assert ('sub/m.dsk', 'PATCH.BIN') in where(load('size.ndjson')), where(load('size.ndjson'))
+dups = json.load(open(f"{work}/dups.json"))['duplicates']
+assert len(dups) == 1 and sorted(i[len(work) + 6:] for i in dups[0]['images']) == ['a.po', 'sub/copy.po'], dups
+PY
+
+printf 'x' | dd of="$WORK/j1.idx" bs=1 seek=100 conv=notrunc 2>/dev/null
+if tool index query "$WORK/j1.idx" --duplicates >/dev/null 2>&1; then
+  fail "C5: damaged index was accepted"
+fi
+
+echo "[PASS] index"
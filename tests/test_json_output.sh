@@ -0,0 +1,145 @@
+#!/usr/bin/env bash
+# --json / --ndjson: machine-readable list, info and validate.
+#
+# Verifies that:
+#   * --json prints exactly one JSON object per command with the documented
+#     field names, and nothing else on stdout
+#   * --ndjson prints one compact record per line; list emits one line per
+#     entry, tagged with image and path
+#   * quotes, backslashes and control characters in image paths, volume
+#     names and file names are escaped, so every record stays on one line
+#   * the output is valid UTF-8 even for names that are not: a Shift-JIS
+#     Human68k name has its high bytes escaped as \u00XX, while Mac-Roman
+#     HFS names arrive as real UTF-8
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+FIXTURES="$SCRIPT_DIR/fixtures"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+command -v python3 >/dev/null 2>&1 || { echo "missing python3" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_json_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+tool() { "$RDEDISKTOOL" --bootdisk-mode off "$@"; }
+
+# The HFS image lives in a directory whose name needs escaping.
+ODD_DIR="$WORK/$(printf 'we"ird\\dir\tand\nnewline')"
+mkdir -p "$ODD_DIR"
+MSX="$WORK/m.dsk"
+HFS="$ODD_DIR/h.img"
+
+tool create "$MSX" -f msxdsk --fs msxdos -n JSON >/dev/null
+tool add "$MSX" "$FIXTURES/README.TXT" README.TXT >/dev/null
+tool add "$MSX" "$FIXTURES/HELLO.BAS" HELLO.BAS >/dev/null
+tool create "$HFS" -f mac_img --fs hfs -n 'Vol "Q"' >/dev/null
+tool add "$HFS" "$FIXTURES/README.TXT" 'Say "hi" \ now' >/dev/null
+tool add "$HFS" "$FIXTURES/README.TXT" "$(printf 'Tab\there')" >/dev/null
+tool mkdir "$HFS" Sub >/dev/null
+tool add "$HFS" "$FIXTURES/HELLO.BAS" Sub/Two >/dev/null
+tool add "$HFS" "$FIXTURES/HELLO.BAS" CafQ >/dev/null
+
+# High-bit names are made by patching ASCII placeholders on disk.
+# XDF: TEXQ.TXT -> 0x83 'e' 0x83 'X' (Shift-JIS katakana "tesu");
+# HFS: CafQ -> Caf 0x8e (Mac-Roman e-acute).
+XDF="$WORK/x.xdf"
+tool create "$XDF" -f xdf --fs human68k -n SJIS >/dev/null
+tool add "$XDF" "$FIXTURES/README.TXT" TEXQ.TXT >/dev/null
+python3 - "$XDF" "$HFS" <<'PY'
+import sys
+for path, old, new in ((sys.argv[1], b'TEXQ    TXT', b'\x83e\x83X    TXT'),
+                       (sys.argv[2], b'\x04CafQ', b'\x04Caf\x8e')):
+    data = open(path, 'rb').read()
+    assert data.count(old) >= 1, old
+    open(path, 'wb').write(data.replace(old, new))
+PY
+tool --json list "$XDF" > "$WORK/x.xdf.list.json"
+tool --ndjson list "$XDF" > "$WORK/x.xdf.list.ndjson"
+
+for img in "$MSX" "$HFS"; do
+  tag=$(basename "$img")
+  for cmd in list info validate; do
+    tool --json "$cmd" "$img" > "$WORK/$tag.$cmd.json"
+    tool --ndjson "$cmd" "$img" > "$WORK/$tag.$cmd.ndjson"
+  done
+done
+tool --ndjson list "$HFS" Sub > "$WORK/h.img.sub.ndjson"
+
+python3 - "$WORK" "$MSX" "$HFS" <<'PY'
+import json, sys
+work, msx, hfs = sys.argv[1:]
+
+FILE = {'name', 'size', 'isDirectory', 'isDeleted', 'fileType', 'attributes',
+        'loadAddress', 'execAddress', 'createdTime', 'modifiedTime'}
+LIST = {'image', 'format', 'fileSystem', 'volume', 'path', 'files',
+        'fileCount', 'totalSize', 'freeSpace'}
+INFO = {'image', 'format', 'formatName', 'platform', 'supported', 'geometry',
+        'fileSystem', 'volume', 'freeSpace', 'totalSpace', 'writeProtected'}
+GEOMETRY = {'tracks', 'sides', 'sectorsPerTrack', 'bytesPerSector',
+            'totalSectors', 'totalSize'}
+VALIDATE = {'image', 'format', 'formatName', 'supported', 'imageValid',
+            'fileSystem', 'isValid', 'errorCount', 'warningCount', 'issues'}
+ISSUE = {'severity', 'message', 'location'}
+
+# Decode strictly: any byte sequence that is not UTF-8 fails here.
+def text_of(name):
+    return open(f'{work}/{name}', 'rb').read().decode('utf-8')
+
+def whole(name):
+    return json.loads(text_of(name))
+
+def lines(name):
+    text = text_of(name)
+    assert text.endswith('\n'), f'{name}: no trailing newline'
+    out = text[:-1].split('\n')
+    assert all(out), f'{name}: empty line'
+    return [json.loads(l) for l in out]
+
+for tag, img, names in (('m.dsk', msx, {'README.TXT', 'HELLO.BAS'}),
+                        ('h.img', hfs, {'Say "hi" \\ now', 'Tab\there', 'Sub', 'Caf\u00e9'})):
+    # list
+    doc = whole(f'{tag}.list.json')
+    assert set(doc) == LIST, (tag, set(doc) ^ LIST)
+    assert doc['image'] == img and doc['path'] == ''
+    assert {f['name'] for f in doc['files']} == names, doc['files']
+    assert doc['fileCount'] == len(names)
+    for f in doc['files']:
+        assert set(f) == FILE, (tag, set(f) ^ FILE)
+    recs = lines(f'{tag}.list.ndjson')
+    assert len(recs) == len(names), f'{tag}: {len(recs)} list lines'
+    for r in recs:
+        assert set(r) == FILE | {'image', 'path'}, (tag, set(r))
+        assert r['image'] == img and r['path'] == ''
+    assert [r['name'] for r in recs] == [f['name'] for f in doc['files']]
+
+    # info
+    doc = whole(f'{tag}.info.json')
+    assert set(doc) == INFO, (tag, set(doc) ^ INFO)
+    assert set(doc['geometry']) == GEOMETRY, doc['geometry']
+    assert lines(f'{tag}.info.ndjson') == [doc]
+
+    # validate
+    doc = whole(f'{tag}.validate.json')
+    assert set(doc) == VALIDATE, (tag, set(doc) ^ VALIDATE)
+    assert doc['isValid'] is True and doc['errorCount'] == 0
+    for issue in doc['issues']:
+        assert set(issue) == ISSUE, issue
+    assert lines(f'{tag}.validate.ndjson') == [doc]
+
+assert whole('h.img.info.json')['volume'] == 'Vol "Q"'
+sub = lines('h.img.sub.ndjson')
+assert [(r['path'], r['name']) for r in sub] == [('Sub', 'Two')], sub
+
+sjis = '\x83e\x83X.TXT'   # each byte escaped as its Latin-1 code point
+assert [f['name'] for f in whole('x.xdf.list.json')['files']] == [sjis]
+assert [r['name'] for r in lines('x.xdf.list.ndjson')] == [sjis]
+assert '\\u0083e\\u0083X.TXT' in text_of('x.xdf.list.json')
+assert 'Caf\u00e9' in text_of('h.img.list.json')   # literal UTF-8
+PY
+
+echo "[PASS] json output"
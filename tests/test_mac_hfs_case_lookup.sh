@@ -0,0 +1,115 @@
+#!/usr/bin/env bash
+# HFS name lookup: case-insensitive, diacritic-sensitive.
+#
+# Verifies that:
+#   * extract and delete reach "Read Me" as "read me", also as a nested
+#     path component ("DOCS/READ ME")
+#   * Mac-Roman letters fold too: "Ärger" is found as "ärger" and
+#     "ÄRGER", "Café" as "CAFÉ"
+#   * different diacritics stay distinct: "Arger", "Àrger", "Cafe" and
+#     "CafÈ" are not found
+#   * rename (file and folder) and rmdir accept folded names, and a
+#     rename that only changes case is allowed
+#
+# `add` stores names as given, so the non-ASCII names are made by
+# patching ASCII placeholders in the catalog keys to Mac-Roman bytes.
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+FIXTURES="$SCRIPT_DIR/fixtures"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+command -v python3 >/dev/null 2>&1 || { echo "missing python3" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_hfs_case_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+tool() { "$RDEDISKTOOL" --bootdisk-mode off "$@"; }
+IMG="$WORK/h.img"
+
+tool create "$IMG" -f mac_img --fs hfs -n Case >/dev/null
+tool add "$IMG" "$FIXTURES/README.TXT" "Read Me" >/dev/null
+tool mkdir "$IMG" Docs >/dev/null
+tool add "$IMG" "$FIXTURES/CHAPTER1.TXT" "Docs/Read Me" >/dev/null
+tool add "$IMG" "$FIXTURES/HELLO.BAS" Qrger >/dev/null
+tool add "$IMG" "$FIXTURES/PATCH.BIN" CafQ >/dev/null
+
+# Catalog keys are Pascal strings: Qrger -> \x80rger (Ä), CafQ -> Caf\x8e (é).
+python3 - "$IMG" <<'PY'
+import sys
+path = sys.argv[1]
+data = open(path, 'rb').read()
+for old, new in ((b'\x05Qrger', b'\x05\x80rger'), (b'\x04CafQ', b'\x04Caf\x8e')):
+    assert data.count(old) >= 1, old   # leaf key, and an index key if any
+    data = data.replace(old, new)
+open(path, 'wb').write(data)
+PY
+listing=$(tool list "$IMG")
+[[ "$listing" == *"Ärger"* && "$listing" == *"Café"* ]] || {
+  echo "patched names not listed:" >&2; echo "$listing" >&2; exit 1
+}
+
+# 1. Folded names reach the stored ones.
+expect_found() {
+  rm -f "$WORK/out.bin"
+  tool extract "$IMG" "$1" "$WORK/out.bin" >/dev/null 2>&1 || { echo "'$1' not found" >&2; exit 1; }
+  cmp -s "$WORK/out.bin" "$FIXTURES/$2" || { echo "'$1' reached the wrong file" >&2; exit 1; }
+}
+expect_found "read me" README.TXT
+expect_found "READ ME" README.TXT
+expect_found "DOCS/READ ME" CHAPTER1.TXT
+expect_found "docs/read me" CHAPTER1.TXT
+expect_found "Ärger" HELLO.BAS
+expect_found "ärger" HELLO.BAS
+expect_found "ÄRGER" HELLO.BAS
+expect_found "café" PATCH.BIN
+expect_found "CAFÉ" PATCH.BIN
+
+# 2. Different diacritics are different names.
+for name in Arger "Àrger" "àrger" Cafe "CafÈ" "Cafè"; do
+  if tool extract "$IMG" "$name" "$WORK/out.bin" >/dev/null 2>&1; then
+    echo "'$name' matched a name with a different diacritic" >&2; exit 1
+  fi
+done
+
+# 3. delete resolves the same way.
+tool delete "$IMG" "read me" >/dev/null
+tool delete "$IMG" "docs/READ ME" >/dev/null
+tool delete "$IMG" "ärger" >/dev/null
+listing=$(tool list "$IMG")
+if [[ "$listing" == *"Read Me"* || "$listing" == *"rger"* ]]; then
+  echo "delete left a file behind:" >&2; echo "$listing" >&2; exit 1
+fi
+[[ "$listing" == *"Café"* ]] || { echo "delete removed Café" >&2; exit 1; }
+if tool list "$IMG" Docs | grep -q "Read Me"; then
+  echo "delete left Docs/Read Me behind" >&2; exit 1
+fi
+tool validate "$IMG" >/dev/null || { echo "validate failed after deletes" >&2; exit 1; }
+
+# 4. rename and rmdir resolve the same way.
+tool add "$IMG" "$FIXTURES/README.TXT" "Read Me" >/dev/null
+tool rename "$IMG" "read me" Notes >/dev/null || { echo "rename of 'read me' failed" >&2; exit 1; }
+tool rename "$IMG" docs Stuff >/dev/null || { echo "rename of folder 'docs' failed" >&2; exit 1; }
+tool rename "$IMG" notes NOTES >/dev/null || { echo "case-only rename failed" >&2; exit 1; }
+listing=$(tool list "$IMG")
+if [[ "$listing" == *"Read Me"* || "$listing" == *"Docs"* || "$listing" == *"Notes"* ]]; then
+  echo "rename left an old name behind:" >&2; echo "$listing" >&2; exit 1
+fi
+[[ "$listing" == *"NOTES"* && "$listing" == *"Stuff"* ]] || {
+  echo "renamed entries not listed:" >&2; echo "$listing" >&2; exit 1
+}
+expect_found notes README.TXT
+if tool rename "$IMG" NOTES "café" >/dev/null 2>&1; then
+  echo "rename onto an existing name (folded) succeeded" >&2; exit 1
+fi
+tool rmdir "$IMG" STUFF >/dev/null || { echo "rmdir of 'STUFF' failed" >&2; exit 1; }
+if tool list "$IMG" | grep -q Stuff; then
+  echo "rmdir left Stuff behind" >&2; exit 1
+fi
+tool validate "$IMG" >/dev/null || { echo "validate failed after renames" >&2; exit 1; }
+
+echo "[PASS] HFS case-insensitive lookup"
@@ -0,0 +1,162 @@
+#!/usr/bin/env bash
+# HFS multi-extent allocation + Extents Overflow B-tree writes.
+#
+# Verifies that:
+#   * a file larger than any free run is spread over several extents,
+#     the first three in the catalog record and the rest as Extents
+#     Overflow records, and extracts byte-identical
+#   * enough overflow records split extents leaves and grow the tree to
+#     depth 2 with a consistent leaf chain, index keys and header counts
+#   * delete frees every extent (bitmap + drFreeBks) and removes the
+#     overflow records, emptying the tree again
+#   * exhausting the extents tree node map fails cleanly and leaves the
+#     image untouched
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+command -v python3 >/dev/null 2>&1 || { echo "missing python3" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_extents_overflow_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+tool() { "$RDEDISKTOOL" --bootdisk-mode off "$@"; }
+
+# Extents tree summary: "depth nodes records bitmapFree drFreeBks".
+# Exits non-zero if the tree or the bitmap is inconsistent.
+xcheck() {
+  python3 - "$1" <<'EOF'
+import struct, sys
+d = open(sys.argv[1], 'rb').read()
+m = 0x400
+be16 = lambda o: struct.unpack('>H', d[o:o+2])[0]
+be32 = lambda o: struct.unpack('>I', d[o:o+4])[0]
+alSt, blk = be16(m+0x1c), be32(m+0x14)
+ext = [be16(m+0x86+i*2) for i in range(6)]
+t = b''.join(d[alSt*512+ext[i*2]*blk:alSt*512+(ext[i*2]+ext[i*2+1])*blk] for i in range(3))
+ns = struct.unpack('>H', t[0x20:0x22])[0]
+depth, root, leafRecs, first, last = struct.unpack('>HIIII', t[14:32])
+total, free = struct.unpack('>II', t[14+0x16:14+0x1e])
+def node(n):
+    p = t[n*ns:(n+1)*ns]
+    fl, bl, kind, ht, nr = struct.unpack('>IIbBH', p[:12])
+    o = [struct.unpack('>H', p[ns-2*(i+1):ns-2*i])[0] for i in range(nr+1)]
+    return fl, bl, kind, ht, [p[o[i]:o[i+1]] for i in range(nr)]
+key = lambda r: (struct.unpack('>I', r[2:6])[0], r[1], struct.unpack('>H', r[6:8])[0])
+seen = set()
+def walk(n, lvl, lo, hi):
+    seen.add(n)
+    fl, bl, kind, ht, recs = node(n)
+    ks = [key(r) for r in recs]
+    assert recs and ht == lvl and ks == sorted(set(ks)), n
+    assert lo is None or ks[0] == lo, n
+    assert hi is None or ks[-1] < hi, n
+    if kind == -1:
+        return ks
+    out = []
+    for i, r in enumerate(recs):
+        out += walk(struct.unpack('>I', r[8:12])[0], lvl-1, ks[i],
+                    ks[i+1] if i+1 < len(ks) else hi)
+    return out
+keys = walk(root, depth, None, None) if depth else []
+chain, n, prev = [], first, 0
+while n:
+    fl, bl, kind, ht, recs = node(n)
+    assert bl == prev, n
+    chain += [key(r) for r in recs]
+    prev, n = n, fl
+assert prev == last and chain == keys and leafRecs == len(keys)
+mapBits = sum(bin(b).count('1') for b in t[248:ns-8])
+assert mapBits == len(seen) + 1 and free == total - mapBits
+nab, vbm = be16(m+0x12), be16(m+0x0e)
+used = sum(1 for b in range(nab) if d[vbm*512+b//8] & (0x80 >> (b % 8)))
+print(depth, len(seen), len(keys), nab - used, be16(m+0x22))
+EOF
+}
+
+# Pin every `stride`-th allocation block from 46 on as used (a stand-in
+# for files we cannot create: the fresh catalog only has room for ~40).
+pin_blocks() {
+  python3 - "$1" "$2" <<'EOF'
+import struct, sys
+path, stride = sys.argv[1], int(sys.argv[2])
+d = bytearray(open(path, 'rb').read())
+m, vbm = 0x400, 3 * 512
+nab = struct.unpack('>H', d[m+0x12:m+0x14])[0]
+n = 0
+for b in range(46, nab, stride):
+    d[vbm + b // 8] |= 0x80 >> (b % 8)
+    n += 1
+free = struct.unpack('>H', d[m+0x22:m+0x24])[0] - n
+d[m+0x22:m+0x24] = struct.pack('>H', free)
+open(path, 'wb').write(d)
+EOF
+}
+
+# 1. Real fragmentation: 30 one-block files, delete every other one, then
+#    add a file that needs the big tail run plus all 15 holes.
+tool create "$WORK/a.img" -f mac_img --fs hfs -n Frag >/dev/null
+head -c 512 /dev/urandom > "$WORK/one.bin"
+for i in $(seq 1 30); do tool add "$WORK/a.img" "$WORK/one.bin" "f$i" >/dev/null; done
+for i in $(seq 1 2 30); do tool delete "$WORK/a.img" "f$i" >/dev/null; done
+free_blocks=$(xcheck "$WORK/a.img" | awk '{print $5}')
+head -c $(( free_blocks * 512 - 100 )) /dev/urandom > "$WORK/big.bin"
+tool add "$WORK/a.img" "$WORK/big.bin" BIG >/dev/null || {
+  echo "C1: add across fragmented free space failed" >&2; exit 1
+}
+tool extract "$WORK/a.img" BIG "$WORK/big.out" >/dev/null
+cmp -s "$WORK/big.bin" "$WORK/big.out" || { echo "C1: round-trip mismatch" >&2; exit 1; }
+read -r depth nodes recs bfree drfree < <(xcheck "$WORK/a.img")
+[[ "$depth" == "1" && "$recs" == "5" && "$bfree" == "0" && "$drfree" == "0" ]] || {
+  echo "C1: expected 5 overflow records on a full volume; got $depth $nodes $recs $bfree $drfree" >&2
+  exit 1
+}
+tool validate "$WORK/a.img" >/dev/null || { echo "C1: validate failed" >&2; exit 1; }
+
+# 2. Leaf splits: one-block holes everywhere, two 300-block files.
+tool create "$WORK/b.img" -f mac_img --fs hfs -n Split >/dev/null
+pin_blocks "$WORK/b.img" 2
+for i in 1 2; do
+  head -c $(( 300 * 512 - 7 )) /dev/urandom > "$WORK/b$i.bin"
+  tool add "$WORK/b.img" "$WORK/b$i.bin" "B$i" >/dev/null || {
+    echo "C2: add B$i failed" >&2; exit 1
+  }
+done
+read -r depth nodes recs bfree drfree < <(xcheck "$WORK/b.img")
+[[ "$depth" == "2" && "$nodes" -gt 3 && "$bfree" == "$drfree" ]] || {
+  echo "C2: expected a split depth-2 extents tree; got $depth $nodes $recs" >&2; exit 1
+}
+for i in 1 2; do
+  tool extract "$WORK/b.img" "B$i" "$WORK/b$i.out" >/dev/null
+  cmp -s "$WORK/b$i.bin" "$WORK/b$i.out" || { echo "C2: B$i mismatch" >&2; exit 1; }
+done
+
+# 3. Node map exhaustion: a third file does not fit; image is unchanged.
+sum_before=$(sha256sum "$WORK/b.img" | awk '{print $1}')
+head -c $(( 300 * 512 )) /dev/urandom > "$WORK/b3.bin"
+if tool add "$WORK/b.img" "$WORK/b3.bin" B3 >"$WORK/b3.log" 2>&1; then
+  echo "C3: expected extents tree exhaustion" >&2; exit 1
+fi
+grep -q "B-tree map has no free nodes" "$WORK/b3.log" || {
+  echo "C3: unexpected error:" >&2; cat "$WORK/b3.log" >&2; exit 1
+}
+[[ "$sum_before" == "$(sha256sum "$WORK/b.img" | awk '{print $1}')" ]] || {
+  echo "C3: failed add modified the image" >&2; exit 1
+}
+
+# 4. Delete frees every extent and drops the overflow records.
+tool delete "$WORK/b.img" B1 >/dev/null
+tool extract "$WORK/b.img" B2 "$WORK/b2.out" >/dev/null
+cmp -s "$WORK/b2.bin" "$WORK/b2.out" || { echo "C4: B2 damaged by delete" >&2; exit 1; }
+tool delete "$WORK/b.img" B2 >/dev/null
+read -r depth nodes recs bfree drfree < <(xcheck "$WORK/b.img")
+[[ "$depth" == "0" && "$recs" == "0" && "$bfree" == "$drfree" ]] || {
+  echo "C4: extents tree not emptied; got $depth $nodes $recs $bfree $drfree" >&2; exit 1
+}
+
+echo "[PASS] HFS extents overflow"
@@ -0,0 +1,64 @@
+#!/usr/bin/env bash
+# patch: sector-level delta between two images.
+#
+# Verifies that:
+#   * create/apply reproduces the new image byte for byte
+#   * a patch made from DSK images applies to the same disk as DMK or
+#     XSA, and one made from IMG images applies to the DC42 copy
+#   * a patch refuses the wrong base image and a damaged patch file
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+FIXTURES="$SCRIPT_DIR/fixtures"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_patch_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+tool() { "$RDEDISKTOOL" --bootdisk-mode off -q "$@"; }
+fail() { echo "$1" >&2; exit 1; }
+
+tool create "$WORK/old.dsk" -f msxdsk --fs msxdos -n PATCH
+tool add "$WORK/old.dsk" "$FIXTURES/README.TXT" README.TXT
+tool add "$WORK/old.dsk" "$FIXTURES/BIG.bin" BIG.BIN
+cp "$WORK/old.dsk" "$WORK/new.dsk"
+tool delete "$WORK/new.dsk" README.TXT
+tool add "$WORK/new.dsk" "$FIXTURES/CHAPTER1.TXT" CHAPTER1.TXT
+
+tool patch create "$WORK/old.dsk" "$WORK/new.dsk" "$WORK/msx.rdp"
+[[ $(wc -c < "$WORK/msx.rdp") -lt $(( $(wc -c < "$WORK/new.dsk") / 10 )) ]] || fail "C1: patch is not compact"
+
+tool patch apply "$WORK/old.dsk" "$WORK/msx.rdp" "$WORK/out.dsk"
+cmp -s "$WORK/out.dsk" "$WORK/new.dsk" || fail "C1: DSK result differs"
+
+tool convert "$WORK/old.dsk" "$WORK/old.dmk"
+tool convert "$WORK/old.dsk" "$WORK/old.xsa"
+tool patch apply "$WORK/old.dmk" "$WORK/msx.rdp" "$WORK/from_dmk.dsk"
+cmp -s "$WORK/from_dmk.dsk" "$WORK/new.dsk" || fail "C2: DMK base gave a different result"
+tool patch apply "$WORK/old.xsa" "$WORK/msx.rdp" "$WORK/from_xsa.xsa"
+tool convert "$WORK/from_xsa.xsa" "$WORK/from_xsa.dsk" -f msxdsk
+cmp -s "$WORK/from_xsa.dsk" "$WORK/new.dsk" || fail "C2: XSA base gave a different result"
+
+cp "$FIXTURES/macintosh/608_SystemTools.img" "$WORK/old.img"
+cp "$WORK/old.img" "$WORK/new.img"
+tool add "$WORK/new.img" "$FIXTURES/README.TXT" NEWFILE
+tool patch create "$WORK/old.img" "$WORK/new.img" "$WORK/mac.rdp"
+tool convert "$WORK/old.img" "$WORK/old.image"
+tool patch apply "$WORK/old.image" "$WORK/mac.rdp" "$WORK/from_dc42.img"
+cmp -s "$WORK/from_dc42.img" "$WORK/new.img" || fail "C2: DC42 base gave a different result"
+
+if tool patch apply "$WORK/new.dsk" "$WORK/msx.rdp" "$WORK/bad.dsk" 2>/dev/null; then
+  fail "C3: patch applied to the wrong base"
+fi
+printf 'x' | dd of="$WORK/msx.rdp" bs=1 seek=60 conv=notrunc 2>/dev/null
+if tool patch apply "$WORK/old.dsk" "$WORK/msx.rdp" "$WORK/bad.dsk" 2>/dev/null; then
+  fail "C3: damaged patch was accepted"
+fi
+[[ ! -e "$WORK/bad.dsk" ]] || fail "C3: failed apply left an output file"
+
+echo "[PASS] patch"
@@ -0,0 +1,87 @@
+#!/usr/bin/env bash
+# ProDOS block images (HDV / 2MG) and volumes larger than 140K.
+#
+# Pass conditions:
+#   * a 32MB .hdv formats as ProDOS, accepts files in the root and in a
+#     subdirectory, extracts byte-identical, and validates
+#   * an 800K .2mg carries a ProDOS-order 2IMG header and round-trips
+#   * a 2MG header whose block count is past the ProDOS limit is rejected,
+#     even when count * 512 wraps to a small size in 32 bits
+#   * 140K .po <-> .hdv conversion preserves the volume byte for byte
+#   * DOS 3.3 is rejected on block images
+#   * zero-filled runs are stored as sparse holes and read back as zeros
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_prodos_hdv_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+# 2MB payload: needs index blocks well past the first bitmap block
+head -c 2097152 /dev/urandom > "$WORK/big.bin"
+head -c 3000 /dev/urandom > "$WORK/small.bin"
+
+# C1: 32MB HDV
+"$RDEDISKTOOL" create "$WORK/hd.hdv" -f hdv --fs prodos -n HARD >/dev/null
+[[ $(stat -c %s "$WORK/hd.hdv") -eq $((65535 * 512)) ]] || {
+  echo "C1: unexpected HDV size" >&2; exit 1
+}
+"$RDEDISKTOOL" add "$WORK/hd.hdv" "$WORK/big.bin" BIG >/dev/null
+"$RDEDISKTOOL" mkdir "$WORK/hd.hdv" SUB >/dev/null
+"$RDEDISKTOOL" add "$WORK/hd.hdv" "$WORK/small.bin" SUB/SMALL >/dev/null
+"$RDEDISKTOOL" extract "$WORK/hd.hdv" BIG "$WORK/big.out" >/dev/null
+"$RDEDISKTOOL" extract "$WORK/hd.hdv" SUB/SMALL "$WORK/small.out" >/dev/null
+cmp -s "$WORK/big.bin" "$WORK/big.out" || { echo "C1: BIG mismatch" >&2; exit 1; }
+cmp -s "$WORK/small.bin" "$WORK/small.out" || { echo "C1: SUB/SMALL mismatch" >&2; exit 1; }
+"$RDEDISKTOOL" validate "$WORK/hd.hdv" >/dev/null || { echo "C1: validate failed" >&2; exit 1; }
+
+# C2: 800K 2MG
+"$RDEDISKTOOL" create "$WORK/flop.2mg" -f 2mg -g 1600:1:1:512 --fs prodos -n FLOP >/dev/null
+[[ "$(head -c 4 "$WORK/flop.2mg")" == "2IMG" ]] || { echo "C2: missing 2IMG magic" >&2; exit 1; }
+[[ $(od -An -tu4 -j12 -N4 "$WORK/flop.2mg") -eq 1 ]] || { echo "C2: not ProDOS order" >&2; exit 1; }
+[[ $(od -An -tu4 -j20 -N4 "$WORK/flop.2mg") -eq 1600 ]] || { echo "C2: wrong block count" >&2; exit 1; }
+"$RDEDISKTOOL" add "$WORK/flop.2mg" "$WORK/small.bin" SMALL >/dev/null
+"$RDEDISKTOOL" extract "$WORK/flop.2mg" SMALL "$WORK/flop.out" >/dev/null
+cmp -s "$WORK/small.bin" "$WORK/flop.out" || { echo "C2: round-trip mismatch" >&2; exit 1; }
+
+# C2b: 0x800001 blocks with data length 0 (512 bytes after a 32-bit wrap)
+cp "$WORK/flop.2mg" "$WORK/wrap.2mg"
+printf '\x01\x00\x80\x00' | dd of="$WORK/wrap.2mg" bs=1 seek=20 conv=notrunc status=none
+printf '\x00\x00\x00\x00' | dd of="$WORK/wrap.2mg" bs=1 seek=28 conv=notrunc status=none
+if "$RDEDISKTOOL" info "$WORK/wrap.2mg" >/dev/null 2>&1; then
+  echo "C2b: 2MG with an oversized block count accepted" >&2; exit 1
+fi
+
+# C3: PO <-> HDV
+"$RDEDISKTOOL" create "$WORK/src.po" -f po --fs prodos -n SRC >/dev/null
+"$RDEDISKTOOL" add "$WORK/src.po" "$WORK/small.bin" SMALL >/dev/null
+"$RDEDISKTOOL" convert "$WORK/src.po" "$WORK/conv.hdv" >/dev/null
+"$RDEDISKTOOL" convert "$WORK/conv.hdv" "$WORK/back.po" >/dev/null
+cmp -s "$WORK/src.po" "$WORK/back.po" || { echo "C3: PO/HDV round-trip mismatch" >&2; exit 1; }
+
+# C4: DOS 3.3 is not a block-device file system
+if "$RDEDISKTOOL" create "$WORK/bad.hdv" -f hdv --fs dos33 >/dev/null 2>&1; then
+  echo "C4: dos33 on HDV accepted" >&2; exit 1
+fi
+
+# C5: sparse tree file (1000 data bytes, 400000 zero bytes, 5000 data bytes)
+{ head -c 1000 /dev/urandom; head -c 400000 /dev/zero; head -c 5000 /dev/urandom; } > "$WORK/sparse.bin"
+free_bytes() { "$RDEDISKTOOL" list "$1" | sed -n 's/^Free space: \([0-9]*\) bytes$/\1/p'; }
+before=$(free_bytes "$WORK/hd.hdv")
+"$RDEDISKTOOL" add "$WORK/hd.hdv" "$WORK/sparse.bin" SPARSE >/dev/null
+after=$(free_bytes "$WORK/hd.hdv")
+# master + 2 index blocks + 2 head blocks + 10 tail blocks
+[[ $((before - after)) -eq $((15 * 512)) ]] || {
+  echo "C5: sparse file used $((before - after)) bytes" >&2; exit 1
+}
+"$RDEDISKTOOL" extract "$WORK/hd.hdv" SPARSE "$WORK/sparse.out" >/dev/null
+cmp -s "$WORK/sparse.bin" "$WORK/sparse.out" || { echo "C5: sparse round-trip mismatch" >&2; exit 1; }
+"$RDEDISKTOOL" validate "$WORK/hd.hdv" >/dev/null || { echo "C5: validate failed" >&2; exit 1; }
+
+echo "[PASS] ProDOS HDV/2MG"
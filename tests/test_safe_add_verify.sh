@@ -0,0 +1,111 @@
+#!/usr/bin/env bash
+# Bootdisk safe-add: verification catches writes into existing files.
+#
+# Verifies that:
+#   * when an allocation map wrongly lists an existing file's storage as
+#     free, a safe add that reuses it is rejected and the image file is
+#     left untouched
+#   * this holds on the by-extent path (DSK, XDF, PO: flat images whose
+#     files map to raw-data runs) and on the readFile fallback (DMK, DIM)
+#   * the same add on an intact image passes verification
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+FIXTURES="$SCRIPT_DIR/fixtures"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+command -v python3 >/dev/null 2>&1 || { echo "missing python3" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_safe_add_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+tool() { "$RDEDISKTOOL" --bootdisk-mode off "$@"; }
+
+# Copy into $1 the bytes that deleting the victim changed in the
+# allocation map [$3, $4), so the victim stays listed but its storage is
+# free. $2 is the same image with the victim deleted.
+free_victim() {
+  python3 - "$@" <<'PY'
+import sys
+path, deleted, lo, hi = sys.argv[1], sys.argv[2], int(sys.argv[3]), int(sys.argv[4])
+a = bytearray(open(path, 'rb').read())
+b = open(deleted, 'rb').read()
+changed = [i for i in range(lo, hi) if a[i] != b[i]]
+assert changed, 'victim has no allocation map entries'
+for i in changed:
+    a[i] = b[i]
+open(path, 'wb').write(a)
+PY
+}
+
+# $1 image, $2 victim, $3 format, $4 filesystem, $5 command printing the
+# image's allocation map range. Leaves an undamaged copy as <name>_intact.
+make_case() {
+  local img="$1" victim="$2" format="$3" fs="$4" map_range="$5"
+  local deleted="${img%.*}_deleted.${img##*.}"
+  tool create "$img" -f "$format" --fs "$fs" -n SAFE >/dev/null
+  tool add "$img" "$FIXTURES/README.TXT" "$victim" >/dev/null
+  cp "$img" "$deleted"
+  tool --force-system-file delete "$deleted" "$victim" >/dev/null </dev/null
+  cp "$img" "$(intact "$img")"
+  # shellcheck disable=SC2046
+  free_victim "$img" "$deleted" $($map_range "$img")
+  rm -f "$deleted"
+}
+intact() { echo "${1%.*}_intact.${1##*.}"; }
+
+# FAT copies of an MSX-DOS image, from its boot sector BPB.
+msx_fats() {
+  python3 -c "
+import struct, sys
+b = open(sys.argv[1], 'rb').read(32)
+bps, res, nfats, spf = struct.unpack_from('<H', b, 11)[0], struct.unpack_from('<H', b, 14)[0], b[16], struct.unpack_from('<H', b, 22)[0]
+print(res * bps, (res + nfats * spf) * bps)" "$1"
+}
+# Human68k 2HD: two FAT copies of two 1024-byte sectors after the boot sector.
+x68k_fats() { echo 1024 5120; }
+# ProDOS volume bitmap, located by the volume directory header.
+prodos_bitmap() {
+  python3 -c "
+import struct, sys
+b = open(sys.argv[1], 'rb').read(1024 + 512)
+blk = struct.unpack_from('<H', b, 1024 + 0x27)[0]
+print(blk * 512, blk * 512 + 512)" "$1"
+}
+
+make_case "$WORK/m.dsk" COMMAND2.COM msxdsk msxdos msx_fats
+make_case "$WORK/x.xdf" HUMAN.SYS xdf human68k x68k_fats
+make_case "$WORK/p.po" PRODOS po prodos prodos_bitmap
+for pair in m.dsk:m.dmk x.xdf:x.dim; do
+  src="$WORK/${pair%%:*}" dst="$WORK/${pair##*:}"
+  tool convert "$src" "$dst" >/dev/null
+  tool convert "$(intact "$src")" "$(intact "$dst")" >/dev/null
+done
+
+for img in m.dsk x.xdf p.po m.dmk x.dim; do
+  # Intact: the safe add runs and passes.
+  out=$("$RDEDISKTOOL" add "$(intact "$WORK/$img")" "$FIXTURES/CHAPTER1.TXT" NEW.TXT 2>&1) || {
+    echo "$img: safe add on the intact image failed: $out" >&2; exit 1
+  }
+  [[ "$out" == *"safe-add verification enabled"* ]] || {
+    echo "$img: safe add did not engage: $out" >&2; exit 1
+  }
+
+  # Damaged: the add lands on the victim and is rejected before saving.
+  before=$(sha256sum "$WORK/$img" | awk '{print $1}')
+  if out=$("$RDEDISKTOOL" add "$WORK/$img" "$FIXTURES/CHAPTER1.TXT" NEW.TXT 2>&1); then
+    echo "$img: add into the victim's storage passed verification" >&2; exit 1
+  fi
+  [[ "$out" == *"verification failed: existing file was modified after add"* ]] || {
+    echo "$img: unexpected failure: $out" >&2; exit 1
+  }
+  [[ "$before" == "$(sha256sum "$WORK/$img" | awk '{print $1}')" ]] || {
+    echo "$img: rejected add was saved" >&2; exit 1
+  }
+done
+
+echo "[PASS] safe add verification"
@@ -0,0 +1,117 @@
+#!/usr/bin/env bash
+# Saving without re-loading: consecutive mutations, with and without --fsync.
+#
+# Verifies that:
+#   * two mutating CLI commands in a row, each saving with --fsync, leave
+#     a DMK, DIM and DC42 image equal to its own decode/encode round trip
+#     (convert to the flat format and back)
+#   * the same two adds through serve, flushed after each one, produce the
+#     same result although the image is never re-read between the saves
+#   * no temporary file is left beside the images
+#
+# MOOF and XSA load read-only, so the non-flat writable containers stand
+# in for them here.
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+FIXTURES="$SCRIPT_DIR/fixtures"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+command -v python3 >/dev/null 2>&1 || { echo "missing python3" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_save_seq_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+SOCK="$WORK/s.sock"
+SERVER_PID=""
+trap '[[ -n "$SERVER_PID" ]] && kill "$SERVER_PID" 2>/dev/null; rm -rf "$WORK"' EXIT
+
+tool() { "$RDEDISKTOOL" --bootdisk-mode off "$@"; }
+
+# Send request lines from stdin; print "ok exit" per response.
+CLIENT='
+import json, socket, sys
+s = socket.socket(socket.AF_UNIX)
+s.connect(sys.argv[1])
+f = s.makefile("rwb")
+for line in sys.stdin:
+    if line.strip():
+        f.write(line.encode()); f.flush()
+        r = json.loads(f.readline())
+        print(str(r["ok"]).lower(), r["exit"])
+'
+send() { python3 -c "$CLIENT" "$SOCK"; }
+
+# name:flat format:container format
+CASES="m:dsk:dmk x:xdf:dim h:img:dc42"
+flat_fmt() { case "$1" in dsk) echo msxdsk;; img) echo mac_img;; *) echo "$1";; esac; }
+cont_fmt() { case "$1" in dc42) echo mac_dc42;; *) echo "$1";; esac; }
+
+tool create "$WORK/m.dsk" -f msxdsk --fs msxdos -n SEQ >/dev/null
+tool create "$WORK/x.xdf" -f xdf --fs human68k -n SEQ >/dev/null
+tool create "$WORK/h.img" -f mac_img --fs hfs -n Seq >/dev/null
+for c in $CASES; do
+  IFS=: read -r name flat cont <<<"$c"
+  tool convert "$WORK/$name.$flat" "$WORK/$name.$cont" -f "$(cont_fmt "$cont")" >/dev/null
+  cp "$WORK/$name.$cont" "$WORK/${name}_srv.$cont"
+done
+
+# 1. Two CLI saves in a row.
+for c in $CASES; do
+  IFS=: read -r name flat cont <<<"$c"
+  tool --fsync add "$WORK/$name.$cont" "$FIXTURES/README.TXT" README.TXT >/dev/null
+  tool --fsync add "$WORK/$name.$cont" "$FIXTURES/BIG.bin" BIG.BIN >/dev/null
+done
+
+# 2. The same adds through serve, flushed between them.
+tool --fsync serve --socket "$SOCK" >/dev/null &
+SERVER_PID=$!
+for _ in $(seq 50); do [[ -S "$SOCK" ]] && break; sleep 0.1; done
+[[ -S "$SOCK" ]] || { echo "server did not start" >&2; exit 1; }
+for c in $CASES; do
+  IFS=: read -r name flat cont <<<"$c"
+  img="$WORK/${name}_srv.$cont"
+  out=$(send <<EOF
+{"cmd":"add","args":["$img","$FIXTURES/README.TXT","README.TXT"]}
+{"cmd":"flush","args":["$img"]}
+{"cmd":"add","args":["$img","$FIXTURES/BIG.bin","BIG.BIN"]}
+{"cmd":"flush","args":["$img"]}
+{"cmd":"close","args":["$img"]}
+EOF
+)
+  [[ "$(echo "$out" | grep -vc '^true 0$')" == "0" ]] || { echo "C2: $name.$cont: $out" >&2; exit 1; }
+done
+echo '{"cmd":"shutdown"}' | send >/dev/null
+wait "$SERVER_PID"
+SERVER_PID=""
+
+# 3. Every saved image equals its round trip and holds both files.
+for c in $CASES; do
+  IFS=: read -r name flat cont <<<"$c"
+  for img in "$WORK/$name.$cont" "$WORK/${name}_srv.$cont"; do
+    tag=$(basename "$img")
+    rm -f "$WORK/rt.$flat" "$WORK/rt.$cont"
+    tool convert "$img" "$WORK/rt.$flat" -f "$(flat_fmt "$flat")" >/dev/null
+    tool convert "$WORK/rt.$flat" "$WORK/rt.$cont" -f "$(cont_fmt "$cont")" >/dev/null
+    cmp -s "$img" "$WORK/rt.$cont" || { echo "C3: $tag differs from its round trip" >&2; exit 1; }
+    tool validate "$img" >/dev/null || { echo "C3: $tag does not validate" >&2; exit 1; }
+    for f in README.TXT:README.TXT BIG.BIN:BIG.bin; do
+      rm -f "$WORK/out.bin"
+      tool extract "$img" "${f%%:*}" "$WORK/out.bin" >/dev/null
+      cmp -s "$WORK/out.bin" "$FIXTURES/${f##*:}" || { echo "C3: $tag: ${f%%:*} differs" >&2; exit 1; }
+    done
+  done
+  # Without timestamps taken from the clock, both paths write the same bytes.
+  if [[ "$name" != h ]]; then
+    cmp -s "$WORK/$name.$cont" "$WORK/${name}_srv.$cont" || {
+      echo "C3: $name.$cont: serve result differs from the CLI result" >&2; exit 1
+    }
+  fi
+done
+
+leftovers=$(find "$WORK" -name '*.tmp.rdedisktool')
+[[ -z "$leftovers" ]] || { echo "temporary files left: $leftovers" >&2; exit 1; }
+
+echo "[PASS] save sequence"
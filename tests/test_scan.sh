@@ -0,0 +1,66 @@
+#!/usr/bin/env bash
+# scan: directory inventory as NDJSON.
+#
+# Verifies that:
+#   * every image under the directory (recursively) gets one "image"
+#     record followed by one "file" record per entry, subdirectories
+#     included, and non-image files are skipped
+#   * a broken image yields ok=false with an error and does not stop
+#     the scan
+#   * --jobs 1 and --jobs 4 produce the same set of records
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+FIXTURES="$SCRIPT_DIR/fixtures"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+command -v python3 >/dev/null 2>&1 || { echo "missing python3" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_scan_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK/tree/sub"
+trap 'rm -rf "$WORK"' EXIT
+
+tool() { "$RDEDISKTOOL" --bootdisk-mode off "$@"; }
+
+tool create "$WORK/tree/a.po" -f po --fs prodos -n SCAN >/dev/null
+tool mkdir "$WORK/tree/a.po" DIR >/dev/null
+tool add "$WORK/tree/a.po" "$FIXTURES/README.TXT" DIR/README >/dev/null
+tool add "$WORK/tree/a.po" "$FIXTURES/HELLO.BAS" HELLO >/dev/null
+tool create "$WORK/tree/sub/m.dsk" -f msxdsk --fs msxdos -n SCAN >/dev/null
+tool add "$WORK/tree/sub/m.dsk" "$FIXTURES/PATCH.BIN" PATCH.BIN >/dev/null
+cp "$FIXTURES/README.TXT" "$WORK/tree/notes.txt"
+# WOZ2 header whose first chunk claims to run far past the end of file
+printf 'WOZ2\xff\n\r\n\0\0\0\0INFO\xff\xff\xff\x7f' > "$WORK/tree/sub/broken.woz"
+head -c 3000 /dev/zero >> "$WORK/tree/sub/broken.woz"
+
+tool scan "$WORK/tree" --jobs 1 > "$WORK/j1.ndjson" 2>/dev/null
+tool scan "$WORK/tree" --jobs 4 > "$WORK/j4.ndjson" 2>/dev/null
+
+python3 - "$WORK/j1.ndjson" "$WORK/tree" <<'EOF'
+import json, sys
+recs = [json.loads(l) for l in open(sys.argv[1])]
+root = sys.argv[2]
+images = {r['image'][len(root) + 1:]: r for r in recs if r['type'] == 'image'}
+assert sorted(images) == ['a.po', 'sub/broken.woz', 'sub/m.dsk'], sorted(images)
+assert images['a.po']['ok'] and images['a.po']['format'] == 'ApplePO'
+assert images['a.po']['fileCount'] == 3, images['a.po']
+assert not images['sub/broken.woz']['ok'] and images['sub/broken.woz']['error']
+files = sorted(r['path'] for r in recs if r['type'] == 'file' and r['image'].endswith('a.po'))
+assert files == ['DIR', 'DIR/README', 'HELLO'], files
+# An image's file records follow its image record
+seen = set()
+for r in recs:
+    if r['type'] == 'image':
+        seen.add(r['image'])
+    else:
+        assert r['image'] in seen, r
+EOF
+
+[[ "$(sort "$WORK/j1.ndjson")" == "$(sort "$WORK/j4.ndjson")" ]] || {
+  echo "C3: --jobs 4 output differs from --jobs 1" >&2; exit 1
+}
+
+echo "[PASS] scan"
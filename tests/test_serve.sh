@@ -0,0 +1,166 @@
+#!/usr/bin/env bash
+# serve: NDJSON requests over a Unix socket against images kept in memory.
+#
+# Verifies that:
+#   * add/mkdir/list/extract/validate run against the loaded image and
+#     nothing reaches the file until flush/close
+#   * a flushed image matches the one plain CLI calls produce
+#   * a failed add (--force overwrite that runs out of space) rolls the
+#     image back instead of leaving the old file deleted
+#   * a failed request rolls back to the full in-memory state, keeping
+#     earlier unflushed writes (DIM keeps its tracks outside the raw data)
+#   * an external change to an image with unflushed changes is refused,
+#     and close --discard drops them
+#   * an "id" that is not a JSON string, number or literal ("1abc", "-x",
+#     "1.2.3") is rejected, and valid ones come back as valid JSON
+#   * a client that stays connected without sending does not block others
+#   * shutdown flushes what is still pending
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+FIXTURES="$SCRIPT_DIR/fixtures"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+command -v python3 >/dev/null 2>&1 || { echo "missing python3" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_serve_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+SOCK="$WORK/s.sock"
+SERVER_PID=""
+trap '[[ -n "$SERVER_PID" ]] && kill "$SERVER_PID" 2>/dev/null; rm -rf "$WORK"' EXIT
+
+tool() { "$RDEDISKTOOL" --bootdisk-mode off "$@"; }
+
+# Send request lines from stdin; print "ok exit" per response, or the
+# field named by $1 of the last response.
+CLIENT='
+import json, socket, sys
+s = socket.socket(socket.AF_UNIX)
+s.connect(sys.argv[1])
+f = s.makefile("rwb")
+last = None
+for line in sys.stdin:
+    if not line.strip():
+        continue
+    f.write(line.encode()); f.flush()
+    last = json.loads(f.readline())
+    if not sys.argv[2]:
+        print(str(last["ok"]).lower(), last["exit"])
+if sys.argv[2]:
+    print(last[sys.argv[2]], end="")
+'
+send() { python3 -c "$CLIENT" "$SOCK" "${1:-}"; }
+
+tool create "$WORK/m.dsk" -f msxdsk --fs msxdos -n SRV >/dev/null
+tool create "$WORK/h.img" -f mac_img --fs hfs -n Srv >/dev/null
+cp "$WORK/m.dsk" "$WORK/m_cli.dsk"
+m_before=$(sha256sum "$WORK/m.dsk" | awk '{print $1}')
+
+tool serve --socket "$SOCK" --cache 1 >/dev/null &
+SERVER_PID=$!
+for _ in $(seq 50); do [[ -S "$SOCK" ]] && break; sleep 0.1; done
+[[ -S "$SOCK" ]] || { echo "server did not start" >&2; exit 1; }
+
+# 1. Mutations stay in memory until flush.
+out=$(send <<EOF
+{"cmd":"add","args":["$WORK/m.dsk","$FIXTURES/README.TXT","README.TXT"]}
+{"cmd":"add","args":["$WORK/m.dsk","$FIXTURES/HELLO.BAS","HELLO.BAS"]}
+{"cmd":"mkdir","args":["$WORK/h.img","Dir"]}
+{"cmd":"add","args":["$WORK/h.img","$FIXTURES/CHAPTER1.TXT","Dir:Ch1"]}
+{"cmd":"extract","args":["$WORK/h.img","Dir:Ch1","$WORK/ch1.out"]}
+{"cmd":"validate","args":["$WORK/m.dsk"]}
+EOF
+)
+[[ "$(echo "$out" | grep -vc '^true 0$')" == "0" ]] || {
+  echo "C1: request failed:" >&2; echo "$out" >&2; exit 1
+}
+cmp -s "$FIXTURES/CHAPTER1.TXT" "$WORK/ch1.out" || { echo "C1: extract mismatch" >&2; exit 1; }
+[[ "$m_before" == "$(sha256sum "$WORK/m.dsk" | awk '{print $1}')" ]] || {
+  echo "C1: image written before flush" >&2; exit 1
+}
+send stdout <<EOF | grep -q "HELLO.BAS" || { echo "C1: list misses HELLO.BAS" >&2; exit 1; }
+{"cmd":"list","args":["$WORK/m.dsk"]}
+EOF
+
+# 2. Flush writes what plain CLI calls would have written.
+echo "{\"cmd\":\"flush\",\"args\":[\"$WORK/m.dsk\"]}" | send >/dev/null
+tool add "$WORK/m_cli.dsk" "$FIXTURES/README.TXT" README.TXT >/dev/null
+tool add "$WORK/m_cli.dsk" "$FIXTURES/HELLO.BAS" HELLO.BAS >/dev/null
+cmp -s "$WORK/m.dsk" "$WORK/m_cli.dsk" || { echo "C2: flushed image differs from CLI result" >&2; exit 1; }
+
+# 3. A failed add is rolled back.
+head -c 2000000 /dev/urandom > "$WORK/huge.bin"
+out=$(send <<EOF
+{"cmd":"add","args":["$WORK/m.dsk","$FIXTURES/PATCH.BIN","PATCH.BIN"]}
+{"cmd":"add","args":["-f","$WORK/m.dsk","$WORK/huge.bin","README.TXT"]}
+EOF
+)
+[[ "$out" == $'true 0\nfalse 1' ]] || { echo "C3: unexpected results: $out" >&2; exit 1; }
+echo "{\"cmd\":\"extract\",\"args\":[\"$WORK/m.dsk\",\"README.TXT\",\"$WORK/readme.out\"]}" | send >/dev/null
+cmp -s "$FIXTURES/README.TXT" "$WORK/readme.out" || { echo "C3: failed add was not rolled back" >&2; exit 1; }
+
+# 3b. A failed request keeps the unflushed writes before it.
+tool create "$WORK/x.dim" -f dim --fs human68k -n SRV >/dev/null
+tool create "$WORK/x.xdf" -f xdf --fs human68k -n SRV >/dev/null
+for img in x.dim x.xdf; do
+  out=$(send <<EOF
+{"cmd":"add","args":["$WORK/$img","$FIXTURES/README.TXT","H.TXT"]}
+{"cmd":"delete","args":["$WORK/$img","NOPE.TXT"]}
+{"cmd":"extract","args":["$WORK/$img","H.TXT","$WORK/h.out"]}
+{"cmd":"close","args":["$WORK/$img"]}
+EOF
+)
+  [[ "$out" == $'true 0\nfalse 1\ntrue 0\ntrue 0' ]] || { echo "C3b: $img: unexpected results: $out" >&2; exit 1; }
+  cmp -s "$FIXTURES/README.TXT" "$WORK/h.out" || { echo "C3b: $img: H.TXT lost in memory" >&2; exit 1; }
+  rm -f "$WORK/h.out"
+  tool extract "$WORK/$img" H.TXT "$WORK/h.out" >/dev/null
+  cmp -s "$FIXTURES/README.TXT" "$WORK/h.out" || { echo "C3b: $img: H.TXT not flushed" >&2; exit 1; }
+done
+
+# 4. External change with unflushed changes is refused; --discard drops them.
+touch -d '2001-01-01' "$WORK/m.dsk"
+err=$(echo "{\"cmd\":\"list\",\"args\":[\"$WORK/m.dsk\"]}" | send stderr)
+[[ "$err" == *"changed on disk"* ]] || { echo "C4: external change not detected: $err" >&2; exit 1; }
+echo "{\"cmd\":\"close\",\"args\":[\"$WORK/m.dsk\",\"--discard\"]}" | send >/dev/null
+cmp -s "$WORK/m.dsk" "$WORK/m_cli.dsk" || { echo "C4: discard wrote the image" >&2; exit 1; }
+
+# 4b. Request ids, with an idle client holding a connection open.
+python3 - "$SOCK" <<'PY' || { echo "C4b: id handling or idle client failed" >&2; exit 1; }
+import json, socket, sys
+
+def connect():
+    s = socket.socket(socket.AF_UNIX)
+    s.settimeout(10)
+    s.connect(sys.argv[1])
+    return s, s.makefile('rwb')
+
+def ask(f, line):
+    f.write(line.encode() + b'\n'); f.flush()
+    return json.loads(f.readline().decode('utf-8'))
+
+idle, idle_f = connect()
+_, f = connect()
+for bad in ('1abc', '-x', '1.2.3', '01', '1.', 'truex', '+1'):
+    r = ask(f, '{"cmd":"flush","id":%s}' % bad)
+    assert r['ok'] is False and 'id' not in r, (bad, r)
+    assert r['error'].startswith('Bad request'), (bad, r)
+for good, value in (('7', 7), ('-0.5e+3', -500.0), ('"a\\"b"', 'a"b'), ('null', None)):
+    r = ask(f, '{"cmd":"flush","id":%s}' % good)
+    assert r['ok'] is True and r['id'] == value, (good, r)
+r = ask(idle_f, '{"cmd":"flush","id":1}')
+assert r['ok'] is True and r['id'] == 1, r
+PY
+
+# 5. Shutdown flushes the pending HFS changes and removes the socket.
+echo '{"cmd":"shutdown"}' | send >/dev/null
+wait "$SERVER_PID"
+SERVER_PID=""
+[[ ! -e "$SOCK" ]] || { echo "C5: socket left behind" >&2; exit 1; }
+tool extract "$WORK/h.img" Dir:Ch1 "$WORK/ch1b.out" >/dev/null
+cmp -s "$FIXTURES/CHAPTER1.TXT" "$WORK/ch1b.out" || { echo "C5: shutdown did not flush" >&2; exit 1; }
+tool validate "$WORK/h.img" >/dev/null || { echo "C5: validate failed" >&2; exit 1; }
+
+echo "[PASS] serve"
@@ -0,0 +1,80 @@
+#!/usr/bin/env bash
+# --stats: per-phase timers and sector I/O counters.
+#
+# Verifies that:
+#   * --stats=json prints one JSON object to stderr with the documented
+#     phases and counters, and --json output on stdout stays parseable
+#   * sector reads and writes are counted on the direct-sector path
+#     (Human68k on XDF) and the raw-data path (HFS), not only through
+#     readSector()/writeSector()
+#   * nothing is printed without --stats
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TOOL_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+FIXTURES="$SCRIPT_DIR/fixtures"
+
+RDEDISKTOOL="${RDEDISKTOOL:-$TOOL_ROOT/build/rdedisktool}"
+[[ -x "$RDEDISKTOOL" ]] || { echo "missing rdedisktool binary" >&2; exit 1; }
+command -v python3 >/dev/null 2>&1 || { echo "missing python3" >&2; exit 1; }
+
+WORK="${WORK:-/tmp/rdedisktool_stats_$$}"
+rm -rf "$WORK"; mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+tool() { "$RDEDISKTOOL" --bootdisk-mode off "$@"; }
+
+tool create "$WORK/x.xdf" -f xdf --fs human68k -n STATS >/dev/null
+tool create "$WORK/h.img" -f mac_img --fs hfs -n Stats >/dev/null
+
+tool --stats=json add "$WORK/x.xdf" "$FIXTURES/README.TXT" README.TXT 2> "$WORK/xdf_add.json" >/dev/null
+tool --stats=json add "$WORK/h.img" "$FIXTURES/CHAPTER1.TXT" Ch1 2> "$WORK/hfs_add.json" >/dev/null
+tool --stats=json extract "$WORK/h.img" Ch1 "$WORK/ch1.out" 2> "$WORK/hfs_extract.json" >/dev/null
+tool --stats=json --json list "$WORK/x.xdf" > "$WORK/list.json" 2> "$WORK/list_stats.json"
+
+python3 - "$WORK" "$(stat -c %s "$WORK/x.xdf")" "$(stat -c %s "$FIXTURES/CHAPTER1.TXT")" <<'PY'
+import json, sys
+work, xdf_size, ch1_size = sys.argv[1], int(sys.argv[2]), int(sys.argv[3])
+load = lambda name: json.load(open(f"{work}/{name}"))
+
+PHASES = {'detect', 'load', 'fsInit', 'save', 'command'}
+COUNTERS = {'sectorReads', 'sectorBytesRead', 'sectorWrites', 'sectorBytesWritten', 'bytesLoaded'}
+
+def check_shape(s):
+    assert set(s) == {'phases', 'counters'}, s
+    assert set(s['phases']) == PHASES, s['phases']
+    for p in s['phases'].values():
+        assert set(p) == {'calls', 'nanoseconds'}, p
+    assert set(s['counters']) == COUNTERS, s['counters']
+
+x = load('xdf_add.json')
+check_shape(x)
+assert x['phases']['load']['calls'] == 1 and x['phases']['save']['calls'] == 1, x['phases']
+assert x['phases']['command']['nanoseconds'] > 0, x['phases']
+c = x['counters']
+assert c['bytesLoaded'] == xdf_size, c
+assert c['sectorReads'] > 0 and c['sectorWrites'] > 0, c
+assert c['sectorBytesWritten'] >= 1024 * c['sectorWrites'], c
+
+h = load('hfs_add.json')
+check_shape(h)
+assert h['counters']['sectorWrites'] > 0 and h['counters']['sectorBytesWritten'] >= ch1_size, h
+
+e = load('hfs_extract.json')
+check_shape(e)
+assert e['phases']['save']['calls'] == 0, e['phases']
+assert e['counters']['sectorBytesRead'] >= ch1_size and e['counters']['sectorWrites'] == 0, e
+
+check_shape(load('list_stats.json'))
+assert load('list.json')['files'], 'list --json output'
+PY
+
+err=$(tool list "$WORK/x.xdf" 2>&1 >/dev/null)
+[[ -z "$err" ]] || { echo "C3: output without --stats: $err" >&2; exit 1; }
+err=$(tool --stats list "$WORK/x.xdf" 2>&1 >/dev/null)
+[[ "$err" == "Statistics:"* && "$err" == *"sectorReads"* ]] || {
+  echo "C3: unexpected --stats text: $err" >&2; exit 1
+}
+
+echo "[PASS] stats"